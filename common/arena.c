@@ -0,0 +1,90 @@
+/**
+ * @file arena.c
+ *
+ * @brief Arena allocator module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stddef.h>
+#include "arena.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+void arena_init(arena_t *arena, void *buf_ptr, uint32_t buf_size)
+{
+    uint32_t padding = (ARENA_ALIGN - ((uintptr_t) buf_ptr % ARENA_ALIGN)) % ARENA_ALIGN;
+
+    // Start at the first aligned address, so that only the sizes of allocations need rounding up
+    if ((buf_ptr == NULL) || (buf_size < padding))
+    {
+        padding = 0;
+        buf_size = 0;
+    }
+    arena->base = (uint8_t *) buf_ptr + padding;
+    arena->size = buf_size - padding;
+    arena->used = 0;
+    arena->high_water = 0;
+    arena->failed_count = 0;
+}
+
+void *arena_alloc(arena_t *arena, uint32_t size)
+{
+    uint32_t aligned_size = (size + (ARENA_ALIGN - 1)) & ~((uint32_t) ARENA_ALIGN - 1);
+    void *ptr;
+
+    if ((aligned_size < size) || (aligned_size > (arena->size - arena->used)))
+    {
+        arena->failed_count++;
+        return NULL;
+    }
+
+    ptr = arena->base + arena->used;
+    arena->used += aligned_size;
+    if (arena->used > arena->high_water)
+    {
+        arena->high_water = arena->used;
+    }
+
+    return ptr;
+}
+
+void arena_reset(arena_t *arena)
+{
+    arena->used = 0;
+}
+
+uint32_t arena_get_high_water(arena_t *arena)
+{
+    return arena->high_water;
+}
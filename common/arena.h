@@ -0,0 +1,120 @@
+/**
+ * @file arena.h
+ *
+ * @brief Functions and prototypes exported by the arena allocator module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+
+/***********************************************************************************************************************
+ * LITERALS, CONSTANTS, MACROS
+ **********************************************************************************************************************/
+
+/**
+ * Alignment of every allocation from an arena, in bytes
+ */
+#define ARENA_ALIGN                                    (8)
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * Arena allocator state
+ *
+ * Allocations are taken in order from a single block of memory and are only freed all at once by arena_reset(), so
+ * an arena never fragments.  Pass one to the init functions of a pipeline (i.e. dspbuf_config_t member arena) and
+ * reset it once the pipeline has been deinitialized.
+ */
+typedef struct
+{
+    uint8_t *base;
+    uint32_t size;
+    uint32_t used;
+    uint32_t high_water;                                // Most bytes ever used, including alignment padding
+    uint32_t failed_count;                              // Number of allocations that did not fit
+} arena_t;
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Initialize an arena over a block of memory
+ *
+ * @param [in]
+ * - arena               Pointer to the arena state
+ * - buf_ptr             Pointer to the memory to allocate from
+ * - buf_size            Size of the memory in bytes
+ *
+ */
+void arena_init(arena_t *arena, void *buf_ptr, uint32_t buf_size);
+
+/**
+ * Allocate memory from an arena
+ *
+ * @param [in]
+ * - arena               Pointer to the arena state
+ * - size                Number of bytes to allocate
+ *
+ * @return
+ * - void *              Pointer to the memory, aligned to ARENA_ALIGN
+ * - NULL                if there is not enough space left in the arena
+ *
+ */
+void *arena_alloc(arena_t *arena, uint32_t size);
+
+/**
+ * Free everything allocated from an arena
+ *
+ * The high-water mark is kept, so it covers every use of the arena since arena_init().
+ *
+ * @param [in]
+ * - arena               Pointer to the arena state
+ *
+ */
+void arena_reset(arena_t *arena);
+
+/**
+ * Get the most memory that has been used from an arena at once
+ *
+ * @param [in]
+ * - arena               Pointer to the arena state
+ *
+ * @return                The high-water mark in bytes
+ *
+ */
+uint32_t arena_get_high_water(arena_t *arena);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARENA_H
@@ -0,0 +1,614 @@
+/**
+ * @file boot_sched.c
+ *
+ * @brief The multi-device boot scheduler module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "boot_sched.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Number of bytes read back from a device at a time to verify a broadcast data block
+ */
+#define BOOT_SCHED_VERIFY_BYTES                         (64)
+
+/**
+ * Access the transfer state of a job, which is shared with the BSP callback
+ *
+ * The release store in the callback ensures transfer_status is visible before is_transfer_pending is cleared, and
+ * the acquire load ensures block_data is only reused once the transfer has finished with it.
+ */
+#define BOOT_SCHED_LOAD_ACQUIRE(A)                      __atomic_load_n(&(A), __ATOMIC_ACQUIRE)
+#define BOOT_SCHED_STORE_RELEASE(A, B)                  __atomic_store_n(&(A), (B), __ATOMIC_RELEASE)
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * Devices to read each data block back from once it has been broadcast
+ */
+typedef struct
+{
+    boot_sched_job_t *jobs;
+    uint32_t num_jobs;
+} boot_sched_verify_t;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Check whether a job is still waiting for a reset delay to elapse
+ *
+ * @param [in] job              Pointer to the job
+ * @param [in] now_ms           Current time in ms
+ * @param [out] remaining_ms    Time left to wait in ms
+ *
+ * @return
+ * - true                       if the job is waiting
+ * - false                      otherwise
+ *
+ */
+static bool boot_sched_is_waiting(boot_sched_job_t *job, uint32_t now_ms, uint32_t *remaining_ms)
+{
+    uint32_t elapsed_ms = now_ms - job->wait_start_ms;
+
+    if ((job->state != BOOT_SCHED_STATE_RESET) || (elapsed_ms >= job->wait_ms))
+    {
+        return false;
+    }
+
+    *remaining_ms = job->wait_ms - elapsed_ms;
+
+    return true;
+}
+
+/**
+ * Check whether any job has a transfer on a bus
+ *
+ * @param [in] jobs             Array of jobs
+ * @param [in] num_jobs         Number of jobs in \b jobs
+ * @param [in] bus_id           The bus
+ *
+ * @return
+ * - true                       if a transfer is pending on the bus
+ * - false                      otherwise
+ *
+ */
+static bool boot_sched_is_bus_busy(boot_sched_job_t *jobs, uint32_t num_jobs, uint32_t bus_id)
+{
+    for (uint32_t i = 0; i < num_jobs; i++)
+    {
+        if ((jobs[i].bus_id == bus_id) && BOOT_SCHED_LOAD_ACQUIRE(jobs[i].is_transfer_pending))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * BSP callback once a data block written by boot_sched_step() has finished
+ *
+ * @param [in] status           BSP_STATUS_ of the transfer
+ * @param [in] cb_arg           Pointer to the job
+ *
+ */
+static void boot_sched_transfer_done(uint32_t status, void *cb_arg)
+{
+    boot_sched_job_t *job = (boot_sched_job_t *) cb_arg;
+
+    job->transfer_status = status;
+    BOOT_SCHED_STORE_RELEASE(job->is_transfer_pending, false);
+}
+
+/**
+ * Allocate memory for a job, from its arena if it has one
+ *
+ * @param [in] job              Pointer to the job
+ * @param [in] size             Number of bytes to allocate
+ *
+ * @return                      Pointer to the memory, or NULL if allocation failed
+ *
+ */
+static void *boot_sched_alloc(boot_sched_job_t *job, uint32_t size)
+{
+    if (job->arena != NULL)
+    {
+        return arena_alloc(job->arena, size);
+    }
+
+    return malloc(size);
+}
+
+/**
+ * Read the header of the current fw_img of a job
+ *
+ * For the first fw_img, the symbol table, algorithm ID list and coefficient set index are allocated into the user's
+ * fw_info so they are kept once the download is complete.  They are only allocated once per job.
+ *
+ * @param [in] job              Pointer to the job
+ *
+ * @return
+ * - BOOT_SCHED_STATUS_FAIL if:
+ *      - the fw_img header is invalid
+ *      - the fw_img blocks do not fit in the job's block_data
+ *      - allocation failed
+ * - BOOT_SCHED_STATUS_OK       otherwise
+ *
+ */
+static uint32_t boot_sched_read_header(boot_sched_job_t *job)
+{
+    fw_img_boot_state_t *boot_state = &(job->boot_state);
+    fw_img_info_t *fw_info = job->fw_info;
+    const uint8_t *fw_img = job->fw_imgs[job->fw_img_index];
+
+    // The fw_img is memory-mapped, so the whole fw_img can be provided at once
+    memset(boot_state, 0, sizeof(fw_img_boot_state_t));
+    boot_state->fw_img_blocks = (uint8_t *) fw_img;
+    boot_state->fw_img_blocks_size = FW_IMG_SIZE(fw_img);
+
+    if (fw_img_read_header(boot_state) != FW_IMG_STATUS_OK)
+    {
+        return BOOT_SCHED_STATUS_FAIL;
+    }
+
+    if ((job->fw_img_index == 0) && (!job->is_fw_info_ready))
+    {
+        fw_img_v3_header_t *header = &(boot_state->fw_info.header);
+
+        fw_info->sym_table = (fw_img_v1_sym_table_t *) boot_sched_alloc(job, header->sym_table_size *
+                                                                                 sizeof(fw_img_v1_sym_table_t));
+        fw_info->alg_id_list = (uint32_t *) boot_sched_alloc(job, header->alg_id_list_size * sizeof(uint32_t));
+        if (((fw_info->sym_table == NULL) && (header->sym_table_size > 0)) ||
+            ((fw_info->alg_id_list == NULL) && (header->alg_id_list_size > 0)))
+        {
+            return BOOT_SCHED_STATUS_FAIL;
+        }
+
+        if (header->coeff_sets > 0)
+        {
+            fw_info->coeff_set_index = (fw_img_v3_coeff_set_t *) boot_sched_alloc(job, header->coeff_sets *
+                                                                                     sizeof(fw_img_v3_coeff_set_t));
+            if (fw_info->coeff_set_index == NULL)
+            {
+                return BOOT_SCHED_STATUS_FAIL;
+            }
+        }
+        job->is_fw_info_ready = true;
+    }
+
+    // If the fw_img is downloaded again (i.e. after a failed verification), the tables are reused
+    if (job->fw_img_index == 0)
+    {
+        boot_state->fw_info.sym_table = fw_info->sym_table;
+        boot_state->fw_info.alg_id_list = fw_info->alg_id_list;
+        boot_state->fw_info.coeff_set_index = fw_info->coeff_set_index;
+    }
+
+    // From fw_img_v2 forward, the max_block_size is stored in the fw_img header itself
+    if ((boot_state->fw_info.preheader.img_format_rev != 1) &&
+        (boot_state->fw_info.header.max_block_size > job->block_data_size))
+    {
+        return BOOT_SCHED_STATUS_FAIL;
+    }
+    boot_state->block_data = job->block_data;
+    boot_state->block_data_size = job->block_data_size;
+
+    return BOOT_SCHED_STATUS_OK;
+}
+
+/**
+ * Read a data block back from every device that has matched so far
+ *
+ * The whole block is compared, a chunk at a time, straight after it has been broadcast, so that a block is never
+ * compared against data that a later block has overwritten.  Any device that does not match is marked to be
+ * downloaded to individually.
+ *
+ * @param [in] verify           Pointer to the devices to verify
+ * @param [in] boot_state       Pointer to the fw_img boot state holding the data block
+ *
+ */
+static void boot_sched_verify_block(boot_sched_verify_t *verify, fw_img_boot_state_t *boot_state)
+{
+    uint8_t bytes[BOOT_SCHED_VERIFY_BYTES] __attribute__((aligned(4)));
+    uint32_t block_addr = boot_state->block.block_addr;
+    uint32_t block_size = boot_state->block.block_size;
+
+    for (uint32_t i = 0; i < verify->num_jobs; i++)
+    {
+        boot_sched_job_t *job = &(verify->jobs[i]);
+
+        for (uint32_t offset = 0; (offset < block_size) && (!job->is_verify_failed); offset += sizeof(bytes))
+        {
+            uint32_t length = block_size - offset;
+
+            if (length > sizeof(bytes))
+            {
+                length = sizeof(bytes);
+            }
+
+            if ((regmap_read_block(job->cp, block_addr + offset, bytes, length) != REGMAP_STATUS_OK) ||
+                (memcmp(bytes, boot_state->block_data + offset, length) != 0))
+            {
+                job->is_verify_failed = true;
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * Run the next step of a job
+ *
+ * A step is a single reset step, reading a fw_img header, writing a single data block or finishing boot, so that no
+ * job holds up the others for long.  If \b is_async is set, a data block is only started, and the job must not be
+ * stepped again until is_transfer_pending has been cleared.  If \b cp is NULL, data blocks are skipped, so that the
+ * fw_imgs are only read for their fw_info.
+ *
+ * @param [in] job              Pointer to the job
+ * @param [in] cp               Pointer to the control port to download to, or NULL
+ * @param [in] verify           Pointer to the devices to read each data block back from once written, or NULL
+ * @param [in] is_async         true to start writing each data block and return without waiting for it to finish
+ * @param [in] now_ms           Current time in ms
+ *
+ * @return
+ * - BOOT_SCHED_STATUS_FAIL     if the step failed
+ * - BOOT_SCHED_STATUS_OK       otherwise
+ *
+ */
+static uint32_t boot_sched_step(boot_sched_job_t *job,
+                                regmap_cp_config_t *cp,
+                                boot_sched_verify_t *verify,
+                                bool is_async,
+                                uint32_t now_ms)
+{
+    uint32_t ret;
+    fw_img_boot_state_t *boot_state = &(job->boot_state);
+
+    switch (job->state)
+    {
+        case BOOT_SCHED_STATE_RESET:
+            job->wait_ms = 0;
+            ret = job->ops->reset(job->driver, &(job->reset_step), &(job->wait_ms));
+            if (ret != BOOT_SCHED_STATUS_OK)
+            {
+                return BOOT_SCHED_STATUS_FAIL;
+            }
+            job->wait_start_ms = now_ms;
+            if (job->reset_step == BOOT_SCHED_RESET_STEP_DONE)
+            {
+                job->state = BOOT_SCHED_STATE_READ_HEADER;
+            }
+            break;
+
+        case BOOT_SCHED_STATE_READ_HEADER:
+            ret = boot_sched_read_header(job);
+            if (ret != BOOT_SCHED_STATUS_OK)
+            {
+                return BOOT_SCHED_STATUS_FAIL;
+            }
+            job->state = BOOT_SCHED_STATE_DOWNLOAD;
+            break;
+
+        case BOOT_SCHED_STATE_DOWNLOAD:
+            ret = fw_img_process(boot_state);
+            if ((ret == FW_IMG_STATUS_DATA_READY) && (cp == NULL))
+            {
+                // The device already holds the data block
+            }
+            else if ((ret == FW_IMG_STATUS_DATA_READY) && is_async)
+            {
+                // Set before starting, as the callback can be called before regmap_write_block_async() returns
+                BOOT_SCHED_STORE_RELEASE(job->is_transfer_pending, true);
+                ret = regmap_write_block_async(cp,
+                                               boot_state->block.block_addr,
+                                               job->transfer_addr,
+                                               boot_state->block_data,
+                                               boot_state->block.block_size,
+                                               boot_sched_transfer_done,
+                                               job);
+                if (ret != REGMAP_STATUS_OK)
+                {
+                    BOOT_SCHED_STORE_RELEASE(job->is_transfer_pending, false);
+                    return BOOT_SCHED_STATUS_FAIL;
+                }
+            }
+            else if (ret == FW_IMG_STATUS_DATA_READY)
+            {
+                ret = regmap_write_block(cp,
+                                         boot_state->block.block_addr,
+                                         boot_state->block_data,
+                                         boot_state->block.block_size);
+                if (ret != REGMAP_STATUS_OK)
+                {
+                    return BOOT_SCHED_STATUS_FAIL;
+                }
+
+                if (verify != NULL)
+                {
+                    boot_sched_verify_block(verify, boot_state);
+                }
+            }
+            else if (ret == FW_IMG_STATUS_OK)
+            {
+                // The fw_img checksum has been processed, so all blocks have been written
+                if (job->fw_img_index == 0)
+                {
+                    *(job->fw_info) = boot_state->fw_info;
+                }
+                job->fw_img_index++;
+                if ((job->fw_img_index < BOOT_SCHED_MAX_FW_IMGS) && (job->fw_imgs[job->fw_img_index] != NULL))
+                {
+                    job->state = BOOT_SCHED_STATE_READ_HEADER;
+                }
+                else
+                {
+                    job->state = BOOT_SCHED_STATE_BOOT;
+                }
+            }
+            else
+            {
+                // The whole fw_img was provided, so running out of data means it is truncated
+                return BOOT_SCHED_STATUS_FAIL;
+            }
+            break;
+
+        case BOOT_SCHED_STATE_BOOT:
+            ret = job->ops->boot(job->driver, job->fw_info);
+            if (ret != BOOT_SCHED_STATUS_OK)
+            {
+                return BOOT_SCHED_STATUS_FAIL;
+            }
+            job->state = BOOT_SCHED_STATE_DONE;
+            break;
+
+        default:
+            return BOOT_SCHED_STATUS_FAIL;
+    }
+
+    return BOOT_SCHED_STATUS_OK;
+}
+
+/**
+ * Download all fw_imgs of a job in one go
+ *
+ * @param [in] job              Pointer to the job
+ * @param [in] cp               Pointer to the control port to download to, or NULL to only read the fw_imgs
+ * @param [in] verify           Pointer to the devices to read each data block back from once written, or NULL
+ *
+ * @return
+ * - BOOT_SCHED_STATUS_FAIL     if any step failed
+ * - BOOT_SCHED_STATUS_OK       otherwise
+ *
+ */
+static uint32_t boot_sched_download(boot_sched_job_t *job, regmap_cp_config_t *cp, boot_sched_verify_t *verify)
+{
+    job->fw_img_index = 0;
+    job->state = BOOT_SCHED_STATE_READ_HEADER;
+
+    while (job->state != BOOT_SCHED_STATE_BOOT)
+    {
+        if (boot_sched_step(job, cp, verify, false, 0) != BOOT_SCHED_STATUS_OK)
+        {
+            return BOOT_SCHED_STATUS_FAIL;
+        }
+    }
+
+    return BOOT_SCHED_STATUS_OK;
+}
+
+/**
+ * Check that a job has been initialised by the user
+ *
+ * @param [in] job              Pointer to the job
+ *
+ * @return
+ * - true                       if all members needed for download and boot are set
+ * - false                      otherwise
+ *
+ */
+static bool boot_sched_is_job_valid(boot_sched_job_t *job)
+{
+    return ((job->driver != NULL) && (job->ops != NULL) && (job->ops->boot != NULL) && (job->cp != NULL) &&
+            (job->fw_imgs[0] != NULL) && (job->fw_info != NULL) && (job->block_data != NULL));
+}
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Boot a number of devices concurrently
+ *
+ */
+uint32_t boot_sched_run(boot_sched_job_t *jobs, uint32_t num_jobs, uint32_t (*get_time_ms)(void))
+{
+    uint32_t ret = BOOT_SCHED_STATUS_OK;
+    uint32_t virtual_ms = 0;
+    uint32_t i;
+
+    if (jobs == NULL)
+    {
+        return BOOT_SCHED_STATUS_FAIL;
+    }
+
+    for (i = 0; i < num_jobs; i++)
+    {
+        boot_sched_job_t *job = &(jobs[i]);
+
+        if (!boot_sched_is_job_valid(job) || (job->ops->reset == NULL))
+        {
+            return BOOT_SCHED_STATUS_FAIL;
+        }
+
+        job->state = BOOT_SCHED_STATE_RESET;
+        job->fw_img_index = 0;
+        job->is_fw_info_ready = false;
+        job->reset_step = 0;
+        job->wait_start_ms = 0;
+        job->wait_ms = 0;
+        job->is_transfer_pending = false;
+        job->transfer_status = BSP_STATUS_OK;
+    }
+
+    while (1)
+    {
+        bool is_active = false;
+        bool has_run = false;
+        bool is_transferring = false;
+        uint32_t min_remaining_ms = 0xFFFFFFFF;
+        uint32_t now_ms = (get_time_ms != NULL) ? get_time_ms() : virtual_ms;
+
+        // Give every job that isn't waiting, and whose bus is free, one step in turn
+        for (i = 0; i < num_jobs; i++)
+        {
+            boot_sched_job_t *job = &(jobs[i]);
+            uint32_t remaining_ms;
+
+            if ((job->state == BOOT_SCHED_STATE_DONE) || (job->state == BOOT_SCHED_STATE_ERROR))
+            {
+                continue;
+            }
+            is_active = true;
+
+            if (BOOT_SCHED_LOAD_ACQUIRE(job->is_transfer_pending))
+            {
+                is_transferring = true;
+                continue;
+            }
+
+            if (job->transfer_status != BSP_STATUS_OK)
+            {
+                job->state = BOOT_SCHED_STATE_ERROR;
+                ret = BOOT_SCHED_STATUS_FAIL;
+                continue;
+            }
+
+            if (boot_sched_is_waiting(job, now_ms, &remaining_ms))
+            {
+                if (remaining_ms < min_remaining_ms)
+                {
+                    min_remaining_ms = remaining_ms;
+                }
+                continue;
+            }
+
+            // Another job sharing the bus is using it, and every step may access the control port
+            if (boot_sched_is_bus_busy(jobs, num_jobs, job->bus_id))
+            {
+                continue;
+            }
+
+            if (boot_sched_step(job, job->cp, NULL, true, now_ms) != BOOT_SCHED_STATUS_OK)
+            {
+                job->state = BOOT_SCHED_STATE_ERROR;
+                ret = BOOT_SCHED_STATUS_FAIL;
+            }
+            has_run = true;
+        }
+
+        if (!is_active)
+        {
+            break;
+        }
+
+        // Every remaining job is waiting, so sleep until the first one is ready.  While any transfer is still on a
+        // bus, keep polling instead, so that its job can carry on as soon as it has finished.
+        if ((!has_run) && (!is_transferring))
+        {
+            bsp_driver_if_g->set_timer(min_remaining_ms, NULL, NULL);
+            virtual_ms += min_remaining_ms;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * Download identical fw_imgs to a number of devices with a single broadcast
+ *
+ */
+uint32_t boot_sched_broadcast(boot_sched_job_t *jobs, uint32_t num_jobs, regmap_cp_config_t *broadcast_cp)
+{
+    uint32_t ret = BOOT_SCHED_STATUS_OK;
+    boot_sched_verify_t verify;
+    uint32_t i;
+
+    if ((jobs == NULL) || (num_jobs == 0) || (broadcast_cp == NULL))
+    {
+        return BOOT_SCHED_STATUS_FAIL;
+    }
+
+    for (i = 0; i < num_jobs; i++)
+    {
+        if (!boot_sched_is_job_valid(&(jobs[i])))
+        {
+            return BOOT_SCHED_STATUS_FAIL;
+        }
+        jobs[i].is_fw_info_ready = false;
+        jobs[i].is_verify_failed = false;
+    }
+
+    // Send the fw_imgs once to every device, reading each data block back from every device as it goes.  A failure
+    // here is not fatal, but as the remaining blocks have not been verified, every device is downloaded to individually.
+    verify.jobs = jobs;
+    verify.num_jobs = num_jobs;
+    if (boot_sched_download(&(jobs[0]), broadcast_cp, &verify) != BOOT_SCHED_STATUS_OK)
+    {
+        for (i = 0; i < num_jobs; i++)
+        {
+            jobs[i].is_verify_failed = true;
+        }
+    }
+
+    for (i = 0; i < num_jobs; i++)
+    {
+        boot_sched_job_t *job = &(jobs[i]);
+
+        // A device that matched still needs the symbol table and algorithm ID list read into its own fw_info
+        if (boot_sched_download(job, (job->is_verify_failed ? job->cp : NULL), NULL) != BOOT_SCHED_STATUS_OK)
+        {
+            job->state = BOOT_SCHED_STATE_ERROR;
+            ret = BOOT_SCHED_STATUS_FAIL;
+            continue;
+        }
+
+        if (boot_sched_step(job, job->cp, NULL, false, 0) != BOOT_SCHED_STATUS_OK)
+        {
+            job->state = BOOT_SCHED_STATE_ERROR;
+            ret = BOOT_SCHED_STATUS_FAIL;
+        }
+    }
+
+    return ret;
+}
+
+/**********************************************************************************************************************/
@@ -0,0 +1,219 @@
+/**
+ * @file boot_sched.h
+ *
+ * @brief Functions and prototypes exported by the multi-device boot scheduler module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef BOOT_SCHED_H
+#define BOOT_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "bsp_driver_if.h"
+#include "regmap.h"
+#include "fw_img.h"
+#include "arena.h"
+
+/***********************************************************************************************************************
+ * LITERALS, CONSTANTS, MACROS
+ **********************************************************************************************************************/
+
+/**
+ * @defgroup BOOT_SCHED_STATUS_
+ * @brief Return codes for boot_sched API calls
+ *
+ * @{
+ */
+#define BOOT_SCHED_STATUS_OK                           (0)
+#define BOOT_SCHED_STATUS_FAIL                         (1)
+/** @} */
+
+/**
+ * @defgroup BOOT_SCHED_STATE_
+ * @brief State of a boot_sched job
+ *
+ * @see boot_sched_job_t member state
+ *
+ * @{
+ */
+#define BOOT_SCHED_STATE_RESET                         (0)
+#define BOOT_SCHED_STATE_READ_HEADER                   (1)
+#define BOOT_SCHED_STATE_DOWNLOAD                      (2)
+#define BOOT_SCHED_STATE_BOOT                          (3)
+#define BOOT_SCHED_STATE_DONE                          (4)
+#define BOOT_SCHED_STATE_ERROR                         (5)
+/** @} */
+
+/**
+ * Value of the reset step once reset has completed
+ *
+ * @see boot_sched_ops_t member reset
+ */
+#define BOOT_SCHED_RESET_STEP_DONE                     (0xFFFFFFFF)
+
+/**
+ * Maximum number of fw_imgs (i.e. firmware then tuning) that can be downloaded per job
+ */
+#define BOOT_SCHED_MAX_FW_IMGS                         (2)
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * Device-specific operations used by the boot scheduler
+ */
+typedef struct
+{
+    /**
+     * Perform the next step of resetting the device
+     *
+     * Must not wait - any delay required before the next step is returned in \b wait_ms.  Called first with \b step
+     * set to 0.  Reset is complete once \b step is set to BOOT_SCHED_RESET_STEP_DONE.
+     *
+     * @param [in] driver           Pointer to the driver state
+     * @param [in,out] step         Pointer to the current step, updated to the next step
+     * @param [out] wait_ms         Minimum time to wait in ms before performing the next step
+     *
+     * @return
+     * - BOOT_SCHED_STATUS_FAIL     if reset failed
+     * - BOOT_SCHED_STATUS_OK       otherwise
+     *
+     */
+    uint32_t (*reset)(void *driver, uint32_t *step, uint32_t *wait_ms);
+
+    /**
+     * Finish booting the device once all fw_imgs have been downloaded
+     *
+     * @param [in] driver           Pointer to the driver state
+     * @param [in] fw_info          Pointer to the fw_img info of the first fw_img of the job
+     *
+     * @return
+     * - BOOT_SCHED_STATUS_FAIL     if boot failed
+     * - BOOT_SCHED_STATUS_OK       otherwise
+     *
+     */
+    uint32_t (*boot)(void *driver, fw_img_info_t *fw_info);
+} boot_sched_ops_t;
+
+/**
+ * Data structure to describe booting one device
+ *
+ * The fw_img symbol table, algorithm ID list and coefficient set index for the first fw_img are malloc'ed into
+ * fw_info by the scheduler, and must be freed by the user as for a normal boot.  If member arena is set, they are
+ * allocated from the arena instead, and are freed along with the rest of the arena.
+ *
+ * Jobs whose control ports are on the same bus must have the same bus_id, so that only one of them uses the bus at a
+ * time.  Leaving bus_id at 0 for every job is always safe.
+ */
+typedef struct
+{
+    void *driver;                                       // Initialised by user
+    const boot_sched_ops_t *ops;                        // Initialised by user
+    regmap_cp_config_t *cp;                             // Initialised by user
+    uint32_t bus_id;                                    // Initialised by user
+    const uint8_t *fw_imgs[BOOT_SCHED_MAX_FW_IMGS];     // Initialised by user, unused entries must be NULL
+    fw_img_info_t *fw_info;                             // Initialised by user
+    uint8_t *block_data;                                // Initialised by user, large enough for any block
+    uint32_t block_data_size;                           // Initialised by user
+    arena_t *arena;                                     // Initialised by user, optional
+
+    uint8_t state;
+    uint8_t fw_img_index;
+    bool is_fw_info_ready;
+    bool is_verify_failed;
+    uint32_t reset_step;
+    uint32_t wait_start_ms;
+    uint32_t wait_ms;
+    fw_img_boot_state_t boot_state;
+    bool is_transfer_pending;                           // Cleared from the BSP callback, possibly in interrupt context
+    uint32_t transfer_status;                           // BSP_STATUS_ of the last transfer, set with the above
+    uint8_t transfer_addr[4];
+} boot_sched_job_t;
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Boot a number of devices concurrently
+ *
+ * Runs each job through reset, fw_img download and boot.  The jobs are interleaved cooperatively: whenever one
+ * job has to wait (i.e. for reset or OTP, or for its last data block to finish on the bus), the other jobs carry on,
+ * one step at a time.  The scheduler only sleeps when every unfinished job is waiting for reset or OTP.
+ *
+ * Data blocks are written with regmap_write_block_async(), so the scheduler moves on to the next job while a block is
+ * still on the bus.  Jobs with different bus_ids download at the same time, so when every device has its own bus,
+ * total boot time approaches that of the slowest device rather than the sum of all of them.  Jobs with the same
+ * bus_id take turns, one step at a time, and gain only the overlap of their reset waits.  Only I2C control ports
+ * have asynchronous transfers in bsp_driver_if_t, so on other buses each block is finished before moving on.
+ *
+ * If \b get_time_ms is NULL, time only advances while the scheduler sleeps.  Waits are then never shortened, but
+ * time spent downloading is not credited to other jobs' waits.
+ *
+ * @param [in] jobs             Array of jobs
+ * @param [in] num_jobs         Number of jobs in \b jobs
+ * @param [in] get_time_ms      Optional function returning a free-running millisecond count
+ *
+ * @return
+ * - BOOT_SCHED_STATUS_FAIL if:
+ *      - any NULL pointers
+ *      - any job failed - the state of each job is left in member state
+ * - BOOT_SCHED_STATUS_OK       otherwise
+ *
+ */
+uint32_t boot_sched_run(boot_sched_job_t *jobs, uint32_t num_jobs, uint32_t (*get_time_ms)(void));
+
+/**
+ * Download identical fw_imgs to a number of devices with a single broadcast
+ *
+ * The fw_imgs of the first job are written once to \b broadcast_cp.  Each data block is read back in full from every
+ * device on its own control port as soon as it has been broadcast, and any device where a block does not match is
+ * downloaded to individually.  Finally each device is booted.  When all devices share a bus, this turns N downloads
+ * into one download plus N read backs, so any time saved depends on how much faster the bus reads than it writes.
+ *
+ * The devices must already be reset and configured to respond to the broadcast address, which is device-specific.
+ * Member ops->reset of the jobs is not used, and member cp of each job must support regmap_read_block().
+ *
+ * @param [in] jobs             Array of jobs, all with identical fw_imgs
+ * @param [in] num_jobs         Number of jobs in \b jobs
+ * @param [in] broadcast_cp     Pointer to the control port for the broadcast address
+ *
+ * @return
+ * - BOOT_SCHED_STATUS_FAIL if:
+ *      - any NULL pointers
+ *      - any job failed - the state of each job is left in member state
+ * - BOOT_SCHED_STATUS_OK       otherwise
+ *
+ */
+uint32_t boot_sched_broadcast(boot_sched_job_t *jobs, uint32_t num_jobs, regmap_cp_config_t *broadcast_cp);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_SCHED_H
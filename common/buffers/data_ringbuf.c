@@ -22,6 +22,7 @@
 /***********************************************************************************************************************
  * INCLUDES
  **********************************************************************************************************************/
+#include <stddef.h>
 #include <string.h>
 #include "data_ringbuf.h"
 
@@ -29,6 +30,23 @@
  * LOCAL LITERAL SUBSTITUTIONS
  **********************************************************************************************************************/
 
+/**
+ * Access the free-running byte counts shared between producer and consumer
+ *
+ * The acquire load ensures buffer memory is only accessed after the other side's count has been seen, and the release
+ * store ensures the count is only published after this side has finished accessing buffer memory.
+ */
+#define DATA_RINGBUF_LOAD_ACQUIRE(A)            __atomic_load_n(&(A), __ATOMIC_ACQUIRE)
+#define DATA_RINGBUF_STORE_RELEASE(A, B)        __atomic_store_n(&(A), (B), __ATOMIC_RELEASE)
+
+/**
+ * Access the gap recorded by the producer, which the consumer may read while the producer records the next one
+ *
+ * Ordering comes from gap_seq and write_count, so only atomicity is needed here.
+ */
+#define DATA_RINGBUF_LOAD_RELAXED(A)            __atomic_load_n(&(A), __ATOMIC_RELAXED)
+#define DATA_RINGBUF_STORE_RELAXED(A, B)        __atomic_store_n(&(A), (B), __ATOMIC_RELAXED)
+
 /***********************************************************************************************************************
  * LOCAL VARIABLES
  **********************************************************************************************************************/
@@ -37,6 +55,94 @@
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
 
+/**
+ * Advance a read or write index by a number of bytes, wrapping at the end of the buffer
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - index            The index to advance
+ * - len              The number of bytes to advance by, no more than buf_size
+ *
+ * @return
+ * - uint32_t         The advanced index
+ *
+ */
+static inline uint32_t data_ringbuf_advance(data_ringbuf_t *data_buf_ptr, uint32_t index, uint32_t len)
+{
+    index += len;
+
+    if (data_buf_ptr->buf_mask != 0)
+    {
+        return index & data_buf_ptr->buf_mask;
+    }
+
+    if (index >= data_buf_ptr->buf_size)
+    {
+        index -= data_buf_ptr->buf_size;
+    }
+
+    return index;
+}
+
+/**
+ * Find how much data is available to the consumer
+ *
+ * Any gap left at the end of the buffer by data_ringbuf_reserve_contiguous() is not counted as data.  If the consumer
+ * has reached the gap, it can be skipped so the next read starts at the beginning of the buffer.
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - skip_gap         true to skip a gap at the next read location, only allowed from the consumer
+ *
+ * @param [out]
+ * - contig_len_ptr   Pointer to a length that will be set to the number of contiguous bytes at the next read location
+ *
+ * @return
+ * - uint32_t         The number of bytes in the buffer
+ *
+ */
+static uint32_t data_ringbuf_read_avail(data_ringbuf_t *data_buf_ptr, bool skip_gap, uint32_t *contig_len_ptr)
+{
+    uint32_t write_count = DATA_RINGBUF_LOAD_ACQUIRE(data_buf_ptr->write_count);
+    uint32_t read_count = data_buf_ptr->read_count;
+    uint32_t data_length = write_count - read_count;
+    uint32_t contig_len = data_buf_ptr->buf_size - data_buf_ptr->next_byte_read_index;
+    // A gap_seq that is seen brings the gap_count and gap_len recorded with it, and the gap is then only used once
+    // write_count has published it
+    uint32_t gap_seq = DATA_RINGBUF_LOAD_ACQUIRE(data_buf_ptr->gap_seq);
+    uint32_t gap_count = DATA_RINGBUF_LOAD_RELAXED(data_buf_ptr->gap_count);
+    uint32_t gap_len = DATA_RINGBUF_LOAD_RELAXED(data_buf_ptr->gap_len);
+
+    // A gap is pending if it has been published and the consumer has not yet skipped it.  The producer can't record a
+    // new gap until read_count passes this one, so a gap_seq other than the last one skipped is always ahead.
+    if ((gap_seq != data_buf_ptr->gap_skip_seq) && ((int32_t) (write_count - gap_count) > 0))
+    {
+        if (skip_gap && (gap_count == read_count))
+        {
+            data_buf_ptr->gap_skip_seq = gap_seq;
+            data_buf_ptr->next_byte_read_index = 0;
+            DATA_RINGBUF_STORE_RELEASE(data_buf_ptr->read_count, read_count + gap_len);
+            contig_len = data_buf_ptr->buf_size;
+        }
+        else
+        {
+            contig_len = gap_count - read_count;
+        }
+        data_length -= gap_len;
+    }
+
+    if (contig_len > data_length)
+    {
+        contig_len = data_length;
+    }
+    if (contig_len_ptr != NULL)
+    {
+        *contig_len_ptr = contig_len;
+    }
+
+    return data_length;
+}
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
@@ -45,19 +151,39 @@ void data_ringbuf_init(data_ringbuf_t *data_buf_ptr, uint8_t *buf_ptr, uint32_t
 {
     data_buf_ptr->buf_ptr = buf_ptr;
     data_buf_ptr->buf_size = buf_size;
+    data_buf_ptr->buf_mask = 0;
     data_buf_ptr->next_byte_write_index = 0;
+    data_buf_ptr->write_count = 0;
+    data_buf_ptr->gap_count = 0;
+    data_buf_ptr->gap_len = 0;
+    data_buf_ptr->gap_seq = 0;
+    data_buf_ptr->gap_skip_seq = 0;
     data_buf_ptr->next_byte_read_index = 0;
-    data_buf_ptr->data_length = 0;
+    data_buf_ptr->read_count = 0;
+}
+
+uint32_t data_ringbuf_init_pow2(data_ringbuf_t *data_buf_ptr, uint8_t *buf_ptr, uint32_t buf_size)
+{
+    if ((buf_size == 0) || ((buf_size & (buf_size - 1)) != 0))
+    {
+        return DATA_RINGBUF_STATUS_FAIL;
+    }
+
+    data_ringbuf_init(data_buf_ptr, buf_ptr, buf_size);
+    data_buf_ptr->buf_mask = buf_size - 1;
+
+    return DATA_RINGBUF_STATUS_OK;
 }
 
 uint32_t data_ringbuf_free_space(data_ringbuf_t *data_buf_ptr)
 {
-    return data_buf_ptr->buf_size - data_buf_ptr->data_length;
+    // The counts are free-running, so the difference is correct even once they wrap
+    return data_buf_ptr->buf_size - (data_buf_ptr->write_count - DATA_RINGBUF_LOAD_ACQUIRE(data_buf_ptr->read_count));
 }
 
 uint32_t data_ringbuf_data_length(data_ringbuf_t *data_buf_ptr)
 {
-    return data_buf_ptr->data_length;
+    return data_ringbuf_read_avail(data_buf_ptr, false, NULL);
 }
 
 void data_ringbuf_next_write_block(data_ringbuf_t *data_buf_ptr, uint8_t **write_ptr_ptr, uint32_t *write_len_ptr)
@@ -70,13 +196,11 @@ void data_ringbuf_next_write_block(data_ringbuf_t *data_buf_ptr, uint8_t **write
     }
     else
     {
-        if (data_buf_ptr->next_byte_read_index <= data_buf_ptr->next_byte_write_index)
+        // Only the producer's own index is used, as the consumer's index may be changing
+        *write_len_ptr = data_buf_ptr->buf_size - data_buf_ptr->next_byte_write_index;
+        if (*write_len_ptr > free_space)
         {
-            *write_len_ptr = data_buf_ptr->buf_size - data_buf_ptr->next_byte_write_index;
-        }
-        else
-        {
-            *write_len_ptr = data_buf_ptr->next_byte_read_index - data_buf_ptr->next_byte_write_index;
+            *write_len_ptr = free_space;
         }
         *write_ptr_ptr = data_buf_ptr->buf_ptr + data_buf_ptr->next_byte_write_index;
     }
@@ -84,21 +208,14 @@ void data_ringbuf_next_write_block(data_ringbuf_t *data_buf_ptr, uint8_t **write
 
 void data_ringbuf_next_read_block(data_ringbuf_t *data_buf_ptr, uint8_t **read_ptr_ptr, uint32_t *read_len_ptr)
 {
-    if (data_ringbuf_data_length(data_buf_ptr) == 0)
+    // Only the consumer's own index is used, as the producer's index may be changing
+    data_ringbuf_read_avail(data_buf_ptr, true, read_len_ptr);
+    if (*read_len_ptr == 0)
     {
-        *read_len_ptr = 0;
         *read_ptr_ptr = NULL;
     }
     else
     {
-        if (data_buf_ptr->next_byte_write_index <= data_buf_ptr->next_byte_read_index)
-        {
-            *read_len_ptr = data_buf_ptr->buf_size - data_buf_ptr->next_byte_read_index;
-        }
-        else
-        {
-            *read_len_ptr = data_buf_ptr->next_byte_write_index - data_buf_ptr->next_byte_read_index;
-        }
         *read_ptr_ptr = data_buf_ptr->buf_ptr + data_buf_ptr->next_byte_read_index;
     }
 }
@@ -106,7 +223,7 @@ void data_ringbuf_next_read_block(data_ringbuf_t *data_buf_ptr, uint8_t **read_p
 uint32_t data_ringbuf_read(data_ringbuf_t *data_buf_ptr, uint8_t* dest_ptr, uint32_t read_len)
 {
     uint32_t bytes_read = 0;
-    if (data_buf_ptr->data_length < read_len)
+    if (data_ringbuf_data_length(data_buf_ptr) < read_len)
     {
         return DATA_RINGBUF_STATUS_FAIL;
     }
@@ -131,28 +248,209 @@ uint32_t data_ringbuf_read(data_ringbuf_t *data_buf_ptr, uint8_t* dest_ptr, uint
 
 uint32_t data_ringbuf_bytes_written(data_ringbuf_t *data_buf_ptr, uint32_t write_len)
 {
-    if (((data_buf_ptr->data_length + write_len) > data_buf_ptr->buf_size)
+    if ((data_ringbuf_free_space(data_buf_ptr) < write_len)
      || ((data_buf_ptr->next_byte_write_index + write_len) > data_buf_ptr->buf_size))
     {
         return DATA_RINGBUF_STATUS_FAIL;
     }
-    data_buf_ptr->next_byte_write_index = (data_buf_ptr->next_byte_write_index + write_len) % data_buf_ptr->buf_size;
-    data_buf_ptr->data_length += write_len;
+    data_buf_ptr->next_byte_write_index = data_ringbuf_advance(data_buf_ptr,
+                                                               data_buf_ptr->next_byte_write_index,
+                                                               write_len);
+    // Publish the new data to the consumer
+    DATA_RINGBUF_STORE_RELEASE(data_buf_ptr->write_count, data_buf_ptr->write_count + write_len);
     return DATA_RINGBUF_STATUS_OK;
 }
 
 uint32_t data_ringbuf_bytes_read(data_ringbuf_t *data_buf_ptr, uint32_t read_len)
 {
-    if ((data_buf_ptr->data_length < read_len)
-    || ((data_buf_ptr->next_byte_read_index + read_len) > data_buf_ptr->buf_size))
+    uint32_t contig_len;
+
+    data_ringbuf_read_avail(data_buf_ptr, true, &contig_len);
+    if (contig_len < read_len)
     {
         return DATA_RINGBUF_STATUS_FAIL;
     }
-    data_buf_ptr->next_byte_read_index = (data_buf_ptr->next_byte_read_index + read_len) % data_buf_ptr->buf_size;
-    data_buf_ptr->data_length -= read_len;
+    data_buf_ptr->next_byte_read_index = data_ringbuf_advance(data_buf_ptr,
+                                                              data_buf_ptr->next_byte_read_index,
+                                                              read_len);
+    // Publish the freed space to the producer
+    DATA_RINGBUF_STORE_RELEASE(data_buf_ptr->read_count, data_buf_ptr->read_count + read_len);
     return DATA_RINGBUF_STATUS_OK;
 }
 
+uint32_t data_ringbuf_reserve_contiguous(data_ringbuf_t *data_buf_ptr, uint32_t len, uint8_t **write_ptr_ptr)
+{
+    uint32_t free_space = data_ringbuf_free_space(data_buf_ptr);
+    uint32_t tail_len = data_buf_ptr->buf_size - data_buf_ptr->next_byte_write_index;
+
+    *write_ptr_ptr = NULL;
+
+    if (tail_len >= len)
+    {
+        if (free_space < len)
+        {
+            return DATA_RINGBUF_STATUS_FAIL;
+        }
+        *write_ptr_ptr = data_buf_ptr->buf_ptr + data_buf_ptr->next_byte_write_index;
+        return DATA_RINGBUF_STATUS_OK;
+    }
+
+    // Not enough room before the end of the buffer, so leave the tail as a gap and start a second region at the
+    // beginning of the buffer
+    if ((len > data_buf_ptr->buf_size) || (free_space < (tail_len + len)))
+    {
+        return DATA_RINGBUF_STATUS_FAIL;
+    }
+
+    // The gap must be recorded before gap_seq announces it, and announced before it is published by write_count
+    DATA_RINGBUF_STORE_RELAXED(data_buf_ptr->gap_count, data_buf_ptr->write_count);
+    DATA_RINGBUF_STORE_RELAXED(data_buf_ptr->gap_len, tail_len);
+    DATA_RINGBUF_STORE_RELEASE(data_buf_ptr->gap_seq, data_buf_ptr->gap_seq + 1);
+    data_buf_ptr->next_byte_write_index = 0;
+    DATA_RINGBUF_STORE_RELEASE(data_buf_ptr->write_count, data_buf_ptr->write_count + tail_len);
+
+    *write_ptr_ptr = data_buf_ptr->buf_ptr;
+
+    return DATA_RINGBUF_STATUS_OK;
+}
+
+uint32_t data_ringbuf_peek_contiguous(data_ringbuf_t *data_buf_ptr, uint32_t len, uint8_t **read_ptr_ptr)
+{
+    uint32_t contig_len;
+
+    data_ringbuf_read_avail(data_buf_ptr, true, &contig_len);
+    if ((len == 0) || (contig_len < len))
+    {
+        *read_ptr_ptr = NULL;
+        return DATA_RINGBUF_STATUS_FAIL;
+    }
+
+    *read_ptr_ptr = data_buf_ptr->buf_ptr + data_buf_ptr->next_byte_read_index;
+
+    return DATA_RINGBUF_STATUS_OK;
+}
+
+uint32_t data_ringbuf_get_read_iov(data_ringbuf_t *data_buf_ptr, data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX])
+{
+    uint32_t contig_len;
+    uint32_t data_length;
+
+    // Any gap at the next read location is skipped, so the data after the first segment always starts at index 0
+    data_length = data_ringbuf_read_avail(data_buf_ptr, true, &contig_len);
+
+    iov[0].ptr = (contig_len > 0) ? (data_buf_ptr->buf_ptr + data_buf_ptr->next_byte_read_index) : NULL;
+    iov[0].len = contig_len;
+    iov[1].ptr = (data_length > contig_len) ? data_buf_ptr->buf_ptr : NULL;
+    iov[1].len = data_length - contig_len;
+
+    return data_length;
+}
+
+uint32_t data_ringbuf_get_write_iov(data_ringbuf_t *data_buf_ptr, data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX])
+{
+    uint32_t free_space = data_ringbuf_free_space(data_buf_ptr);
+    uint32_t contig_len = data_buf_ptr->buf_size - data_buf_ptr->next_byte_write_index;
+
+    if (contig_len > free_space)
+    {
+        contig_len = free_space;
+    }
+
+    iov[0].ptr = (contig_len > 0) ? (data_buf_ptr->buf_ptr + data_buf_ptr->next_byte_write_index) : NULL;
+    iov[0].len = contig_len;
+    iov[1].ptr = (free_space > contig_len) ? data_buf_ptr->buf_ptr : NULL;
+    iov[1].len = free_space - contig_len;
+
+    return free_space;
+}
+
+uint32_t data_ringbuf_commit_read_iov(data_ringbuf_t *data_buf_ptr, uint32_t read_len)
+{
+    uint32_t contig_len;
+
+    if (data_ringbuf_read_avail(data_buf_ptr, true, &contig_len) < read_len)
+    {
+        return DATA_RINGBUF_STATUS_FAIL;
+    }
+
+    // Remove the first segment separately, so that any gap before the second segment is skipped
+    if (read_len > contig_len)
+    {
+        data_ringbuf_bytes_read(data_buf_ptr, contig_len);
+        read_len -= contig_len;
+    }
+
+    return data_ringbuf_bytes_read(data_buf_ptr, read_len);
+}
+
+uint32_t data_ringbuf_commit_write_iov(data_ringbuf_t *data_buf_ptr, uint32_t write_len)
+{
+    if (data_ringbuf_free_space(data_buf_ptr) < write_len)
+    {
+        return DATA_RINGBUF_STATUS_FAIL;
+    }
+    data_buf_ptr->next_byte_write_index = data_ringbuf_advance(data_buf_ptr,
+                                                               data_buf_ptr->next_byte_write_index,
+                                                               write_len);
+    // Publish both segments to the consumer at once
+    DATA_RINGBUF_STORE_RELEASE(data_buf_ptr->write_count, data_buf_ptr->write_count + write_len);
+    return DATA_RINGBUF_STATUS_OK;
+}
+
+uint32_t data_ringbuf_iov_contig(data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX], uint32_t offset, uint32_t unit_bytes)
+{
+    if (offset < iov[0].len)
+    {
+        return (iov[0].len - offset) / unit_bytes;
+    }
+
+    return (iov[1].len - (offset - iov[0].len)) / unit_bytes;
+}
+
+uint8_t *data_ringbuf_iov_ptr(data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX],
+                              uint32_t offset,
+                              uint32_t len,
+                              uint8_t *temp_buf,
+                              bool is_read)
+{
+    if ((offset + len) <= iov[0].len)
+    {
+        return iov[0].ptr + offset;
+    }
+    else if (offset >= iov[0].len)
+    {
+        return iov[1].ptr + (offset - iov[0].len);
+    }
+
+    if (is_read)
+    {
+        for (uint32_t index = 0; index < len; index++, offset++)
+        {
+            temp_buf[index] = (offset < iov[0].len) ? iov[0].ptr[offset] : iov[1].ptr[offset - iov[0].len];
+        }
+    }
+
+    return temp_buf;
+}
+
+void data_ringbuf_iov_scatter(data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX],
+                              uint32_t offset,
+                              uint32_t len,
+                              const uint8_t *temp_buf)
+{
+    for (uint32_t index = 0; index < len; index++, offset++)
+    {
+        if (offset < iov[0].len)
+        {
+            iov[0].ptr[offset] = temp_buf[index];
+        }
+        else
+        {
+            iov[1].ptr[offset - iov[0].len] = temp_buf[index];
+        }
+    }
+}
+
 uint32_t data_ringbuf_write(data_ringbuf_t *data_buf_ptr, uint8_t *buf_ptr, uint32_t buf_size)
 {
     uint32_t free_space = data_ringbuf_free_space(data_buf_ptr);
@@ -31,6 +31,7 @@ extern "C" {
  * INCLUDES
  **********************************************************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 
 /***********************************************************************************************************************
  * LITERALS & CONSTANTS
@@ -44,6 +45,11 @@ extern "C" {
 #define DATA_RINGBUF_STATUS_OK                    (0)
 #define DATA_RINGBUF_STATUS_FAIL                  (1)
 
+/**
+ * Maximum number of segments needed to describe all data or all free space in a data ring buffer
+ */
+#define DATA_RINGBUF_IOV_MAX                      (2)
+
 /***********************************************************************************************************************
  * MACROS
  **********************************************************************************************************************/
@@ -55,16 +61,49 @@ extern "C" {
 
 /**
  * Data structure for storing a ring buffer of data
+ *
+ * The buffer is safe for a single producer and a single consumer running in different contexts (i.e. a DMA callback
+ * and the main loop) without disabling IRQs.  Each side only writes its own members, and publishes its free-running
+ * byte count after it has finished with the buffer memory, so the other side never sees a partial update.
+ *
+ * The producer may only call data_ringbuf_free_space(), data_ringbuf_next_write_block(), data_ringbuf_bytes_written(),
+ * data_ringbuf_reserve_contiguous(), data_ringbuf_get_write_iov(), data_ringbuf_commit_write_iov() and
+ * data_ringbuf_write().  The consumer may only call data_ringbuf_data_length(), data_ringbuf_next_read_block(),
+ * data_ringbuf_bytes_read(), data_ringbuf_peek_contiguous(), data_ringbuf_get_read_iov(),
+ * data_ringbuf_commit_read_iov() and data_ringbuf_read().
+ * data_ringbuf_init() must only be called when neither side is using the buffer.
+ *
+ * The buffer also works as a bip-buffer: data_ringbuf_reserve_contiguous() leaves the end of the buffer unused when a
+ * block won't fit before it, and starts a second region at the beginning of the buffer instead.  The consumer skips
+ * the unused gap, so blocks reserved this way can always be read in place with data_ringbuf_peek_contiguous().
  */
  typedef struct
  {
      uint8_t *buf_ptr;
      uint32_t buf_size;
-     uint32_t data_length;
-     uint32_t next_byte_write_index;
-     uint32_t next_byte_read_index;
+     uint32_t buf_mask;                         // buf_size - 1 if initialised with data_ringbuf_init_pow2(), else 0
+     uint32_t next_byte_write_index;            // Owned by the producer
+     uint32_t write_count;                      // Owned by the producer, total bytes ever written
+     uint32_t gap_count;                        // Owned by the producer, write_count at the start of the last gap
+     uint32_t gap_len;                          // Owned by the producer, length of the last gap
+     uint32_t gap_seq;                          // Owned by the producer, number of gaps ever recorded
+     uint32_t next_byte_read_index;             // Owned by the consumer
+     uint32_t read_count;                       // Owned by the consumer, total bytes ever read
+     uint32_t gap_skip_seq;                     // Owned by the consumer, gap_seq of the last gap skipped
  } data_ringbuf_t;
 
+/**
+ * One contiguous segment of a data ring buffer
+ *
+ * @see data_ringbuf_get_read_iov
+ * @see data_ringbuf_get_write_iov
+ */
+typedef struct
+{
+    uint8_t *ptr;                               // Start of the segment, NULL if len is 0
+    uint32_t len;                               // Length of the segment in bytes
+} data_ringbuf_iov_t;
+
 /***********************************************************************************************************************
  * GLOBAL VARIABLES
  **********************************************************************************************************************/
@@ -84,6 +123,23 @@ extern "C" {
  */
 void data_ringbuf_init(data_ringbuf_t *data_buf_ptr, uint8_t *buf_ptr, uint32_t buf_size);
 
+/**
+ * Initialize data ring buffer struct with a power-of-two size
+ *
+ * Wrapping the read and write indexes is then a mask rather than a compare and subtract.
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - buf_ptr          Pointer to the memory to use for the ring buffer data
+ * - buf_size         Size of the ring buffer data memory (in bytes), must be a power of two
+ *
+ * @return
+ * - DATA_RINGBUF_STATUS_FAIL       buf_size is not a power of two
+ * - DATA_RINGBUF_STATUS_OK         The ring buffer was initialized
+ *
+ */
+uint32_t data_ringbuf_init_pow2(data_ringbuf_t *data_buf_ptr, uint8_t *buf_ptr, uint32_t buf_size);
+
 /**
  * Return the number of unused bytes in the data ring buffer
  *
@@ -177,6 +233,166 @@ uint32_t data_ringbuf_bytes_written(data_ringbuf_t *data_buf_ptr, uint32_t write
  */
 uint32_t data_ringbuf_bytes_read(data_ringbuf_t *data_buf_ptr, uint32_t read_len);
 
+/**
+ * Reserve a contiguous area of the buffer to write to
+ *
+ * If there is not enough room before the end of the buffer, the rest of the buffer is skipped and the area is
+ * reserved at the beginning of the buffer.  Once written, the data is committed with data_ringbuf_bytes_written().
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - len              The number of contiguous bytes to reserve
+ *
+ * @param [out]
+ * - write_ptr_ptr    Pointer to a byte pointer that will be set to point to the reserved area, or NULL on failure
+ *
+ * @return
+ * - DATA_RINGBUF_STATUS_FAIL       There is not enough free space for len contiguous bytes
+ * - DATA_RINGBUF_STATUS_OK         The area was reserved
+ *
+ */
+uint32_t data_ringbuf_reserve_contiguous(data_ringbuf_t *data_buf_ptr, uint32_t len, uint8_t **write_ptr_ptr);
+
+/**
+ * Get a pointer to a number of contiguous bytes at the next read location, without removing them from the buffer
+ *
+ * Always succeeds for data written in blocks of at least len bytes with data_ringbuf_reserve_contiguous().  Once
+ * used, the data is removed with data_ringbuf_bytes_read().
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - len              The number of contiguous bytes required
+ *
+ * @param [out]
+ * - read_ptr_ptr     Pointer to a byte pointer that will be set to point to the data, or NULL on failure
+ *
+ * @return
+ * - DATA_RINGBUF_STATUS_FAIL       There are not len contiguous bytes at the next read location
+ * - DATA_RINGBUF_STATUS_OK         read_ptr_ptr points to len bytes of data
+ *
+ */
+uint32_t data_ringbuf_peek_contiguous(data_ringbuf_t *data_buf_ptr, uint32_t len, uint8_t **read_ptr_ptr);
+
+/**
+ * Get all of the data in the buffer as up to two segments
+ *
+ * The segments are in read order.  If the data wraps the end of the buffer, the second segment starts at the beginning
+ * of the buffer, otherwise it has length 0.  Once used, the data is removed with data_ringbuf_commit_read_iov().
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ *
+ * @param [out]
+ * - iov              Array of DATA_RINGBUF_IOV_MAX segments that will be set to describe the data
+ *
+ * @return
+ * - uint32_t         The total length of the segments, i.e. the number of bytes in the buffer
+ *
+ */
+uint32_t data_ringbuf_get_read_iov(data_ringbuf_t *data_buf_ptr, data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX]);
+
+/**
+ * Get all of the free space in the buffer as up to two segments
+ *
+ * The segments are in write order.  If the free space wraps the end of the buffer, the second segment starts at the
+ * beginning of the buffer, otherwise it has length 0.  Once written, the data is committed with
+ * data_ringbuf_commit_write_iov().
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ *
+ * @param [out]
+ * - iov              Array of DATA_RINGBUF_IOV_MAX segments that will be set to describe the free space
+ *
+ * @return
+ * - uint32_t         The total length of the segments, i.e. the number of free bytes in the buffer
+ *
+ */
+uint32_t data_ringbuf_get_write_iov(data_ringbuf_t *data_buf_ptr, data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX]);
+
+/**
+ * Remove a number of bytes read using data_ringbuf_get_read_iov() from the buffer
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - read_len         The number of bytes read, starting at the first segment and continuing into the second
+ *
+ * @return
+ * - DATA_RINGBUF_STATUS_FAIL       There are fewer than read_len bytes in the buffer
+ * - DATA_RINGBUF_STATUS_OK         The bytes were removed
+ *
+ */
+uint32_t data_ringbuf_commit_read_iov(data_ringbuf_t *data_buf_ptr, uint32_t read_len);
+
+/**
+ * Commit a number of bytes written using data_ringbuf_get_write_iov() to the buffer
+ *
+ * @param [in]
+ * - data_buf_ptr     Pointer to the data ring buffer structure
+ * - write_len        The number of bytes written, starting at the first segment and continuing into the second
+ *
+ * @return
+ * - DATA_RINGBUF_STATUS_FAIL       There are fewer than write_len bytes of free space in the buffer
+ * - DATA_RINGBUF_STATUS_OK         The bytes were committed
+ *
+ */
+uint32_t data_ringbuf_commit_write_iov(data_ringbuf_t *data_buf_ptr, uint32_t write_len);
+
+/**
+ * Get the number of whole units (i.e. samples or frames) from an offset up to the end of its segment
+ *
+ * @param [in]
+ * - iov              Array of DATA_RINGBUF_IOV_MAX segments from data_ringbuf_get_read_iov() or
+ *                    data_ringbuf_get_write_iov()
+ * - offset           Offset into the segments, starting at the first segment and continuing into the second
+ * - unit_bytes       Size of a unit in bytes
+ *
+ * @return
+ * - uint32_t         The number of whole units that can be accessed in place from offset
+ *
+ */
+uint32_t data_ringbuf_iov_contig(data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX], uint32_t offset, uint32_t unit_bytes);
+
+/**
+ * Get a pointer to a number of bytes at an offset into the segments from data_ringbuf_get_read_iov() or
+ * data_ringbuf_get_write_iov()
+ *
+ * If the bytes straddle the two segments, a pointer to temp_buf is returned instead.  When reading, the bytes are
+ * first gathered into temp_buf; when writing, they must be scattered back with data_ringbuf_iov_scatter().  This
+ * lets a stage work on whole samples or frames in place, only copying the one that wraps the end of the buffer.
+ *
+ * @param [in]
+ * - iov              Array of DATA_RINGBUF_IOV_MAX segments
+ * - offset           Offset of the bytes, starting at the first segment and continuing into the second
+ * - len              The number of bytes, which must all be within the segments
+ * - temp_buf         At least len bytes to use if the bytes straddle the segments, may be NULL if they can't
+ * - is_read          true to gather the bytes into temp_buf
+ *
+ * @return
+ * - uint8_t *        Pointer to the bytes, or to temp_buf
+ *
+ */
+uint8_t *data_ringbuf_iov_ptr(data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX],
+                              uint32_t offset,
+                              uint32_t len,
+                              uint8_t *temp_buf,
+                              bool is_read);
+
+/**
+ * Copy bytes from temp_buf back to an offset into the segments from data_ringbuf_get_write_iov()
+ *
+ * @param [in]
+ * - iov              Array of DATA_RINGBUF_IOV_MAX segments
+ * - offset           Offset of the bytes, starting at the first segment and continuing into the second
+ * - len              The number of bytes, which must all be within the segments
+ * - temp_buf         The bytes, as returned by data_ringbuf_iov_ptr()
+ *
+ */
+void data_ringbuf_iov_scatter(data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX],
+                              uint32_t offset,
+                              uint32_t len,
+                              const uint8_t *temp_buf);
+
 /**
  * Write a number of bytes into the buffer
  *
@@ -0,0 +1,457 @@
+/**
+ * @file data_ringbuf_tee.c
+ *
+ * @brief The multi-reader data ring buffer API module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "data_ringbuf_tee.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Access the counts shared between the producer and the readers
+ *
+ * As for data_ringbuf, the acquire load ensures buffer memory is only accessed after the other side's count has been
+ * seen, and the release store ensures the count is only published after this side has finished with buffer memory.
+ * The full barrier separates dropping a reader from overwriting the data it may still be reading.
+ */
+#define DATA_RINGBUF_TEE_LOAD_ACQUIRE(A)        __atomic_load_n(&(A), __ATOMIC_ACQUIRE)
+#define DATA_RINGBUF_TEE_STORE_RELEASE(A, B)    __atomic_store_n(&(A), (B), __ATOMIC_RELEASE)
+#define DATA_RINGBUF_TEE_BARRIER()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Find the free space left by a reader, from the producer's side
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_ptr       Pointer to the reader
+ *
+ * @return
+ * - uint32_t         The number of bytes free, or buf_size if the reader is inactive or has been dropped
+ *
+ */
+static uint32_t data_ringbuf_tee_reader_space(data_ringbuf_tee_t *tee_ptr, data_ringbuf_tee_reader_t *reader_ptr)
+{
+    uint32_t lag;
+
+    // The reader's read_count is only valid once it has acknowledged being dropped
+    if ((!reader_ptr->is_active)
+     || (DATA_RINGBUF_TEE_LOAD_ACQUIRE(reader_ptr->ack_drop_count) != reader_ptr->drop_count))
+    {
+        return tee_ptr->buf_size;
+    }
+
+    // A reader that is resynchronising can briefly be more than a buffer behind, if so it is simply in the way
+    lag = tee_ptr->write_count - DATA_RINGBUF_TEE_LOAD_ACQUIRE(reader_ptr->read_count);
+    if (lag > tee_ptr->buf_size)
+    {
+        lag = tee_ptr->buf_size;
+    }
+
+    return tee_ptr->buf_size - lag;
+}
+
+/**
+ * Find the free space left by every reader that has not been dropped
+ *
+ */
+static uint32_t data_ringbuf_tee_space(data_ringbuf_tee_t *tee_ptr)
+{
+    uint32_t space = tee_ptr->buf_size;
+
+    for (uint32_t i = 0; i < tee_ptr->num_readers; i++)
+    {
+        uint32_t reader_space = data_ringbuf_tee_reader_space(tee_ptr, &tee_ptr->readers[i]);
+
+        if (reader_space < space)
+        {
+            space = reader_space;
+        }
+    }
+
+    return space;
+}
+
+/**
+ * Find the contiguous free space left by every reader that has not been dropped
+ *
+ */
+static uint32_t data_ringbuf_tee_contig_space(data_ringbuf_tee_t *tee_ptr)
+{
+    uint32_t write_index = tee_ptr->write_count & tee_ptr->buf_mask;
+    uint32_t space = data_ringbuf_tee_space(tee_ptr);
+
+    if (space > (tee_ptr->buf_size - write_index))
+    {
+        space = tee_ptr->buf_size - write_index;
+    }
+
+    return space;
+}
+
+/**
+ * Resynchronise a reader that has been dropped by the producer
+ *
+ * The reader skips to the newest data and the lost data is recorded as an overrun.
+ *
+ * The producer ignores a dropped reader until it sees the acknowledgement, so by then it may have written more than a
+ * whole buffer past the reader's read_count.  A reader that is more than a buffer behind is clamped to the oldest data
+ * still in the buffer, and the bytes skipped are also recorded as lost.
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_ptr       Pointer to the reader
+ *
+ * @return
+ * - true             The reader had been dropped
+ * - false            otherwise
+ *
+ */
+static bool data_ringbuf_tee_reader_sync(data_ringbuf_tee_t *tee_ptr, data_ringbuf_tee_reader_t *reader_ptr)
+{
+    uint32_t drop_count = DATA_RINGBUF_TEE_LOAD_ACQUIRE(reader_ptr->drop_count);
+    bool is_dropped = (drop_count != reader_ptr->ack_drop_count);
+    uint32_t write_count;
+
+    if (is_dropped)
+    {
+        write_count = DATA_RINGBUF_TEE_LOAD_ACQUIRE(tee_ptr->write_count);
+        reader_ptr->overrun_count++;
+        reader_ptr->overrun_bytes += write_count - reader_ptr->read_count;
+
+        // The new read_count must be visible to the producer before it starts taking the reader into account again
+        DATA_RINGBUF_TEE_STORE_RELEASE(reader_ptr->read_count, write_count);
+        DATA_RINGBUF_TEE_STORE_RELEASE(reader_ptr->ack_drop_count, drop_count);
+
+        // Only check how far the producer got once the acknowledgement is visible to it
+        DATA_RINGBUF_TEE_BARRIER();
+    }
+
+    write_count = DATA_RINGBUF_TEE_LOAD_ACQUIRE(tee_ptr->write_count);
+    if ((write_count - reader_ptr->read_count) > tee_ptr->buf_size)
+    {
+        uint32_t oldest_count = write_count - tee_ptr->buf_size;
+
+        reader_ptr->overrun_bytes += oldest_count - reader_ptr->read_count;
+        DATA_RINGBUF_TEE_STORE_RELEASE(reader_ptr->read_count, oldest_count);
+    }
+
+    return is_dropped;
+}
+
+/**
+ * Check whether a reader was dropped while it was reading, after it has finished accessing buffer memory
+ *
+ */
+static bool data_ringbuf_tee_reader_is_dropped(data_ringbuf_tee_reader_t *reader_ptr)
+{
+    DATA_RINGBUF_TEE_BARRIER();
+
+    return (DATA_RINGBUF_TEE_LOAD_ACQUIRE(reader_ptr->drop_count) != reader_ptr->ack_drop_count);
+}
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+uint32_t data_ringbuf_tee_init(data_ringbuf_tee_t *tee_ptr, uint8_t *buf_ptr, uint32_t buf_size)
+{
+    if ((buf_size == 0) || ((buf_size & (buf_size - 1)) != 0))
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    memset(tee_ptr, 0, sizeof(data_ringbuf_tee_t));
+    tee_ptr->buf_ptr = buf_ptr;
+    tee_ptr->buf_size = buf_size;
+    tee_ptr->buf_mask = buf_size - 1;
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+uint32_t data_ringbuf_tee_add_reader(data_ringbuf_tee_t *tee_ptr, uint8_t policy, uint32_t *reader_id_ptr)
+{
+    data_ringbuf_tee_reader_t *reader_ptr;
+
+    if ((tee_ptr->num_readers >= DATA_RINGBUF_TEE_MAX_READERS)
+     || ((policy != DATA_RINGBUF_TEE_POLICY_BLOCK) && (policy != DATA_RINGBUF_TEE_POLICY_DROP)))
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    reader_ptr = &tee_ptr->readers[tee_ptr->num_readers];
+    memset(reader_ptr, 0, sizeof(data_ringbuf_tee_reader_t));
+    reader_ptr->read_count = tee_ptr->write_count;
+    reader_ptr->policy = policy;
+    reader_ptr->is_active = true;
+
+    *reader_id_ptr = tee_ptr->num_readers;
+    tee_ptr->num_readers++;
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+uint32_t data_ringbuf_tee_free_space(data_ringbuf_tee_t *tee_ptr)
+{
+    uint32_t space = tee_ptr->buf_size;
+
+    for (uint32_t i = 0; i < tee_ptr->num_readers; i++)
+    {
+        data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[i];
+
+        if (reader_ptr->policy == DATA_RINGBUF_TEE_POLICY_BLOCK)
+        {
+            uint32_t reader_space = data_ringbuf_tee_reader_space(tee_ptr, reader_ptr);
+
+            if (reader_space < space)
+            {
+                space = reader_space;
+            }
+        }
+    }
+
+    return space;
+}
+
+uint32_t data_ringbuf_tee_make_space(data_ringbuf_tee_t *tee_ptr, uint32_t write_len)
+{
+    bool is_dropped = false;
+
+    if (data_ringbuf_tee_free_space(tee_ptr) < write_len)
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    for (uint32_t i = 0; i < tee_ptr->num_readers; i++)
+    {
+        data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[i];
+
+        if ((reader_ptr->policy == DATA_RINGBUF_TEE_POLICY_DROP)
+         && (data_ringbuf_tee_reader_space(tee_ptr, reader_ptr) < write_len))
+        {
+            DATA_RINGBUF_TEE_STORE_RELEASE(reader_ptr->drop_count, reader_ptr->drop_count + 1);
+            is_dropped = true;
+        }
+    }
+
+    // Make sure dropped readers can see they were dropped before any of their data is overwritten
+    if (is_dropped)
+    {
+        DATA_RINGBUF_TEE_BARRIER();
+    }
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+void data_ringbuf_tee_next_write_block(data_ringbuf_tee_t *tee_ptr, uint8_t **write_ptr_ptr, uint32_t *write_len_ptr)
+{
+    *write_len_ptr = data_ringbuf_tee_contig_space(tee_ptr);
+    if (*write_len_ptr == 0)
+    {
+        *write_ptr_ptr = NULL;
+    }
+    else
+    {
+        *write_ptr_ptr = tee_ptr->buf_ptr + (tee_ptr->write_count & tee_ptr->buf_mask);
+    }
+}
+
+uint32_t data_ringbuf_tee_bytes_written(data_ringbuf_tee_t *tee_ptr, uint32_t write_len)
+{
+    if (data_ringbuf_tee_contig_space(tee_ptr) < write_len)
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    // Publish the new data to every reader
+    DATA_RINGBUF_TEE_STORE_RELEASE(tee_ptr->write_count, tee_ptr->write_count + write_len);
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+uint32_t data_ringbuf_tee_get_write_iov(data_ringbuf_tee_t *tee_ptr, data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX])
+{
+    uint32_t write_index = tee_ptr->write_count & tee_ptr->buf_mask;
+    uint32_t contig_len = tee_ptr->buf_size - write_index;
+    uint32_t space;
+
+    // Only readers that block are left in the way once the others have been dropped
+    data_ringbuf_tee_make_space(tee_ptr, data_ringbuf_tee_free_space(tee_ptr));
+    space = data_ringbuf_tee_space(tee_ptr);
+    if (contig_len > space)
+    {
+        contig_len = space;
+    }
+
+    iov[0].ptr = (contig_len > 0) ? (tee_ptr->buf_ptr + write_index) : NULL;
+    iov[0].len = contig_len;
+    iov[1].ptr = (space > contig_len) ? tee_ptr->buf_ptr : NULL;
+    iov[1].len = space - contig_len;
+
+    return space;
+}
+
+uint32_t data_ringbuf_tee_commit_write_iov(data_ringbuf_tee_t *tee_ptr, uint32_t write_len)
+{
+    if (data_ringbuf_tee_space(tee_ptr) < write_len)
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    // Publish the new data to every reader
+    DATA_RINGBUF_TEE_STORE_RELEASE(tee_ptr->write_count, tee_ptr->write_count + write_len);
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+uint32_t data_ringbuf_tee_write(data_ringbuf_tee_t *tee_ptr, uint8_t *buf_ptr, uint32_t buf_size)
+{
+    uint32_t write_index = tee_ptr->write_count & tee_ptr->buf_mask;
+    uint32_t first_len = tee_ptr->buf_size - write_index;
+
+    if ((buf_ptr == NULL) || (data_ringbuf_tee_make_space(tee_ptr, buf_size) != DATA_RINGBUF_TEE_STATUS_OK))
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    if (first_len > buf_size)
+    {
+        first_len = buf_size;
+    }
+    memcpy(tee_ptr->buf_ptr + write_index, buf_ptr, first_len);
+    memcpy(tee_ptr->buf_ptr, buf_ptr + first_len, buf_size - first_len);
+
+    // Publish the new data to every reader
+    DATA_RINGBUF_TEE_STORE_RELEASE(tee_ptr->write_count, tee_ptr->write_count + buf_size);
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+uint32_t data_ringbuf_tee_data_length(data_ringbuf_tee_t *tee_ptr, uint32_t reader_id)
+{
+    data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[reader_id];
+
+    data_ringbuf_tee_reader_sync(tee_ptr, reader_ptr);
+
+    return DATA_RINGBUF_TEE_LOAD_ACQUIRE(tee_ptr->write_count) - reader_ptr->read_count;
+}
+
+void data_ringbuf_tee_next_read_block(data_ringbuf_tee_t *tee_ptr,
+                                      uint32_t reader_id,
+                                      uint8_t **read_ptr_ptr,
+                                      uint32_t *read_len_ptr)
+{
+    data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[reader_id];
+    uint32_t data_length = data_ringbuf_tee_data_length(tee_ptr, reader_id);
+    // Only taken after data_ringbuf_tee_data_length(), as it may have resynchronised the reader
+    uint32_t read_index = reader_ptr->read_count & tee_ptr->buf_mask;
+
+    *read_len_ptr = tee_ptr->buf_size - read_index;
+    if (*read_len_ptr > data_length)
+    {
+        *read_len_ptr = data_length;
+    }
+
+    if (*read_len_ptr == 0)
+    {
+        *read_ptr_ptr = NULL;
+    }
+    else
+    {
+        *read_ptr_ptr = tee_ptr->buf_ptr + read_index;
+    }
+}
+
+uint32_t data_ringbuf_tee_bytes_read(data_ringbuf_tee_t *tee_ptr, uint32_t reader_id, uint32_t read_len)
+{
+    data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[reader_id];
+
+    // If the reader was dropped, the producer may have overwritten what was just read
+    if (data_ringbuf_tee_reader_is_dropped(reader_ptr))
+    {
+        data_ringbuf_tee_reader_sync(tee_ptr, reader_ptr);
+        return DATA_RINGBUF_TEE_STATUS_OVERRUN;
+    }
+
+    if ((DATA_RINGBUF_TEE_LOAD_ACQUIRE(tee_ptr->write_count) - reader_ptr->read_count) < read_len)
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    // Publish the freed space to the producer
+    DATA_RINGBUF_TEE_STORE_RELEASE(reader_ptr->read_count, reader_ptr->read_count + read_len);
+
+    return DATA_RINGBUF_TEE_STATUS_OK;
+}
+
+uint32_t data_ringbuf_tee_read(data_ringbuf_tee_t *tee_ptr, uint32_t reader_id, uint8_t *dest_ptr, uint32_t read_len)
+{
+    data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[reader_id];
+    uint32_t read_index;
+    uint32_t first_len;
+
+    if (data_ringbuf_tee_reader_sync(tee_ptr, reader_ptr))
+    {
+        return DATA_RINGBUF_TEE_STATUS_OVERRUN;
+    }
+
+    if ((dest_ptr == NULL) || (data_ringbuf_tee_data_length(tee_ptr, reader_id) < read_len))
+    {
+        return DATA_RINGBUF_TEE_STATUS_FAIL;
+    }
+
+    read_index = reader_ptr->read_count & tee_ptr->buf_mask;
+    first_len = tee_ptr->buf_size - read_index;
+    if (first_len > read_len)
+    {
+        first_len = read_len;
+    }
+    memcpy(dest_ptr, tee_ptr->buf_ptr + read_index, first_len);
+    memcpy(dest_ptr + first_len, tee_ptr->buf_ptr, read_len - first_len);
+
+    return data_ringbuf_tee_bytes_read(tee_ptr, reader_id, read_len);
+}
+
+void data_ringbuf_tee_get_overruns(data_ringbuf_tee_t *tee_ptr,
+                                   uint32_t reader_id,
+                                   uint32_t *overrun_count_ptr,
+                                   uint32_t *overrun_bytes_ptr)
+{
+    data_ringbuf_tee_reader_t *reader_ptr = &tee_ptr->readers[reader_id];
+
+    // Account for a drop that has not been noticed yet
+    data_ringbuf_tee_reader_sync(tee_ptr, reader_ptr);
+
+    *overrun_count_ptr = reader_ptr->overrun_count;
+    *overrun_bytes_ptr = reader_ptr->overrun_bytes;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file data_ringbuf_tee.h
+ *
+ * @brief Functions and prototypes for multi-reader data ring buffer handling
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef DATA_RINGBUF_TEE_H
+#define DATA_RINGBUF_TEE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "data_ringbuf.h"
+
+/***********************************************************************************************************************
+ * LITERALS & CONSTANTS
+ **********************************************************************************************************************/
+ /**
+ * @defgroup DATA_RINGBUF_TEE_STATUS_
+ * @brief Return values for multi-reader data ring buffer API
+ *
+ * @{
+ */
+#define DATA_RINGBUF_TEE_STATUS_OK                (0)
+#define DATA_RINGBUF_TEE_STATUS_FAIL              (1)
+#define DATA_RINGBUF_TEE_STATUS_OVERRUN           (2)
+/** @} */
+
+/**
+ * @defgroup DATA_RINGBUF_TEE_POLICY_
+ * @brief What happens when a reader is too slow for the producer
+ *
+ * @{
+ */
+#define DATA_RINGBUF_TEE_POLICY_BLOCK             (0) // Reader never loses data, the producer has to wait for it
+#define DATA_RINGBUF_TEE_POLICY_DROP              (1) // Reader is dropped rather than make the producer wait
+/** @} */
+
+/**
+ * Maximum number of readers of one multi-reader data ring buffer
+ */
+#define DATA_RINGBUF_TEE_MAX_READERS              (4)
+
+/***********************************************************************************************************************
+ * MACROS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * One reader of a multi-reader data ring buffer
+ */
+typedef struct
+{
+    uint32_t read_count;                        // Owned by the reader, total bytes ever read
+    uint32_t ack_drop_count;                    // Owned by the reader, drop_count when it last resynchronised
+    uint32_t overrun_count;                     // Owned by the reader, number of times it has been dropped
+    uint32_t overrun_bytes;                     // Owned by the reader, total bytes it has lost
+    uint32_t drop_count;                        // Owned by the producer, number of times it has dropped the reader
+    uint8_t policy;                             // DATA_RINGBUF_TEE_POLICY_
+    bool is_active;
+} data_ringbuf_tee_reader_t;
+
+/**
+ * Multi-reader data ring buffer
+ *
+ * A single producer writes one stream that is read, without copying, by up to DATA_RINGBUF_TEE_MAX_READERS readers.
+ * Each reader has its own read count, and free space is set by the slowest reader.  The producer and each reader may
+ * run in different contexts, as for data_ringbuf_t.
+ *
+ * A reader with DATA_RINGBUF_TEE_POLICY_DROP is dropped by the producer whenever it would stop a write.  The next
+ * time the reader uses the buffer it skips to the newest data and records an overrun.  A reader with
+ * DATA_RINGBUF_TEE_POLICY_BLOCK is never dropped, so writes fail until it has made room.
+ *
+ * The buffer size must be a power of two, so that each read and write index is simply its count masked.
+ * data_ringbuf_tee_init() and data_ringbuf_tee_add_reader() must only be called when nothing is using the buffer.
+ */
+typedef struct
+{
+    uint8_t *buf_ptr;
+    uint32_t buf_size;
+    uint32_t buf_mask;
+    uint32_t write_count;                       // Owned by the producer, total bytes ever written
+    uint32_t num_readers;
+    data_ringbuf_tee_reader_t readers[DATA_RINGBUF_TEE_MAX_READERS];
+} data_ringbuf_tee_t;
+
+/***********************************************************************************************************************
+ * GLOBAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Initialise the multi-reader data ring buffer, with no readers
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - buf_ptr          A pointer to the memory to use for the buffer
+ * - buf_size         The size of the buffer memory, must be a power of two
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL   buf_size is not a power of two
+ * - DATA_RINGBUF_TEE_STATUS_OK     The buffer was initialised
+ *
+ */
+uint32_t data_ringbuf_tee_init(data_ringbuf_tee_t *tee_ptr, uint8_t *buf_ptr, uint32_t buf_size);
+
+/**
+ * Add a reader to the multi-reader data ring buffer
+ *
+ * The reader starts at the newest data.
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - policy           What to do when the reader is too slow, one of DATA_RINGBUF_TEE_POLICY_
+ *
+ * @param [out]
+ * - reader_id_ptr    Pointer to a reader ID that will be set to identify the reader in later calls
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL   Too many readers, or invalid policy
+ * - DATA_RINGBUF_TEE_STATUS_OK     The reader was added
+ *
+ */
+uint32_t data_ringbuf_tee_add_reader(data_ringbuf_tee_t *tee_ptr, uint8_t policy, uint32_t *reader_id_ptr);
+
+/**
+ * Find the amount of data that can be written
+ *
+ * Only readers with DATA_RINGBUF_TEE_POLICY_BLOCK are taken into account, as any other reader in the way will be
+ * dropped.
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ *
+ * @return
+ * - uint32_t         The number of bytes that can be written
+ *
+ */
+uint32_t data_ringbuf_tee_free_space(data_ringbuf_tee_t *tee_ptr);
+
+/**
+ * Drop any readers that would stop a number of bytes being written
+ *
+ * Called by data_ringbuf_tee_write().  A producer writing through data_ringbuf_tee_next_write_block() calls this
+ * first so that the block is not limited by readers that can be dropped.
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - write_len        The number of bytes to make room for
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL   A reader with DATA_RINGBUF_TEE_POLICY_BLOCK is in the way, nothing was dropped
+ * - DATA_RINGBUF_TEE_STATUS_OK     There is room for write_len bytes
+ *
+ */
+uint32_t data_ringbuf_tee_make_space(data_ringbuf_tee_t *tee_ptr, uint32_t write_len);
+
+/**
+ * Get a pointer to and length of the next contiguous block of free space
+ *
+ * Limited by every reader that has not been dropped.
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ *
+ * @param [out]
+ * - write_ptr_ptr    Pointer to a byte pointer that will be set to point to the next write location, or NULL
+ * - write_len_ptr    Pointer to a length that will be set to the number of contiguous bytes free
+ *
+ */
+void data_ringbuf_tee_next_write_block(data_ringbuf_tee_t *tee_ptr, uint8_t **write_ptr_ptr, uint32_t *write_len_ptr);
+
+/**
+ * Commit a number of bytes written to the block from data_ringbuf_tee_next_write_block()
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - write_len        The number of bytes written
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL   write_len is larger than the next contiguous block of free space
+ * - DATA_RINGBUF_TEE_STATUS_OK     The bytes were committed
+ *
+ */
+uint32_t data_ringbuf_tee_bytes_written(data_ringbuf_tee_t *tee_ptr, uint32_t write_len);
+
+/**
+ * Describe all of the free space in the buffer, dropping slow readers as required
+ *
+ * As data_ringbuf_get_write_iov(), the free space is described by one segment, plus a second segment if it wraps
+ * around the end of the buffer.  Any reader with DATA_RINGBUF_TEE_POLICY_DROP in the way is dropped first, so that a
+ * producer can write straight into the buffer, for example with fmtconv_data_iov(), and then commit the data with
+ * data_ringbuf_tee_commit_write_iov().
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ *
+ * @param [out]
+ * - iov              Array of DATA_RINGBUF_IOV_MAX segments that will be set to describe the free space
+ *
+ * @return
+ * - uint32_t         The total number of bytes free
+ *
+ */
+uint32_t data_ringbuf_tee_get_write_iov(data_ringbuf_tee_t *tee_ptr, data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX]);
+
+/**
+ * Commit a number of bytes written using data_ringbuf_tee_get_write_iov() to the buffer
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - write_len        The number of bytes written
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL   write_len is larger than the free space
+ * - DATA_RINGBUF_TEE_STATUS_OK     The bytes were committed
+ *
+ */
+uint32_t data_ringbuf_tee_commit_write_iov(data_ringbuf_tee_t *tee_ptr, uint32_t write_len);
+
+/**
+ * Write a number of bytes into the buffer, dropping slow readers as required
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - buf_ptr          A pointer to the data to write
+ * - buf_size         The number of bytes to write
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL   Not enough space, due to a reader with DATA_RINGBUF_TEE_POLICY_BLOCK
+ * - DATA_RINGBUF_TEE_STATUS_OK     The data was written
+ *
+ */
+uint32_t data_ringbuf_tee_write(data_ringbuf_tee_t *tee_ptr, uint8_t *buf_ptr, uint32_t buf_size);
+
+/**
+ * Find the amount of data a reader has yet to read
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_id        The reader
+ *
+ * @return
+ * - uint32_t         The number of bytes available to the reader
+ *
+ */
+uint32_t data_ringbuf_tee_data_length(data_ringbuf_tee_t *tee_ptr, uint32_t reader_id);
+
+/**
+ * Get a pointer to and length of the next contiguous block of data for a reader
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_id        The reader
+ *
+ * @param [out]
+ * - read_ptr_ptr     Pointer to a byte pointer that will be set to point to the next read location, or NULL
+ * - read_len_ptr     Pointer to a length that will be set to the number of contiguous bytes available
+ *
+ */
+void data_ringbuf_tee_next_read_block(data_ringbuf_tee_t *tee_ptr,
+                                      uint32_t reader_id,
+                                      uint8_t **read_ptr_ptr,
+                                      uint32_t *read_len_ptr);
+
+/**
+ * Remove a number of bytes read from the block from data_ringbuf_tee_next_read_block()
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_id        The reader
+ * - read_len         The number of bytes read
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL       read_len is larger than the data available to the reader
+ * - DATA_RINGBUF_TEE_STATUS_OVERRUN    The reader was dropped, so the bytes read may have been overwritten
+ * - DATA_RINGBUF_TEE_STATUS_OK         The bytes were removed
+ *
+ */
+uint32_t data_ringbuf_tee_bytes_read(data_ringbuf_tee_t *tee_ptr, uint32_t reader_id, uint32_t read_len);
+
+/**
+ * Read a number of bytes from the buffer for a reader
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_id        The reader
+ * - dest_ptr         A pointer to where to copy the data
+ * - read_len         The number of bytes to read
+ *
+ * @return
+ * - DATA_RINGBUF_TEE_STATUS_FAIL       Not enough data available to the reader
+ * - DATA_RINGBUF_TEE_STATUS_OVERRUN    The reader was dropped, so the data must be discarded
+ * - DATA_RINGBUF_TEE_STATUS_OK         The data was read
+ *
+ */
+uint32_t data_ringbuf_tee_read(data_ringbuf_tee_t *tee_ptr, uint32_t reader_id, uint8_t *dest_ptr, uint32_t read_len);
+
+/**
+ * Get the overrun statistics for a reader
+ *
+ * @param [in]
+ * - tee_ptr          Pointer to the multi-reader data ring buffer structure
+ * - reader_id        The reader
+ *
+ * @param [out]
+ * - overrun_count_ptr    Pointer to a count that will be set to the number of times the reader has been dropped
+ * - overrun_bytes_ptr    Pointer to a count that will be set to the total number of bytes the reader has lost
+ *
+ */
+void data_ringbuf_tee_get_overruns(data_ringbuf_tee_t *tee_ptr,
+                                   uint32_t reader_id,
+                                   uint32_t *overrun_count_ptr,
+                                   uint32_t *overrun_bytes_ptr);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DATA_RINGBUF_TEE_H
@@ -1,7 +1,7 @@
 /**
  * @file dspbuf.c
  *
- * @brief DSP compressed read buffer module
+ * @brief DSP compressed read and write buffer module
  *
  * @copyright
  * Copyright (c) Cirrus Logic 2023 All Rights Reserved, http://www.cirrus.com/
@@ -32,28 +32,135 @@
  * LOCAL LITERAL SUBSTITUTIONS
  **********************************************************************************************************************/
 
+// Number of elements in dspbuf_struct_offsets_t, no DSP struct layout has more
+#define DSPBUF_N_ELEMENTS                         (end_of_stream + 1)
+
+// Only write a new high_water_mark if it differs from the current one by more than 1/(2^shift)
+#define DSPBUF_HWM_HYSTERESIS_SHIFT               (3)
+// The worst IRQ service time seen decays by 1/(2^shift) on each IRQ
+#define DSPBUF_HWM_SERVICE_DECAY_SHIFT            (3)
+
 /***********************************************************************************************************************
  * LOCAL VARIABLES
  **********************************************************************************************************************/
+// The Halo Core struct has the elements in the order of dspbuf_struct_offsets_t
+static const uint8_t dspbuf_halo_struct_layout[DSPBUF_N_ELEMENTS] =
+{
+    [buf1_base] = 0,
+    [buf1_size] = 1,
+    [buf2_base] = 2,
+    [buf1_buf2_size] = 3,
+    [buf3_base] = 4,
+    [total_buf_size] = 5,
+    [high_water_mark] = 6,
+    [irq_count] = 7,
+    [irq_ack] = 8,
+    [next_word_write_index] = 9,
+    [next_word_read_index] = 10,
+    [error] = 11,
+    [end_of_stream] = DSPBUF_ELEMENT_NONE,
+};
+
+/***********************************************************************************************************************
+ * GLOBAL VARIABLES
+ **********************************************************************************************************************/
+const uint8_t dspbuf_adsp2_struct_layout[DSPBUF_N_ELEMENTS] =
+{
+    [buf1_base] = 0,
+    [buf1_size] = 1,
+    [buf2_base] = DSPBUF_ELEMENT_NONE,
+    [buf1_buf2_size] = DSPBUF_ELEMENT_NONE,
+    [buf3_base] = DSPBUF_ELEMENT_NONE,
+    [total_buf_size] = DSPBUF_ELEMENT_NONE,
+    [high_water_mark] = DSPBUF_ELEMENT_NONE,
+    [irq_count] = DSPBUF_ELEMENT_NONE,
+    [irq_ack] = 2,
+    [next_word_write_index] = 3,
+    [next_word_read_index] = 4,
+    [error] = 5,
+    [end_of_stream] = 6,
+};
 
 /***********************************************************************************************************************
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
+static uint32_t dspbuf_element_pos(dspbuf_t *dspbuf, dspbuf_struct_offsets_t offset);
+static uint32_t dspbuf_struct_n_elements(dspbuf_t *dspbuf);
+static uint32_t dspbuf_addr_per_reg(dspbuf_t *dspbuf);
 static uint32_t dspbuf_get_value(dspbuf_t *dspbuf, dspbuf_struct_offsets_t offset, uint32_t *value);
 static uint32_t dspbuf_set_value(dspbuf_t *dspbuf, dspbuf_struct_offsets_t offset, uint32_t value);
+static uint32_t dspbuf_get_struct(dspbuf_t *dspbuf, uint32_t *values);
+static void dspbuf_unpack_status(dspbuf_t *dspbuf, uint32_t *values);
 static uint32_t dspbuf_struct_init(dspbuf_t *dspbuf, dspbuf_ringbuf_t *ring_buf);
+static uint32_t dspbuf_tune_high_water_mark(dspbuf_t *dspbuf);
+static uint32_t dspbuf_n_bufs(dspbuf_t *dspbuf);
+static dspbuf_loc_t *dspbuf_find_loc(dspbuf_t *dspbuf, uint32_t word_index);
+#ifndef CONFIG_DSPBUF_NO_DECOMPR
+static uint32_t dspbuf_drain(dspbuf_t *dspbuf, uint32_t *bytes_read);
+#endif
+
+/**
+ * Get the position of an element in the DSP struct, DSPBUF_ELEMENT_NONE if the DSP struct does not have it
+ *
+ */
+static uint32_t dspbuf_element_pos(dspbuf_t *dspbuf, dspbuf_struct_offsets_t offset)
+{
+    const uint8_t *layout = (dspbuf->config.struct_layout != NULL) ? dspbuf->config.struct_layout
+                                                                     : dspbuf_halo_struct_layout;
+
+    return layout[offset];
+}
+
+/**
+ * Get the number of elements in the DSP struct, up to the last one used
+ *
+ */
+static uint32_t dspbuf_struct_n_elements(dspbuf_t *dspbuf)
+{
+    uint32_t n_elements = 0;
+
+    for (uint32_t i = 0; i < DSPBUF_N_ELEMENTS; i++)
+    {
+        uint32_t pos = dspbuf_element_pos(dspbuf, (dspbuf_struct_offsets_t) i);
+
+        if ((pos != DSPBUF_ELEMENT_NONE) && (pos >= n_elements))
+        {
+            n_elements = pos + 1;
+        }
+    }
+
+    return n_elements;
+}
+
+/**
+ * Get the control port address increment per DSP word
+ *
+ */
+static uint32_t dspbuf_addr_per_reg(dspbuf_t *dspbuf)
+{
+    return (dspbuf->config.addr_per_reg != 0) ? dspbuf->config.addr_per_reg : dspbuf->config.bytes_per_reg;
+}
 
 /**
  * Read a value of an element of dspbuf struct from DSP
  *
+ * Elements the DSP struct does not have read as 0.
+ *
  */
 static uint32_t dspbuf_get_value(dspbuf_t *dspbuf,
                                  dspbuf_struct_offsets_t offset,
                                  uint32_t *value)
 {
-    uint32_t addr = (dspbuf->rb_struct_base_addr + (offset * dspbuf->config.bytes_per_reg));
+    uint32_t pos = dspbuf_element_pos(dspbuf, offset);
+    uint32_t addr = (dspbuf->rb_struct_base_addr + (pos * dspbuf_addr_per_reg(dspbuf)));
     uint32_t ret;
 
+    if (pos == DSPBUF_ELEMENT_NONE)
+    {
+        *value = 0;
+        return DSPBUF_STATUS_OK;
+    }
+
     ret = regmap_read(dspbuf->config.cp, addr, value);
     *value = *value & 0xFFFFFF; // 24bit values on ADSP2
     if (ret != REGMAP_STATUS_OK)
@@ -69,14 +176,22 @@ static uint32_t dspbuf_get_value(dspbuf_t *dspbuf,
 /**
  * Set a value of an element of dspbuf struct to DSP
  *
+ * Elements the DSP struct does not have are skipped.
+ *
  */
 static uint32_t dspbuf_set_value(dspbuf_t *dspbuf,
                                  dspbuf_struct_offsets_t offset,
                                  uint32_t value)
 {
-    uint32_t addr = (dspbuf->rb_struct_base_addr + (offset * dspbuf->config.bytes_per_reg));
+    uint32_t pos = dspbuf_element_pos(dspbuf, offset);
+    uint32_t addr = (dspbuf->rb_struct_base_addr + (pos * dspbuf_addr_per_reg(dspbuf)));
     uint32_t ret;
 
+    if (pos == DSPBUF_ELEMENT_NONE)
+    {
+        return DSPBUF_STATUS_OK;
+    }
+
     value = value & 0x00FFFFFF; // 24bit values on ADSP2
     ret = regmap_write(dspbuf->config.cp, addr, value);
     if (ret != REGMAP_STATUS_OK)
@@ -89,32 +204,145 @@ static uint32_t dspbuf_set_value(dspbuf_t *dspbuf,
     }
 }
 
+/**
+ * Read every element of dspbuf struct from DSP in a single transaction
+ *
+ */
+static uint32_t dspbuf_get_struct(dspbuf_t *dspbuf, uint32_t *values)
+{
+    uint8_t bytes[DSPBUF_N_ELEMENTS * sizeof(uint32_t)];
+    uint32_t n_elements = dspbuf_struct_n_elements(dspbuf);
+    uint32_t ret;
+
+    // The struct can only be unpacked from a block read if each element is a whole 32bit register
+    if (dspbuf->config.bytes_per_reg != sizeof(uint32_t))
+    {
+        for (uint32_t i = 0; i < DSPBUF_N_ELEMENTS; i++)
+        {
+            ret = dspbuf_get_value(dspbuf, (dspbuf_struct_offsets_t) i, &values[i]);
+            if (ret != DSPBUF_STATUS_OK)
+            {
+                return DSPBUF_STATUS_FAIL;
+            }
+        }
+
+        return DSPBUF_STATUS_OK;
+    }
+
+    ret = regmap_read_block(dspbuf->config.cp, dspbuf->rb_struct_base_addr, bytes, n_elements * sizeof(uint32_t));
+    if (ret != REGMAP_STATUS_OK)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    for (uint32_t i = 0; i < DSPBUF_N_ELEMENTS; i++)
+    {
+        uint32_t pos = dspbuf_element_pos(dspbuf, (dspbuf_struct_offsets_t) i);
+        uint8_t *word;
+
+        if (pos == DSPBUF_ELEMENT_NONE)
+        {
+            values[i] = 0;
+            continue;
+        }
+
+        // Registers are big-endian on the bus, and values are 24bit on ADSP2
+        word = &bytes[pos * sizeof(uint32_t)];
+        values[i] = (((uint32_t) word[1]) << 16) | (((uint32_t) word[2]) << 8) | ((uint32_t) word[3]);
+    }
+
+    return DSPBUF_STATUS_OK;
+}
+
+/**
+ * Update the status elements of the dspbuf struct and the available data from a copy of the struct
+ *
+ */
+static void dspbuf_unpack_status(dspbuf_t *dspbuf, uint32_t *values)
+{
+    int32_t data;
+
+    // Count each error once, when it is first reported
+    if ((dspbuf->ring_buf.error == DSPBUF_BUF_STATUS_OK) && (values[error] != DSPBUF_BUF_STATUS_OK))
+    {
+        if (values[error] & DSPBUF_BUF_STATUS_ERROR_OVERFLOW)
+        {
+            dspbuf->stats.overflow_count++;
+        }
+        else
+        {
+            dspbuf->stats.error_count++;
+        }
+    }
+
+    dspbuf->ring_buf.irq_count = values[irq_count];
+    dspbuf->ring_buf.irq_ack = values[irq_ack];
+    dspbuf->ring_buf.next_word_write_index = values[next_word_write_index];
+    dspbuf->ring_buf.next_word_read_index = values[next_word_read_index];
+    dspbuf->ring_buf.error = values[error];
+
+    data = (dspbuf->ring_buf.next_word_write_index - dspbuf->ring_buf.next_word_read_index)
+         * dspbuf->config.bytes_per_reg;
+    if (data < 0)
+    {
+        // Write index has wrapped
+        data += dspbuf->ring_buf.total_bufs_size;
+    }
+
+    dspbuf->ring_buf.data_avail = data;
+    // One word is always left empty, so that a full buffer can be told apart from an empty one
+    dspbuf->ring_buf.space_avail = (dspbuf->ring_buf.total_bufs_size > (uint32_t) data) ?
+                                   (dspbuf->ring_buf.total_bufs_size - data - dspbuf->config.bytes_per_reg) : 0;
+    if (dspbuf->ring_buf.data_avail > dspbuf->ring_buf.peak_data_avail)
+    {
+        dspbuf->ring_buf.peak_data_avail = dspbuf->ring_buf.data_avail;
+    }
+    if (dspbuf->ring_buf.data_avail > dspbuf->stats.max_data_avail)
+    {
+        dspbuf->stats.max_data_avail = dspbuf->ring_buf.data_avail;
+    }
+
+    // The data rate is measured from when the stream starts, not from init, which may be long before
+    if (!dspbuf->ring_buf.is_streaming && (dspbuf->ring_buf.data_avail > 0) && (dspbuf->config.get_time_ms != NULL))
+    {
+        dspbuf->ring_buf.is_streaming = true;
+        dspbuf->ring_buf.tune_time_ms = dspbuf->config.get_time_ms();
+        dspbuf->ring_buf.tune_data_avail = dspbuf->ring_buf.data_avail;
+        dspbuf->ring_buf.words_read = 0;
+    }
+}
+
 /**
  * Initialize each element of dsp ring dspbuf struct, and communicate values with DSP when needed
  *
  */
 static uint32_t dspbuf_struct_init(dspbuf_t *dspbuf, dspbuf_ringbuf_t *ring_buf)
 {
+    uint32_t values[DSPBUF_N_ELEMENTS];
     uint32_t index = 0;
     uint32_t buf_start_offset = 0;
-    while (index < DSPBUF_MAX_N_BUFFERS)
+    uint32_t n_bufs = dspbuf_n_bufs(dspbuf);
+
+    if (dspbuf_get_struct(dspbuf, values) != DSPBUF_STATUS_OK)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    // Unused regions are left empty, starting and ending where the last used region ends
+    memset(ring_buf->dspbuf_locs, 0, sizeof(ring_buf->dspbuf_locs));
+    while (index < n_bufs)
     {
         dspbuf_loc_t *buf_loc_ptr = &ring_buf->dspbuf_locs[index];
         buf_loc_ptr->start_offset = buf_start_offset;
 
         // Get the dspbuf end offset
-        dspbuf_get_value(dspbuf,
-                         dspbuf->config.bufs_config[index].size_id,
-                         &(buf_loc_ptr->end_offset));
+        buf_loc_ptr->end_offset = values[dspbuf->config.bufs_config[index].size_id];
 
         // If the end of this dspbuf is the same as the start of the last, then this dspbuf is NULL
         if (buf_loc_ptr->end_offset != buf_start_offset)
         {
-            dspbuf_get_value(dspbuf,
-                             dspbuf->config.bufs_config[index].base_id,
-                             &(buf_loc_ptr->base));
-            buf_loc_ptr->base = (buf_loc_ptr->base * dspbuf->config.bytes_per_reg)
-                               + dspbuf->config.bufs_config[index].mem_base;
+            buf_loc_ptr->base = (values[dspbuf->config.bufs_config[index].base_id] * dspbuf_addr_per_reg(dspbuf))
+                              + dspbuf->config.bufs_config[index].mem_base;
         }
         else
         {
@@ -125,22 +353,227 @@ static uint32_t dspbuf_struct_init(dspbuf_t *dspbuf, dspbuf_ringbuf_t *ring_buf)
         ++index;
         ++buf_loc_ptr;
     }
-    ring_buf->total_bufs_size = ring_buf->dspbuf_locs[DSPBUF_MAX_N_BUFFERS - 1].end_offset
-                              * dspbuf->config.bytes_per_reg;
-    ring_buf->space_avail = ring_buf->total_bufs_size / dspbuf->config.bytes_per_reg;
+    while (index < DSPBUF_MAX_N_BUFFERS)
+    {
+        ring_buf->dspbuf_locs[index].start_offset = buf_start_offset;
+        ring_buf->dspbuf_locs[index].end_offset = buf_start_offset;
+        ++index;
+    }
+    ring_buf->total_bufs_size = buf_start_offset * dspbuf->config.bytes_per_reg;
+    ring_buf->space_avail = (ring_buf->total_bufs_size > 0) ?
+                            (ring_buf->total_bufs_size - dspbuf->config.bytes_per_reg) : 0;
     ring_buf->next_word_write_index = 0;
     ring_buf->next_word_read_index = 0;
     ring_buf->data_avail = 0;
-    dspbuf_get_value(dspbuf, irq_ack, &(ring_buf->irq_ack));
-    dspbuf_get_value(dspbuf, next_word_write_index, &(ring_buf->next_word_write_index));
-    dspbuf_get_value(dspbuf, error, &(ring_buf->error));
-    dspbuf_get_value(dspbuf, irq_count, &(ring_buf->irq_count));
-    ring_buf->high_water_mark = 4096;
+    ring_buf->irq_ack = values[irq_ack];
+    ring_buf->next_word_write_index = values[next_word_write_index];
+    ring_buf->error = values[error];
+    ring_buf->irq_count = values[irq_count];
+    ring_buf->high_water_mark = DSPBUF_DEFAULT_HIGH_WATER_MARK;
     dspbuf_set_value(dspbuf, high_water_mark, ring_buf->high_water_mark);
 
+    ring_buf->stream_pos = 0;
+    ring_buf->words_read = 0;
+    ring_buf->peak_data_avail = 0;
+    ring_buf->tune_data_avail = 0;
+    ring_buf->tune_time_ms = 0;
+    ring_buf->is_streaming = false;
+    ring_buf->data_rate = 0;
+    ring_buf->service_words = 0;
+
     return DSPBUF_STATUS_OK;
 }
 
+/**
+ * Adapt high_water_mark to the data rate and IRQ service time measured since it was last tuned
+ *
+ */
+static uint32_t dspbuf_tune_high_water_mark(dspbuf_t *dspbuf)
+{
+    dspbuf_ringbuf_t *ring_buf = &dspbuf->ring_buf;
+    uint32_t bytes_per_reg = dspbuf->config.bytes_per_reg;
+    uint32_t total_words = ring_buf->total_bufs_size / bytes_per_reg;
+    uint32_t margin = dspbuf->config.hwm_service_margin;
+    uint32_t now_ms;
+    uint32_t elapsed_ms;
+    int32_t words_written;
+    uint32_t data_rate;
+    uint32_t peak_words;
+    uint32_t hwm;
+    uint32_t hwm_min;
+    uint32_t hwm_max;
+    uint32_t hwm_diff;
+
+    if ((dspbuf->config.get_time_ms == NULL) || (dspbuf->config.hwm_latency_max_ms == 0) || (total_words < 2)
+     || !ring_buf->is_streaming)
+    {
+        return DSPBUF_STATUS_OK;
+    }
+
+    now_ms = dspbuf->config.get_time_ms();
+    elapsed_ms = now_ms - ring_buf->tune_time_ms;
+    if (elapsed_ms == 0)
+    {
+        return DSPBUF_STATUS_OK;
+    }
+
+    // Everything the DSP has written since last time has either been read or is still available
+    words_written = (int32_t) ring_buf->words_read
+                  + ((int32_t) (ring_buf->data_avail - ring_buf->tune_data_avail) / (int32_t) bytes_per_reg);
+    data_rate = (words_written > 0) ? (((uint32_t) words_written * 1000) / elapsed_ms) : 0;
+    if (ring_buf->data_rate != 0)
+    {
+        data_rate = ((ring_buf->data_rate * 3) + data_rate) / 4;
+    }
+
+    // With no data rate, the latency bounds would pull high_water_mark down to 1 word.  Keep the current one, and
+    // measure over a longer time on the next IRQ
+    if ((words_written <= 0) || (data_rate == 0))
+    {
+        return DSPBUF_STATUS_OK;
+    }
+    ring_buf->data_rate = data_rate;
+
+    // Anything beyond high_water_mark was written while the IRQ was waiting to be serviced.  Track the worst case,
+    // slowly forgetting it
+    peak_words = ring_buf->peak_data_avail / bytes_per_reg;
+    ring_buf->service_words -= ring_buf->service_words >> DSPBUF_HWM_SERVICE_DECAY_SHIFT;
+    if ((peak_words > ring_buf->high_water_mark)
+     && ((peak_words - ring_buf->high_water_mark) > ring_buf->service_words))
+    {
+        ring_buf->service_words = peak_words - ring_buf->high_water_mark;
+    }
+
+    ring_buf->words_read = 0;
+    ring_buf->peak_data_avail = ring_buf->data_avail;
+    ring_buf->tune_data_avail = ring_buf->data_avail;
+    ring_buf->tune_time_ms = now_ms;
+
+    // Leave enough free space to cover the worst service time with some margin
+    if (margin == 0)
+    {
+        margin = DSPBUF_DEFAULT_HWM_SERVICE_MARGIN;
+    }
+    hwm = (total_words > (ring_buf->service_words * margin)) ? (total_words - (ring_buf->service_words * margin)) : 0;
+
+    // Keep the time taken to fill to high_water_mark within the configured bounds
+    hwm_min = (ring_buf->data_rate * dspbuf->config.hwm_latency_min_ms) / 1000;
+    hwm_max = (ring_buf->data_rate * dspbuf->config.hwm_latency_max_ms) / 1000;
+    if (hwm > hwm_max)
+    {
+        hwm = hwm_max;
+    }
+    if (hwm < hwm_min)
+    {
+        hwm = hwm_min;
+    }
+
+    // The DSP must always be able to reach high_water_mark
+    if (hwm == 0)
+    {
+        hwm = 1;
+    }
+    else if (hwm >= total_words)
+    {
+        hwm = total_words - 1;
+    }
+
+    // Avoid an extra control port write for small changes
+    hwm_diff = (hwm > ring_buf->high_water_mark) ? (hwm - ring_buf->high_water_mark)
+                                                 : (ring_buf->high_water_mark - hwm);
+    if (hwm_diff <= (ring_buf->high_water_mark >> DSPBUF_HWM_HYSTERESIS_SHIFT))
+    {
+        return DSPBUF_STATUS_OK;
+    }
+
+    ring_buf->high_water_mark = hwm;
+
+    return dspbuf_set_value(dspbuf, high_water_mark, ring_buf->high_water_mark);
+}
+
+/**
+ * Get the number of DSP buffer regions in use
+ *
+ */
+static uint32_t dspbuf_n_bufs(dspbuf_t *dspbuf)
+{
+    if ((dspbuf->config.n_bufs == 0) || (dspbuf->config.n_bufs > DSPBUF_MAX_N_BUFFERS))
+    {
+        return DSPBUF_MAX_N_BUFFERS;
+    }
+
+    return dspbuf->config.n_bufs;
+}
+
+/**
+ * Find the DSP buffer region that contains a word index
+ *
+ */
+static dspbuf_loc_t *dspbuf_find_loc(dspbuf_t *dspbuf, uint32_t word_index)
+{
+    uint32_t n_bufs = dspbuf_n_bufs(dspbuf);
+
+    for (uint32_t i = 0; i < n_bufs; i++)
+    {
+        dspbuf_loc_t *buf_loc_ptr = &dspbuf->ring_buf.dspbuf_locs[i];
+
+        if ((word_index >= buf_loc_ptr->start_offset) && (word_index < buf_loc_ptr->end_offset))
+        {
+            return buf_loc_ptr;
+        }
+    }
+
+    return NULL;
+}
+
+#ifndef CONFIG_DSPBUF_NO_DECOMPR
+/**
+ * Read and decompress data from one stream until its DSP buffer is empty or its decompressed data buffer is full
+ *
+ */
+static uint32_t dspbuf_drain(dspbuf_t *dspbuf, uint32_t *bytes_read)
+{
+    uint32_t ret;
+    bool can_read_more_data;
+    bool can_decompress_more_data;
+
+    do
+    {
+        uint32_t compress_space_avail = data_ringbuf_free_space(&dspbuf->compr_data_buf);
+        uint32_t data_len = dspbuf->ring_buf.data_avail;
+        uint32_t data_read = 0;
+        uint32_t bytes_decompressed = 0;
+
+        // Only whole words can be read
+        if (data_len > compress_space_avail)
+        {
+            data_len = compress_space_avail - (compress_space_avail % dspbuf->config.bytes_per_reg);
+        }
+        if (data_len > 0)
+        {
+            ret = dspbuf_read(dspbuf, &dspbuf->compr_data_buf, data_len, &data_read);
+            if (ret != DSPBUF_STATUS_OK)
+            {
+                return DSPBUF_STATUS_FAIL;
+            }
+            *bytes_read += data_read;
+        }
+
+        ret = decompr_data(&dspbuf->decompr, &dspbuf->decompr_data_buf, &dspbuf->compr_data_buf, &bytes_decompressed);
+        if (ret != DECOMPR_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+
+        can_read_more_data = (dspbuf->ring_buf.data_avail > 0)
+                          && (data_ringbuf_free_space(&dspbuf->compr_data_buf) >= dspbuf->config.bytes_per_reg);
+        can_decompress_more_data = (bytes_decompressed > 0) || (data_read > 0);
+    } while (can_read_more_data && can_decompress_more_data);
+
+    return DSPBUF_STATUS_OK;
+}
+#endif
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
@@ -152,6 +585,7 @@ uint32_t dspbuf_init(dspbuf_t *dspbuf, dspbuf_config_t *dspbuf_config)
     uint32_t count = 0;
 
     dspbuf->config = *dspbuf_config;
+    memset(&dspbuf->stats, 0, sizeof(dspbuf->stats));
 
     // Find ring dspbuf address
     if (dspbuf->config.buf_symbol == 0)
@@ -159,6 +593,29 @@ uint32_t dspbuf_init(dspbuf_t *dspbuf, dspbuf_config_t *dspbuf_config)
         return DSPBUF_STATUS_FAIL;
     }
 
+    // Every element must fit in the largest struct, and region base and size must be elements of the dspbuf struct
+    for (uint32_t i = 0; i < DSPBUF_N_ELEMENTS; i++)
+    {
+        uint32_t pos = dspbuf_element_pos(dspbuf, (dspbuf_struct_offsets_t) i);
+
+        if ((pos != DSPBUF_ELEMENT_NONE) && (pos >= DSPBUF_N_ELEMENTS))
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+    }
+    for (uint32_t i = 0; i < dspbuf_n_bufs(dspbuf); i++)
+    {
+        if ((dspbuf->config.bufs_config[i].base_id >= DSPBUF_N_ELEMENTS)
+         || (dspbuf->config.bufs_config[i].size_id >= DSPBUF_N_ELEMENTS)
+         || (dspbuf_element_pos(dspbuf, (dspbuf_struct_offsets_t) dspbuf->config.bufs_config[i].base_id)
+             == DSPBUF_ELEMENT_NONE)
+         || (dspbuf_element_pos(dspbuf, (dspbuf_struct_offsets_t) dspbuf->config.bufs_config[i].size_id)
+             == DSPBUF_ELEMENT_NONE))
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+    }
+
     ret = regmap_read(dspbuf->config.cp, dspbuf->config.buf_symbol, &addr);
     if (ret != REGMAP_STATUS_OK)
     {
@@ -182,7 +639,7 @@ uint32_t dspbuf_init(dspbuf_t *dspbuf, dspbuf_config_t *dspbuf_config)
          return DSPBUF_STATUS_FAIL;
     }
 
-    dspbuf->rb_struct_base_addr = (addr * dspbuf->config.bytes_per_reg) + dspbuf->config.rb_struct_mem_start_address;
+    dspbuf->rb_struct_base_addr = (addr * dspbuf_addr_per_reg(dspbuf)) + dspbuf->config.rb_struct_mem_start_address;
 
     ret = dspbuf_struct_init(dspbuf,
                              &dspbuf->ring_buf);
@@ -191,46 +648,43 @@ uint32_t dspbuf_init(dspbuf_t *dspbuf, dspbuf_config_t *dspbuf_config)
       return DSPBUF_STATUS_FAIL;
     }
 
-    ret = decompr_init(&dspbuf->decompr, dspbuf->config.enc_format, ENDIAN_LITTLE);
-    if (ret != DECOMPR_STATUS_OK)
+    // A stream that is only written to does not need a compressed data buffer or decompression
+    if (dspbuf->config.compr_buf_size == 0)
     {
-        debug_printf("Failed to init decompression %lu\n\r", ret);
-        return DSPBUF_STATUS_FAIL;
+        return dspbuf_update_status(dspbuf);
     }
 
-    data_ringbuf_init(&dspbuf->compr_data_buf, dspbuf->config.compr_buf_ptr, dspbuf->config.compr_buf_size);
-
-    return dspbuf_update_status(dspbuf);
-}
-
-uint32_t dspbuf_data_avail(dspbuf_t *dspbuf)
-{
-    int32_t data;
-    uint32_t ret;
-
-    ret = dspbuf_get_value(dspbuf, next_word_read_index, &dspbuf->ring_buf.next_word_read_index);
-    if (ret)
+#ifdef CONFIG_DSPBUF_NO_DECOMPR
+    debug_printf("Built without decompression\n\r");
+    return DSPBUF_STATUS_FAIL;
+#else
+    if ((dspbuf->config.compr_buf_ptr == NULL) && (dspbuf->config.arena != NULL))
     {
-        return DSPBUF_STATUS_FAIL;
+        dspbuf->config.compr_buf_ptr = arena_alloc(dspbuf->config.arena, dspbuf->config.compr_buf_size);
     }
-
-    ret = dspbuf_get_value(dspbuf, next_word_write_index, &dspbuf->ring_buf.next_word_write_index);
-    if (ret)
+    if (dspbuf->config.compr_buf_ptr == NULL)
     {
+        debug_printf("No compressed data buffer\n\r");
         return DSPBUF_STATUS_FAIL;
     }
 
-    data = (dspbuf->ring_buf.next_word_write_index - dspbuf->ring_buf.next_word_read_index)
-         * dspbuf->config.bytes_per_reg;
-    if (data < 0)
+    ret = decompr_init(&dspbuf->decompr, dspbuf->config.enc_format, ENDIAN_LITTLE, dspbuf->config.arena);
+    if (ret != DECOMPR_STATUS_OK)
     {
-        // Write index has wrapped
-        data += dspbuf->ring_buf.total_bufs_size;
+        debug_printf("Failed to init decompression %lu\n\r", ret);
+        return DSPBUF_STATUS_FAIL;
     }
 
-    dspbuf->ring_buf.data_avail = data;
+    data_ringbuf_init(&dspbuf->compr_data_buf, dspbuf->config.compr_buf_ptr, dspbuf->config.compr_buf_size);
 
-    return DSPBUF_STATUS_OK;
+    return dspbuf_update_status(dspbuf);
+#endif
+}
+
+uint32_t dspbuf_data_avail(dspbuf_t *dspbuf)
+{
+    // The indexes are read along with the rest of the status, as it takes no more transactions
+    return dspbuf_update_status(dspbuf);
 }
 
 uint32_t dspbuf_read(dspbuf_t *dspbuf,
@@ -242,6 +696,10 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
     uint32_t ret;
     uint32_t data_to_read;
     uint32_t index = 0;
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t iov_index = 0;
+    uint32_t iov_offset = 0;
+    PERF_STATS_START(start_ticks);
     *data_read = 0;
 
     if (data_len > dspbuf->ring_buf.data_avail || ((data_len % dspbuf->config.bytes_per_reg) != 0))
@@ -250,8 +708,8 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
         return DSPBUF_STATUS_FAIL;
     }
 
-    // Find out how much data to read
-    data_buf_space = data_ringbuf_free_space(data_buf);
+    // Find out how much data to read, and where to put it
+    data_buf_space = data_ringbuf_get_write_iov(data_buf, iov);
     data_to_read = (data_len > data_buf_space) ? data_buf_space : data_len;
 
     // Loop until all the required data has been read
@@ -264,7 +722,7 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
         &&  dspbuf->ring_buf.next_word_read_index < buf_loc_ptr->end_offset)
         {
             uint32_t buf_start_word_read_index = dspbuf->ring_buf.next_word_read_index - buf_loc_ptr->start_offset;
-            uint32_t read_addr = buf_loc_ptr->base + (buf_start_word_read_index * dspbuf->config.bytes_per_reg);
+            uint32_t read_addr = buf_loc_ptr->base + (buf_start_word_read_index * dspbuf_addr_per_reg(dspbuf));
             uint32_t bytes_to_read;
             uint8_t *write_ptr;
             uint32_t write_len;
@@ -274,8 +732,14 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
                                        dspbuf->ring_buf.next_word_write_index - buf_loc_ptr->start_offset
                                      : buf_loc_ptr->end_offset;
 
-            // Next part of the dspbuf that can be written into with the read data
-            data_ringbuf_next_write_block(data_buf, &write_ptr, &write_len);
+            // Next part of the data buffer that can be written into with the read data
+            if (iov_offset == iov[iov_index].len)
+            {
+                iov_index++;
+                iov_offset = 0;
+            }
+            write_ptr = iov[iov_index].ptr + iov_offset;
+            write_len = iov[iov_index].len - iov_offset;
 
             // There is space to write more than is requested so just take what is requested
             if (write_len > (data_to_read - *data_read))
@@ -304,7 +768,7 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
                 return DSPBUF_STATUS_FAIL;
             }
 
-            data_ringbuf_bytes_written(data_buf, bytes_to_read);
+            iov_offset += bytes_to_read;
             dspbuf->ring_buf.next_word_read_index =
                     (dspbuf->ring_buf.next_word_read_index + (buf_end_word_read_index - buf_start_word_read_index))
                     % (((dspbuf->ring_buf.total_bufs_size) / dspbuf->config.bytes_per_reg));
@@ -313,9 +777,12 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
         else
         {
             // Not starting in this dspbuf so check the next dspbuf
-            index = (index + 1) % DSPBUF_MAX_N_BUFFERS;
+            index = (index + 1) % dspbuf_n_bufs(dspbuf);
         }
     }
+    // Commit everything read, across both segments, at once
+    data_ringbuf_commit_write_iov(data_buf, *data_read);
+
     ret = dspbuf_set_value(dspbuf, next_word_read_index, dspbuf->ring_buf.next_word_read_index);
     if (ret != DSPBUF_STATUS_OK)
     {
@@ -323,20 +790,152 @@ uint32_t dspbuf_read(dspbuf_t *dspbuf,
     }
 
     dspbuf->ring_buf.data_avail -= *data_read;
+    dspbuf->ring_buf.stream_pos += *data_read;
+    dspbuf->ring_buf.words_read += *data_read / dspbuf->config.bytes_per_reg;
+    PERF_STATS_RECORD(&dspbuf->stats.read_perf, start_ticks, *data_read);
 
     return DSPBUF_STATUS_OK;
 }
 
+uint32_t dspbuf_write(dspbuf_t *dspbuf,
+                      data_ringbuf_t *data_buf,
+                      uint32_t data_len,
+                      uint32_t *data_written)
+{
+    uint32_t bytes_per_reg = dspbuf->config.bytes_per_reg;
+    uint32_t total_words = dspbuf->ring_buf.total_bufs_size / bytes_per_reg;
+    uint32_t write_index = dspbuf->ring_buf.next_word_write_index;
+    uint32_t data_buf_avail;
+    uint32_t data_to_write;
+    uint32_t ret;
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t iov_index = 0;
+    uint32_t iov_offset = 0;
+    *data_written = 0;
+
+    if (data_len > dspbuf->ring_buf.space_avail || ((data_len % bytes_per_reg) != 0) || (total_words == 0))
+    {
+        debug_printf("Writing: data_len error, requested %lu bytes but only %lu space\n\r",
+                     data_len,
+                     dspbuf->ring_buf.space_avail);
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    // Find out how much data to write, and where to take it from.  Only whole words are written
+    data_buf_avail = data_ringbuf_get_read_iov(data_buf, iov);
+    data_to_write = (data_len > data_buf_avail) ? data_buf_avail : data_len;
+    data_to_write -= data_to_write % bytes_per_reg;
+
+    // Loop until all the required data has been written, one block per region or data buffer segment
+    while (*data_written < data_to_write)
+    {
+        dspbuf_loc_t *buf_loc_ptr = dspbuf_find_loc(dspbuf, write_index);
+        uint32_t write_addr;
+        uint32_t bytes_to_write;
+        uint8_t *read_ptr;
+        uint8_t word[sizeof(uint32_t)];
+
+        if ((buf_loc_ptr == NULL) || (buf_loc_ptr->base == 0))
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+        write_addr = buf_loc_ptr->base + ((write_index - buf_loc_ptr->start_offset) * dspbuf_addr_per_reg(dspbuf));
+
+        // Next part of the data buffer to write from
+        if (iov_offset == iov[iov_index].len)
+        {
+            iov_index++;
+            iov_offset = 0;
+        }
+        read_ptr = iov[iov_index].ptr + iov_offset;
+
+        // Write up to the end of this region, this data buffer segment or the requested data, whichever is first
+        bytes_to_write = (buf_loc_ptr->end_offset - write_index) * bytes_per_reg;
+        if (bytes_to_write > (iov[iov_index].len - iov_offset))
+        {
+            bytes_to_write = iov[iov_index].len - iov_offset;
+        }
+        if (bytes_to_write > (data_to_write - *data_written))
+        {
+            bytes_to_write = data_to_write - *data_written;
+        }
+        bytes_to_write -= bytes_to_write % bytes_per_reg;
+
+        if ((bytes_to_write == 0) && (bytes_per_reg <= sizeof(word)))
+        {
+            // A word straddles the end of the first data buffer segment, so gather it into a single write
+            uint32_t first_len = iov[iov_index].len - iov_offset;
+
+            memcpy(word, read_ptr, first_len);
+            memcpy(&word[first_len], iov[iov_index + 1].ptr, bytes_per_reg - first_len);
+            read_ptr = word;
+            bytes_to_write = bytes_per_reg;
+            iov_index++;
+            iov_offset = bytes_per_reg - first_len;
+        }
+        else if (bytes_to_write == 0)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+        else
+        {
+            iov_offset += bytes_to_write;
+        }
+
+        ret = regmap_write_block(dspbuf->config.cp, write_addr, read_ptr, bytes_to_write);
+        if (ret != REGMAP_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+
+        write_index = (write_index + (bytes_to_write / bytes_per_reg)) % total_words;
+        *data_written += bytes_to_write;
+    }
+
+    if (*data_written == 0)
+    {
+        return DSPBUF_STATUS_OK;
+    }
+
+    // The DSP only sees the new data once, after all of it has been written
+    ret = dspbuf_set_value(dspbuf, next_word_write_index, write_index);
+    if (ret != DSPBUF_STATUS_OK)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    data_ringbuf_commit_read_iov(data_buf, *data_written);
+
+    dspbuf->ring_buf.next_word_write_index = write_index;
+    dspbuf->ring_buf.space_avail -= *data_written;
+    dspbuf->ring_buf.data_avail += *data_written;
+
+    return DSPBUF_STATUS_OK;
+}
+
+uint32_t dspbuf_write_eof(dspbuf_t *dspbuf)
+{
+    if (dspbuf_element_pos(dspbuf, end_of_stream) == DSPBUF_ELEMENT_NONE)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    return dspbuf_set_value(dspbuf, end_of_stream, 1);
+}
+
 uint32_t dspbuf_reenable_irq(dspbuf_t *dspbuf)
 {
     uint32_t ret;
 
-    ret = dspbuf_get_value(dspbuf, irq_count, &dspbuf->ring_buf.irq_count);
+    // Update high_water_mark before the ack, so that it applies to the next IRQ
+    ret = dspbuf_tune_high_water_mark(dspbuf);
     if (ret != DSPBUF_STATUS_OK)
     {
         return DSPBUF_STATUS_FAIL;
     }
 
+    // The DSP does not raise another IRQ until this one is acked, so the irq_count from the status read on the IRQ is
+    // still current
     if (dspbuf->ring_buf.irq_count & 0x01)
     {
         debug_printf("No need to ack irq_count=%lu\n\r", dspbuf->ring_buf.irq_count);
@@ -355,10 +954,15 @@ uint32_t dspbuf_reenable_irq(dspbuf_t *dspbuf)
 
 uint32_t dspbuf_update_status(dspbuf_t *dspbuf)
 {
-    dspbuf_get_value(dspbuf, irq_ack, &(dspbuf->ring_buf.irq_ack));
-    dspbuf_get_value(dspbuf, error, &(dspbuf->ring_buf.error));
-    dspbuf_get_value(dspbuf, irq_count, &(dspbuf->ring_buf.irq_count));
-    dspbuf_get_value(dspbuf, next_word_read_index, &(dspbuf->ring_buf.next_word_read_index));
+    uint32_t values[DSPBUF_N_ELEMENTS];
+
+    if (dspbuf_get_struct(dspbuf, values) != DSPBUF_STATUS_OK)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    dspbuf_unpack_status(dspbuf, values);
+
     return DSPBUF_STATUS_OK;
 }
 
@@ -373,3 +977,204 @@ uint32_t dspbuf_get_data_avail(dspbuf_t *dspbuf)
 {
     return dspbuf->ring_buf.data_avail;
 }
+
+uint32_t dspbuf_get_write_index(dspbuf_t *dspbuf)
+{
+    return dspbuf->ring_buf.next_word_write_index;
+}
+
+
+uint32_t dspbuf_get_space_avail(dspbuf_t *dspbuf)
+{
+    return dspbuf->ring_buf.space_avail;
+}
+
+
+uint32_t dspbuf_resync(dspbuf_t *dspbuf)
+{
+    uint32_t ret;
+    uint32_t compr_len;
+
+    ret = dspbuf_update_status(dspbuf);
+    if (ret != DSPBUF_STATUS_OK)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    if ((dspbuf->config.bytes_per_reg == sizeof(uint32_t))
+     && (dspbuf_element_pos(dspbuf, error) == (dspbuf_element_pos(dspbuf, next_word_read_index) + 1)))
+    {
+        // next_word_read_index and error are adjacent, so both are written in one transaction
+        uint8_t bytes[2 * sizeof(uint32_t)] = {0};
+        uint32_t addr = dspbuf->rb_struct_base_addr
+                      + (dspbuf_element_pos(dspbuf, next_word_read_index) * dspbuf_addr_per_reg(dspbuf));
+
+        bytes[1] = (uint8_t) (dspbuf->ring_buf.next_word_write_index >> 16);
+        bytes[2] = (uint8_t) (dspbuf->ring_buf.next_word_write_index >> 8);
+        bytes[3] = (uint8_t) dspbuf->ring_buf.next_word_write_index;
+        ret = regmap_write_block(dspbuf->config.cp, addr, bytes, sizeof(bytes));
+        if (ret != REGMAP_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+    }
+    else
+    {
+        ret = dspbuf_set_value(dspbuf, next_word_read_index, dspbuf->ring_buf.next_word_write_index);
+        ret |= dspbuf_set_value(dspbuf, error, DSPBUF_BUF_STATUS_OK);
+        if (ret != DSPBUF_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+    }
+
+    // Anything already read would not join up with the new data, so drop it and start the decoder afresh, from where
+    // the new data is in the stream
+    dspbuf->ring_buf.stream_pos += dspbuf->ring_buf.data_avail;
+    compr_len = 0;
+#ifndef CONFIG_DSPBUF_NO_DECOMPR
+    if (dspbuf->config.compr_buf_size != 0)
+    {
+        data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+
+        compr_len = data_ringbuf_get_read_iov(&dspbuf->compr_data_buf, iov);
+        data_ringbuf_commit_read_iov(&dspbuf->compr_data_buf, compr_len);
+        ret = decompr_reset(&dspbuf->decompr, dspbuf->ring_buf.stream_pos);
+        if (ret != DECOMPR_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+    }
+#endif
+
+    dspbuf->stats.bytes_dropped += dspbuf->ring_buf.data_avail + compr_len;
+    dspbuf->stats.resync_count++;
+
+    dspbuf->ring_buf.next_word_read_index = dspbuf->ring_buf.next_word_write_index;
+    dspbuf->ring_buf.error = DSPBUF_BUF_STATUS_OK;
+    dspbuf->ring_buf.data_avail = 0;
+    dspbuf->ring_buf.space_avail = dspbuf->ring_buf.total_bufs_size - dspbuf->config.bytes_per_reg;
+    dspbuf->ring_buf.tune_data_avail = 0;
+    dspbuf->ring_buf.peak_data_avail = 0;
+
+    return DSPBUF_STATUS_OK;
+}
+
+
+const dspbuf_stats_t *dspbuf_get_stats(dspbuf_t *dspbuf)
+{
+    return &dspbuf->stats;
+}
+
+
+void dspbuf_reset_stats(dspbuf_t *dspbuf)
+{
+    memset(&dspbuf->stats, 0, sizeof(dspbuf->stats));
+}
+
+
+#ifndef CONFIG_DSPBUF_NO_DECOMPR
+uint32_t dspbuf_group_init(dspbuf_group_t *group,
+                           dspbuf_t **streams,
+                           dspbuf_config_t *configs,
+                           uint32_t n_streams,
+                           uint8_t *scratch,
+                           uint32_t scratch_size)
+{
+    uint32_t stream_buf_size;
+
+    if ((group == NULL) || (streams == NULL) || (configs == NULL) || (scratch == NULL)
+     || (n_streams == 0) || (n_streams > DSPBUF_MAX_N_STREAMS))
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    // Keep each stream's compressed data buffer word-aligned
+    stream_buf_size = (scratch_size / n_streams) & ~(sizeof(uint32_t) - 1);
+    if (stream_buf_size == 0)
+    {
+        return DSPBUF_STATUS_FAIL;
+    }
+
+    group->n_streams = 0;
+    for (uint32_t i = 0; i < n_streams; i++)
+    {
+        uint32_t ret;
+
+        configs[i].compr_buf_ptr = scratch + (i * stream_buf_size);
+        configs[i].compr_buf_size = stream_buf_size;
+        ret = dspbuf_init(streams[i], &configs[i]);
+        if (ret != DSPBUF_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+
+        group->streams[i] = streams[i];
+        group->n_streams++;
+    }
+
+    return DSPBUF_STATUS_OK;
+}
+
+
+uint32_t dspbuf_group_service(dspbuf_group_t *group, uint32_t *bytes_read)
+{
+    uint32_t total_read = 0;
+    bool is_pending = false;
+
+    for (uint32_t i = 0; i < group->n_streams; i++)
+    {
+        dspbuf_t *dspbuf = group->streams[i];
+        uint32_t ret;
+
+        ret = dspbuf_update_status(dspbuf);
+        if (ret != DSPBUF_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+
+        // Skip the data lost to an overflow and carry on, but no other error can be recovered from here
+        if (dspbuf_get_error(dspbuf) == DSPBUF_BUF_STATUS_ERROR_OVERFLOW)
+        {
+            ret = dspbuf_resync(dspbuf);
+            if (ret != DSPBUF_STATUS_OK)
+            {
+                return DSPBUF_STATUS_FAIL;
+            }
+        }
+        if (dspbuf_get_error(dspbuf) != DSPBUF_BUF_STATUS_OK)
+        {
+            debug_printf("Stream %lu: DSP buffer error 0x%lx\n\r", i, dspbuf_get_error(dspbuf));
+            return DSPBUF_STATUS_FAIL;
+        }
+
+        ret = dspbuf_drain(dspbuf, &total_read);
+        if (ret != DSPBUF_STATUS_OK)
+        {
+            return DSPBUF_STATUS_FAIL;
+        }
+
+        // Only ask for another IRQ once everything signalled by this one has been read, until then the caller has to
+        // come back for the rest
+        if (dspbuf->ring_buf.data_avail == 0)
+        {
+            ret = dspbuf_reenable_irq(dspbuf);
+            if (ret != DSPBUF_STATUS_OK)
+            {
+                return DSPBUF_STATUS_FAIL;
+            }
+        }
+        else
+        {
+            is_pending = true;
+        }
+    }
+
+    if (bytes_read != NULL)
+    {
+        *bytes_read = total_read;
+    }
+
+    return is_pending ? DSPBUF_STATUS_AGAIN : DSPBUF_STATUS_OK;
+}
+#endif
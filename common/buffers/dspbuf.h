@@ -1,7 +1,7 @@
 /**
  * @file dspbuf.h
  *
- * @brief Functions and prototypes exported by the DSP compressed read buffer module
+ * @brief Functions and prototypes exported by the DSP compressed read and write buffer module
  *
  * @copyright
  * Copyright (c) Cirrus Logic 2023 All Rights Reserved, http://www.cirrus.com/
@@ -30,8 +30,10 @@ extern "C" {
 /***********************************************************************************************************************
  * INCLUDES
  **********************************************************************************************************************/
+#include "arena.h"
 #include "data_ringbuf.h"
 #include "decompr.h"
+#include "perf_stats.h"
 #include "regmap.h"
 
 /***********************************************************************************************************************
@@ -43,7 +45,17 @@ extern "C" {
  *
  * @{
  */
+// Maximum number of DSP buffer regions, may be overridden at compile time
+#ifndef DSPBUF_MAX_N_BUFFERS
 #define DSPBUF_MAX_N_BUFFERS                      3
+#endif
+// Maximum number of streams serviced together by a dspbuf_group_t, may be overridden at compile time
+#ifndef DSPBUF_MAX_N_STREAMS
+#define DSPBUF_MAX_N_STREAMS                      2
+#endif
+// If CONFIG_DSPBUF_NO_DECOMPR is defined (i.e. in the makefile), dspbuf is built without decompression, so that it
+// links without the compression modules.  Only streams with compr_buf_size 0 can then be initialized, and the
+// dspbuf_group_ functions are left out.
 
 #define DSPBUF_BUF_STATUS_OK                      (0)
 #define DSPBUF_BUF_STATUS_ERROR_OVERFLOW          (1<<0)
@@ -57,12 +69,19 @@ extern "C" {
 #define DSPBUF_BUF_STATUS_ERROR_TRUNCATED         (1<<8)
 #define DSPBUF_BUF_STATUS_ERROR_OVERRUN_AT_START  (1<<9)
 
+#define DSPBUF_DEFAULT_HIGH_WATER_MARK            (4096)
+#define DSPBUF_DEFAULT_HWM_SERVICE_MARGIN         (2)
+
+// Entry of dspbuf_config_t struct_layout for an element the DSP struct does not have
+#define DSPBUF_ELEMENT_NONE                       (0xFF)
+
 /***********************************************************************************************************************
  * MACROS
  **********************************************************************************************************************/
 
 #define DSPBUF_STATUS_OK                          (0)
 #define DSPBUF_STATUS_FAIL                        (1)
+#define DSPBUF_STATUS_AGAIN                       (2)
 
 /***********************************************************************************************************************
  * ENUMS, STRUCTS, UNIONS, TYPEDEFS
@@ -106,20 +125,60 @@ typedef struct
     uint32_t space_avail;
     uint32_t data_avail;
     uint32_t buf_size;
+    uint32_t stream_pos;                        // Bytes of the stream read or dropped, so where next_word_read_index
+                                                // is in the stream
+    // Measurements for adapting high_water_mark, see dspbuf_config_t
+    uint32_t words_read;                        // Words read since high_water_mark was last tuned
+    uint32_t peak_data_avail;                   // Most data available seen since high_water_mark was last tuned
+    uint32_t tune_data_avail;                   // data_avail when high_water_mark was last tuned
+    uint32_t tune_time_ms;                      // Time when high_water_mark was last tuned, or the stream started
+    bool is_streaming;                          // Set once the DSP has written data, measurements start from then
+    uint32_t data_rate;                         // Words per second written by the DSP
+    uint32_t service_words;                     // Words written by the DSP between its IRQ and the host reading
 } dspbuf_ringbuf_t;
 
 typedef struct
 {
     regmap_cp_config_t *cp;
     dspbuf_loc_config_t bufs_config[DSPBUF_MAX_N_BUFFERS];
+    uint32_t n_bufs;                            // Number of entries of bufs_config used, DSPBUF_MAX_N_BUFFERS if 0
     uint32_t rb_struct_mem_start_address;
-    uint8_t *compr_buf_ptr;
-    uint32_t compr_buf_size;
+    uint8_t *compr_buf_ptr;                     // Allocated from arena if NULL
+    uint32_t compr_buf_size;                    // 0 for a stream only written with dspbuf_write(), which then has no
+                                                // compressed data buffer or decompression
     uint32_t buf_symbol;
     compr_enc_format_t enc_format;
     uint32_t bytes_per_reg;
+    uint32_t addr_per_reg;                      // Control port address increment per DSP word, bytes_per_reg if 0
+    const uint8_t *struct_layout;               // Position in the DSP struct of each dspbuf_struct_offsets_t element,
+                                                // the Halo Core layout if NULL, see dspbuf_adsp2_struct_layout
+    // high_water_mark is adapted at runtime if get_time_ms and hwm_latency_max_ms are set, otherwise it is fixed at
+    // DSPBUF_DEFAULT_HIGH_WATER_MARK
+    uint32_t (*get_time_ms)(void);              // Free-running millisecond count
+    uint32_t hwm_latency_min_ms;                // Minimum time to fill to high_water_mark, limits the IRQ rate
+    uint32_t hwm_latency_max_ms;                // Maximum time to fill to high_water_mark, limits the latency
+    uint32_t hwm_service_margin;                // Free space kept for this many times the worst IRQ service time,
+                                                // DSPBUF_DEFAULT_HWM_SERVICE_MARGIN if 0
+    arena_t *arena;                             // Optional, decompression contexts are allocated from here if set
 } dspbuf_config_t;
 
+/**
+ * Counters of DSP buffer errors and recovery
+ *
+ * @see dspbuf_get_stats
+ */
+typedef struct
+{
+    uint32_t overflow_count;                    // Times the DSP reported DSPBUF_BUF_STATUS_ERROR_OVERFLOW
+    uint32_t error_count;                       // Times the DSP reported any other error
+    uint32_t resync_count;                      // Times dspbuf_resync() has been called
+    uint32_t bytes_dropped;                     // Compressed bytes discarded by dspbuf_resync()
+    uint32_t max_data_avail;                    // Most data available seen in the DSP buffer, in bytes
+#ifdef CONFIG_PERF_STATS
+    perf_stats_t read_perf;                     // Time taken and bytes read by dspbuf_read()
+#endif
+} dspbuf_stats_t;
+
 /**
  * Data structure to hold anything buffer-related
  *
@@ -132,9 +191,24 @@ typedef struct
     dspbuf_ringbuf_t ring_buf;
     data_ringbuf_t compr_data_buf;
     data_ringbuf_t decompr_data_buf;
+#ifndef CONFIG_DSPBUF_NO_DECOMPR
     decompr_t decompr;
+#endif
+    dspbuf_stats_t stats;
 } dspbuf_t;
 
+/**
+ * Data structure for servicing several DSP streams together
+ *
+ * @see dspbuf_group_init
+ * @see dspbuf_group_service
+ */
+typedef struct
+{
+    dspbuf_t *streams[DSPBUF_MAX_N_STREAMS];
+    uint32_t n_streams;
+} dspbuf_group_t;
+
 /**
  * Data structure to identify DSP buffer elements
  *
@@ -156,12 +230,15 @@ typedef enum
     irq_ack,
     next_word_write_index,
     next_word_read_index,
-    error
+    error,
+    end_of_stream                               // Not in the Halo Core struct, only used to stream into a decoder
 } dspbuf_struct_offsets_t;
 
 /***********************************************************************************************************************
  * GLOBAL VARIABLES
  **********************************************************************************************************************/
+// struct_layout for the ADSP2 ring buffer struct, which has a single buffer region given by buf1_base and buf1_size
+extern const uint8_t dspbuf_adsp2_struct_layout[];
 
 /***********************************************************************************************************************
  * API FUNCTIONS
@@ -204,9 +281,48 @@ uint32_t dspbuf_init(dspbuf_t *dspbuf, dspbuf_config_t *dspbuf_config);
  */
 uint32_t dspbuf_read(dspbuf_t *dspbuf, data_ringbuf_t *data_buf, uint32_t data_len, uint32_t *data_read);
 
+/**
+ * Write data to dsp ring buffer
+ *
+ * Used to stream data into a DSP decoder.  The data is written in one block per DSP buffer region, wrapping from the
+ * last region back to the first, and the DSP is only told about it by a single update of next_word_write_index once
+ * all of it has been written.  Only whole words are written; data in \b data_buf is consumed as it is written.
+ *
+ * dspbuf_update_status() should be called first to find the space available.
+ *
+ * @param [in]
+ * - dspbuf              Pointer to DSP buffer structure
+ * - data_buf            Pointer to data buffer structure holding the outgoing data
+ * - data_len            Number of bytes to write. Should not be longer than the space available in the dsp buffer.
+ * - data_written        Pointer to the number of bytes written, may be less than data_len if data_buf runs out
+ *
+ * @return
+ * - DSPBUF_STATUS_FAIL         Control port activity fails
+ * - DSPBUF_STATUS_OK           otherwise
+ *
+ * @see dspbuf_get_space_avail
+ *
+ */
+uint32_t dspbuf_write(dspbuf_t *dspbuf, data_ringbuf_t *data_buf, uint32_t data_len, uint32_t *data_written);
+
+/**
+ * Tell the DSP decoder that no more data will be written
+ *
+ * @param [in]
+ * - dspbuf              Pointer to DSP buffer structure
+ *
+ * @return
+ * - DSPBUF_STATUS_FAIL         Control port activity fails, or the DSP struct has no end_of_stream element
+ * - DSPBUF_STATUS_OK           otherwise
+ *
+ */
+uint32_t dspbuf_write_eof(dspbuf_t *dspbuf);
+
 /**
  * Update the amount of available data on DSP encoder
  *
+ * Equivalent to dspbuf_update_status().
+ *
  * @param [in]
  * - dspbuf           Pointer to DSP buffer structure
  *
@@ -220,6 +336,13 @@ uint32_t dspbuf_data_avail(dspbuf_t *dspbuf);
 /**
  * Acknowledge the DSP IRQ which re-enables it
  *
+ * Uses the IRQ count from the last dspbuf_update_status(), which must have been called after the IRQ.
+ *
+ * If enabled in dspbuf_config_t, high_water_mark is first adapted to the data rate and IRQ service time measured
+ * since the last IRQ.  It is set as high as the configured maximum latency allows, to reduce the IRQ rate, but low
+ * enough that the free space left covers hwm_service_margin times the worst service time seen, to avoid overflow.
+ * The configured latency bounds take precedence.
+ *
  * @param [in]
  * - dspbuf           Pointer to DSP buffer structure
  *
@@ -233,6 +356,9 @@ uint32_t dspbuf_reenable_irq(dspbuf_t *dspbuffer);
 /**
  * Read the current status of the DSP ring buffer
  *
+ * The whole DSP ring buffer struct is read in a single control port transaction, updating the IRQ count, indexes,
+ * error, available data and available space together.
+ *
  * @param [in]
  * - dspbuf           Pointer to DSP buffer structure
  *
@@ -267,6 +393,130 @@ uint32_t dspbuf_get_error(dspbuf_t *dsp_buffer);
  */
 uint32_t dspbuf_get_data_avail(dspbuf_t *dspbuf);
 
+/**
+ * Get the index of the next word the DSP will write
+ *
+ * Uses the index from the last dspbuf_update_status(), so does not access the control port.
+ *
+ * @param [in]
+ * - dspbuf           Pointer to DSP buffer structure
+ *
+ * @return            The next_word_write_index of the DSP ring buffer, in words
+ *
+ */
+uint32_t dspbuf_get_write_index(dspbuf_t *dspbuf);
+
+/**
+ * Get the space in bytes available to write
+ *
+ * @param [in]
+ * - dspbuf           Pointer to DSP buffer structure
+ *
+ * @return            The number of bytes that can be written
+ *
+ */
+uint32_t dspbuf_get_space_avail(dspbuf_t *dspbuf);
+
+/**
+ * Recover from a DSP buffer error without re-initializing
+ *
+ * All data not yet read is discarded: the read index jumps to the current write index and the DSP error is cleared, in
+ * a single control port transaction where possible.  Compressed data already read but not yet decompressed is also
+ * discarded and the decoder is reset.  The new read position is rarely on a frame or block boundary, so the decoder
+ * is told where it is in the stream and drops data up to the next frame or block it can decode (see decompr_reset()).
+ * Decompressed data is kept.  The bytes discarded are added to the stats.
+ *
+ * @param [in]
+ * - dspbuf           Pointer to DSP buffer structure
+ *
+ * @return
+ * - DSPBUF_STATUS_FAIL        Control port activity or decoder reset fails
+ * - DSPBUF_STATUS_OK          otherwise
+ *
+ * @see dspbuf_get_stats
+ *
+ */
+uint32_t dspbuf_resync(dspbuf_t *dspbuf);
+
+/**
+ * Get the error and recovery counters of the DSP ring buffer
+ *
+ * Errors are counted by dspbuf_update_status() when the DSP error changes from 0.
+ *
+ * @param [in]
+ * - dspbuf           Pointer to DSP buffer structure
+ *
+ * @return            Pointer to the counters
+ *
+ */
+const dspbuf_stats_t *dspbuf_get_stats(dspbuf_t *dspbuf);
+
+/**
+ * Reset the error and recovery counters of the DSP ring buffer
+ *
+ * @param [in]
+ * - dspbuf           Pointer to DSP buffer structure
+ *
+ */
+void dspbuf_reset_stats(dspbuf_t *dspbuf);
+
+#ifndef CONFIG_DSPBUF_NO_DECOMPR
+/**
+ * Initialize several DSP streams that share one block of scratch memory
+ *
+ * \b scratch is split evenly, in whole words, into the compressed data buffer of each stream, so that no per-stream
+ * allocation is needed.  Member compr_buf_ptr and compr_buf_size of each config are ignored.  Each stream is then
+ * initialized as for dspbuf_init().  The decompressed data buffer of each stream must still be set up by the user.
+ *
+ * @param [in]
+ * - group            Pointer to the group structure
+ * - streams          Array of pointers to the DSP buffer structure of each stream
+ * - configs          Array of configs, one for each stream
+ * - n_streams        Number of streams, no more than DSPBUF_MAX_N_STREAMS
+ * - scratch          Pointer to scratch memory for the compressed data of all streams
+ * - scratch_size     Size of \b scratch in bytes
+ *
+ * @return
+ * - DSPBUF_STATUS_FAIL        Invalid arguments or control port activity fails
+ * - DSPBUF_STATUS_OK          otherwise
+ *
+ * @see dspbuf_init
+ *
+ */
+uint32_t dspbuf_group_init(dspbuf_group_t *group,
+                           dspbuf_t **streams,
+                           dspbuf_config_t *configs,
+                           uint32_t n_streams,
+                           uint8_t *scratch,
+                           uint32_t scratch_size);
+
+/**
+ * Drain every stream of a group
+ *
+ * Called on a DSP IRQ.  The status of each stream is read, then data is read from its DSP buffer and decompressed
+ * into its decompressed data buffer until either the DSP buffer is empty or the decompressed data buffer is full.
+ * The IRQ of each stream that has been emptied is then re-enabled.
+ *
+ * The IRQ of a stream that still has data in its DSP buffer is left disabled, and the DSP will not raise it again, so
+ * while DSPBUF_STATUS_AGAIN is returned the caller must keep calling this, e.g. as decompressed data is consumed,
+ * rather than wait for the next IRQ.
+ *
+ * A DSPBUF_BUF_STATUS_ERROR_OVERFLOW reported by the DSP is recovered from with dspbuf_resync(), dropping the data
+ * that was lost, and is counted in the stream's dspbuf_stats_t.  Any other DSP error fails.
+ *
+ * @param [in]
+ * - group            Pointer to the group structure
+ * - bytes_read       Pointer to the total number of compressed bytes read from all streams, may be NULL
+ *
+ * @return
+ * - DSPBUF_STATUS_FAIL        Control port activity or decompression fails, or a DSP buffer reports an error
+ * - DSPBUF_STATUS_AGAIN       Data is still waiting in a DSP buffer, so its IRQ has not been re-enabled
+ * - DSPBUF_STATUS_OK          otherwise
+ *
+ */
+uint32_t dspbuf_group_service(dspbuf_group_t *group, uint32_t *bytes_read);
+#endif
+
 /**********************************************************************************************************************/
 #ifdef __cplusplus
 }
@@ -0,0 +1,163 @@
+/**
+ * @file test_data_ringbuf_bench.c
+ *
+ * @brief Host benchmark of data ring buffer reads and writes
+ *
+ * A fixed byte stream is written into and read back out of a data ring buffer in operations of a fixed size, once
+ * with the default wrapping by compare and subtract and once with the power-of-two mask.  The stream read back must
+ * match the stream written.  The throughput of each operation size and wrapping mode is printed.
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#define _POSIX_C_SOURCE 199309L         // clock_gettime()
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "data_ringbuf.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_BUF_SIZE                   (1024)                              // Valid for both wrapping modes
+#define TEST_STREAM_BYTES               (4 * 1024 * 1024)
+#define TEST_OP_BYTES_MAX               (256)
+#define TEST_PASSES                     (5)                                 // The fastest pass is reported
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+static data_ringbuf_t test_rb;
+static uint8_t test_buf[TEST_BUF_SIZE];
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Free-running nanosecond count
+ *
+ */
+static uint64_t test_get_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Stream TEST_STREAM_BYTES through the ring buffer, writing then reading op_bytes at a time, and print the throughput
+ *
+ * The write index is kept 3 bytes ahead of the read index, so every size of operation wraps at the end of the buffer.
+ * Host timings vary from run to run, so the fastest of TEST_PASSES passes is printed.
+ */
+static void test_bench(uint32_t op_bytes, bool pow2)
+{
+    uint8_t in[TEST_OP_BYTES_MAX];
+    uint8_t out[TEST_OP_BYTES_MAX];
+    uint8_t pad[3] = {0};
+    uint32_t ops = TEST_STREAM_BYTES / op_bytes;
+    uint32_t errors = 0;
+    uint64_t ns = UINT64_MAX;
+
+    if (pow2)
+    {
+        TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_init_pow2(&test_rb, test_buf, TEST_BUF_SIZE));
+    }
+    else
+    {
+        data_ringbuf_init(&test_rb, test_buf, TEST_BUF_SIZE);
+    }
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_write(&test_rb, pad, sizeof(pad)));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_read(&test_rb, pad, sizeof(pad)));
+
+    for (uint32_t i = 0; i < op_bytes; i++)
+    {
+        in[i] = (uint8_t) ((i * 7) + 1);
+    }
+
+    for (uint32_t pass = 0; pass < TEST_PASSES; pass++)
+    {
+        uint64_t start_ns = test_get_ns();
+        uint64_t pass_ns;
+
+        for (uint32_t i = 0; i < ops; i++)
+        {
+            errors += data_ringbuf_write(&test_rb, in, op_bytes);
+            errors += data_ringbuf_read(&test_rb, out, op_bytes);
+        }
+        pass_ns = test_get_ns() - start_ns;
+        if (pass_ns < ns)
+        {
+            ns = pass_ns;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, errors);
+    TEST_ASSERT_EQUAL_MEMORY(in, out, op_bytes);
+    TEST_ASSERT_EQUAL(0, data_ringbuf_data_length(&test_rb));
+
+    printf("data_ringbuf bench %3lu byte ops, %-7s %8.1f MB/s, %6.1f ns per write and read\n",
+           (unsigned long) op_bytes,
+           pow2 ? "pow2" : "default",
+           (ns == 0) ? 0.0 : (((double) ops * op_bytes * 1000.0) / (double) ns),
+           (double) ns / ops);
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(data_ringbuf_bench);
+
+TEST_SETUP(data_ringbuf_bench)
+{
+    memset(test_buf, 0, sizeof(test_buf));
+}
+
+TEST_TEAR_DOWN(data_ringbuf_bench)
+{
+}
+
+TEST(data_ringbuf_bench, ops_1_byte)
+{
+    test_bench(1, false);
+    test_bench(1, true);
+}
+
+TEST(data_ringbuf_bench, ops_6_bytes)
+{
+    test_bench(6, false);
+    test_bench(6, true);
+}
+
+TEST(data_ringbuf_bench, ops_256_bytes)
+{
+    test_bench(256, false);
+    test_bench(256, true);
+}
+
+TEST_GROUP_RUNNER(data_ringbuf_bench)
+{
+    RUN_TEST_CASE(data_ringbuf_bench, ops_1_byte);
+    RUN_TEST_CASE(data_ringbuf_bench, ops_6_bytes);
+    RUN_TEST_CASE(data_ringbuf_bench, ops_256_bytes);
+}
@@ -0,0 +1,424 @@
+/**
+ * @file test_data_ringbuf_stress.c
+ *
+ * @brief Two-thread stress test of the single producer, single consumer data ring buffer
+ *
+ * A producer thread and a consumer thread share one data ring buffer with no locking, as the I2S DMA callback and the
+ * main loop do.  Each side cycles through all of its APIs with varying lengths, and the consumer checks that it sees
+ * the producer's byte sequence intact across many wraps of the buffer.
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#define _POSIX_C_SOURCE 200112L         // pthreads, sched_yield()
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "data_ringbuf.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_BUF_SIZE_PLAIN             (1000)                              // Not a power of two
+#define TEST_BUF_SIZE_POW2              (1024)
+#define TEST_STREAM_BYTES               (16 * 1024 * 1024)
+#define TEST_CHUNK_MAX                  (300)
+#define TEST_RESERVE_MAX                (64)                                // Largest data_ringbuf_reserve_contiguous()
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+/**
+ * State of one side of the stress test
+ *
+ * Only the thread running that side writes its members, and the main thread reads them once both have been joined.
+ */
+typedef struct
+{
+    uint32_t count;                     // Bytes of the test stream written or read so far
+    uint32_t seed;                      // Pseudo-random state choosing the API and length of each call
+    uint32_t calls[4];                  // Number of calls made of each API
+    uint32_t errors;                    // Calls that failed when they should have succeeded
+    uint32_t mismatch_count;            // Stream position of the first byte read that was wrong
+    bool mismatch;
+} test_side_t;
+
+static data_ringbuf_t test_rb;
+static uint8_t test_buf[TEST_BUF_SIZE_POW2];
+static test_side_t test_producer;
+static test_side_t test_consumer;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Byte at a given position of the test stream
+ *
+ * The period of 251 bytes is prime, so is never a multiple of the buffer size and a byte that is lost, repeated or
+ * read from the wrong place is always seen.
+ */
+static uint8_t test_stream_byte(uint32_t count)
+{
+    return (uint8_t) (count % 251);
+}
+
+/**
+ * Next pseudo-random number for a side, from 0 to limit - 1
+ *
+ */
+static uint32_t test_rand(test_side_t *side, uint32_t limit)
+{
+    side->seed = (side->seed * 1664525) + 1013904223;
+
+    return (side->seed >> 8) % limit;
+}
+
+/**
+ * Fill part of the buffer with the next bytes of the test stream
+ *
+ */
+static void test_fill(uint8_t *ptr, uint32_t len, uint32_t count)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        ptr[i] = test_stream_byte(count + i);
+    }
+}
+
+/**
+ * Check part of the buffer holds the next bytes of the test stream, recording the first mismatch
+ *
+ */
+static void test_check(test_side_t *side, const uint8_t *ptr, uint32_t len, uint32_t count)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        if ((ptr[i] != test_stream_byte(count + i)) && !side->mismatch)
+        {
+            side->mismatch = true;
+            side->mismatch_count = count + i;
+        }
+    }
+}
+
+/**
+ * Producer thread, writing the test stream with each of the producer APIs in turn
+ *
+ */
+static void *test_producer_thread(void *arg)
+{
+    test_side_t *side = &test_producer;
+    uint8_t chunk[TEST_CHUNK_MAX];
+
+    while (side->count < TEST_STREAM_BYTES)
+    {
+        uint32_t api = test_rand(side, 4);
+        uint32_t len = test_rand(side, TEST_CHUNK_MAX) + 1;
+        uint32_t written = 0;
+
+        if (len > (TEST_STREAM_BYTES - side->count))
+        {
+            len = TEST_STREAM_BYTES - side->count;
+        }
+
+        if (api == 0)
+        {
+            if (data_ringbuf_free_space(&test_rb) >= len)
+            {
+                test_fill(chunk, len, side->count);
+                if (data_ringbuf_write(&test_rb, chunk, len) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                written = len;
+            }
+        }
+        else if (api == 1)
+        {
+            uint8_t *ptr;
+            uint32_t block_len;
+
+            data_ringbuf_next_write_block(&test_rb, &ptr, &block_len);
+            if (block_len > len)
+            {
+                block_len = len;
+            }
+            if (block_len > 0)
+            {
+                test_fill(ptr, block_len, side->count);
+                if (data_ringbuf_bytes_written(&test_rb, block_len) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                written = block_len;
+            }
+        }
+        else if (api == 2)
+        {
+            data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+            uint32_t free_space = data_ringbuf_get_write_iov(&test_rb, iov);
+
+            if (free_space > len)
+            {
+                free_space = len;
+            }
+            if (free_space > 0)
+            {
+                uint32_t len0 = (free_space < iov[0].len) ? free_space : iov[0].len;
+
+                test_fill(iov[0].ptr, len0, side->count);
+                test_fill(iov[1].ptr, free_space - len0, side->count + len0);
+                if (data_ringbuf_commit_write_iov(&test_rb, free_space) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                written = free_space;
+            }
+        }
+        else
+        {
+            uint8_t *ptr;
+
+            // Reserving may leave a gap at the end of the buffer that the consumer has to skip
+            if (len > TEST_RESERVE_MAX)
+            {
+                len = (len % TEST_RESERVE_MAX) + 1;
+            }
+            if (data_ringbuf_reserve_contiguous(&test_rb, len, &ptr) == DATA_RINGBUF_STATUS_OK)
+            {
+                test_fill(ptr, len, side->count);
+                if (data_ringbuf_bytes_written(&test_rb, len) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                written = len;
+            }
+        }
+
+        if (written == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        side->calls[api]++;
+        side->count += written;
+    }
+
+    return arg;
+}
+
+/**
+ * Consumer thread, reading and checking the test stream with each of the consumer APIs in turn
+ *
+ */
+static void *test_consumer_thread(void *arg)
+{
+    test_side_t *side = &test_consumer;
+    uint8_t chunk[TEST_CHUNK_MAX];
+
+    while (side->count < TEST_STREAM_BYTES)
+    {
+        uint32_t api = test_rand(side, 4);
+        uint32_t len = test_rand(side, TEST_CHUNK_MAX) + 1;
+        uint32_t read = 0;
+
+        if (api == 0)
+        {
+            if (data_ringbuf_data_length(&test_rb) >= len)
+            {
+                if (data_ringbuf_read(&test_rb, chunk, len) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                test_check(side, chunk, len, side->count);
+                read = len;
+            }
+        }
+        else if (api == 1)
+        {
+            uint8_t *ptr;
+            uint32_t block_len;
+
+            data_ringbuf_next_read_block(&test_rb, &ptr, &block_len);
+            if (block_len > len)
+            {
+                block_len = len;
+            }
+            if (block_len > 0)
+            {
+                test_check(side, ptr, block_len, side->count);
+                if (data_ringbuf_bytes_read(&test_rb, block_len) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                read = block_len;
+            }
+        }
+        else if (api == 2)
+        {
+            data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+            uint32_t data_length = data_ringbuf_get_read_iov(&test_rb, iov);
+
+            if (data_length > len)
+            {
+                data_length = len;
+            }
+            if (data_length > 0)
+            {
+                uint32_t len0 = (data_length < iov[0].len) ? data_length : iov[0].len;
+
+                test_check(side, iov[0].ptr, len0, side->count);
+                test_check(side, iov[1].ptr, data_length - len0, side->count + len0);
+                if (data_ringbuf_commit_read_iov(&test_rb, data_length) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                read = data_length;
+            }
+        }
+        else
+        {
+            uint8_t *ptr;
+
+            if (len > TEST_RESERVE_MAX)
+            {
+                len = (len % TEST_RESERVE_MAX) + 1;
+            }
+            if (data_ringbuf_peek_contiguous(&test_rb, len, &ptr) == DATA_RINGBUF_STATUS_OK)
+            {
+                test_check(side, ptr, len, side->count);
+                if (data_ringbuf_bytes_read(&test_rb, len) != DATA_RINGBUF_STATUS_OK)
+                {
+                    side->errors++;
+                }
+                read = len;
+            }
+        }
+
+        if (read == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        side->calls[api]++;
+        side->count += read;
+    }
+
+    return arg;
+}
+
+/**
+ * Run the producer and consumer threads to completion and check the stream arrived intact
+ *
+ */
+static void test_run(void)
+{
+    pthread_t producer;
+    pthread_t consumer;
+
+    memset(&test_producer, 0, sizeof(test_producer));
+    memset(&test_consumer, 0, sizeof(test_consumer));
+    test_producer.seed = 1;
+    test_consumer.seed = 2;
+
+    TEST_ASSERT_EQUAL(0, pthread_create(&consumer, NULL, test_consumer_thread, NULL));
+    TEST_ASSERT_EQUAL(0, pthread_create(&producer, NULL, test_producer_thread, NULL));
+    TEST_ASSERT_EQUAL(0, pthread_join(producer, NULL));
+    TEST_ASSERT_EQUAL(0, pthread_join(consumer, NULL));
+
+    TEST_ASSERT_EQUAL(0, test_producer.errors);
+    TEST_ASSERT_EQUAL(0, test_consumer.errors);
+    TEST_ASSERT_FALSE(test_consumer.mismatch);
+    TEST_ASSERT_EQUAL(TEST_STREAM_BYTES, test_consumer.count);
+    TEST_ASSERT_EQUAL(0, data_ringbuf_data_length(&test_rb));
+
+    // Every API was used on both sides
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_GREATER_THAN(0, test_producer.calls[i]);
+        TEST_ASSERT_GREATER_THAN(0, test_consumer.calls[i]);
+    }
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(data_ringbuf_stress);
+
+TEST_SETUP(data_ringbuf_stress)
+{
+    memset(test_buf, 0, sizeof(test_buf));
+}
+
+TEST_TEAR_DOWN(data_ringbuf_stress)
+{
+}
+
+TEST(data_ringbuf_stress, two_threads_plain)
+{
+    data_ringbuf_init(&test_rb, test_buf, TEST_BUF_SIZE_PLAIN);
+    test_run();
+}
+
+TEST(data_ringbuf_stress, two_threads_pow2)
+{
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_init_pow2(&test_rb, test_buf, TEST_BUF_SIZE_POW2));
+    test_run();
+}
+
+TEST(data_ringbuf_stress, two_threads_counts_wrap)
+{
+    // Start the free-running counts just short of wrapping, so they wrap part way through the stream
+    data_ringbuf_init(&test_rb, test_buf, TEST_BUF_SIZE_PLAIN);
+    test_rb.write_count = 0xFFFFFFFF - (TEST_STREAM_BYTES / 2);
+    test_rb.read_count = test_rb.write_count;
+    test_run();
+}
+
+TEST(data_ringbuf_stress, skipped_gap_stays_skipped)
+{
+    uint8_t *ptr;
+
+    // Leave a gap at the end of the buffer and read past it
+    data_ringbuf_init(&test_rb, test_buf, TEST_BUF_SIZE_PLAIN);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_written(&test_rb, TEST_BUF_SIZE_PLAIN - 10));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_read(&test_rb, TEST_BUF_SIZE_PLAIN - 10));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_reserve_contiguous(&test_rb, 20, &ptr));
+    TEST_ASSERT_EQUAL_PTR(test_buf, ptr);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_written(&test_rb, 20));
+    TEST_ASSERT_EQUAL(20, data_ringbuf_data_length(&test_rb));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_read(&test_rb, 20));
+
+    // Once the counts are more than half their range past the gap, it must not look like it is still ahead
+    test_rb.write_count += 0x80000000 + TEST_BUF_SIZE_PLAIN;
+    test_rb.read_count = test_rb.write_count;
+    TEST_ASSERT_EQUAL(0, data_ringbuf_data_length(&test_rb));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_written(&test_rb, 30));
+    TEST_ASSERT_EQUAL(30, data_ringbuf_data_length(&test_rb));
+}
+
+TEST_GROUP_RUNNER(data_ringbuf_stress)
+{
+    RUN_TEST_CASE(data_ringbuf_stress, two_threads_plain);
+    RUN_TEST_CASE(data_ringbuf_stress, two_threads_pow2);
+    RUN_TEST_CASE(data_ringbuf_stress, two_threads_counts_wrap);
+    RUN_TEST_CASE(data_ringbuf_stress, skipped_gap_stays_skipped);
+}
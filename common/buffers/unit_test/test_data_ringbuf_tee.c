@@ -0,0 +1,364 @@
+/**
+ * @file test_data_ringbuf_tee.c
+ *
+ * @brief Unit tests for the multi-reader data ring buffer
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <string.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "data_ringbuf_tee.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_BUF_SIZE                   (64)
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+static data_ringbuf_tee_t test_tee;
+static uint8_t test_buf[TEST_BUF_SIZE];
+static uint32_t test_write_count;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Byte at a given position of the test stream
+ *
+ */
+static uint8_t test_stream_byte(uint32_t count)
+{
+    return (uint8_t) ((count * 7) + (count >> 8) + 1);
+}
+
+/**
+ * Write the next bytes of the test stream
+ *
+ */
+static uint32_t test_write(uint32_t len)
+{
+    uint8_t data[TEST_BUF_SIZE * 4];
+    uint32_t ret;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        data[i] = test_stream_byte(test_write_count + i);
+    }
+
+    ret = data_ringbuf_tee_write(&test_tee, data, len);
+    if (ret == DATA_RINGBUF_TEE_STATUS_OK)
+    {
+        test_write_count += len;
+    }
+
+    return ret;
+}
+
+/**
+ * Read bytes for a reader with data_ringbuf_tee_read() and check they are the expected part of the test stream
+ *
+ */
+static void test_read_check(uint32_t reader_id, uint32_t len, uint32_t stream_count)
+{
+    uint8_t data[TEST_BUF_SIZE];
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, data_ringbuf_tee_read(&test_tee, reader_id, data, len));
+    for (uint32_t i = 0; i < len; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8(test_stream_byte(stream_count + i), data[i]);
+    }
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(data_ringbuf_tee);
+
+TEST_SETUP(data_ringbuf_tee)
+{
+    memset(test_buf, 0, sizeof(test_buf));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, data_ringbuf_tee_init(&test_tee, test_buf, TEST_BUF_SIZE));
+    test_write_count = 0;
+}
+
+TEST_TEAR_DOWN(data_ringbuf_tee)
+{
+}
+
+TEST(data_ringbuf_tee, init_rejects_non_power_of_two)
+{
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, data_ringbuf_tee_init(&test_tee, test_buf, 0));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, data_ringbuf_tee_init(&test_tee, test_buf, 48));
+}
+
+TEST(data_ringbuf_tee, add_reader_limits)
+{
+    uint32_t reader_id;
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, data_ringbuf_tee_add_reader(&test_tee, 2, &reader_id));
+    for (uint32_t i = 0; i < DATA_RINGBUF_TEE_MAX_READERS; i++)
+    {
+        TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK,
+                          data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &reader_id));
+        TEST_ASSERT_EQUAL(i, reader_id);
+    }
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL,
+                      data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &reader_id));
+}
+
+TEST(data_ringbuf_tee, readers_share_one_stream)
+{
+    uint32_t copy_reader;
+    uint32_t zero_copy_reader;
+    uint32_t copy_count = 0;
+    uint32_t zero_copy_count = 0;
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &copy_reader);
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &zero_copy_reader);
+
+    // Odd lengths, so that writes and both kinds of read wrap at every point of the buffer
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        uint8_t *read_ptr;
+        uint32_t read_len;
+
+        TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(13 + (i % 5)));
+
+        test_read_check(copy_reader, data_ringbuf_tee_data_length(&test_tee, copy_reader), copy_count);
+        copy_count = test_write_count;
+
+        // Zero-copy reads only return contiguous data, so may take two blocks
+        while (data_ringbuf_tee_data_length(&test_tee, zero_copy_reader) > 0)
+        {
+            data_ringbuf_tee_next_read_block(&test_tee, zero_copy_reader, &read_ptr, &read_len);
+            TEST_ASSERT_NOT_NULL(read_ptr);
+            TEST_ASSERT_TRUE((read_ptr + read_len) <= (test_buf + TEST_BUF_SIZE));
+            for (uint32_t j = 0; j < read_len; j++)
+            {
+                TEST_ASSERT_EQUAL_HEX8(test_stream_byte(zero_copy_count + j), read_ptr[j]);
+            }
+            TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK,
+                              data_ringbuf_tee_bytes_read(&test_tee, zero_copy_reader, read_len));
+            zero_copy_count += read_len;
+        }
+    }
+    TEST_ASSERT_EQUAL(test_write_count, zero_copy_count);
+}
+
+TEST(data_ringbuf_tee, free_space_set_by_slowest_reader)
+{
+    uint32_t fast_reader;
+    uint32_t slow_reader;
+    uint8_t data[TEST_BUF_SIZE];
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &fast_reader);
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &slow_reader);
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(40));
+    data_ringbuf_tee_read(&test_tee, fast_reader, data, 40);
+    data_ringbuf_tee_read(&test_tee, slow_reader, data, 10);
+
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 30, data_ringbuf_tee_free_space(&test_tee));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, test_write(TEST_BUF_SIZE - 29));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(TEST_BUF_SIZE - 30));
+    TEST_ASSERT_EQUAL(0, data_ringbuf_tee_free_space(&test_tee));
+
+    // A blocking reader never loses data
+    test_read_check(slow_reader, TEST_BUF_SIZE, 10);
+}
+
+TEST(data_ringbuf_tee, slow_reader_is_dropped)
+{
+    uint32_t block_reader;
+    uint32_t drop_reader;
+    uint32_t overrun_count;
+    uint32_t overrun_bytes;
+    uint8_t data[TEST_BUF_SIZE];
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &block_reader);
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &drop_reader);
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(48));
+    data_ringbuf_tee_read(&test_tee, block_reader, data, 48);
+    data_ringbuf_tee_read(&test_tee, drop_reader, data, 8);
+
+    // The dropping reader is in the way of this write, so is dropped rather than stopping it
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE, data_ringbuf_tee_free_space(&test_tee));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(32));
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OVERRUN, data_ringbuf_tee_read(&test_tee, drop_reader, data, 4));
+    data_ringbuf_tee_get_overruns(&test_tee, drop_reader, &overrun_count, &overrun_bytes);
+    TEST_ASSERT_EQUAL(1, overrun_count);
+    TEST_ASSERT_EQUAL(80 - 8, overrun_bytes);
+
+    // The reader carries on from the newest data
+    TEST_ASSERT_EQUAL(0, data_ringbuf_tee_data_length(&test_tee, drop_reader));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(16));
+    test_read_check(drop_reader, 16, 80);
+    test_read_check(block_reader, 48, 48);
+}
+
+TEST(data_ringbuf_tee, dropped_during_zero_copy_read)
+{
+    uint32_t drop_reader;
+    uint32_t overrun_count;
+    uint32_t overrun_bytes;
+    uint8_t *read_ptr;
+    uint32_t read_len;
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &drop_reader);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(TEST_BUF_SIZE));
+
+    data_ringbuf_tee_next_read_block(&test_tee, drop_reader, &read_ptr, &read_len);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE, read_len);
+
+    // The producer overwrites the block whilst the reader is still using it
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(8));
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OVERRUN, data_ringbuf_tee_bytes_read(&test_tee, drop_reader, read_len));
+    data_ringbuf_tee_get_overruns(&test_tee, drop_reader, &overrun_count, &overrun_bytes);
+    TEST_ASSERT_EQUAL(1, overrun_count);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE + 8, overrun_bytes);
+    TEST_ASSERT_EQUAL(0, data_ringbuf_tee_data_length(&test_tee, drop_reader));
+}
+
+TEST(data_ringbuf_tee, lagging_reader_is_clamped)
+{
+    uint32_t drop_reader;
+    uint32_t overrun_count;
+    uint32_t overrun_bytes;
+    uint8_t *read_ptr;
+    uint32_t read_len;
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &drop_reader);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(TEST_BUF_SIZE));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(TEST_BUF_SIZE));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(24));
+
+    // Emulate the producer writing more than a buffer between the reader resynchronising and the producer seeing the
+    // acknowledgement: the reader is no longer dropped, but is left behind data that has already been overwritten
+    test_tee.readers[drop_reader].ack_drop_count = test_tee.readers[drop_reader].drop_count;
+    test_tee.readers[drop_reader].read_count = 8;
+
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE, data_ringbuf_tee_data_length(&test_tee, drop_reader));
+    data_ringbuf_tee_get_overruns(&test_tee, drop_reader, &overrun_count, &overrun_bytes);
+    TEST_ASSERT_EQUAL((2 * TEST_BUF_SIZE) + 24 - TEST_BUF_SIZE - 8, overrun_bytes);
+
+    // Only data still in the buffer is returned
+    data_ringbuf_tee_next_read_block(&test_tee, drop_reader, &read_ptr, &read_len);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 24, read_len);
+    TEST_ASSERT_EQUAL_HEX8(test_stream_byte(test_write_count - TEST_BUF_SIZE), read_ptr[0]);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, data_ringbuf_tee_bytes_read(&test_tee, drop_reader, read_len));
+    test_read_check(drop_reader, 24, test_write_count - 24);
+}
+
+TEST(data_ringbuf_tee, make_space_then_zero_copy_write)
+{
+    uint32_t block_reader;
+    uint32_t drop_reader;
+    uint8_t *write_ptr;
+    uint32_t write_len;
+    uint8_t data[TEST_BUF_SIZE];
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &block_reader);
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &drop_reader);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(40));
+    data_ringbuf_tee_read(&test_tee, block_reader, data, 40);
+
+    // The dropping reader limits the next block until make_space drops it
+    data_ringbuf_tee_next_write_block(&test_tee, &write_ptr, &write_len);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 40, write_len);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, data_ringbuf_tee_make_space(&test_tee, 40));
+    data_ringbuf_tee_next_write_block(&test_tee, &write_ptr, &write_len);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 40, write_len);
+    TEST_ASSERT_EQUAL_PTR(test_buf + 40, write_ptr);
+
+    for (uint32_t i = 0; i < write_len; i++)
+    {
+        write_ptr[i] = test_stream_byte(test_write_count + i);
+    }
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, data_ringbuf_tee_bytes_written(&test_tee, write_len + 1));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, data_ringbuf_tee_bytes_written(&test_tee, write_len));
+    test_write_count += write_len;
+
+    // The blocking reader still stops writes
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, data_ringbuf_tee_make_space(&test_tee, 41));
+    test_read_check(block_reader, TEST_BUF_SIZE - 40, 40);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OVERRUN, data_ringbuf_tee_read(&test_tee, drop_reader, data, 1));
+}
+
+TEST(data_ringbuf_tee, write_iov_wraps_and_drops_slow_reader)
+{
+    uint32_t block_reader;
+    uint32_t drop_reader;
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+    uint8_t data[TEST_BUF_SIZE];
+    uint32_t offset = 0;
+
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &block_reader);
+    data_ringbuf_tee_add_reader(&test_tee, DATA_RINGBUF_TEE_POLICY_DROP, &drop_reader);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, test_write(40));
+
+    // Only the blocking reader limits the free space, and the dropping reader is left alone while it fits
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 40, data_ringbuf_tee_get_write_iov(&test_tee, iov));
+    TEST_ASSERT_EQUAL_PTR(test_buf + 40, iov[0].ptr);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 40, iov[0].len);
+    TEST_ASSERT_NULL(iov[1].ptr);
+    TEST_ASSERT_EQUAL(0, iov[1].len);
+    TEST_ASSERT_EQUAL(40, data_ringbuf_tee_data_length(&test_tee, drop_reader));
+
+    // Once the blocking reader has made room, the free space wraps and the dropping reader is dropped
+    data_ringbuf_tee_read(&test_tee, block_reader, data, 40);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE, data_ringbuf_tee_get_write_iov(&test_tee, iov));
+    TEST_ASSERT_EQUAL_PTR(test_buf + 40, iov[0].ptr);
+    TEST_ASSERT_EQUAL(TEST_BUF_SIZE - 40, iov[0].len);
+    TEST_ASSERT_EQUAL_PTR(test_buf, iov[1].ptr);
+    TEST_ASSERT_EQUAL(40, iov[1].len);
+
+    for (uint32_t i = 0; i < DATA_RINGBUF_IOV_MAX; i++)
+    {
+        for (uint32_t j = 0; j < iov[i].len; j++, offset++)
+        {
+            iov[i].ptr[j] = test_stream_byte(test_write_count + offset);
+        }
+    }
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_FAIL, data_ringbuf_tee_commit_write_iov(&test_tee, TEST_BUF_SIZE + 1));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OK, data_ringbuf_tee_commit_write_iov(&test_tee, TEST_BUF_SIZE));
+    test_write_count += TEST_BUF_SIZE;
+
+    test_read_check(block_reader, TEST_BUF_SIZE, 40);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_TEE_STATUS_OVERRUN, data_ringbuf_tee_read(&test_tee, drop_reader, data, 1));
+}
+
+TEST_GROUP_RUNNER(data_ringbuf_tee)
+{
+    RUN_TEST_CASE(data_ringbuf_tee, init_rejects_non_power_of_two);
+    RUN_TEST_CASE(data_ringbuf_tee, add_reader_limits);
+    RUN_TEST_CASE(data_ringbuf_tee, readers_share_one_stream);
+    RUN_TEST_CASE(data_ringbuf_tee, free_space_set_by_slowest_reader);
+    RUN_TEST_CASE(data_ringbuf_tee, slow_reader_is_dropped);
+    RUN_TEST_CASE(data_ringbuf_tee, dropped_during_zero_copy_read);
+    RUN_TEST_CASE(data_ringbuf_tee, lagging_reader_is_clamped);
+    RUN_TEST_CASE(data_ringbuf_tee, make_space_then_zero_copy_write);
+    RUN_TEST_CASE(data_ringbuf_tee, write_iov_wraps_and_drops_slow_reader);
+}
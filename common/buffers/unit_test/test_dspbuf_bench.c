@@ -0,0 +1,774 @@
+/**
+ * @file test_dspbuf_bench.c
+ *
+ * @brief Host benchmark of the DSP buffer capture pipeline
+ *
+ * Fixed reference streams are compressed on the host and played out of a mock DSP ring buffer, which sits behind the
+ * real regmap on a mock control port.  The DSP raises its IRQ at the high water mark, and the host drains the buffer
+ * with dspbuf_group_service() and decompresses it, as the cs47l63 BSP does.  The output must match a one-pass decode
+ * of the reference stream.  Throughput, per-call latency percentiles and arena use are printed.  An overflow that
+ * drops data part way through a frame is also injected, after which decoding must pick up at the next whole frame.
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#define _POSIX_C_SOURCE 199309L         // clock_gettime()
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "bsp_driver_if.h"
+#include "arena.h"
+#include "compr.h"
+#include "dspbuf.h"
+#include "ima_adpcm.h"
+#include "perf_stats.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_PI                         (3.14159265358979323846)
+#define TEST_FS_HZ                      (16000)
+#define TEST_REF_SAMPLES                (120 * 540)                         // Whole mSBC frames and packed16 words
+#define TEST_REF_BYTES                  (TEST_REF_SAMPLES * 2)
+#define TEST_COMPR_BYTES_MAX            ((TEST_REF_BYTES * 2) + 64)
+#define TEST_IMA_ADPCM_REF_BLOCKS       (126)                               // Whole packed16 words, decoded fit
+#define TEST_PACKED16_WORD_BYTES        (8)                                 // Compressed bytes of 3 samples
+#define TEST_PACKED16_SAMPLE_BYTES      (6)
+#define TEST_MSBC_FRAME_BYTES           (57)
+#define TEST_MSBC_DECODED_FRAME_BYTES   (240)
+
+// Mock DSP words read before an overflow, then lost to it, an odd number in all so the resync splits a packed16 sample
+#define TEST_RESYNC_READ_WORDS          (1001)
+#define TEST_RESYNC_LOST_WORDS          (334)
+
+// Mock DSP memory, as seen on the control port
+#define TEST_DSP_DEV_ID                 (0)
+#define TEST_DSP_MEM_BASE               (0x2800000)
+#define TEST_DSP_MEM_BYTES              (0xA000)
+#define TEST_DSP_XMEM_BASE              (TEST_DSP_MEM_BASE)
+#define TEST_DSP_YMEM_BASE              (TEST_DSP_MEM_BASE + 0x8000)
+#define TEST_DSP_BUF_SYMBOL             (TEST_DSP_MEM_BASE)                 // Holds the struct address, in words
+#define TEST_DSP_STRUCT_WORD            (0x10)
+#define TEST_DSP_STRUCT_ADDR            (TEST_DSP_XMEM_BASE + (TEST_DSP_STRUCT_WORD * 4))
+#define TEST_DSP_REGION_WORDS           (2048)
+#define TEST_DSP_BUF_WORDS              (TEST_DSP_REGION_WORDS * 3)
+#define TEST_DSP_BUF1_BASE              (0x100)                             // Words from TEST_DSP_XMEM_BASE
+#define TEST_DSP_BUF2_BASE              (0x1000)                            // Words from TEST_DSP_XMEM_BASE
+#define TEST_DSP_BUF3_BASE              (0)                                 // Words from TEST_DSP_YMEM_BASE
+#define TEST_DSP_WORDS_PER_PERIOD       (60)                                // Words the DSP writes at a time
+
+#define TEST_ARENA_SIZE                 (16384)
+#define TEST_SCRATCH_SIZE               (4096)
+#define TEST_DECOMPR_SIZE               (4096)
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+static uint8_t test_dsp_mem[TEST_DSP_MEM_BYTES];
+static bool test_dsp_irq;
+
+static int16_t test_ref_pcm[TEST_REF_SAMPLES];
+static uint8_t test_ref_compr[TEST_COMPR_BYTES_MAX];
+static uint32_t test_ref_compr_len;
+static uint8_t test_ref_decompr[TEST_REF_BYTES + 64];
+static uint32_t test_ref_decompr_len;
+static uint8_t test_out[TEST_REF_BYTES + 64];
+static uint32_t test_out_len;
+
+static uint8_t test_arena_mem[TEST_ARENA_SIZE] __attribute__((aligned(8)));
+static uint8_t test_scratch[TEST_SCRATCH_SIZE];
+static uint8_t test_decompr_mem[TEST_DECOMPR_SIZE];
+static arena_t test_arena;
+
+static regmap_cp_config_t test_cp =
+{
+    .dev_id = TEST_DSP_DEV_ID,
+    .bus_type = REGMAP_BUS_TYPE_I2C,
+    .receive_max = 0,
+};
+static dspbuf_t test_dspbuf;
+static dspbuf_t *test_streams[] = {&test_dspbuf};
+static dspbuf_group_t test_group;
+static perf_stats_t test_service_perf;
+
+static bsp_driver_if_t *test_saved_bsp_driver_if;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Get a pointer into the mock DSP memory, NULL if out of range
+ *
+ */
+static uint8_t *test_dsp_ptr(uint32_t addr, uint32_t length)
+{
+    if ((addr < TEST_DSP_MEM_BASE) || ((addr - TEST_DSP_MEM_BASE + length) > TEST_DSP_MEM_BYTES) || ((addr % 4) != 0))
+    {
+        return NULL;
+    }
+
+    return &test_dsp_mem[addr - TEST_DSP_MEM_BASE];
+}
+
+/**
+ * Read a word of mock DSP memory
+ *
+ */
+static uint32_t test_dsp_read(uint32_t addr)
+{
+    uint8_t *ptr = test_dsp_ptr(addr, 4);
+
+    return ((uint32_t) ptr[0] << 24) | ((uint32_t) ptr[1] << 16) | ((uint32_t) ptr[2] << 8) | ptr[3];
+}
+
+/**
+ * Write a word of mock DSP memory
+ *
+ */
+static void test_dsp_write(uint32_t addr, uint32_t val)
+{
+    uint8_t *ptr = test_dsp_ptr(addr, 4);
+
+    ptr[0] = (uint8_t) (val >> 24);
+    ptr[1] = (uint8_t) (val >> 16);
+    ptr[2] = (uint8_t) (val >> 8);
+    ptr[3] = (uint8_t) val;
+}
+
+/**
+ * Read an element of the mock DSP ring buffer struct
+ *
+ */
+static uint32_t test_dsp_get(dspbuf_struct_offsets_t element)
+{
+    return test_dsp_read(TEST_DSP_STRUCT_ADDR + (element * 4));
+}
+
+/**
+ * Write an element of the mock DSP ring buffer struct
+ *
+ */
+static void test_dsp_set(dspbuf_struct_offsets_t element, uint32_t val)
+{
+    test_dsp_write(TEST_DSP_STRUCT_ADDR + (element * 4), val);
+}
+
+/**
+ * Set up the mock DSP ring buffer, with three regions spread over two memories
+ *
+ */
+static void test_dsp_init(void)
+{
+    memset(test_dsp_mem, 0, sizeof(test_dsp_mem));
+    test_dsp_write(TEST_DSP_BUF_SYMBOL, TEST_DSP_STRUCT_WORD);
+    test_dsp_set(buf1_base, TEST_DSP_BUF1_BASE);
+    test_dsp_set(buf1_size, TEST_DSP_REGION_WORDS);
+    test_dsp_set(buf2_base, TEST_DSP_BUF2_BASE);
+    test_dsp_set(buf1_buf2_size, TEST_DSP_REGION_WORDS * 2);
+    test_dsp_set(buf3_base, TEST_DSP_BUF3_BASE);
+    test_dsp_set(total_buf_size, TEST_DSP_BUF_WORDS);
+    test_dsp_set(irq_count, 0);
+    test_dsp_set(irq_ack, 1);
+    test_dsp_irq = false;
+}
+
+/**
+ * Address of a word of the mock DSP ring buffer
+ *
+ */
+static uint32_t test_dsp_buf_addr(uint32_t index)
+{
+    if (index < TEST_DSP_REGION_WORDS)
+    {
+        return TEST_DSP_XMEM_BASE + ((TEST_DSP_BUF1_BASE + index) * 4);
+    }
+    else if (index < (TEST_DSP_REGION_WORDS * 2))
+    {
+        return TEST_DSP_XMEM_BASE + ((TEST_DSP_BUF2_BASE + index - TEST_DSP_REGION_WORDS) * 4);
+    }
+
+    return TEST_DSP_YMEM_BASE + ((TEST_DSP_BUF3_BASE + index - (TEST_DSP_REGION_WORDS * 2)) * 4);
+}
+
+/**
+ * Words written by the mock DSP but not yet read by the host
+ *
+ */
+static uint32_t test_dsp_data_words(void)
+{
+    return (test_dsp_get(next_word_write_index) + TEST_DSP_BUF_WORDS - test_dsp_get(next_word_read_index))
+           % TEST_DSP_BUF_WORDS;
+}
+
+/**
+ * Mock DSP firmware - write the next words of the stream and raise the IRQ at the high water mark, if it is enabled
+ *
+ */
+static void test_dsp_produce(const uint8_t *stream, uint32_t words)
+{
+    uint32_t write_index = test_dsp_get(next_word_write_index);
+
+    if ((test_dsp_data_words() + words) >= TEST_DSP_BUF_WORDS)
+    {
+        test_dsp_set(error, DSPBUF_BUF_STATUS_ERROR_OVERFLOW);
+        return;
+    }
+
+    for (uint32_t i = 0; i < words; i++)
+    {
+        memcpy(test_dsp_ptr(test_dsp_buf_addr(write_index), 4), &stream[i * 4], 4);
+        write_index = (write_index + 1) % TEST_DSP_BUF_WORDS;
+    }
+    test_dsp_set(next_word_write_index, write_index);
+
+    if ((test_dsp_data_words() >= test_dsp_get(high_water_mark))
+     && (test_dsp_get(irq_ack) == (test_dsp_get(irq_count) | 1)))
+    {
+        test_dsp_set(irq_count, test_dsp_get(irq_count) + 2);
+        test_dsp_irq = true;
+    }
+}
+
+/**
+ * Mock bsp_driver_if_t i2c_read_repeated_start, as used by regmap_read() and regmap_read_block()
+ *
+ */
+static uint32_t test_i2c_read_repeated_start(uint32_t bsp_dev_id,
+                                             uint8_t *write_buffer,
+                                             uint32_t write_length,
+                                             uint8_t *read_buffer,
+                                             uint32_t read_length,
+                                             bsp_callback_t cb,
+                                             void *cb_arg)
+{
+    uint32_t addr;
+    uint8_t *ptr;
+
+    if ((bsp_dev_id != TEST_DSP_DEV_ID) || (write_length != 4))
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    addr = ((uint32_t) write_buffer[0] << 24) | ((uint32_t) write_buffer[1] << 16) |
+           ((uint32_t) write_buffer[2] << 8) | write_buffer[3];
+    ptr = test_dsp_ptr(addr, read_length);
+    if (ptr == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+    memcpy(read_buffer, ptr, read_length);
+
+    return BSP_STATUS_OK;
+}
+
+/**
+ * Mock bsp_driver_if_t i2c_write, as used by regmap_write()
+ *
+ */
+static uint32_t test_i2c_write(uint32_t bsp_dev_id,
+                               uint8_t *write_buffer,
+                               uint32_t write_length,
+                               bsp_callback_t cb,
+                               void *cb_arg)
+{
+    uint32_t addr;
+    uint8_t *ptr;
+
+    if ((bsp_dev_id != TEST_DSP_DEV_ID) || (write_length != 8))
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    addr = ((uint32_t) write_buffer[0] << 24) | ((uint32_t) write_buffer[1] << 16) |
+           ((uint32_t) write_buffer[2] << 8) | write_buffer[3];
+    ptr = test_dsp_ptr(addr, 4);
+    if (ptr == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+    memcpy(ptr, &write_buffer[4], 4);
+
+    return BSP_STATUS_OK;
+}
+
+/**
+ * Mock bsp_driver_if_t i2c_db_write, as used by regmap_write_block()
+ *
+ */
+static uint32_t test_i2c_db_write(uint32_t bsp_dev_id,
+                                  uint8_t *write_buffer_0,
+                                  uint32_t write_length_0,
+                                  uint8_t *write_buffer_1,
+                                  uint32_t write_length_1,
+                                  bsp_callback_t cb,
+                                  void *cb_arg)
+{
+    uint32_t addr;
+    uint8_t *ptr;
+
+    if ((bsp_dev_id != TEST_DSP_DEV_ID) || (write_length_0 != 4))
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    addr = ((uint32_t) write_buffer_0[0] << 24) | ((uint32_t) write_buffer_0[1] << 16) |
+           ((uint32_t) write_buffer_0[2] << 8) | write_buffer_0[3];
+    ptr = test_dsp_ptr(addr, write_length_1);
+    if (ptr == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+    memcpy(ptr, write_buffer_1, write_length_1);
+
+    return BSP_STATUS_OK;
+}
+
+/**
+ * Mock bsp_driver_if_t set_timer
+ *
+ */
+static uint32_t test_set_timer(uint32_t duration_ms, bsp_callback_t cb, void *cb_arg)
+{
+    return BSP_STATUS_OK;
+}
+
+static bsp_driver_if_t test_bsp_driver_if =
+{
+    .set_timer = test_set_timer,
+    .i2c_read_repeated_start = test_i2c_read_repeated_start,
+    .i2c_write = test_i2c_write,
+    .i2c_db_write = test_i2c_db_write,
+};
+
+/**
+ * Free-running nanosecond count, the time source of the statistics
+ *
+ */
+static uint32_t test_get_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t) (((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec);
+}
+
+/**
+ * Fill test_ref_pcm with the reference signal: a tone, a rising chirp and pseudo-random noise
+ *
+ */
+static void test_ref_signal(void)
+{
+    uint32_t noise = 0x12345678;
+
+    for (uint32_t i = 0; i < TEST_REF_SAMPLES; i++)
+    {
+        double t = (double) i / TEST_FS_HZ;
+        double value = (6000.0 * sin(2.0 * TEST_PI * 440.0 * t))
+                     + (4000.0 * sin(2.0 * TEST_PI * (100.0 + (500.0 * t)) * t));
+
+        noise = (noise * 1664525) + 1013904223;
+        value += ((int32_t) (noise >> 16) - 32768) / 32;
+        test_ref_pcm[i] = (int16_t) lrint(value);
+    }
+}
+
+/**
+ * Replace the start of the reference signal with IMA-ADPCM blocks, headed by samples of the signal and filled with
+ * pseudo-random codes
+ *
+ * @return                The length of the blocks, in bytes
+ *
+ */
+static uint32_t test_ref_ima_adpcm_blocks(void)
+{
+    uint8_t *block = (uint8_t *) test_ref_pcm;
+    uint32_t noise = 0x87654321;
+
+    for (uint32_t i = 0; i < TEST_IMA_ADPCM_REF_BLOCKS; i++)
+    {
+        int16_t predictor = test_ref_pcm[(i * IMA_ADPCM_BLOCK_SIZE) / sizeof(int16_t)];
+
+        block[0] = (uint8_t) predictor;
+        block[1] = (uint8_t) ((uint16_t) predictor >> 8);
+        block[2] = (uint8_t) (i % 89);                  // Every valid step index
+        block[3] = 0;
+        for (uint32_t j = IMA_ADPCM_BLOCK_HEADER_SIZE; j < IMA_ADPCM_BLOCK_SIZE; j++)
+        {
+            noise = (noise * 1664525) + 1013904223;
+            block[j] = (uint8_t) (noise >> 24);
+        }
+        block += IMA_ADPCM_BLOCK_SIZE;
+    }
+
+    return TEST_IMA_ADPCM_REF_BLOCKS * IMA_ADPCM_BLOCK_SIZE;
+}
+
+/**
+ * Compress the reference signal into test_ref_compr, in whole DSP words, and decode that in one pass
+ *
+ */
+static void test_ref_stream(compr_enc_format_t enc_format)
+{
+    compr_t compr;
+    decompr_t decompr;
+    data_ringbuf_t pcm_data_buf;
+    data_ringbuf_t compr_data_buf;
+    data_ringbuf_t decompr_data_buf;
+    uint32_t pcm_len = sizeof(test_ref_pcm);
+    compr_enc_format_t compr_enc_format = enc_format;
+    uint32_t bytes;
+
+    test_ref_signal();
+
+    // IMA-ADPCM blocks cannot be encoded on the host, so made up ones are carried as packed16, as the DSP does
+    if (enc_format == COMPR_ENC_FORMAT_IMA_ADPCM)
+    {
+        pcm_len = test_ref_ima_adpcm_blocks();
+        compr_enc_format = COMPR_ENC_FORMAT_PACKED16;
+    }
+
+    data_ringbuf_init(&pcm_data_buf, (uint8_t *) test_ref_pcm, sizeof(test_ref_pcm));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_written(&pcm_data_buf, pcm_len));
+    data_ringbuf_init(&compr_data_buf, test_ref_compr, sizeof(test_ref_compr));
+    TEST_ASSERT_EQUAL(COMPR_STATUS_OK, compr_init(&compr, compr_enc_format, ENDIAN_LITTLE, NULL));
+    do
+    {
+        TEST_ASSERT_EQUAL(COMPR_STATUS_OK, compr_data(&compr, &compr_data_buf, &pcm_data_buf, &bytes));
+    } while (bytes != 0);
+    compr_deinit(&compr);
+    test_ref_compr_len = data_ringbuf_data_length(&compr_data_buf) & ~0x3;
+
+    data_ringbuf_init(&compr_data_buf, test_ref_compr, sizeof(test_ref_compr));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_bytes_written(&compr_data_buf, test_ref_compr_len));
+    data_ringbuf_init(&decompr_data_buf, test_ref_decompr, sizeof(test_ref_decompr));
+    TEST_ASSERT_EQUAL(DECOMPR_STATUS_OK, decompr_init(&decompr, enc_format, ENDIAN_LITTLE, NULL));
+    do
+    {
+        TEST_ASSERT_EQUAL(DECOMPR_STATUS_OK, decompr_data(&decompr, &decompr_data_buf, &compr_data_buf, &bytes));
+    } while (bytes != 0);
+    decompr_deinit(&decompr);
+    test_ref_decompr_len = data_ringbuf_data_length(&decompr_data_buf);
+}
+
+/**
+ * Move all decompressed data to test_out, as the I2S would consume it
+ *
+ */
+static void test_consume(void)
+{
+    uint32_t len = data_ringbuf_data_length(&test_dspbuf.decompr_data_buf);
+
+    TEST_ASSERT_TRUE((test_out_len + len) <= sizeof(test_out));
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK,
+                      data_ringbuf_read(&test_dspbuf.decompr_data_buf, &test_out[test_out_len], len));
+    test_out_len += len;
+}
+
+/**
+ * Service the group as the BSP does on an IRQ: keep calling while data is left behind, consuming in between
+ *
+ */
+static void test_service(void)
+{
+    uint32_t ret;
+
+    do
+    {
+        uint32_t start_ticks = perf_stats_get_ticks();
+        uint32_t bytes_read;
+
+        ret = dspbuf_group_service(&test_group, &bytes_read);
+        perf_stats_record(&test_service_perf, start_ticks, bytes_read);
+        TEST_ASSERT_NOT_EQUAL(DSPBUF_STATUS_FAIL, ret);
+        test_consume();
+    } while (ret == DSPBUF_STATUS_AGAIN);
+}
+
+/**
+ * Print the statistics of one stage
+ *
+ */
+static void test_print_perf_stats(const char *name, perf_stats_t *stats)
+{
+    printf("  %-22s %7lu calls, %7.1f MB/s, p50 %6lu p99 %6lu max %7lu ns\n",
+           name,
+           (unsigned long) stats->calls,
+           (stats->ticks == 0) ? 0.0 : (((double) stats->bytes * 1000.0) / (double) stats->ticks),
+           (unsigned long) perf_stats_get_percentile(stats, 50),
+           (unsigned long) perf_stats_get_percentile(stats, 99),
+           (unsigned long) stats->max_ticks);
+}
+
+/**
+ * Set up the capture pipeline on the mock DSP buffer
+ *
+ */
+static void test_group_init(compr_enc_format_t enc_format)
+{
+    dspbuf_config_t config =
+    {
+        .cp = &test_cp,
+        .bufs_config =
+        {
+            {.base_id = buf1_base, .size_id = buf1_size,      .mem_base = TEST_DSP_XMEM_BASE},
+            {.base_id = buf2_base, .size_id = buf1_buf2_size, .mem_base = TEST_DSP_XMEM_BASE},
+            {.base_id = buf3_base, .size_id = total_buf_size, .mem_base = TEST_DSP_YMEM_BASE},
+        },
+        .rb_struct_mem_start_address = TEST_DSP_XMEM_BASE,
+        .buf_symbol = TEST_DSP_BUF_SYMBOL,
+        .enc_format = enc_format,
+        .bytes_per_reg = 4,
+        .arena = &test_arena,
+    };
+
+    TEST_ASSERT_EQUAL(DSPBUF_STATUS_OK,
+                      dspbuf_group_init(&test_group, test_streams, &config, 1, test_scratch, sizeof(test_scratch)));
+    data_ringbuf_init(&test_dspbuf.decompr_data_buf, test_decompr_mem, sizeof(test_decompr_mem));
+}
+
+/**
+ * Have the mock DSP write the reference stream from start to end a period at a time, servicing each IRQ straight away
+ *
+ * @return                The number of IRQs serviced
+ *
+ */
+static uint32_t test_play(uint32_t start, uint32_t end)
+{
+    uint32_t produced = start;
+    uint32_t irqs = 0;
+
+    while (produced < end)
+    {
+        uint32_t words = (end - produced) / 4;
+
+        if (words > TEST_DSP_WORDS_PER_PERIOD)
+        {
+            words = TEST_DSP_WORDS_PER_PERIOD;
+        }
+        test_dsp_produce(&test_ref_compr[produced], words);
+        produced += words * 4;
+
+        if (test_dsp_irq)
+        {
+            test_dsp_irq = false;
+            irqs++;
+            test_service();
+        }
+    }
+
+    return irqs;
+}
+
+/**
+ * Pick up whatever is left below the high water mark, then decompress what is left as the BSP does while playing
+ *
+ */
+static void test_flush(void)
+{
+    uint32_t bytes_decompressed;
+
+    test_service();
+    do
+    {
+        TEST_ASSERT_EQUAL(DECOMPR_STATUS_OK,
+                          decompr_data(&test_dspbuf.decompr,
+                                       &test_dspbuf.decompr_data_buf,
+                                       &test_dspbuf.compr_data_buf,
+                                       &bytes_decompressed));
+        test_consume();
+    } while (bytes_decompressed != 0);
+}
+
+/**
+ * Stream a reference stream through the mock DSP buffer and the capture pipeline
+ *
+ */
+static void test_bench(compr_enc_format_t enc_format, const char *name)
+{
+    uint32_t irqs;
+
+    // Even mSBC, at 57 bytes for every 240 of PCM, wraps the DSP buffer
+    test_ref_stream(enc_format);
+    TEST_ASSERT_TRUE(test_ref_compr_len > (TEST_DSP_BUF_WORDS * 4));
+
+    test_group_init(enc_format);
+    irqs = test_play(0, test_ref_compr_len);
+    test_flush();
+
+    TEST_ASSERT_EQUAL(0, test_dsp_get(error));
+    TEST_ASSERT_EQUAL(0, test_dsp_data_words());
+    TEST_ASSERT_EQUAL(0, dspbuf_get_stats(&test_dspbuf)->overflow_count);
+    TEST_ASSERT_EQUAL(test_ref_decompr_len, test_out_len);
+    TEST_ASSERT_EQUAL_MEMORY(test_ref_decompr, test_out, test_out_len);
+
+    printf("dspbuf bench %s: %lu compressed bytes in %lu IRQs, %lu decompressed bytes, arena high water %lu bytes\n",
+           name,
+           (unsigned long) test_ref_compr_len,
+           (unsigned long) irqs,
+           (unsigned long) test_out_len,
+           (unsigned long) arena_get_high_water(&test_arena));
+    test_print_perf_stats("dspbuf_group_service", &test_service_perf);
+#ifdef CONFIG_PERF_STATS
+    test_print_perf_stats("dspbuf_read", &test_dspbuf.stats.read_perf);
+    test_print_perf_stats("decompr_data", &test_dspbuf.decompr.perf);
+#endif
+
+    decompr_deinit(&test_dspbuf.decompr);
+}
+
+/**
+ * Where in the one-pass decode the output picks up again after a resync at compr_pos, i.e. the start of the next
+ * whole sample, frame or block
+ *
+ */
+static uint32_t test_resync_decompr_pos(compr_enc_format_t enc_format, uint32_t compr_pos)
+{
+    uint32_t unpacked_pos = ((compr_pos + TEST_PACKED16_WORD_BYTES - 1) / TEST_PACKED16_WORD_BYTES)
+                          * TEST_PACKED16_SAMPLE_BYTES;
+
+    switch (enc_format)
+    {
+        case COMPR_ENC_FORMAT_MSBC:
+            return ((unpacked_pos + TEST_MSBC_FRAME_BYTES - 1) / TEST_MSBC_FRAME_BYTES) * TEST_MSBC_DECODED_FRAME_BYTES;
+        case COMPR_ENC_FORMAT_IMA_ADPCM:
+            return ((unpacked_pos + IMA_ADPCM_BLOCK_SIZE - 1) / IMA_ADPCM_BLOCK_SIZE)
+                   * IMA_ADPCM_SAMPLES_PER_BLOCK * sizeof(int16_t);
+        default:
+            return unpacked_pos;
+    }
+}
+
+/**
+ * Stream a reference stream with an overflow part way through, which drops data that ends part way through a frame
+ *
+ * @return                The number of bytes output before the overflow
+ *
+ */
+static uint32_t test_resync(compr_enc_format_t enc_format)
+{
+    uint32_t read_len = TEST_RESYNC_READ_WORDS * 4;
+    uint32_t resync_pos = (TEST_RESYNC_READ_WORDS + TEST_RESYNC_LOST_WORDS) * 4;
+    uint32_t resync_decompr_pos;
+    uint32_t pre_len;
+
+    test_ref_stream(enc_format);
+    resync_decompr_pos = test_resync_decompr_pos(enc_format, resync_pos);
+
+    test_group_init(enc_format);
+    test_play(0, read_len);
+    test_flush();
+    pre_len = test_out_len;
+
+    // The host falls behind and the DSP reports an overflow, so everything it wrote in the meantime is skipped
+    test_dsp_produce(&test_ref_compr[read_len], TEST_RESYNC_LOST_WORDS);
+    test_dsp_set(error, DSPBUF_BUF_STATUS_ERROR_OVERFLOW);
+    test_dsp_irq = false;
+    test_service();
+    TEST_ASSERT_EQUAL(1, dspbuf_get_stats(&test_dspbuf)->resync_count);
+    TEST_ASSERT_EQUAL(0, test_dsp_get(error));
+
+    test_play(resync_pos, test_ref_compr_len);
+    test_flush();
+
+    // Everything decoded before the overflow is kept, then decoding picks up at the first whole frame after it
+    TEST_ASSERT_TRUE(pre_len > 0);
+    TEST_ASSERT_TRUE(resync_decompr_pos < test_ref_decompr_len);
+    TEST_ASSERT_EQUAL_MEMORY(test_ref_decompr, test_out, pre_len);
+    TEST_ASSERT_EQUAL(pre_len + test_ref_decompr_len - resync_decompr_pos, test_out_len);
+
+    decompr_deinit(&test_dspbuf.decompr);
+
+    return pre_len;
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(dspbuf_bench);
+
+TEST_SETUP(dspbuf_bench)
+{
+    test_saved_bsp_driver_if = bsp_driver_if_g;
+    bsp_driver_if_g = &test_bsp_driver_if;
+    perf_stats_set_time_source(test_get_ns);
+    perf_stats_reset(&test_service_perf);
+
+    arena_init(&test_arena, test_arena_mem, sizeof(test_arena_mem));
+    test_dsp_init();
+    test_out_len = 0;
+}
+
+TEST_TEAR_DOWN(dspbuf_bench)
+{
+    perf_stats_set_time_source(NULL);
+    bsp_driver_if_g = test_saved_bsp_driver_if;
+}
+
+TEST(dspbuf_bench, packed16_stream)
+{
+    test_bench(COMPR_ENC_FORMAT_PACKED16, "PACKED16");
+
+    // packed16 is lossless
+    TEST_ASSERT_EQUAL(sizeof(test_ref_pcm), test_out_len);
+    TEST_ASSERT_EQUAL_MEMORY(test_ref_pcm, test_out, test_out_len);
+}
+
+TEST(dspbuf_bench, msbc_stream)
+{
+    test_bench(COMPR_ENC_FORMAT_MSBC, "MSBC");
+}
+
+TEST(dspbuf_bench, packed16_resync_mid_sample)
+{
+    uint32_t pre_len = test_resync(COMPR_ENC_FORMAT_PACKED16);
+    uint32_t resync_decompr_pos = test_resync_decompr_pos(COMPR_ENC_FORMAT_PACKED16,
+                                                          (TEST_RESYNC_READ_WORDS + TEST_RESYNC_LOST_WORDS) * 4);
+
+    // The second word of the split sample is dropped, rather than taken as the first word of the next
+    TEST_ASSERT_EQUAL_MEMORY(&test_ref_decompr[resync_decompr_pos], &test_out[pre_len], test_out_len - pre_len);
+}
+
+TEST(dspbuf_bench, msbc_resync_mid_frame)
+{
+    // The decoder only has to find the next frame, its output is not bit exact until its filters have settled again
+    test_resync(COMPR_ENC_FORMAT_MSBC);
+}
+
+TEST(dspbuf_bench, ima_adpcm_resync_mid_block)
+{
+    uint32_t pre_len = test_resync(COMPR_ENC_FORMAT_IMA_ADPCM);
+    uint32_t resync_decompr_pos = test_resync_decompr_pos(COMPR_ENC_FORMAT_IMA_ADPCM,
+                                                          (TEST_RESYNC_READ_WORDS + TEST_RESYNC_LOST_WORDS) * 4);
+
+    // Each block starts from its own header, so the blocks after the resync decode exactly
+    TEST_ASSERT_EQUAL_MEMORY(&test_ref_decompr[resync_decompr_pos], &test_out[pre_len], test_out_len - pre_len);
+}
+
+TEST_GROUP_RUNNER(dspbuf_bench)
+{
+    RUN_TEST_CASE(dspbuf_bench, packed16_stream);
+    RUN_TEST_CASE(dspbuf_bench, msbc_stream);
+    RUN_TEST_CASE(dspbuf_bench, packed16_resync_mid_sample);
+    RUN_TEST_CASE(dspbuf_bench, msbc_resync_mid_frame);
+    RUN_TEST_CASE(dspbuf_bench, ima_adpcm_resync_mid_block);
+}
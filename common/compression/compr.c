@@ -0,0 +1,102 @@
+/**
+ * @file compr.c
+ *
+ * @brief Compression API module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stddef.h>
+#include "compr.h"
+#include "msbc.h"
+#include "packed16.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+uint32_t compr_init(compr_t *compr, compr_enc_format_t enc_format, endian_t input_endian, arena_t *arena)
+{
+    compr->input_endian = input_endian;
+    compr->enc_format = enc_format;
+
+    // Select the requested compressed stream encoding
+    switch (compr->enc_format)
+    {
+        case COMPR_ENC_FORMAT_PACKED16:
+            // The packed16 context is symmetric, the same byte order is used in both directions
+            compr->init = &packed16_init;
+            compr->compress = &packed16_compress;
+            compr->deinit = &packed16_deinit;
+            break;
+        case COMPR_ENC_FORMAT_MSBC:
+            compr->init = &msbc_enc_init;
+            compr->compress = &msbc_compress;
+            compr->deinit = &msbc_enc_deinit;
+            break;
+        default:
+            compr->compress = NULL;
+            return COMPR_STATUS_FAIL;
+    }
+
+    // Call the compression algorithms init to create a context
+    compr->context = compr->init(input_endian, arena);
+    if (compr->context == NULL)
+    {
+        return COMPR_STATUS_FAIL;
+    }
+    PERF_STATS_RESET(&compr->perf);
+
+    return COMPR_STATUS_OK;
+}
+
+uint32_t compr_data(compr_t *compr,
+                    data_ringbuf_t *compr_data_buf_ptr,
+                    data_ringbuf_t *pcm_data_buf_ptr,
+                    uint32_t *bytes_compressed)
+{
+    uint32_t ret;
+    PERF_STATS_START(start_ticks);
+
+    ret = compr->compress(compr->context, compr_data_buf_ptr, pcm_data_buf_ptr, bytes_compressed);
+    PERF_STATS_RECORD(&compr->perf, start_ticks, *bytes_compressed);
+
+    return ret;
+}
+
+void compr_deinit(compr_t *compr)
+{
+    compr->deinit(compr->context);
+    compr->context = NULL;
+    compr->init = NULL;
+    compr->compress = NULL;
+    compr->deinit = NULL;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file compr.h
+ *
+ * @brief Functions and prototypes exported by the compression API module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef COMPR_H
+#define COMPR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include "data_ringbuf.h"
+#include "decompr.h"
+#include "perf_stats.h"
+
+/***********************************************************************************************************************
+ * LITERALS & CONSTANTS
+ **********************************************************************************************************************/
+
+/**
+ * @defgroup COMPR_
+ * @brief Return values for compression API
+ *
+ * @{
+ */
+#define COMPR_STATUS_OK                      (0)
+#define COMPR_STATUS_FAIL                    (1)
+
+/***********************************************************************************************************************
+ * MACROS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+typedef struct
+{
+    compr_enc_format_t enc_format;
+    endian_t input_endian;
+    void *(*init)(endian_t input_endian, arena_t *arena);
+    uint32_t (*compress)(void *context,
+                         data_ringbuf_t *compr_data_buf_ptr,
+                         data_ringbuf_t *pcm_data_buf_ptr,
+                         uint32_t *bytes_compressed);
+    void (*deinit)(void *context);
+    void *context;
+#ifdef CONFIG_PERF_STATS
+    perf_stats_t perf;
+#endif
+} compr_t;
+
+/***********************************************************************************************************************
+ * GLOBAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Initialize the compression structure with a given encoding format
+ *
+ * Only COMPR_ENC_FORMAT_PACKED16 and COMPR_ENC_FORMAT_MSBC can be compressed.  The compressed data is in the same
+ * format as the DSP produces, i.e. it can be decompressed with decompr_data() or written to a DSP buffer with
+ * dspbuf_write().
+ *
+ * @param [in]
+ * - compr               Pointer to the compression state structure
+ * - enc_format          The encoding format to be used when compressing
+ * - input_endian        The endianness of the input PCM data
+ * - arena               Arena to allocate from, or NULL to use the heap (or the static pool)
+ *
+ * @return
+ * - COMPR_STATUS_FAIL           Failed to initialize the compression module
+ * - COMPR_STATUS_OK             otherwise
+ *
+ */
+uint32_t compr_init(compr_t *compr, compr_enc_format_t enc_format, endian_t input_endian, arena_t *arena);
+
+/**
+ * Compress data in the initialized format
+ *
+ * Only whole packed16 samples or mSBC frames are taken from \b pcm_data_buf_ptr, any remainder is left there for the
+ * next call.
+ *
+ * @param [in]
+ * - compr                Pointer to the compression state structure
+ * - compr_data_buf_ptr   Pointer to the data buffer to compress data to
+ * - pcm_data_buf_ptr     Pointer to the data buffer containing the PCM data
+ * - bytes_compressed     Pointer to store number of compressed bytes
+ *
+ * @return
+ * - COMPR_STATUS_FAIL           Failed to compress the given data
+ * - COMPR_STATUS_OK             otherwise
+ *
+ */
+uint32_t compr_data(compr_t *compr,
+                    data_ringbuf_t *compr_data_buf_ptr,
+                    data_ringbuf_t *pcm_data_buf_ptr,
+                    uint32_t *bytes_compressed);
+
+/**
+ * Deinitialize the compression structure, freeing all resources used
+ *
+ * @param [in]
+ * - compr               Pointer to the compression state structure
+ *
+ */
+void compr_deinit(compr_t *compr);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COMPR_H
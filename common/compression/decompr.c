@@ -24,9 +24,11 @@
  **********************************************************************************************************************/
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "debug.h"
 #include "decompr.h"
+#include "ima_adpcm.h"
 #include "msbc.h"
 #include "packed16.h"
 
@@ -42,11 +44,20 @@
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
 
+/**
+ * Realign a packed16 stream, which has no state beyond its samples
+ *
+ */
+static void decompr_packed16_realign(void *context, uint32_t stream_pos)
+{
+    packed16_realign(context, stream_pos);
+}
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
 
-uint32_t decompr_init(decompr_t *decompr, compr_enc_format_t enc_format, endian_t output_endian)
+uint32_t decompr_init(decompr_t *decompr, compr_enc_format_t enc_format, endian_t output_endian, arena_t *arena)
 {
     decompr->output_endian = output_endian;
     decompr->enc_format = enc_format;
@@ -57,16 +68,25 @@ uint32_t decompr_init(decompr_t *decompr, compr_enc_format_t enc_format, endian_
         case COMPR_ENC_FORMAT_PACKED16:
             decompr->init = &packed16_init;
             decompr->decompress = &packed16_decompress;
+            decompr->realign = &decompr_packed16_realign;
             decompr->deinit = &packed16_deinit;
             break;
         case COMPR_ENC_FORMAT_MSBC:
             decompr->init = &msbc_init;
             decompr->decompress = &msbc_decompress;
+            decompr->realign = &msbc_realign;
             decompr->deinit = &msbc_deinit;
             break;
+        case COMPR_ENC_FORMAT_IMA_ADPCM:
+            decompr->init = &ima_adpcm_init;
+            decompr->decompress = &ima_adpcm_decompress;
+            decompr->realign = &ima_adpcm_realign;
+            decompr->deinit = &ima_adpcm_deinit;
+            break;
         case COMPR_ENC_FORMAT_DEFAULT: // Do not change the buffer format (must be chosen for SCC lib v8.7.0 and older)
            decompr->init = &msbc_init;
            decompr->decompress = &msbc_decompress;
+           decompr->realign = &msbc_realign;
            decompr->deinit = &msbc_deinit;
             break;
         default:
@@ -74,12 +94,15 @@ uint32_t decompr_init(decompr_t *decompr, compr_enc_format_t enc_format, endian_
             return DECOMPR_STATUS_FAIL;
     }
 
-    // Call the decompression algorithms init to create a context
-    decompr->context = decompr->init(output_endian);
+    // Call the decompression algorithms init to create a context, noting which part of the arena it used
+    decompr->arena_ptr = (arena != NULL) ? (arena->base + arena->used) : NULL;
+    decompr->context = decompr->init(output_endian, arena);
     if (decompr->context == NULL)
     {
         return DECOMPR_STATUS_FAIL;
     }
+    decompr->arena_len = (arena != NULL) ? (uint32_t) ((arena->base + arena->used) - decompr->arena_ptr) : 0;
+    PERF_STATS_RESET(&decompr->perf);
 
     return DECOMPR_STATUS_OK;
 }
@@ -89,7 +112,41 @@ uint32_t decompr_data(decompr_t *decompr,
                       data_ringbuf_t *compr_data_buf_ptr,
                       uint32_t *bytes_decompressed)
 {
-    return decompr->decompress(decompr->context, decompr_data_buf_ptr, compr_data_buf_ptr, bytes_decompressed);
+    uint32_t ret;
+    PERF_STATS_START(start_ticks);
+
+    ret = decompr->decompress(decompr->context, decompr_data_buf_ptr, compr_data_buf_ptr, bytes_decompressed);
+    PERF_STATS_RECORD(&decompr->perf, start_ticks, *bytes_decompressed);
+
+    return ret;
+}
+
+uint32_t decompr_reset(decompr_t *decompr, uint32_t stream_pos)
+{
+    arena_t arena;
+
+    decompr->deinit(decompr->context);
+    decompr->context = NULL;
+
+    if (decompr->arena_ptr == NULL)
+    {
+        decompr->context = decompr->init(decompr->output_endian, NULL);
+    }
+    else
+    {
+        // The same format needs exactly the same allocations again, so they fit where the old ones were
+        arena_init(&arena, decompr->arena_ptr, decompr->arena_len);
+        decompr->context = decompr->init(decompr->output_endian, &arena);
+    }
+    if (decompr->context == NULL)
+    {
+        return DECOMPR_STATUS_FAIL;
+    }
+
+    // The data that follows starts wherever the dropped data ended, not on a frame or block boundary
+    decompr->realign(decompr->context, stream_pos);
+
+    return DECOMPR_STATUS_OK;
 }
 
 void decompr_deinit(decompr_t *decompr)
@@ -98,6 +155,40 @@ void decompr_deinit(decompr_t *decompr)
     decompr->context = NULL;
     decompr->init = NULL;
     decompr->decompress = NULL;
+    decompr->realign = NULL;
     decompr->deinit = NULL;
 }
 
+void *decompr_alloc_context(decompr_context_pool_t *pool, arena_t *arena)
+{
+    if (arena != NULL)
+    {
+        return arena_alloc(arena, pool->context_size);
+    }
+
+#ifdef DECOMPR_STATIC_CONTEXTS
+    for (uint32_t i = 0; i < DECOMPR_STATIC_CONTEXTS; i++)
+    {
+        if (!pool->used[i])
+        {
+            pool->used[i] = true;
+            return pool->contexts + (i * pool->context_size);
+        }
+    }
+
+    return NULL;
+#else
+    return malloc(pool->context_size);
+#endif
+}
+
+void decompr_free_context(decompr_context_pool_t *pool, void *context)
+{
+#ifdef DECOMPR_STATIC_CONTEXTS
+    pool->used[((uint8_t *) context - pool->contexts) / pool->context_size] = false;
+#else
+    (void) pool;
+    free(context);
+#endif
+}
+
@@ -30,7 +30,9 @@ extern "C" {
 /***********************************************************************************************************************
  * INCLUDES
  **********************************************************************************************************************/
+#include "arena.h"
 #include "data_ringbuf.h"
+#include "perf_stats.h"
 
 /***********************************************************************************************************************
  * LITERALS & CONSTANTS
@@ -45,10 +47,31 @@ extern "C" {
 #define DECOMPR_STATUS_OK                    (0)
 #define DECOMPR_STATUS_FAIL                  (1)
 
+/*
+ * If DECOMPR_STATIC_CONTEXTS is defined (i.e. in the makefile), each decompression format takes its contexts from a
+ * static pool of that many contexts rather than from the heap.  Either way, contexts are taken from an arena instead
+ * if one is passed to decompr_init() or compr_init().  An mSBC stream uses one mSBC and one packed16 context.
+ * The compression formats (see compr.h) have pools of the same size.
+ */
+
 /***********************************************************************************************************************
  * MACROS
  **********************************************************************************************************************/
 
+/**
+ * Define a pool of contexts of a type, for decompr_alloc_context() and decompr_free_context()
+ *
+ * Without DECOMPR_STATIC_CONTEXTS the pool only records the size, and contexts come from the heap.
+ */
+#ifdef DECOMPR_STATIC_CONTEXTS
+#define DECOMPR_CONTEXT_POOL(name, type) \
+    static type name##_contexts[DECOMPR_STATIC_CONTEXTS]; \
+    static decompr_context_pool_t name = {sizeof(type), (uint8_t *) name##_contexts, {false}}
+#else
+#define DECOMPR_CONTEXT_POOL(name, type) \
+    static decompr_context_pool_t name = {sizeof(type)}
+#endif
+
 /***********************************************************************************************************************
  * ENUMS, STRUCTS, UNIONS, TYPEDEFS
  **********************************************************************************************************************/
@@ -58,6 +81,7 @@ typedef enum
     COMPR_ENC_FORMAT_PACKED16,
     COMPR_ENC_FORMAT_MSBC,
     COMPR_ENC_FORMAT_UNSHORTEN,
+    COMPR_ENC_FORMAT_IMA_ADPCM,
     COMPR_ENC_FORMAT_DEFAULT // Do not change the buffer format (must be chosen for SCC lib v8.7.0 and older)
 } compr_enc_format_t;
 
@@ -71,12 +95,31 @@ typedef struct
 {
     compr_enc_format_t enc_format;
     endian_t output_endian;
-    void *(*init)(endian_t output_endian);
+    void *(*init)(endian_t output_endian, arena_t *arena);
     uint32_t (*decompress)(void *context, data_ringbuf_t *decompr_data_buf_ptr, data_ringbuf_t *compr_data_buf_ptr, uint32_t *bytes_decompressed);
+    void (*realign)(void *context, uint32_t stream_pos);
     void (*deinit)(void *context);
     void *context;
+    // Memory of the context within the arena, if allocated from one
+    uint8_t *arena_ptr;
+    uint32_t arena_len;
+#ifdef CONFIG_PERF_STATS
+    perf_stats_t perf;
+#endif
 } decompr_t;
 
+/**
+ * Contexts of one decompression or compression format, see DECOMPR_CONTEXT_POOL()
+ */
+typedef struct
+{
+    uint32_t context_size;
+#ifdef DECOMPR_STATIC_CONTEXTS
+    uint8_t *contexts;                          // DECOMPR_STATIC_CONTEXTS contexts of context_size bytes
+    bool used[DECOMPR_STATIC_CONTEXTS];
+#endif
+} decompr_context_pool_t;
+
 /***********************************************************************************************************************
  * GLOBAL VARIABLES
  **********************************************************************************************************************/
@@ -92,13 +135,14 @@ typedef struct
  * - decompr             Pointer to the decompression state structure
  * - enc_format          The encoding format to be used when decompressing
  * - output_endian       The endianness to use for the output data
+ * - arena               Arena to allocate from, or NULL to use the heap (or the static pool)
  *
  * @return
  * - DECOMPR_STATUS_FAIL         Failed to initialize the decompression module
  * - DECOMPR_STATUS_OK           otherwise
  *
  */
-uint32_t decompr_init(decompr_t *decompr, compr_enc_format_t enc_format, endian_t output_endian);
+uint32_t decompr_init(decompr_t *decompr, compr_enc_format_t enc_format, endian_t output_endian, arena_t *arena);
 
 /**
  * Decompress data in the initialized format
@@ -119,6 +163,25 @@ uint32_t decompr_data(decompr_t *decompr,
                       data_ringbuf_t *compr_data_buf_ptr,
                       uint32_t *bytes_decompressed);
 
+/**
+ * Reset the decompression structure to its initial state, i.e. after compressed data has been dropped
+ *
+ * A context that was allocated from an arena is reinitialized in the same memory, so resetting never uses more of
+ * the arena.  As the compressed data that follows can start part way through a frame or block, the format then drops
+ * data up to the next one it can decode: mSBC hunts for the next sync word, and IMA-ADPCM skips to the next block
+ * boundary counted from \b stream_pos.
+ *
+ * @param [in]
+ * - decompr             Pointer to the decompression state structure
+ * - stream_pos          Position in the compressed stream, in bytes, of the next compressed data
+ *
+ * @return
+ * - DECOMPR_STATUS_FAIL         Failed to reinitialize the decompression module
+ * - DECOMPR_STATUS_OK           otherwise
+ *
+ */
+uint32_t decompr_reset(decompr_t *decompr, uint32_t stream_pos);
+
 /**
  * Deinitialize the decompression structure, freeing all resources used
  *
@@ -128,6 +191,32 @@ uint32_t decompr_data(decompr_t *decompr,
  */
 void decompr_deinit(decompr_t *decompr);
 
+/**
+ * Allocate a context for a format
+ *
+ * Used by the format modules from their init functions.
+ *
+ * @param [in]
+ * - pool                Pool of contexts of the format
+ * - arena               Arena to allocate from, or NULL to take a context from the pool
+ *
+ * @return
+ * - void *              Pointer to the context
+ * - NULL                if there is no free context
+ *
+ */
+void *decompr_alloc_context(decompr_context_pool_t *pool, arena_t *arena);
+
+/**
+ * Free a context that was taken from a pool, i.e. allocated by decompr_alloc_context() without an arena
+ *
+ * @param [in]
+ * - pool                Pool of contexts of the format
+ * - context             Pointer to the context
+ *
+ */
+void decompr_free_context(decompr_context_pool_t *pool, void *context);
+
 /**********************************************************************************************************************/
 #ifdef __cplusplus
 }
@@ -0,0 +1,364 @@
+/**
+ * @file fmtconv.c
+ *
+ * @brief PCM format conversion module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include "debug.h"
+#include "fmtconv.h"
+#if defined(__ARM_FEATURE_SAT)
+#include <arm_acle.h>
+#endif
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define FMTCONV_IN_SAMPLE_BYTES     (2)
+#define FMTCONV_FRAME_BYTES_MAX     (FMTCONV_CHANNELS_MAX * 4)
+#define FMTCONV_GAIN_SHIFT          (12)
+
+// The word kernels move 16bit samples around within 32bit words, which relies on the first sample being in the low half
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define FMTCONV_WORDS
+#endif
+
+#if defined(__ARM_FEATURE_SAT)
+#define FMTCONV_SSAT(value, bits)   (__ssat((value), (bits)))
+#else
+#define FMTCONV_SSAT(value, bits)   (fmtconv_ssat((value), (bits)))
+#endif
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+#if !defined(__ARM_FEATURE_SAT)
+/**
+ * Saturate a signed value to a number of bits
+ *
+ */
+static inline int32_t fmtconv_ssat(int32_t value, uint32_t bits)
+{
+    int32_t max = (1 << (bits - 1)) - 1;
+
+    if (value > max)
+    {
+        return max;
+    }
+    else if (value < (-max - 1))
+    {
+        return -max - 1;
+    }
+
+    return value;
+}
+#endif
+
+/**
+ * Convert any format, one sample at a time
+ *
+ */
+static void fmtconv_kernel_samples(const fmtconv_t *conv, uint8_t *out_ptr, const uint8_t *in_ptr, uint32_t num_frames)
+{
+    const fmtconv_config_t *config = &conv->config;
+
+    for (; num_frames > 0; num_frames--)
+    {
+        for (uint32_t channel = 0; channel < config->out_channels; channel++)
+        {
+            // A mono input is copied to every output channel
+            const uint8_t *sample_ptr = in_ptr + ((channel % config->in_channels) * FMTCONV_IN_SAMPLE_BYTES);
+            int32_t sample;
+            uint32_t out;
+
+            if (config->in_endian == ENDIAN_LITTLE)
+            {
+                sample = (int16_t) (sample_ptr[0] | (sample_ptr[1] << 8));
+            }
+            else
+            {
+                sample = (int16_t) ((sample_ptr[0] << 8) | sample_ptr[1]);
+            }
+
+            // Apply the gain at 24bit resolution so that widened outputs keep the extra precision
+            sample *= config->gain;
+            if (config->out_sample_bytes == 2)
+            {
+                out = (uint32_t) FMTCONV_SSAT(sample >> FMTCONV_GAIN_SHIFT, 16);
+            }
+            else
+            {
+                out = (uint32_t) FMTCONV_SSAT(sample >> (FMTCONV_GAIN_SHIFT - 8), 24);
+                if (config->out_sample_bytes == 4)
+                {
+                    out <<= 8;
+                }
+            }
+
+            for (uint32_t index = 0; index < config->out_sample_bytes; index++)
+            {
+                uint32_t shift = (config->out_endian == ENDIAN_LITTLE) ? index : (config->out_sample_bytes - 1 - index);
+                out_ptr[index] = (uint8_t) (out >> (shift * 8));
+            }
+            out_ptr += config->out_sample_bytes;
+        }
+        in_ptr += conv->in_frame_bytes;
+    }
+}
+
+/**
+ * Copy 16bit samples without any conversion
+ *
+ */
+static void fmtconv_kernel_copy(const fmtconv_t *conv, uint8_t *out_ptr, const uint8_t *in_ptr, uint32_t num_frames)
+{
+    memcpy(out_ptr, in_ptr, num_frames * conv->in_frame_bytes);
+}
+
+#ifdef FMTCONV_WORDS
+/**
+ * Load a 32bit word from a possibly unaligned address
+ *
+ */
+static inline uint32_t fmtconv_load32(const uint8_t *ptr)
+{
+    uint32_t word;
+
+    memcpy(&word, ptr, sizeof(word));
+
+    return word;
+}
+
+/**
+ * Store a 32bit word to a possibly unaligned address
+ *
+ */
+static inline void fmtconv_store32(uint8_t *ptr, uint32_t word)
+{
+    memcpy(ptr, &word, sizeof(word));
+}
+
+/**
+ * Swap the bytes of both 16bit halves of a word, i.e. REV16
+ *
+ */
+static inline uint32_t fmtconv_rev16(uint32_t word)
+{
+    return ((word & 0x00FF00FF) << 8) | ((word & 0xFF00FF00) >> 8);
+}
+
+/**
+ * Swap the endianness of 16bit samples, two at a time
+ *
+ */
+static void fmtconv_kernel_swap16(const fmtconv_t *conv, uint8_t *out_ptr, const uint8_t *in_ptr, uint32_t num_frames)
+{
+    uint32_t num_samples = num_frames * conv->config.in_channels;
+
+    for (; num_samples >= 2; num_samples -= 2)
+    {
+        fmtconv_store32(out_ptr, fmtconv_rev16(fmtconv_load32(in_ptr)));
+        in_ptr += 4;
+        out_ptr += 4;
+    }
+
+    if (num_samples > 0)
+    {
+        out_ptr[0] = in_ptr[1];
+        out_ptr[1] = in_ptr[0];
+    }
+}
+
+/**
+ * Copy 16bit mono samples to both channels of a stereo output, two samples at a time
+ *
+ * The halfword packing compiles to PKHBT/PKHTB (and the swap to REV16) on cores with the DSP extension.
+ *
+ */
+static void fmtconv_kernel_dup16(const fmtconv_t *conv, uint8_t *out_ptr, const uint8_t *in_ptr, uint32_t num_frames)
+{
+    bool is_swap = (conv->config.in_endian != conv->config.out_endian);
+
+    for (; num_frames >= 2; num_frames -= 2)
+    {
+        uint32_t samples = fmtconv_load32(in_ptr);
+
+        if (is_swap)
+        {
+            samples = fmtconv_rev16(samples);
+        }
+        fmtconv_store32(out_ptr, (samples & 0x0000FFFF) | (samples << 16));
+        fmtconv_store32(out_ptr + 4, (samples & 0xFFFF0000) | (samples >> 16));
+        in_ptr += 4;
+        out_ptr += 8;
+    }
+
+    if (num_frames > 0)
+    {
+        fmtconv_kernel_samples(conv, out_ptr, in_ptr, num_frames);
+    }
+}
+#endif
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+uint32_t fmtconv_init(fmtconv_t *conv, const fmtconv_config_t *config)
+{
+    if ((config->in_channels < 1) || (config->in_channels > FMTCONV_CHANNELS_MAX)
+     || (config->out_channels < config->in_channels) || (config->out_channels > FMTCONV_CHANNELS_MAX)
+     || (config->out_sample_bytes < 2) || (config->out_sample_bytes > 4))
+    {
+        debug_printf("fmtconv_init: Unsupported format\n\r");
+        return FMTCONV_STATUS_FAIL;
+    }
+
+    conv->config = *config;
+    conv->in_frame_bytes = config->in_channels * FMTCONV_IN_SAMPLE_BYTES;
+    conv->out_frame_bytes = config->out_channels * config->out_sample_bytes;
+
+    // Pick the fastest kernel for the conversion, falling back to converting one sample at a time
+    conv->kernel = &fmtconv_kernel_samples;
+    if ((config->out_sample_bytes == 2) && (config->gain == FMTCONV_GAIN_UNITY))
+    {
+        if ((config->in_channels == config->out_channels) && (config->in_endian == config->out_endian))
+        {
+            conv->kernel = &fmtconv_kernel_copy;
+        }
+#ifdef FMTCONV_WORDS
+        else if (config->in_channels == config->out_channels)
+        {
+            conv->kernel = &fmtconv_kernel_swap16;
+        }
+        else
+        {
+            conv->kernel = &fmtconv_kernel_dup16;
+        }
+#endif
+    }
+    PERF_STATS_RESET(&conv->perf);
+
+    return FMTCONV_STATUS_OK;
+}
+
+uint32_t fmtconv_data_iov(fmtconv_t *conv,
+                          data_ringbuf_iov_t out_iov[DATA_RINGBUF_IOV_MAX],
+                          data_ringbuf_t *in_data_buf_ptr,
+                          uint32_t *bytes_converted)
+{
+    data_ringbuf_iov_t in_iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t num_frames;
+    uint32_t max_out_frames;
+    uint32_t in_offset = 0;
+    uint32_t out_offset = 0;
+    PERF_STATS_START(start_ticks);
+
+    *bytes_converted = 0;
+
+    // Convert everything there is data and space for in a single pass, writing in place into the output segments
+    num_frames = data_ringbuf_get_read_iov(in_data_buf_ptr, in_iov) / conv->in_frame_bytes;
+    max_out_frames = (out_iov[0].len + out_iov[1].len) / conv->out_frame_bytes;
+    if (num_frames > max_out_frames)
+    {
+        num_frames = max_out_frames;
+    }
+
+    while (num_frames > 0)
+    {
+        uint8_t framebuf_in[FMTCONV_FRAME_BYTES_MAX];
+        uint8_t framebuf_out[FMTCONV_FRAME_BYTES_MAX];
+        uint8_t *in_ptr;
+        uint8_t *out_ptr;
+        uint32_t run;
+
+        // Convert as many frames as are contiguous in both buffers in one go
+        run = data_ringbuf_iov_contig(in_iov, in_offset, conv->in_frame_bytes);
+        if (run > data_ringbuf_iov_contig(out_iov, out_offset, conv->out_frame_bytes))
+        {
+            run = data_ringbuf_iov_contig(out_iov, out_offset, conv->out_frame_bytes);
+        }
+        if (run > num_frames)
+        {
+            run = num_frames;
+        }
+
+        if (run > 0)
+        {
+            in_ptr = data_ringbuf_iov_ptr(in_iov, in_offset, run * conv->in_frame_bytes, NULL, false);
+            out_ptr = data_ringbuf_iov_ptr(out_iov, out_offset, run * conv->out_frame_bytes, NULL, false);
+            conv->kernel(conv, out_ptr, in_ptr, run);
+        }
+        else
+        {
+            // This frame straddles the end of a segment in one of the buffers
+            run = 1;
+            in_ptr = data_ringbuf_iov_ptr(in_iov, in_offset, conv->in_frame_bytes, framebuf_in, true);
+            out_ptr = data_ringbuf_iov_ptr(out_iov, out_offset, conv->out_frame_bytes, framebuf_out, false);
+            conv->kernel(conv, out_ptr, in_ptr, 1);
+            if (out_ptr == framebuf_out)
+            {
+                data_ringbuf_iov_scatter(out_iov, out_offset, conv->out_frame_bytes, framebuf_out);
+            }
+        }
+
+        in_offset += run * conv->in_frame_bytes;
+        out_offset += run * conv->out_frame_bytes;
+        num_frames -= run;
+    }
+
+    if (data_ringbuf_commit_read_iov(in_data_buf_ptr, in_offset) != DATA_RINGBUF_STATUS_OK)
+    {
+        debug_printf("fmtconv_data_iov: Failed to commit converted data\n\r");
+        return FMTCONV_STATUS_FAIL;
+    }
+    *bytes_converted = out_offset;
+    PERF_STATS_RECORD(&conv->perf, start_ticks, out_offset);
+
+    return FMTCONV_STATUS_OK;
+}
+
+uint32_t fmtconv_data(fmtconv_t *conv,
+                      data_ringbuf_t *out_data_buf_ptr,
+                      data_ringbuf_t *in_data_buf_ptr,
+                      uint32_t *bytes_converted)
+{
+    data_ringbuf_iov_t out_iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t ret;
+
+    data_ringbuf_get_write_iov(out_data_buf_ptr, out_iov);
+    ret = fmtconv_data_iov(conv, out_iov, in_data_buf_ptr, bytes_converted);
+    if ((ret == FMTCONV_STATUS_OK)
+     && (data_ringbuf_commit_write_iov(out_data_buf_ptr, *bytes_converted) != DATA_RINGBUF_STATUS_OK))
+    {
+        debug_printf("fmtconv_data: Failed to commit converted data\n\r");
+        *bytes_converted = 0;
+        ret = FMTCONV_STATUS_FAIL;
+    }
+
+    return ret;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file fmtconv.h
+ *
+ * @brief Functions and prototypes exported by the PCM format conversion module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef FMTCONV_H
+#define FMTCONV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+#include "data_ringbuf.h"
+#include "decompr.h"
+#include "perf_stats.h"
+
+/***********************************************************************************************************************
+ * LITERALS & CONSTANTS
+ **********************************************************************************************************************/
+
+/**
+ * @defgroup FMTCONV_
+ * @brief Return values for format conversion API
+ *
+ * @{
+ */
+#define FMTCONV_STATUS_OK                    (0)
+#define FMTCONV_STATUS_FAIL                  (1)
+
+#define FMTCONV_GAIN_UNITY                   (0x1000) // Gain is Q3.12, i.e. at most 8x (+18dB)
+#define FMTCONV_CHANNELS_MAX                 (2)
+
+/***********************************************************************************************************************
+ * MACROS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * Configuration of a format conversion stage
+ *
+ * The input is always 16bit PCM, i.e. as produced by decompr_data().
+ */
+typedef struct
+{
+    uint8_t in_channels;                            // 1 or 2
+    uint8_t out_channels;                           // 1 or 2, a mono input is copied to both output channels
+    uint8_t out_sample_bytes;                       // 2, 3 or 4 - 4 is 24bit data left-justified in 32bits
+    endian_t in_endian;
+    endian_t out_endian;
+    int16_t gain;                                   // Q3.12, FMTCONV_GAIN_UNITY for no gain
+} fmtconv_config_t;
+
+typedef struct fmtconv_s
+{
+    fmtconv_config_t config;
+    uint32_t in_frame_bytes;
+    uint32_t out_frame_bytes;
+    // Convert a number of frames that are contiguous in both buffers
+    void (*kernel)(const struct fmtconv_s *conv, uint8_t *out_ptr, const uint8_t *in_ptr, uint32_t num_frames);
+#ifdef CONFIG_PERF_STATS
+    perf_stats_t perf;
+#endif
+} fmtconv_t;
+
+/***********************************************************************************************************************
+ * GLOBAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Initialize a format conversion stage
+ *
+ * @param [in]
+ * - conv                Pointer to the format conversion state structure
+ * - config              Pointer to the configuration
+ *
+ * @return
+ * - FMTCONV_STATUS_FAIL         if the configuration is not supported
+ * - FMTCONV_STATUS_OK           otherwise
+ *
+ */
+uint32_t fmtconv_init(fmtconv_t *conv, const fmtconv_config_t *config);
+
+/**
+ * Convert PCM data from one data buffer into another
+ *
+ * Converts as many whole frames as there is data for in \b in_data_buf_ptr and space for in \b out_data_buf_ptr.
+ * The converted data is written in place into the output buffer, so this is suitable for filling an I2S DMA buffer
+ * from its callback.
+ *
+ * @param [in]
+ * - conv                 Pointer to the format conversion state structure
+ * - out_data_buf_ptr     Pointer to the data buffer to write converted data to
+ * - in_data_buf_ptr      Pointer to the data buffer containing the 16bit PCM data
+ *
+ * @param [out]
+ * - bytes_converted      Pointer to the length of data added to the out_data_buf_ptr
+ *
+ * @return
+ * - FMTCONV_STATUS_FAIL         Failed to commit the converted data
+ * - FMTCONV_STATUS_OK           otherwise
+ *
+ */
+uint32_t fmtconv_data(fmtconv_t *conv,
+                      data_ringbuf_t *out_data_buf_ptr,
+                      data_ringbuf_t *in_data_buf_ptr,
+                      uint32_t *bytes_converted);
+
+/**
+ * Convert PCM data from a data buffer into free space described by a write iov
+ *
+ * As fmtconv_data(), but the output is any buffer that can describe its free space as DATA_RINGBUF_IOV_MAX segments,
+ * e.g. from data_ringbuf_tee_get_write_iov().  The input data used is removed from \b in_data_buf_ptr, but the
+ * caller must commit the converted data to the output buffer.
+ *
+ * @param [in]
+ * - conv                 Pointer to the format conversion state structure
+ * - out_iov              Segments describing the free space to write converted data to
+ * - in_data_buf_ptr      Pointer to the data buffer containing the 16bit PCM data
+ *
+ * @param [out]
+ * - bytes_converted      Pointer to the length of data written to the out_iov segments
+ *
+ * @return
+ * - FMTCONV_STATUS_FAIL         Failed to commit the input data used
+ * - FMTCONV_STATUS_OK           otherwise
+ *
+ */
+uint32_t fmtconv_data_iov(fmtconv_t *conv,
+                          data_ringbuf_iov_t out_iov[DATA_RINGBUF_IOV_MAX],
+                          data_ringbuf_t *in_data_buf_ptr,
+                          uint32_t *bytes_converted);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMTCONV_H
@@ -0,0 +1,307 @@
+/**
+ * @file ima_adpcm.c
+ *
+ * @brief IMA-ADPCM decompression module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <string.h>
+#include "debug.h"
+#include "ima_adpcm.h"
+#include "packed16.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define IMA_ADPCM_DECODED_BLOCK_SIZE    (IMA_ADPCM_SAMPLES_PER_BLOCK * sizeof(int16_t))
+// Whole packed16 samples are unpacked into the block, so it may hold up to one sample beyond the end of a block
+#define IMA_ADPCM_BLOCK_BUF_SIZE        (IMA_ADPCM_BLOCK_SIZE + PACKED16_DECOMPR_SAMPLE_BYTES - 1)
+#define IMA_ADPCM_MAX_STEP_INDEX        (88)
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+typedef struct
+{
+    endian_t endian;
+    void *packed16;
+    uint32_t block_len;                             // Bytes of the next block received so far
+    uint32_t skip_len;                              // Bytes to drop to get back to the start of a block
+    uint8_t block[IMA_ADPCM_BLOCK_BUF_SIZE];
+    // Only used if there is no contiguous space in the decompressed buffer, otherwise blocks are decoded in place
+    uint8_t decoded_block[IMA_ADPCM_DECODED_BLOCK_SIZE];
+    bool is_arena;                                  // Freed by arena_reset() rather than on deinit
+} ima_adpcm_t;
+
+DECOMPR_CONTEXT_POOL(ima_adpcm_pool, ima_adpcm_t);
+
+static const int16_t ima_adpcm_step_table[IMA_ADPCM_MAX_STEP_INDEX + 1] =
+{
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t ima_adpcm_index_table[8] =
+{
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Free a context structure
+ *
+ */
+static void ima_adpcm_deinit_context(ima_adpcm_t *ima_adpcm)
+{
+    if (!ima_adpcm->is_arena)
+    {
+        decompr_free_context(&ima_adpcm_pool, ima_adpcm);
+    }
+}
+
+/**
+ * Decode one 4bit code, updating the predictor and step index
+ *
+ */
+static inline int32_t ima_adpcm_decode_nibble(uint8_t code, int32_t *predictor, int32_t *step_index)
+{
+    int32_t step = ima_adpcm_step_table[*step_index];
+    int32_t diff = step >> 3;
+
+    if (code & 0x4)
+    {
+        diff += step;
+    }
+    if (code & 0x2)
+    {
+        diff += step >> 1;
+    }
+    if (code & 0x1)
+    {
+        diff += step >> 2;
+    }
+
+    *predictor += (code & 0x8) ? -diff : diff;
+    if (*predictor > INT16_MAX)
+    {
+        *predictor = INT16_MAX;
+    }
+    else if (*predictor < INT16_MIN)
+    {
+        *predictor = INT16_MIN;
+    }
+
+    *step_index += ima_adpcm_index_table[code & 0x7];
+    if (*step_index < 0)
+    {
+        *step_index = 0;
+    }
+    else if (*step_index > IMA_ADPCM_MAX_STEP_INDEX)
+    {
+        *step_index = IMA_ADPCM_MAX_STEP_INDEX;
+    }
+
+    return *predictor;
+}
+
+/**
+ * Store a 16bit sample in the output endianness
+ *
+ */
+static inline void ima_adpcm_store(uint8_t *dest_ptr, int32_t sample, endian_t endian)
+{
+    if (endian == ENDIAN_LITTLE)
+    {
+        dest_ptr[0] = (uint8_t) sample;
+        dest_ptr[1] = (uint8_t) (sample >> 8);
+    }
+    else
+    {
+        dest_ptr[0] = (uint8_t) (sample >> 8);
+        dest_ptr[1] = (uint8_t) sample;
+    }
+}
+
+/**
+ * Decode one block
+ *
+ */
+static bool ima_adpcm_decode_block(ima_adpcm_t *ima_adpcm, uint8_t *dest_ptr)
+{
+    const uint8_t *code_ptr = &ima_adpcm->block[IMA_ADPCM_BLOCK_HEADER_SIZE];
+    int32_t predictor = (int16_t) (ima_adpcm->block[0] | (ima_adpcm->block[1] << 8));
+    int32_t step_index = ima_adpcm->block[2];
+
+    if ((step_index > IMA_ADPCM_MAX_STEP_INDEX) || (ima_adpcm->block[3] != 0))
+    {
+        return false;
+    }
+
+    ima_adpcm_store(dest_ptr, predictor, ima_adpcm->endian);
+    dest_ptr += sizeof(int16_t);
+
+    for (uint32_t i = 0; i < (IMA_ADPCM_BLOCK_SIZE - IMA_ADPCM_BLOCK_HEADER_SIZE); i++)
+    {
+        uint8_t codes = code_ptr[i];
+
+        ima_adpcm_store(dest_ptr, ima_adpcm_decode_nibble(codes & 0xF, &predictor, &step_index), ima_adpcm->endian);
+        ima_adpcm_store(dest_ptr + sizeof(int16_t),
+                        ima_adpcm_decode_nibble(codes >> 4, &predictor, &step_index),
+                        ima_adpcm->endian);
+        dest_ptr += 2 * sizeof(int16_t);
+    }
+
+    return true;
+}
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+void *ima_adpcm_init(endian_t output_endian, arena_t *arena)
+{
+    ima_adpcm_t *ima_adpcm;
+
+    // Create a context structure, from the arena if one is given
+    ima_adpcm = decompr_alloc_context(&ima_adpcm_pool, arena);
+    if (ima_adpcm == NULL)
+    {
+        return NULL;
+    }
+    ima_adpcm->is_arena = (arena != NULL);
+
+    ima_adpcm->endian = output_endian;
+    ima_adpcm->block_len = 0;
+    ima_adpcm->skip_len = 0;
+
+    // The blocks are carried as a stream of little-endian packed16 bytes
+    ima_adpcm->packed16 = packed16_init(ENDIAN_LITTLE, arena);
+    if (ima_adpcm->packed16 == NULL)
+    {
+        ima_adpcm_deinit_context(ima_adpcm);
+        return NULL;
+    }
+
+    return ima_adpcm;
+}
+
+uint32_t ima_adpcm_decompress(void *context,
+                              data_ringbuf_t *decompr_data_buf_ptr,
+                              data_ringbuf_t *compr_data_buf_ptr,
+                              uint32_t *bytes_decompressed)
+{
+    ima_adpcm_t *ima_adpcm = (ima_adpcm_t *)context;
+    *bytes_decompressed = 0;
+
+    // There needs to be space for the decoded block before anything more is taken from the compressed buffer
+    while (data_ringbuf_free_space(decompr_data_buf_ptr) >= IMA_ADPCM_DECODED_BLOCK_SIZE)
+    {
+        uint8_t *decoded_block_ptr;
+        bool is_decoded_block_in_place;
+
+        // Unpack straight into the block, as far as the end of this block
+        if (ima_adpcm->block_len < IMA_ADPCM_BLOCK_SIZE)
+        {
+            ima_adpcm->block_len += packed16_unpack_ringbuf(ima_adpcm->packed16,
+                                                            compr_data_buf_ptr,
+                                                            &ima_adpcm->block[ima_adpcm->block_len],
+                                                            IMA_ADPCM_BLOCK_SIZE - ima_adpcm->block_len);
+        }
+
+        // Drop the rest of any block that the data started part way through, i.e. after a resync
+        if (ima_adpcm->skip_len > 0)
+        {
+            uint32_t skip_len = (ima_adpcm->skip_len < ima_adpcm->block_len) ? ima_adpcm->skip_len
+                                                                              : ima_adpcm->block_len;
+
+            if (skip_len == 0)
+            {
+                break;
+            }
+            ima_adpcm->skip_len -= skip_len;
+            ima_adpcm->block_len -= skip_len;
+            memmove(ima_adpcm->block, &ima_adpcm->block[skip_len], ima_adpcm->block_len);
+            continue;
+        }
+        if (ima_adpcm->block_len < IMA_ADPCM_BLOCK_SIZE)
+        {
+            break;
+        }
+
+        // Decode straight into the decompressed buffer if there is a contiguous area for it
+        is_decoded_block_in_place = (data_ringbuf_reserve_contiguous(decompr_data_buf_ptr,
+                                                                     IMA_ADPCM_DECODED_BLOCK_SIZE,
+                                                                     &decoded_block_ptr) == DATA_RINGBUF_STATUS_OK);
+        if (!is_decoded_block_in_place)
+        {
+            decoded_block_ptr = ima_adpcm->decoded_block;
+        }
+
+        if (!ima_adpcm_decode_block(ima_adpcm, decoded_block_ptr))
+        {
+            debug_printf("ima_adpcm_decompress: Invalid block header - discard block and continue\n\r");
+        }
+        else if (is_decoded_block_in_place)
+        {
+            data_ringbuf_bytes_written(decompr_data_buf_ptr, IMA_ADPCM_DECODED_BLOCK_SIZE);
+            *bytes_decompressed += IMA_ADPCM_DECODED_BLOCK_SIZE;
+        }
+        else
+        {
+            if (data_ringbuf_write(decompr_data_buf_ptr, ima_adpcm->decoded_block, IMA_ADPCM_DECODED_BLOCK_SIZE)
+                != DATA_RINGBUF_STATUS_OK)
+            {
+                debug_printf("ima_adpcm_decompress: Failed to write decoded block to decompressed buffer\n\r");
+                return DECOMPR_STATUS_FAIL;
+            }
+            *bytes_decompressed += IMA_ADPCM_DECODED_BLOCK_SIZE;
+        }
+
+        // Keep any bytes of the next block that were unpacked along with this one
+        ima_adpcm->block_len -= IMA_ADPCM_BLOCK_SIZE;
+        memmove(ima_adpcm->block, &ima_adpcm->block[IMA_ADPCM_BLOCK_SIZE], ima_adpcm->block_len);
+    }
+
+    return DECOMPR_STATUS_OK;
+}
+
+void ima_adpcm_realign(void *context, uint32_t stream_pos)
+{
+    ima_adpcm_t *ima_adpcm = (ima_adpcm_t *)context;
+    uint32_t pos = packed16_realign(ima_adpcm->packed16, stream_pos);
+
+    // Blocks have no sync word, but every block is the same size, so the next one starts on a block boundary
+    ima_adpcm->block_len = 0;
+    ima_adpcm->skip_len = (IMA_ADPCM_BLOCK_SIZE - (pos % IMA_ADPCM_BLOCK_SIZE)) % IMA_ADPCM_BLOCK_SIZE;
+}
+
+void ima_adpcm_deinit(void *context)
+{
+    ima_adpcm_t *ima_adpcm = (ima_adpcm_t *)context;
+    packed16_deinit(ima_adpcm->packed16);
+    ima_adpcm_deinit_context(ima_adpcm);
+}
+
@@ -0,0 +1,127 @@
+/**
+ * @file ima_adpcm.h
+ *
+ * @brief Functions and prototypes for IMA-ADPCM decompression module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IMA_ADPCM_H
+#define IMA_ADPCM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include "decompr.h"
+
+/***********************************************************************************************************************
+ * LITERALS & CONSTANTS
+ **********************************************************************************************************************/
+/**
+ * Mono IMA-ADPCM blocks as in WAV files: a 4 byte header holding the first sample (16bit, little-endian) and the step
+ * index, followed by 4bit codes for the remaining samples, low nibble first.  The blocks are carried in packed16
+ * format.
+ */
+#define IMA_ADPCM_BLOCK_SIZE                (256)
+#define IMA_ADPCM_BLOCK_HEADER_SIZE         (4)
+#define IMA_ADPCM_SAMPLES_PER_BLOCK         (((IMA_ADPCM_BLOCK_SIZE - IMA_ADPCM_BLOCK_HEADER_SIZE) * 2) + 1)
+
+/***********************************************************************************************************************
+ * MACROS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * GLOBAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Allocate and initialize an IMA-ADPCM decompression structure with a given output endian format
+ *
+ * @param [in]
+ * - output_endian       The endianness to use for the output data
+ * - arena               Arena to allocate from, or NULL to use the heap (or the static pool)
+ *
+ * @return
+ * - void *              An IMA-ADPCM context structure
+ * - NULL                Failed to allocation and initialize an IMA-ADPCM decompression structure
+ *
+ */
+void *ima_adpcm_init(endian_t output_endian, arena_t *arena);
+
+/**
+ * Decompress data in IMA-ADPCM format
+ *
+ * Whole blocks are decoded as soon as they have been received and there is space for them.  A block with an invalid
+ * header is discarded.
+ *
+ * @param [in]
+ * - context              Pointer to the IMA-ADPCM decompression state structure
+ * - decompr_data_buf_ptr Pointer to the data buffer to decompress data to
+ * - compr_data_buf_ptr   Pointer to the data buffer containing the compressed data
+ *
+ * @param [out]
+ * - bytes_decompressed   Pointer to the length of data added to the decompr_data_buf_ptr
+ *
+ * @return
+ * - DECOMPR_STATUS_FAIL         Failed to decompress the given data
+ * - DECOMPR_STATUS_OK           otherwise
+ *
+ */
+uint32_t ima_adpcm_decompress(void *context,
+                              data_ringbuf_t *decompr_data_buf_ptr,
+                              data_ringbuf_t *compr_data_buf_ptr,
+                              uint32_t *bytes_decompressed);
+
+/**
+ * Get back in step with the IMA-ADPCM stream after compressed data has been dropped
+ *
+ * Decoding resumes from the next block boundary, counting from the start of the stream.
+ *
+ * @param [in]
+ * - context              Pointer to the IMA-ADPCM decompression state structure
+ * - stream_pos           Position in the compressed stream, in bytes, of the next compressed data
+ *
+ */
+void ima_adpcm_realign(void *context, uint32_t stream_pos);
+
+/**
+ * Deinitialize and free the IMA-ADPCM decompression structure, freeing all resources used
+ *
+ * @param [in]
+ * - context              Pointer to the IMA-ADPCM decompression state structure
+ *
+ */
+void ima_adpcm_deinit(void *context);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMA_ADPCM_H
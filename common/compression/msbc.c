@@ -1,7 +1,7 @@
 /**
  * @file msbc.c
  *
- * @brief mSBC decompression module
+ * @brief mSBC compression and decompression module
  *
  * @copyright
  * Copyright (c) Cirrus Logic 2023 All Rights Reserved, http://www.cirrus.com/
@@ -22,16 +22,22 @@
 /***********************************************************************************************************************
  * INCLUDES
  **********************************************************************************************************************/
-#include <stdlib.h>
+#include <string.h>
 #include "debug.h"
+#include "compr.h"
 #include "msbc.h"
+#include "packed16.h"
 #include "sbc.h"
-#include "platform_bsp.h"
 
 /***********************************************************************************************************************
  * LOCAL LITERAL SUBSTITUTIONS
  **********************************************************************************************************************/
-#define MSBC_BUF_SIZE   (2048LU)
+// mSBC is fixed at 15 blocks of 8 subbands, mono, bitpool 26
+#define MSBC_FRAMELEN_MAX               (57)
+#define MSBC_SYNCWORD                   (0xAD)
+#define MSBC_DECODED_FRAMELEN_MAX       (15 * 8 * sizeof(int16_t))
+// Whole packed16 samples are unpacked into the frame, so it may hold up to one sample beyond the end of a frame
+#define MSBC_FRAME_BUF_SIZE             (MSBC_FRAMELEN_MAX + PACKED16_DECOMPR_SAMPLE_BYTES - 1)
 
 /***********************************************************************************************************************
  * LOCAL VARIABLES
@@ -39,121 +45,131 @@
 typedef struct
 {
     sbc_t sbc;
-    data_ringbuf_t packed16_data_buf;
-    uint8_t *packed16_buf;
-    uint8_t *frame;
-    uint8_t *decoded_frame;
-    int32_t framelen;
+    void *packed16;
+    int32_t framelen;                               // 0 until the first frame has been decoded
     size_t decoded_framelen;
-    decompr_t decompr;
+    uint32_t frame_len;                             // Bytes of the next frame assembled so far
+    uint8_t frame[MSBC_FRAME_BUF_SIZE];
+    // Only used if there is no contiguous space in the decompressed buffer, otherwise frames are decoded in place
+    uint8_t decoded_frame[MSBC_DECODED_FRAMELEN_MAX];
+    bool is_arena;                                  // Freed by arena_reset() rather than on deinit
 } msbc_t;
 
+typedef struct
+{
+    sbc_t sbc;
+    void *packed16;
+    uint32_t frame_len;                             // Bytes of encoded frames not yet packed
+    uint8_t frame[MSBC_FRAME_BUF_SIZE];
+    // Only used if a PCM frame is not contiguous in the PCM buffer, otherwise frames are encoded in place
+    uint8_t pcm_frame[MSBC_DECODED_FRAMELEN_MAX];
+    bool is_arena;                                  // Freed by arena_reset() rather than on deinit
+} msbc_enc_t;
+
+DECOMPR_CONTEXT_POOL(msbc_pool, msbc_t);
+DECOMPR_CONTEXT_POOL(msbc_enc_pool, msbc_enc_t);
+
 /***********************************************************************************************************************
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
 
-static uint32_t msbc_configure(msbc_t *msbc, data_ringbuf_t *compr_data_buf_ptr)
+/**
+ * Free a context structure
+ *
+ */
+static void msbc_deinit_context(msbc_t *msbc)
 {
-    uint8_t temp_buf[1024];
-    uint32_t p16_bytes;
-    uint8_t *next_read_ptr;
-    uint32_t next_read_len;
-
-    // Get some data in the packed16_data_buf ready to decode
-    if (decompr_data(&msbc->decompr, &msbc->packed16_data_buf, compr_data_buf_ptr, &p16_bytes) != DECOMPR_STATUS_OK)
+    if (!msbc->is_arena)
     {
-        debug_printf("Failed to decompress compr_data_buf_ptr->packed16_data_buf\n\r");
-        return DECOMPR_STATUS_FAIL;
+        decompr_free_context(&msbc_pool, msbc);
     }
+}
 
-    // Find the next read block in the packed16_data_buf as sbc_decode works with raw pointers
-    data_ringbuf_next_read_block(&msbc->packed16_data_buf, &next_read_ptr, &next_read_len);
-
-    // Temporarily point decoded_frame at the temp_buf until it is known how big decoded_frame needs to be
-    if (msbc->decoded_frame != NULL)
-    {
-        free(msbc->decoded_frame);
-    }
-    msbc->decoded_frame = temp_buf;
-
-    // Decode the 1st frame to get the framelen
-    msbc->framelen = sbc_decode(&msbc->sbc,
-                                next_read_ptr,
-                                next_read_len,
-                                msbc->decoded_frame,
-                                sizeof(temp_buf),
-                                &msbc->decoded_framelen);
-    // Don't need the data now so set decoded_frame to NULL in case a later step fails
-    msbc->decoded_frame = NULL;
-
-    // Allocate frame and decoded_frame buffers of the correct size
-    if (msbc->framelen > 0)
+/**
+ * Free an encoder context structure
+ *
+ */
+static void msbc_enc_deinit_context(msbc_enc_t *msbc_enc)
+{
+    if (!msbc_enc->is_arena)
     {
-        // Allocate a frame buffer of the exact required size
-        msbc->frame = malloc(msbc->framelen);
-        if (msbc->frame == NULL)
-        {
-            debug_printf("Couldn't allocate frame\n\r");
-            return DECOMPR_STATUS_FAIL;
-        }
-        // Allocate a decoded_frame buffer of the exact required size
-        msbc->decoded_frame = malloc(msbc->decoded_framelen);
-        if (msbc->decoded_frame == NULL)
-        {
-            debug_printf("Couldn't allocate decoded_frame\n\r");
-            return DECOMPR_STATUS_FAIL;
-        }
+        decompr_free_context(&msbc_enc_pool, msbc_enc);
     }
-    else
+}
+
+/**
+ * Drop bytes from the start of the frame until it starts with a sync word
+ *
+ * @return                true if the frame already started with a sync word, or is empty
+ *
+ */
+static bool msbc_hunt_sync(msbc_t *msbc)
+{
+    uint8_t *sync_ptr;
+    uint32_t skip_len;
+
+    if ((msbc->frame_len == 0) || (msbc->frame[0] == MSBC_SYNCWORD))
     {
-        debug_printf("Initial framelen=%ld\n\r", msbc->framelen);
-        return DECOMPR_STATUS_FAIL;
+        return true;
     }
-    return DECOMPR_STATUS_OK;
+
+    sync_ptr = memchr(&msbc->frame[1], MSBC_SYNCWORD, msbc->frame_len - 1);
+    skip_len = (sync_ptr != NULL) ? (uint32_t) (sync_ptr - msbc->frame) : msbc->frame_len;
+    msbc->frame_len -= skip_len;
+    memmove(msbc->frame, &msbc->frame[skip_len], msbc->frame_len);
+
+    return false;
+}
+
+/**
+ * Pack as much of the encoded frame data as there is space for, keeping any partial packed16 sample
+ *
+ */
+static uint32_t msbc_enc_pack(msbc_enc_t *msbc_enc, data_ringbuf_t *compr_data_buf_ptr)
+{
+    uint32_t packed_len = packed16_pack_ringbuf(msbc_enc->packed16,
+                                                compr_data_buf_ptr,
+                                                msbc_enc->frame,
+                                                msbc_enc->frame_len);
+
+    msbc_enc->frame_len -= packed_len;
+    memmove(msbc_enc->frame, &msbc_enc->frame[packed_len], msbc_enc->frame_len);
+
+    return (packed_len / PACKED16_DECOMPR_SAMPLE_BYTES) * PACKED16_COMPR_SAMPLE_BYTES;
 }
 
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
 
-void *msbc_init(endian_t output_endian)
+void *msbc_init(endian_t output_endian, arena_t *arena)
 {
     msbc_t *msbc;
 
-    // Create a context structure and set it all to 0s
-    msbc = malloc(sizeof(msbc_t));
+    // Create a context structure, from the arena if one is given
+    msbc = decompr_alloc_context(&msbc_pool, arena);
     if (msbc == NULL)
     {
         return NULL;
     }
+    msbc->is_arena = (arena != NULL);
 
-    msbc->frame = NULL;
-    msbc->decoded_frame = NULL;
     msbc->framelen = 0;
     msbc->decoded_framelen = 0;
+    msbc->frame_len = 0;
 
-    // Initialize the packed16 decode
-    decompr_init(&msbc->decompr, COMPR_ENC_FORMAT_PACKED16, ENDIAN_LITTLE);
+    // The SBC frames are carried as a stream of little-endian packed16 bytes
+    msbc->packed16 = packed16_init(ENDIAN_LITTLE, arena);
+    if (msbc->packed16 == NULL)
+    {
+        msbc_deinit_context(msbc);
+        return NULL;
+    }
 
     // Init the sbc lib
     sbc_init_msbc(&msbc->sbc, 0L);
     msbc->sbc.endian = (output_endian == ENDIAN_LITTLE) ? SBC_LE : SBC_BE;
 
-    // Init the packed16_data_buf which will hold the data after it has been unpacked
-    msbc->packed16_buf = malloc(MSBC_BUF_SIZE);
-
-    if (msbc->packed16_buf != NULL)
-    {
-        data_ringbuf_init(&msbc->packed16_data_buf, msbc->packed16_buf, MSBC_BUF_SIZE);
-    }
-    else
-    {
-        sbc_finish(&msbc->sbc);
-        decompr_deinit(&msbc->decompr);
-        free(msbc);
-        msbc = NULL;
-    }
-
     return msbc;
 }
 
@@ -163,103 +179,204 @@ uint32_t msbc_decompress(void *context,
                          uint32_t *bytes_decompressed)
 {
     msbc_t *msbc = (msbc_t *)context;
-    bool data_to_decode;
     *bytes_decompressed = 0;
 
-    // If this is the 1st time decompress has been called, then init the msbc stream
-    if (msbc->frame == NULL)
+    while (true)
     {
-        if (msbc_configure(msbc, compr_data_buf_ptr) != DECOMPR_STATUS_OK)
+        // Until the first frame has been decoded its length is not known, so assume the longest possible
+        uint32_t frame_target = (msbc->framelen > 0) ? (uint32_t) msbc->framelen : MSBC_FRAMELEN_MAX;
+        size_t decoded_target = (msbc->framelen > 0) ? msbc->decoded_framelen : MSBC_DECODED_FRAMELEN_MAX;
+        size_t len = 0;
+        int32_t curr_framelen;
+        uint8_t *decoded_frame_ptr;
+        bool is_decoded_frame_in_place;
+
+        // There needs to be space for the decoded frame before anything more is taken from the compressed buffer
+        if (data_ringbuf_free_space(decompr_data_buf_ptr) < decoded_target)
         {
-            debug_printf("Failed to init msbc stream\n\r");
-            return DECOMPR_STATUS_OK;
+            break;
         }
-    }
 
-    // There needs to be:
-    // * At least 8 bytes of data to decode in the compressed buffer OR at least framelen bytes in the packed16 buffer
-    // * At least decoded_framlen bytes free space in the decompressed buffer
-    data_to_decode = (   (data_ringbuf_data_length(compr_data_buf_ptr) >= 8)
-                      || (data_ringbuf_data_length(&msbc->packed16_data_buf) >= msbc->framelen))
-                  && (data_ringbuf_free_space(decompr_data_buf_ptr) > msbc->decoded_framelen);
-    while (data_to_decode)
-    {
-        // Check if the packed16_data_buf can be topped up
-        if (data_ringbuf_free_space(&msbc->packed16_data_buf) > 6)
+        // Unpack straight into the frame, as far as the end of this frame
+        if (msbc->frame_len < frame_target)
         {
-            uint32_t p16_bytes;
-            if (decompr_data(&msbc->decompr, &msbc->packed16_data_buf, compr_data_buf_ptr, &p16_bytes) != DECOMPR_STATUS_OK)
-            {
-                debug_printf("msbc_decompress: decmopress failed\n\r");
-                return DECOMPR_STATUS_FAIL;
-            }
+            msbc->frame_len += packed16_unpack_ringbuf(msbc->packed16,
+                                                       compr_data_buf_ptr,
+                                                       &msbc->frame[msbc->frame_len],
+                                                       frame_target - msbc->frame_len);
+        }
+
+        // After a resync or a corrupt frame the data can start anywhere, so find the next frame before decoding
+        if (!msbc_hunt_sync(msbc))
+        {
+            continue;
+        }
+        if (msbc->frame_len < frame_target)
+        {
+            break;
+        }
+
+        // Decode straight into the decompressed buffer if there is a contiguous area for it
+        is_decoded_frame_in_place = (data_ringbuf_reserve_contiguous(decompr_data_buf_ptr,
+                                                                     decoded_target,
+                                                                     &decoded_frame_ptr) == DATA_RINGBUF_STATUS_OK);
+        if (!is_decoded_frame_in_place)
+        {
+            decoded_frame_ptr = msbc->decoded_frame;
         }
 
-        // Decode whilst there is still packed16 data to decode and space to put it in the decompressed buffer
-        while ((data_ringbuf_data_length(&msbc->packed16_data_buf) >= msbc->framelen)
-            && (data_ringbuf_free_space(decompr_data_buf_ptr) >= msbc->decoded_framelen))
+        // Decode the frame
+        curr_framelen = sbc_decode(&msbc->sbc,
+                                   msbc->frame,
+                                   frame_target,
+                                   decoded_frame_ptr,
+                                   decoded_target,
+                                   &len);
+
+        if ((curr_framelen <= 0) || ((uint32_t) curr_framelen > frame_target) || (len > decoded_target))
         {
-            size_t len;
-            int32_t curr_framelen;
-
-            // Read the next frame from packed16_data_buf into frame
-            data_ringbuf_read(&msbc->packed16_data_buf, msbc->frame, msbc->framelen);
-
-            // Decode the frame
-            curr_framelen = sbc_decode(&msbc->sbc,
-                                       msbc->frame,
-                                       msbc->framelen,
-                                       msbc->decoded_frame,
-                                       msbc->decoded_framelen,
-                                       &len);
-            if (curr_framelen < 0)
+            // The sync word may have been part of the previous frame's data, so only drop it and hunt again
+            debug_printf("msbc_decompress: Failed to decode frame - hunt for the next sync word\n\r");
+            curr_framelen = 1;
+        }
+        else
+        {
+            if (msbc->framelen == 0)
             {
-                debug_printf("msbc_decompress: Failed to decode frame - discard frame and continue\n\r");
+                msbc->framelen = curr_framelen;
+                msbc->decoded_framelen = len;
             }
-            else
+
+            if (is_decoded_frame_in_place)
             {
-                // Write it to the decompressed buffer
-                if (data_ringbuf_write(decompr_data_buf_ptr, msbc->decoded_frame, msbc->decoded_framelen) != DATA_RINGBUF_STATUS_OK)
-                {
-                    debug_printf("msbc_decompress: Failed to write decoded frame to decompressed buffer\n\r");
-                    return DECOMPR_STATUS_FAIL;
-                }
-                *bytes_decompressed += msbc->decoded_framelen;
+                data_ringbuf_bytes_written(decompr_data_buf_ptr, len);
             }
+            else if (data_ringbuf_write(decompr_data_buf_ptr, msbc->decoded_frame, len) != DATA_RINGBUF_STATUS_OK)
+            {
+                debug_printf("msbc_decompress: Failed to write decoded frame to decompressed buffer\n\r");
+                return DECOMPR_STATUS_FAIL;
+            }
+            *bytes_decompressed += len;
         }
 
-        // There needs to be:
-        // * At least 8 bytes of data to decode in the compressed buffer OR at least framelen bytes in the packed16 buffer
-        // * At least decoded_framlen bytes free space in the decompressed buffer
-        data_to_decode = (   (data_ringbuf_data_length(compr_data_buf_ptr) >= 8)
-                          || (data_ringbuf_data_length(&msbc->packed16_data_buf) >= msbc->framelen))
-                      && (data_ringbuf_free_space(decompr_data_buf_ptr) > msbc->decoded_framelen);
+        // Keep any bytes of the next frame that were unpacked along with this one
+        msbc->frame_len -= curr_framelen;
+        memmove(msbc->frame, &msbc->frame[curr_framelen], msbc->frame_len);
     }
 
     return DECOMPR_STATUS_OK;
 }
 
+void msbc_realign(void *context, uint32_t stream_pos)
+{
+    msbc_t *msbc = (msbc_t *)context;
+
+    // Frames are found by their sync word, so only the packed16 samples need to be in step
+    packed16_realign(msbc->packed16, stream_pos);
+}
+
 void msbc_deinit(void *context)
 {
     msbc_t *msbc = (msbc_t *)context;
     sbc_finish(&msbc->sbc);
-    decompr_deinit(&msbc->decompr);
-    if (msbc->decoded_frame)
+    packed16_deinit(msbc->packed16);
+    msbc_deinit_context(msbc);
+}
+
+void *msbc_enc_init(endian_t input_endian, arena_t *arena)
+{
+    msbc_enc_t *msbc_enc;
+
+    // Create a context structure, from the arena if one is given
+    msbc_enc = decompr_alloc_context(&msbc_enc_pool, arena);
+    if (msbc_enc == NULL)
     {
-        free(msbc->decoded_frame);
-        msbc->decoded_frame = NULL;
+        return NULL;
     }
-    if (msbc->frame)
+    msbc_enc->is_arena = (arena != NULL);
+
+    msbc_enc->frame_len = 0;
+
+    // The SBC frames are carried as a stream of little-endian packed16 bytes
+    msbc_enc->packed16 = packed16_init(ENDIAN_LITTLE, arena);
+    if (msbc_enc->packed16 == NULL)
     {
-        free(msbc->frame);
-        msbc->frame = NULL;
+        msbc_enc_deinit_context(msbc_enc);
+        return NULL;
     }
-    if (msbc->packed16_buf)
+
+    // Init the sbc lib
+    sbc_init_msbc(&msbc_enc->sbc, 0L);
+    msbc_enc->sbc.endian = (input_endian == ENDIAN_LITTLE) ? SBC_LE : SBC_BE;
+
+    return msbc_enc;
+}
+
+uint32_t msbc_compress(void *context,
+                       data_ringbuf_t *compr_data_buf_ptr,
+                       data_ringbuf_t *pcm_data_buf_ptr,
+                       uint32_t *bytes_compressed)
+{
+    msbc_enc_t *msbc_enc = (msbc_enc_t *)context;
+    *bytes_compressed = 0;
+
+    while (true)
     {
-        free(msbc->packed16_buf);
-        msbc->packed16_buf = NULL;
+        ssize_t len = 0;
+        ssize_t curr_pcm_len;
+        uint8_t *pcm_frame_ptr;
+        bool is_pcm_frame_in_place;
+
+        // Finish packing the previous frame before encoding another one
+        *bytes_compressed += msbc_enc_pack(msbc_enc, compr_data_buf_ptr);
+        if ((msbc_enc->frame_len >= PACKED16_DECOMPR_SAMPLE_BYTES)
+         || (data_ringbuf_data_length(pcm_data_buf_ptr) < MSBC_DECODED_FRAMELEN_MAX))
+        {
+            break;
+        }
+
+        // Encode straight from the PCM buffer if the frame is contiguous there
+        is_pcm_frame_in_place = (data_ringbuf_peek_contiguous(pcm_data_buf_ptr,
+                                                              MSBC_DECODED_FRAMELEN_MAX,
+                                                              &pcm_frame_ptr) == DATA_RINGBUF_STATUS_OK);
+        if (!is_pcm_frame_in_place)
+        {
+            pcm_frame_ptr = msbc_enc->pcm_frame;
+            if (data_ringbuf_read(pcm_data_buf_ptr, pcm_frame_ptr, MSBC_DECODED_FRAMELEN_MAX) != DATA_RINGBUF_STATUS_OK)
+            {
+                debug_printf("msbc_compress: Failed to read PCM frame\n\r");
+                return COMPR_STATUS_FAIL;
+            }
+        }
+
+        // Encode the frame after any bytes of the previous frame that are still to be packed
+        curr_pcm_len = sbc_encode(&msbc_enc->sbc,
+                                  pcm_frame_ptr,
+                                  MSBC_DECODED_FRAMELEN_MAX,
+                                  &msbc_enc->frame[msbc_enc->frame_len],
+                                  MSBC_FRAMELEN_MAX,
+                                  &len);
+
+        if (is_pcm_frame_in_place)
+        {
+            data_ringbuf_bytes_read(pcm_data_buf_ptr, MSBC_DECODED_FRAMELEN_MAX);
+        }
+
+        if ((curr_pcm_len != MSBC_DECODED_FRAMELEN_MAX) || (len <= 0) || (len > MSBC_FRAMELEN_MAX))
+        {
+            debug_printf("msbc_compress: Failed to encode frame\n\r");
+            return COMPR_STATUS_FAIL;
+        }
+        msbc_enc->frame_len += len;
     }
-    free(msbc);
-    msbc = NULL;
+
+    return COMPR_STATUS_OK;
 }
 
+void msbc_enc_deinit(void *context)
+{
+    msbc_enc_t *msbc_enc = (msbc_enc_t *)context;
+    sbc_finish(&msbc_enc->sbc);
+    packed16_deinit(msbc_enc->packed16);
+    msbc_enc_deinit_context(msbc_enc);
+}
@@ -57,13 +57,14 @@ extern "C" {
  *
  * @param [in]
  * - output_endian       The endianness to use for the output data
+ * - arena               Arena to allocate from, or NULL to use the heap (or the static pool)
  *
  * @return
  * - void *              An msbc context structure
  * - NULL                Failed to allocation and initialize an msbc decompression structure
  *
  */
-void *msbc_init(endian_t output_endian);
+void *msbc_init(endian_t output_endian, arena_t *arena);
 
 /**
  * Decompress data in mSBC format
@@ -86,6 +87,18 @@ uint32_t msbc_decompress(void *context,
                          data_ringbuf_t *compr_data_buf_ptr,
                          uint32_t *bytes_decompressed);
 
+/**
+ * Get back in step with the mSBC stream after compressed data has been dropped
+ *
+ * Decoding resumes from the next sync word.
+ *
+ * @param [in]
+ * - context              Pointer to the msbc decompression state structure
+ * - stream_pos           Position in the compressed stream, in bytes, of the next compressed data
+ *
+ */
+void msbc_realign(void *context, uint32_t stream_pos);
+
 /**
  * Deinitialize and free the msbc decompression structure, freeing all resources used
  *
@@ -95,6 +108,53 @@ uint32_t msbc_decompress(void *context,
  */
 void msbc_deinit(void *context);
 
+/**
+ * Allocate and initialize an msbc compression structure with a given input endian format
+ *
+ * @param [in]
+ * - input_endian        The endianness of the input PCM data
+ * - arena               Arena to allocate from, or NULL to use the heap (or the static pool)
+ *
+ * @return
+ * - void *              An msbc compression context structure
+ * - NULL                Failed to allocation and initialize an msbc compression structure
+ *
+ */
+void *msbc_enc_init(endian_t input_endian, arena_t *arena);
+
+/**
+ * Compress PCM data to mSBC format
+ *
+ * PCM data is encoded in whole frames of 120 16bit samples.  The last few bytes of an encoded frame may be held back
+ * until the next frame, as only whole packed16 samples are written to \b compr_data_buf_ptr.
+ *
+ * @param [in]
+ * - context              Pointer to the msbc compression state structure
+ * - compr_data_buf_ptr   Pointer to the data buffer to compress data to
+ * - pcm_data_buf_ptr     Pointer to the data buffer containing the PCM data
+ *
+ * @param [out]
+ * - bytes_compressed     Pointer to the length of data added to the compr_data_buf_ptr
+ *
+ * @return
+ * - COMPR_STATUS_FAIL           Failed to compress the given data
+ * - COMPR_STATUS_OK             otherwise
+ *
+ */
+uint32_t msbc_compress(void *context,
+                       data_ringbuf_t *compr_data_buf_ptr,
+                       data_ringbuf_t *pcm_data_buf_ptr,
+                       uint32_t *bytes_compressed);
+
+/**
+ * Deinitialize and free the msbc compression structure, freeing all resources used
+ *
+ * @param [in]
+ * - context              Pointer to the msbc compression state structure
+ *
+ */
+void msbc_enc_deinit(void *context);
+
 /**********************************************************************************************************************/
 #ifdef __cplusplus
 }
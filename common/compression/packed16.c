@@ -1,7 +1,7 @@
 /**
  * @file packed16.c
  *
- * @brief packed16 decompression module
+ * @brief packed16 compression and decompression module
  *
  * @copyright
  * Copyright (c) Cirrus Logic 2023 All Rights Reserved, http://www.cirrus.com/
@@ -22,16 +22,16 @@
 /***********************************************************************************************************************
  * INCLUDES
  **********************************************************************************************************************/
-#include <stdlib.h>
+#include <string.h>
 #include "debug.h"
+#include "compr.h"
 #include "packed16.h"
-#include "platform_bsp.h"
 
 /***********************************************************************************************************************
  * LOCAL LITERAL SUBSTITUTIONS
  **********************************************************************************************************************/
-#define COMPRESSED_DATA_BYTES   (8) // two 32bits containing two 24bit values
-#define DECOMPRESSED_DATA_BYTES (6) // two 24bit values
+#define COMPRESSED_DATA_BYTES   (PACKED16_COMPR_SAMPLE_BYTES)
+#define DECOMPRESSED_DATA_BYTES (PACKED16_DECOMPR_SAMPLE_BYTES)
 
 // MSB and LSB positions of packed16 data within compressed data
 #define PACKED16_0_MSB          (3)
@@ -41,6 +41,11 @@
 #define PACKED16_2_MSB          (6)
 #define PACKED16_2_LSB          (5)
 
+// The bulk kernels work on two groups at a time, i.e. four 32bit words in and three out
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define PACKED16_BULK_WORDS
+#endif
+
 /***********************************************************************************************************************
  * LOCAL VARIABLES
  **********************************************************************************************************************/
@@ -48,28 +53,208 @@ typedef struct
 {
     endian_t endian;
     uint32_t write_index[DECOMPRESSED_DATA_BYTES]; // Indices of packed16 bytes within compressed data
+    // Decompress a number of samples that are contiguous in both buffers
+    void (*bulk)(const uint32_t *write_index, uint8_t *decompr_ptr, const uint8_t *compr_ptr, uint32_t num_samples);
+    uint32_t skip_len;                              // Compressed bytes to drop to get back in step with whole samples
+    bool is_arena;                                  // Freed by arena_reset() rather than on deinit
 } packed16_t;
 
+DECOMPR_CONTEXT_POOL(packed16_pool, packed16_t);
+
 /***********************************************************************************************************************
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
 
+/**
+ * Drop any compressed bytes left over from a sample that was split by packed16_realign()
+ *
+ * @return                true once the compressed data is in step with whole samples
+ *
+ */
+static bool packed16_skip(packed16_t *packed16, data_ringbuf_t *compr_data_buf_ptr)
+{
+    uint32_t len = data_ringbuf_data_length(compr_data_buf_ptr);
+
+    if (len > packed16->skip_len)
+    {
+        len = packed16->skip_len;
+    }
+    data_ringbuf_bytes_read(compr_data_buf_ptr, len);
+    packed16->skip_len -= len;
+
+    return (packed16->skip_len == 0);
+}
+
+/**
+ * Decompress one sample, using the byte order in write_index
+ *
+ */
+static inline void packed16_sample(const uint32_t *write_index, uint8_t *decompr_ptr, const uint8_t *compr_ptr)
+{
+    for (uint32_t index = 0; index < DECOMPRESSED_DATA_BYTES; index++)
+    {
+        // Put decompressed data in correct order and ignore empty bytes
+        decompr_ptr[index] = compr_ptr[write_index[index]];
+    }
+}
+
+#ifdef PACKED16_BULK_WORDS
+/**
+ * Load a 32bit word from a possibly unaligned address
+ *
+ */
+static inline uint32_t packed16_load32(const uint8_t *ptr)
+{
+    uint32_t word;
+
+    memcpy(&word, ptr, sizeof(word));
+
+    return word;
+}
+
+/**
+ * Store a 32bit word to a possibly unaligned address
+ *
+ */
+static inline void packed16_store32(uint8_t *ptr, uint32_t word)
+{
+    memcpy(ptr, &word, sizeof(word));
+}
+
+/**
+ * Decompress two samples to three little-endian output words
+ *
+ * Each compressed word is a 24bit value sent MSB first after a pad byte, so byte-swapping it lines up the packed16
+ * bytes in little-endian order.
+ *
+ */
+static inline void packed16_pair_le(const uint8_t *compr_ptr, uint32_t *out)
+{
+    uint32_t w0 = __builtin_bswap32(packed16_load32(compr_ptr));
+    uint32_t w1 = packed16_load32(compr_ptr + 4);
+    uint32_t w2 = __builtin_bswap32(packed16_load32(compr_ptr + 8));
+    uint32_t w3 = __builtin_bswap32(packed16_load32(compr_ptr + 12));
+
+    out[0] = (w0 & 0x00FFFFFF) | (w1 & 0xFF000000);
+    out[1] = ((__builtin_bswap32(w1) >> 8) & 0x0000FFFF) | (w2 << 16);
+    out[2] = ((w2 >> 16) & 0x000000FF) | (w3 << 8);
+}
+
+/**
+ * Decompress samples to little-endian output, two at a time
+ *
+ */
+static void packed16_bulk_le(const uint32_t *write_index,
+                             uint8_t *decompr_ptr,
+                             const uint8_t *compr_ptr,
+                             uint32_t num_samples)
+{
+    for (; num_samples >= 2; num_samples -= 2)
+    {
+        uint32_t out[3];
+
+        packed16_pair_le(compr_ptr, out);
+        packed16_store32(decompr_ptr, out[0]);
+        packed16_store32(decompr_ptr + 4, out[1]);
+        packed16_store32(decompr_ptr + 8, out[2]);
+        compr_ptr += 2 * COMPRESSED_DATA_BYTES;
+        decompr_ptr += 2 * DECOMPRESSED_DATA_BYTES;
+    }
+
+    if (num_samples > 0)
+    {
+        packed16_sample(write_index, decompr_ptr, compr_ptr);
+    }
+}
+
+/**
+ * Decompress samples to big-endian output, two at a time
+ *
+ * Every 16bit output value lies within one output word, so this is the little-endian kernel with the bytes of each
+ * halfword swapped.
+ *
+ */
+static void packed16_bulk_be(const uint32_t *write_index,
+                             uint8_t *decompr_ptr,
+                             const uint8_t *compr_ptr,
+                             uint32_t num_samples)
+{
+    for (; num_samples >= 2; num_samples -= 2)
+    {
+        uint32_t out[3];
+
+        packed16_pair_le(compr_ptr, out);
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            out[i] = ((out[i] & 0x00FF00FF) << 8) | ((out[i] >> 8) & 0x00FF00FF);
+            packed16_store32(decompr_ptr + (i * sizeof(uint32_t)), out[i]);
+        }
+        compr_ptr += 2 * COMPRESSED_DATA_BYTES;
+        decompr_ptr += 2 * DECOMPRESSED_DATA_BYTES;
+    }
+
+    if (num_samples > 0)
+    {
+        packed16_sample(write_index, decompr_ptr, compr_ptr);
+    }
+}
+#else
+/**
+ * Decompress samples one byte at a time, for hosts where the word kernels do not apply
+ *
+ */
+static void packed16_bulk_bytes(const uint32_t *write_index,
+                                uint8_t *decompr_ptr,
+                                const uint8_t *compr_ptr,
+                                uint32_t num_samples)
+{
+    for (; num_samples > 0; num_samples--)
+    {
+        packed16_sample(write_index, decompr_ptr, compr_ptr);
+        compr_ptr += COMPRESSED_DATA_BYTES;
+        decompr_ptr += DECOMPRESSED_DATA_BYTES;
+    }
+}
+#endif
+
+/**
+ * Pack samples, using the byte order in write_index
+ *
+ */
+static void packed16_pack(const uint32_t *write_index, uint8_t *compr_ptr, const uint8_t *pcm_ptr, uint32_t num_samples)
+{
+    for (; num_samples > 0; num_samples--)
+    {
+        // The pad bytes of each DSP word are 0
+        compr_ptr[0] = 0;
+        compr_ptr[4] = 0;
+        for (uint32_t index = 0; index < DECOMPRESSED_DATA_BYTES; index++)
+        {
+            compr_ptr[write_index[index]] = pcm_ptr[index];
+        }
+        compr_ptr += COMPRESSED_DATA_BYTES;
+        pcm_ptr += DECOMPRESSED_DATA_BYTES;
+    }
+}
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
 
-void *packed16_init(endian_t output_endian)
+void *packed16_init(endian_t output_endian, arena_t *arena)
 {
     packed16_t *packed16;
 
-    // Create a context structure and set it all to 0s
-    packed16 = malloc(sizeof(packed16_t));
+    // Create a context structure, from the arena if one is given
+    packed16 = decompr_alloc_context(&packed16_pool, arena);
     if (packed16 == NULL)
     {
         return NULL;
     }
+    packed16->is_arena = (arena != NULL);
 
     packed16->endian = output_endian;
+    packed16->skip_len = 0;
 
     if (packed16->endian == ENDIAN_LITTLE)
     {
@@ -90,6 +275,12 @@ void *packed16_init(endian_t output_endian)
         packed16->write_index[5] = PACKED16_2_MSB;
     }
 
+#ifdef PACKED16_BULK_WORDS
+    packed16->bulk = (packed16->endian == ENDIAN_LITTLE) ? &packed16_bulk_le : &packed16_bulk_be;
+#else
+    packed16->bulk = &packed16_bulk_bytes;
+#endif
+
     return packed16;
 }
 
@@ -99,36 +290,284 @@ uint32_t packed16_decompress(void *context,
                              uint32_t *bytes_decompressed)
 {
     packed16_t *packed16 = (packed16_t *)context;
+    data_ringbuf_iov_t compr_iov[DATA_RINGBUF_IOV_MAX];
+    data_ringbuf_iov_t decompr_iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t num_samples;
+    uint32_t max_decompr_samples;
+    uint32_t compr_offset = 0;
+    uint32_t decompr_offset = 0;
+
     *bytes_decompressed = 0;
-    while ((data_ringbuf_data_length(compr_data_buf_ptr) >= COMPRESSED_DATA_BYTES)
-    &&     (data_ringbuf_free_space(decompr_data_buf_ptr) >= DECOMPRESSED_DATA_BYTES))
+
+    if (!packed16_skip(packed16, compr_data_buf_ptr))
+    {
+        return DECOMPR_STATUS_OK;
+    }
+
+    // Decompress everything there is data and space for in a single pass, working in place in both buffers
+    num_samples = data_ringbuf_get_read_iov(compr_data_buf_ptr, compr_iov) / COMPRESSED_DATA_BYTES;
+    max_decompr_samples = data_ringbuf_get_write_iov(decompr_data_buf_ptr, decompr_iov) / DECOMPRESSED_DATA_BYTES;
+    if (num_samples > max_decompr_samples)
+    {
+        num_samples = max_decompr_samples;
+    }
+
+    while (num_samples > 0)
     {
         uint8_t samplebuf_compr[COMPRESSED_DATA_BYTES];
         uint8_t samplebuf_decompr[DECOMPRESSED_DATA_BYTES];
-        if (data_ringbuf_read(compr_data_buf_ptr, &samplebuf_compr[0], COMPRESSED_DATA_BYTES) != DATA_RINGBUF_STATUS_OK)
+        uint8_t *compr_ptr;
+        uint8_t *decompr_ptr;
+        uint32_t run;
+
+        // Decompress as many samples as are contiguous in both buffers in one go
+        run = data_ringbuf_iov_contig(compr_iov, compr_offset, COMPRESSED_DATA_BYTES);
+        if (run > data_ringbuf_iov_contig(decompr_iov, decompr_offset, DECOMPRESSED_DATA_BYTES))
         {
-            debug_printf("Failed to read from compr buf\n");
-            return DECOMPR_STATUS_FAIL;
+            run = data_ringbuf_iov_contig(decompr_iov, decompr_offset, DECOMPRESSED_DATA_BYTES);
         }
-        for (uint32_t index = 0; index < DECOMPRESSED_DATA_BYTES; index++)
+        if (run > num_samples)
+        {
+            run = num_samples;
+        }
+
+        if (run > 0)
         {
-            // Put decompressed data in correct order and ignore empty bytes
-            samplebuf_decompr[index] = samplebuf_compr[packed16->write_index[index]];
+            compr_ptr = data_ringbuf_iov_ptr(compr_iov, compr_offset, run * COMPRESSED_DATA_BYTES, NULL, false);
+            decompr_ptr = data_ringbuf_iov_ptr(decompr_iov, decompr_offset, run * DECOMPRESSED_DATA_BYTES, NULL, false);
+            packed16->bulk(packed16->write_index, decompr_ptr, compr_ptr, run);
         }
-        if (data_ringbuf_write(decompr_data_buf_ptr, &samplebuf_decompr[0], DECOMPRESSED_DATA_BYTES) != DATA_RINGBUF_STATUS_OK)
+        else
         {
-            debug_printf("Failed to write to packed16 buf\n");
-            return DECOMPR_STATUS_FAIL;
+            // This sample straddles the end of a segment in one of the buffers
+            run = 1;
+            compr_ptr = data_ringbuf_iov_ptr(compr_iov, compr_offset, COMPRESSED_DATA_BYTES, samplebuf_compr, true);
+            decompr_ptr = data_ringbuf_iov_ptr(decompr_iov,
+                                               decompr_offset,
+                                               DECOMPRESSED_DATA_BYTES,
+                                               samplebuf_decompr,
+                                               false);
+            packed16_sample(packed16->write_index, decompr_ptr, compr_ptr);
+            if (decompr_ptr == samplebuf_decompr)
+            {
+                data_ringbuf_iov_scatter(decompr_iov, decompr_offset, DECOMPRESSED_DATA_BYTES, samplebuf_decompr);
+            }
         }
-        *bytes_decompressed += DECOMPRESSED_DATA_BYTES;
+
+        compr_offset += run * COMPRESSED_DATA_BYTES;
+        decompr_offset += run * DECOMPRESSED_DATA_BYTES;
+        num_samples -= run;
+    }
+
+    if ((data_ringbuf_commit_write_iov(decompr_data_buf_ptr, decompr_offset) != DATA_RINGBUF_STATUS_OK)
+     || (data_ringbuf_commit_read_iov(compr_data_buf_ptr, compr_offset) != DATA_RINGBUF_STATUS_OK))
+    {
+        debug_printf("Failed to commit packed16 data\n");
+        return DECOMPR_STATUS_FAIL;
     }
+    *bytes_decompressed = decompr_offset;
 
     return DECOMPR_STATUS_OK;
 }
 
+uint32_t packed16_compress(void *context,
+                           data_ringbuf_t *compr_data_buf_ptr,
+                           data_ringbuf_t *pcm_data_buf_ptr,
+                           uint32_t *bytes_compressed)
+{
+    packed16_t *packed16 = (packed16_t *)context;
+    data_ringbuf_iov_t pcm_iov[DATA_RINGBUF_IOV_MAX];
+    data_ringbuf_iov_t compr_iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t num_samples;
+    uint32_t max_compr_samples;
+    uint32_t pcm_offset = 0;
+    uint32_t compr_offset = 0;
+
+    *bytes_compressed = 0;
+
+    // Compress everything there is data and space for in a single pass, working in place in both buffers
+    num_samples = data_ringbuf_get_read_iov(pcm_data_buf_ptr, pcm_iov) / DECOMPRESSED_DATA_BYTES;
+    max_compr_samples = data_ringbuf_get_write_iov(compr_data_buf_ptr, compr_iov) / COMPRESSED_DATA_BYTES;
+    if (num_samples > max_compr_samples)
+    {
+        num_samples = max_compr_samples;
+    }
+
+    while (num_samples > 0)
+    {
+        uint8_t samplebuf_pcm[DECOMPRESSED_DATA_BYTES];
+        uint8_t samplebuf_compr[COMPRESSED_DATA_BYTES];
+        uint8_t *pcm_ptr;
+        uint8_t *compr_ptr;
+        uint32_t run;
+
+        // Compress as many samples as are contiguous in both buffers in one go
+        run = data_ringbuf_iov_contig(pcm_iov, pcm_offset, DECOMPRESSED_DATA_BYTES);
+        if (run > data_ringbuf_iov_contig(compr_iov, compr_offset, COMPRESSED_DATA_BYTES))
+        {
+            run = data_ringbuf_iov_contig(compr_iov, compr_offset, COMPRESSED_DATA_BYTES);
+        }
+        if (run > num_samples)
+        {
+            run = num_samples;
+        }
+
+        if (run > 0)
+        {
+            pcm_ptr = data_ringbuf_iov_ptr(pcm_iov, pcm_offset, run * DECOMPRESSED_DATA_BYTES, NULL, false);
+            compr_ptr = data_ringbuf_iov_ptr(compr_iov, compr_offset, run * COMPRESSED_DATA_BYTES, NULL, false);
+            packed16_pack(packed16->write_index, compr_ptr, pcm_ptr, run);
+        }
+        else
+        {
+            // This sample straddles the end of a segment in one of the buffers
+            run = 1;
+            pcm_ptr = data_ringbuf_iov_ptr(pcm_iov, pcm_offset, DECOMPRESSED_DATA_BYTES, samplebuf_pcm, true);
+            compr_ptr = data_ringbuf_iov_ptr(compr_iov, compr_offset, COMPRESSED_DATA_BYTES, samplebuf_compr, false);
+            packed16_pack(packed16->write_index, compr_ptr, pcm_ptr, 1);
+            if (compr_ptr == samplebuf_compr)
+            {
+                data_ringbuf_iov_scatter(compr_iov, compr_offset, COMPRESSED_DATA_BYTES, samplebuf_compr);
+            }
+        }
+
+        pcm_offset += run * DECOMPRESSED_DATA_BYTES;
+        compr_offset += run * COMPRESSED_DATA_BYTES;
+        num_samples -= run;
+    }
+
+    if ((data_ringbuf_commit_write_iov(compr_data_buf_ptr, compr_offset) != DATA_RINGBUF_STATUS_OK)
+     || (data_ringbuf_commit_read_iov(pcm_data_buf_ptr, pcm_offset) != DATA_RINGBUF_STATUS_OK))
+    {
+        debug_printf("Failed to commit packed16 data\n");
+        return COMPR_STATUS_FAIL;
+    }
+    *bytes_compressed = compr_offset;
+
+    return COMPR_STATUS_OK;
+}
+
+uint32_t packed16_pack_ringbuf(void *context, data_ringbuf_t *compr_data_buf_ptr, const uint8_t *src_ptr, uint32_t len)
+{
+    packed16_t *packed16 = (packed16_t *)context;
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t num_samples;
+    uint32_t compr_offset = 0;
+    uint32_t src_offset = 0;
+
+    // Only whole samples are packed, as far as there is space
+    num_samples = data_ringbuf_get_write_iov(compr_data_buf_ptr, iov) / COMPRESSED_DATA_BYTES;
+    if (num_samples > (len / DECOMPRESSED_DATA_BYTES))
+    {
+        num_samples = len / DECOMPRESSED_DATA_BYTES;
+    }
+
+    while (num_samples > 0)
+    {
+        uint8_t samplebuf_compr[COMPRESSED_DATA_BYTES];
+        uint8_t *compr_ptr;
+        uint32_t run = data_ringbuf_iov_contig(iov, compr_offset, COMPRESSED_DATA_BYTES);
+
+        if (run > num_samples)
+        {
+            run = num_samples;
+        }
+
+        if (run > 0)
+        {
+            compr_ptr = data_ringbuf_iov_ptr(iov, compr_offset, run * COMPRESSED_DATA_BYTES, NULL, false);
+            packed16_pack(packed16->write_index, compr_ptr, src_ptr + src_offset, run);
+        }
+        else
+        {
+            // This sample straddles the end of the compressed buffer
+            run = 1;
+            compr_ptr = data_ringbuf_iov_ptr(iov, compr_offset, COMPRESSED_DATA_BYTES, samplebuf_compr, false);
+            packed16_pack(packed16->write_index, compr_ptr, src_ptr + src_offset, 1);
+            data_ringbuf_iov_scatter(iov, compr_offset, COMPRESSED_DATA_BYTES, samplebuf_compr);
+        }
+
+        compr_offset += run * COMPRESSED_DATA_BYTES;
+        src_offset += run * DECOMPRESSED_DATA_BYTES;
+        num_samples -= run;
+    }
+
+    data_ringbuf_commit_write_iov(compr_data_buf_ptr, compr_offset);
+
+    return src_offset;
+}
+
+uint32_t packed16_unpack_ringbuf(void *context, data_ringbuf_t *compr_data_buf_ptr, uint8_t *dest_ptr, uint32_t len)
+{
+    packed16_t *packed16 = (packed16_t *)context;
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t num_samples;
+    uint32_t compr_offset = 0;
+    uint32_t decompr_offset = 0;
+
+    if (!packed16_skip(packed16, compr_data_buf_ptr))
+    {
+        return 0;
+    }
+
+    // Only take as many whole samples as are needed to unpack len bytes
+    num_samples = data_ringbuf_get_read_iov(compr_data_buf_ptr, iov) / COMPRESSED_DATA_BYTES;
+    if (num_samples > ((len + DECOMPRESSED_DATA_BYTES - 1) / DECOMPRESSED_DATA_BYTES))
+    {
+        num_samples = (len + DECOMPRESSED_DATA_BYTES - 1) / DECOMPRESSED_DATA_BYTES;
+    }
+
+    while (num_samples > 0)
+    {
+        uint8_t samplebuf_compr[COMPRESSED_DATA_BYTES];
+        uint8_t *compr_ptr;
+        uint32_t run = data_ringbuf_iov_contig(iov, compr_offset, COMPRESSED_DATA_BYTES);
+
+        if (run > num_samples)
+        {
+            run = num_samples;
+        }
+
+        if (run > 0)
+        {
+            compr_ptr = data_ringbuf_iov_ptr(iov, compr_offset, run * COMPRESSED_DATA_BYTES, NULL, false);
+        }
+        else
+        {
+            // This sample straddles the end of the compressed buffer
+            run = 1;
+            compr_ptr = data_ringbuf_iov_ptr(iov, compr_offset, COMPRESSED_DATA_BYTES, samplebuf_compr, true);
+        }
+
+        packed16->bulk(packed16->write_index, dest_ptr + decompr_offset, compr_ptr, run);
+        compr_offset += run * COMPRESSED_DATA_BYTES;
+        decompr_offset += run * DECOMPRESSED_DATA_BYTES;
+        num_samples -= run;
+    }
+
+    data_ringbuf_commit_read_iov(compr_data_buf_ptr, compr_offset);
+
+    return decompr_offset;
+}
+
+uint32_t packed16_realign(void *context, uint32_t stream_pos)
+{
+    packed16_t *packed16 = (packed16_t *)context;
+    uint32_t sample_pos = (stream_pos + COMPRESSED_DATA_BYTES - 1) / COMPRESSED_DATA_BYTES;
+
+    // The two DSP words of a sample are only meaningful together, so drop the second half of a split one
+    packed16->skip_len = (sample_pos * COMPRESSED_DATA_BYTES) - stream_pos;
+
+    return sample_pos * DECOMPRESSED_DATA_BYTES;
+}
+
 void packed16_deinit(void *context)
 {
     packed16_t *packed16 = (packed16_t *)context;
-    free(packed16);
+
+    if (!packed16->is_arena)
+    {
+        decompr_free_context(&packed16_pool, packed16);
+    }
 }
 
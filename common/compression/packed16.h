@@ -35,6 +35,8 @@ extern "C" {
 /***********************************************************************************************************************
  * LITERALS & CONSTANTS
  **********************************************************************************************************************/
+#define PACKED16_COMPR_SAMPLE_BYTES     (8) // two 32bits containing two 24bit values
+#define PACKED16_DECOMPR_SAMPLE_BYTES   (6) // two 24bit values, i.e. three 16bit values
 
 /***********************************************************************************************************************
  * MACROS
@@ -57,13 +59,14 @@ extern "C" {
  *
  * @param [in]
  * - output_endian       The endianness to use for the output data
+ * - arena               Arena to allocate from, or NULL to use the heap (or the static pool)
  *
  * @return
  * - void *              A packed16 context structure
  * - NULL                Failed to allocation and initialize an packed16 decompression structure
  *
  */
-void *packed16_init(endian_t output_endian);
+void *packed16_init(endian_t output_endian, arena_t *arena);
 
 /**
  * Decompress data in packed16 format
@@ -86,6 +89,77 @@ uint32_t packed16_decompress(void *context,
                          data_ringbuf_t *compr_data_buf_ptr,
                          uint32_t *bytes_decompressed);
 
+/**
+ * Compress PCM data to packed16 format
+ *
+ * The context must have been initialized with the endianness of the PCM data.
+ *
+ * @param [in]
+ * - context              Pointer to the packed16 state structure
+ * - compr_data_buf_ptr   Pointer to the data buffer to compress data to
+ * - pcm_data_buf_ptr     Pointer to the data buffer containing the PCM data
+ *
+ * @param [out]
+ * - bytes_compressed     Pointer to the length of data added to the compr_data_buf_ptr
+ *
+ * @return
+ * - COMPR_STATUS_FAIL           Failed to compress the given data
+ * - COMPR_STATUS_OK             otherwise
+ *
+ */
+uint32_t packed16_compress(void *context,
+                           data_ringbuf_t *compr_data_buf_ptr,
+                           data_ringbuf_t *pcm_data_buf_ptr,
+                           uint32_t *bytes_compressed);
+
+/**
+ * Pack bytes from plain memory into packed16 samples in a data buffer
+ *
+ * Packs as many whole samples from \b src_ptr as there are in \b len bytes and space for in \b compr_data_buf_ptr.
+ *
+ * @param [in]
+ * - context              Pointer to the packed16 state structure
+ * - compr_data_buf_ptr   Pointer to the data buffer to compress data to
+ * - src_ptr              Pointer to the bytes to pack
+ * - len                  Number of bytes at \b src_ptr
+ *
+ * @return                The number of bytes taken from \b src_ptr
+ *
+ */
+uint32_t packed16_pack_ringbuf(void *context, data_ringbuf_t *compr_data_buf_ptr, const uint8_t *src_ptr, uint32_t len);
+
+/**
+ * Unpack packed16 samples from a data buffer into plain memory
+ *
+ * Takes the fewest whole samples from \b compr_data_buf_ptr that give at least \b len bytes, or as many as there are
+ * if fewer.  Up to PACKED16_DECOMPR_SAMPLE_BYTES - 1 bytes beyond \b len may therefore be written to \b dest_ptr.
+ *
+ * @param [in]
+ * - context              Pointer to the packed16 decompression state structure
+ * - compr_data_buf_ptr   Pointer to the data buffer containing the compressed data
+ * - dest_ptr             Pointer to memory for the unpacked data
+ * - len                  Number of unpacked bytes wanted
+ *
+ * @return                The number of bytes written to \b dest_ptr
+ *
+ */
+uint32_t packed16_unpack_ringbuf(void *context, data_ringbuf_t *compr_data_buf_ptr, uint8_t *dest_ptr, uint32_t len);
+
+/**
+ * Get back in step with whole samples after compressed data has been dropped
+ *
+ * The compressed data that follows must start \b stream_pos bytes into the stream.  If that is part way through a
+ * sample, the rest of the sample is dropped by the next packed16_decompress() or packed16_unpack_ringbuf().
+ *
+ * @param [in]
+ * - context              Pointer to the packed16 decompression state structure
+ * - stream_pos           Position in the compressed stream, in bytes, of the next compressed data
+ *
+ * @return                The position in the unpacked stream, in bytes, of the next byte that will be unpacked
+ *
+ */
+uint32_t packed16_realign(void *context, uint32_t stream_pos);
+
 /**
  * Deinitialize and free the packed16 decompression structure, freeing all resources used
  *
@@ -0,0 +1,252 @@
+/**
+ * @file resampler.c
+ *
+ * @brief Streaming sample rate converter module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include "debug.h"
+#include "resampler.h"
+#if defined(__ARM_FEATURE_SAT) || defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#endif
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define RESAMPLER_SAMPLE_BYTES      (2)
+#define RESAMPLER_FRAME_BYTES_MAX   (RESAMPLER_CHANNELS_MAX * RESAMPLER_SAMPLE_BYTES)
+#define RESAMPLER_COEFF_SHIFT       (15)
+
+#if defined(__ARM_FEATURE_SAT)
+#define RESAMPLER_SSAT16(value)     (__ssat((value), 16))
+#else
+#define RESAMPLER_SSAT16(value)     (((value) > INT16_MAX) ? INT16_MAX : (((value) < INT16_MIN) ? INT16_MIN : (value)))
+#endif
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+
+/*
+ * Interpolation filter, Q15, one row per phase from 0 to RESAMPLER_PHASES inclusive.  Kaiser-windowed (beta 5) sinc
+ * with its cutoff at 0.45 of the input rate, each row normalized to unity gain at DC.  Row p weights the
+ * RESAMPLER_TAPS most recent inputs (oldest first) for an output p / RESAMPLER_PHASES of a sample after the
+ * (RESAMPLER_TAPS / 2)th oldest.
+ */
+static const int16_t resampler_coeffs[RESAMPLER_PHASES + 1][RESAMPLER_TAPS] __attribute__((aligned(4))) =
+{
+    {   646,  -1688,   2786,  29371,   2786,  -1688,    646,    -91},
+    {   574,  -1425,   1940,  29339,   3680,  -1955,    718,   -103},
+    {   503,  -1168,   1142,  29224,   4617,  -2223,    789,   -116},
+    {   433,   -918,    394,  29025,   5593,  -2489,    858,   -128},
+    {   366,   -677,   -303,  28741,   6607,  -2751,    925,   -140},
+    {   301,   -446,   -947,  28379,   7653,  -3007,    987,   -152},
+    {   238,   -227,  -1537,  27936,   8727,  -3252,   1045,   -162},
+    {   180,    -22,  -2072,  27418,   9824,  -3485,   1097,   -172},
+    {   125,    169,  -2552,  26824,  10941,  -3701,   1142,   -180},
+    {    75,    345,  -2976,  26160,  12071,  -3899,   1179,   -187},
+    {    28,    506,  -3346,  25429,  13209,  -4074,   1207,   -191},
+    {   -13,    650,  -3662,  24635,  14349,  -4223,   1225,   -193},
+    {   -51,    778,  -3925,  23784,  15487,  -4344,   1231,   -192},
+    {   -83,    889,  -4136,  22877,  16616,  -4433,   1225,   -187},
+    {  -111,    984,  -4297,  21923,  17730,  -4487,   1206,   -180},
+    {  -135,   1063,  -4411,  20927,  18823,  -4503,   1173,   -169},
+    {  -154,   1126,  -4479,  19891,  19891,  -4479,   1126,   -154},
+    {  -169,   1173,  -4503,  18823,  20927,  -4411,   1063,   -135},
+    {  -180,   1206,  -4487,  17730,  21923,  -4297,    984,   -111},
+    {  -187,   1225,  -4433,  16616,  22877,  -4136,    889,    -83},
+    {  -192,   1231,  -4344,  15487,  23784,  -3925,    778,    -51},
+    {  -193,   1225,  -4223,  14349,  24635,  -3662,    650,    -13},
+    {  -191,   1207,  -4074,  13209,  25429,  -3346,    506,     28},
+    {  -187,   1179,  -3899,  12071,  26160,  -2976,    345,     75},
+    {  -180,   1142,  -3701,  10941,  26824,  -2552,    169,    125},
+    {  -172,   1097,  -3485,   9824,  27418,  -2072,    -22,    180},
+    {  -162,   1045,  -3252,   8727,  27936,  -1537,   -227,    238},
+    {  -152,    987,  -3007,   7653,  28379,   -947,   -446,    301},
+    {  -140,    925,  -2751,   6607,  28741,   -303,   -677,    366},
+    {  -128,    858,  -2489,   5593,  29025,    394,   -918,    433},
+    {  -116,    789,  -2223,   4617,  29224,   1142,  -1168,    503},
+    {  -103,    718,  -1955,   3680,  29339,   1940,  -1425,    574},
+    {   -91,    646,  -1688,   2786,  29371,   2786,  -1688,    646},
+};
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Apply one row of the filter to the input history
+ *
+ */
+static inline int32_t resampler_fir(const int16_t *history, const int16_t *coeffs)
+{
+    int32_t acc = 0;
+
+#if defined(__ARM_FEATURE_SIMD32)
+    // Two 16bit multiply-accumulates per instruction (SMLAD)
+    for (uint32_t tap = 0; tap < RESAMPLER_TAPS; tap += 2)
+    {
+        int16x2_t history_pair;
+        int16x2_t coeffs_pair;
+
+        memcpy(&history_pair, &history[tap], sizeof(history_pair));
+        memcpy(&coeffs_pair, &coeffs[tap], sizeof(coeffs_pair));
+        acc = __smlad(history_pair, coeffs_pair, acc);
+    }
+#else
+    for (uint32_t tap = 0; tap < RESAMPLER_TAPS; tap++)
+    {
+        acc += history[tap] * coeffs[tap];
+    }
+#endif
+
+    return acc;
+}
+
+/**
+ * Calculate one output sample from the input history of a channel
+ *
+ */
+static inline int16_t resampler_sample(const int16_t *history, uint32_t phase_index, int32_t phase_frac)
+{
+    int32_t acc0 = resampler_fir(history, resampler_coeffs[phase_index]);
+    int32_t acc1 = resampler_fir(history, resampler_coeffs[phase_index + 1]);
+    int32_t acc;
+
+    // Interpolate linearly between the two nearest phases of the filter
+    acc = acc0 + (int32_t) ((((int64_t) (acc1 - acc0)) * phase_frac) >> RESAMPLER_COEFF_SHIFT);
+    acc = (acc + (1 << (RESAMPLER_COEFF_SHIFT - 1))) >> RESAMPLER_COEFF_SHIFT;
+
+    return (int16_t) RESAMPLER_SSAT16(acc);
+}
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+uint32_t resampler_init(resampler_t *resampler, const resampler_config_t *config)
+{
+    if ((config->channels < 1) || (config->channels > RESAMPLER_CHANNELS_MAX)
+     || (config->in_fs_hz == 0) || (config->out_fs_hz < config->in_fs_hz)
+     || (config->out_fs_hz > (UINT32_MAX / (RESAMPLER_PHASES * 2))))
+    {
+        debug_printf("resampler_init: Unsupported configuration\n\r");
+        return RESAMPLER_STATUS_FAIL;
+    }
+
+    resampler->config = *config;
+    resampler->phase = 0;
+    resampler->history_index = 0;
+    memset(resampler->history, 0, sizeof(resampler->history));
+    PERF_STATS_RESET(&resampler->perf);
+
+    return RESAMPLER_STATUS_OK;
+}
+
+uint32_t resampler_data(resampler_t *resampler,
+                        data_ringbuf_t *out_data_buf_ptr,
+                        data_ringbuf_t *in_data_buf_ptr,
+                        uint32_t *bytes_resampled)
+{
+    const resampler_config_t *config = &resampler->config;
+    uint32_t frame_bytes = config->channels * RESAMPLER_SAMPLE_BYTES;
+    data_ringbuf_iov_t in_iov[DATA_RINGBUF_IOV_MAX];
+    data_ringbuf_iov_t out_iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t in_len;
+    uint32_t out_len;
+    uint32_t in_offset = 0;
+    uint32_t out_offset = 0;
+    PERF_STATS_START(start_ticks);
+
+    *bytes_resampled = 0;
+
+    in_len = data_ringbuf_get_read_iov(in_data_buf_ptr, in_iov);
+    out_len = data_ringbuf_get_write_iov(out_data_buf_ptr, out_iov);
+
+    while ((out_offset + frame_bytes) <= out_len)
+    {
+        uint8_t framebuf[RESAMPLER_FRAME_BYTES_MAX];
+        uint8_t *frame_ptr;
+        uint32_t phase_index;
+        int32_t phase_frac;
+
+        // Take in input samples until the next output falls between the middle two of the history
+        while (resampler->phase >= config->out_fs_hz)
+        {
+            if ((in_offset + frame_bytes) > in_len)
+            {
+                break;
+            }
+
+            frame_ptr = data_ringbuf_iov_ptr(in_iov, in_offset, frame_bytes, framebuf, true);
+            for (uint32_t channel = 0; channel < config->channels; channel++)
+            {
+                int16_t sample = (int16_t) (frame_ptr[channel * 2] | (frame_ptr[(channel * 2) + 1] << 8));
+
+                resampler->history[channel][resampler->history_index] = sample;
+                resampler->history[channel][resampler->history_index + RESAMPLER_TAPS] = sample;
+            }
+            resampler->history_index = (resampler->history_index + 1) % RESAMPLER_TAPS;
+            resampler->phase -= config->out_fs_hz;
+            in_offset += frame_bytes;
+        }
+        if (resampler->phase >= config->out_fs_hz)
+        {
+            break;
+        }
+
+        // Split the phase into a filter row and a Q15 fraction between that row and the next
+        phase_index = (resampler->phase * RESAMPLER_PHASES) / config->out_fs_hz;
+        phase_frac = (int32_t) (((((resampler->phase * RESAMPLER_PHASES) % config->out_fs_hz) << 8) / config->out_fs_hz)
+                                << (RESAMPLER_COEFF_SHIFT - 8));
+
+        frame_ptr = data_ringbuf_iov_ptr(out_iov, out_offset, frame_bytes, framebuf, false);
+        for (uint32_t channel = 0; channel < config->channels; channel++)
+        {
+            int16_t sample = resampler_sample(&resampler->history[channel][resampler->history_index],
+                                              phase_index,
+                                              phase_frac);
+
+            frame_ptr[channel * 2] = (uint8_t) sample;
+            frame_ptr[(channel * 2) + 1] = (uint8_t) (((uint16_t) sample) >> 8);
+        }
+        if (frame_ptr == framebuf)
+        {
+            data_ringbuf_iov_scatter(out_iov, out_offset, frame_bytes, framebuf);
+        }
+
+        resampler->phase += config->in_fs_hz;
+        out_offset += frame_bytes;
+    }
+
+    if ((data_ringbuf_commit_write_iov(out_data_buf_ptr, out_offset) != DATA_RINGBUF_STATUS_OK)
+     || (data_ringbuf_commit_read_iov(in_data_buf_ptr, in_offset) != DATA_RINGBUF_STATUS_OK))
+    {
+        debug_printf("resampler_data: Failed to commit resampled data\n\r");
+        return RESAMPLER_STATUS_FAIL;
+    }
+    *bytes_resampled = out_offset;
+    PERF_STATS_RECORD(&resampler->perf, start_ticks, out_offset);
+
+    return RESAMPLER_STATUS_OK;
+}
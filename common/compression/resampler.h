@@ -0,0 +1,140 @@
+/**
+ * @file resampler.h
+ *
+ * @brief Functions and prototypes exported by the streaming sample rate converter module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+#include "data_ringbuf.h"
+#include "perf_stats.h"
+
+/***********************************************************************************************************************
+ * LITERALS & CONSTANTS
+ **********************************************************************************************************************/
+
+/**
+ * @defgroup RESAMPLER_
+ * @brief Return values for sample rate converter API
+ *
+ * @{
+ */
+#define RESAMPLER_STATUS_OK                  (0)
+#define RESAMPLER_STATUS_FAIL                (1)
+
+#define RESAMPLER_CHANNELS_MAX               (2)
+#define RESAMPLER_TAPS                       (8)  // Taps of the interpolation filter, per output sample and channel
+#define RESAMPLER_PHASES                     (32) // Phases of the filter table, interpolated between
+
+/***********************************************************************************************************************
+ * MACROS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * Configuration of a sample rate converter
+ *
+ * Data is interleaved 16bit little-endian PCM, i.e. as produced by decompr_data() for the cs47l63.  No BSP uses the
+ * converter yet: the cs47l63 BSP plays at the capture rate, since running its I2S at 48kHz needs platform clocking
+ * changes.  Quality and throughput are checked by the host tests in unit_test/test_resampler.c.
+ */
+typedef struct
+{
+    uint32_t in_fs_hz;
+    uint32_t out_fs_hz;                             // At least in_fs_hz, e.g. 16000 to 48000, or 44100 to 48000
+    uint8_t channels;                               // 1 or 2
+} resampler_config_t;
+
+typedef struct
+{
+    resampler_config_t config;
+    uint32_t phase;                                 // Position of the next output after the oldest input, in out_fs_hz
+    uint32_t history_index;
+    // Input history, stored twice so that the last RESAMPLER_TAPS samples are always contiguous
+    int16_t history[RESAMPLER_CHANNELS_MAX][RESAMPLER_TAPS * 2];
+#ifdef CONFIG_PERF_STATS
+    perf_stats_t perf;
+#endif
+} resampler_t;
+
+/***********************************************************************************************************************
+ * GLOBAL VARIABLES
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Initialize a sample rate converter
+ *
+ * @param [in]
+ * - resampler           Pointer to the sample rate converter state structure
+ * - config              Pointer to the configuration
+ *
+ * @return
+ * - RESAMPLER_STATUS_FAIL       if the configuration is not supported
+ * - RESAMPLER_STATUS_OK         otherwise
+ *
+ */
+uint32_t resampler_init(resampler_t *resampler, const resampler_config_t *config);
+
+/**
+ * Convert the sample rate of PCM data from one data buffer into another
+ *
+ * Produces as many output frames as there is input for and space for.  Each output frame costs a fixed
+ * RESAMPLER_TAPS * 2 multiply-accumulates per channel, so the cost of a call is bounded by the space in
+ * \b out_data_buf_ptr.  The output is delayed by RESAMPLER_TAPS / 2 input samples.
+ *
+ * @param [in]
+ * - resampler            Pointer to the sample rate converter state structure
+ * - out_data_buf_ptr     Pointer to the data buffer to write the output data to
+ * - in_data_buf_ptr      Pointer to the data buffer containing the input data
+ *
+ * @param [out]
+ * - bytes_resampled      Pointer to the length of data added to the out_data_buf_ptr
+ *
+ * @return
+ * - RESAMPLER_STATUS_FAIL       Failed to commit the output data
+ * - RESAMPLER_STATUS_OK         otherwise
+ *
+ */
+uint32_t resampler_data(resampler_t *resampler,
+                        data_ringbuf_t *out_data_buf_ptr,
+                        data_ringbuf_t *in_data_buf_ptr,
+                        uint32_t *bytes_resampled);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RESAMPLER_H
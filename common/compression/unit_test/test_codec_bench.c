@@ -0,0 +1,307 @@
+/**
+ * @file test_codec_bench.c
+ *
+ * @brief Host benchmark of the decompression kernels
+ *
+ * Fixed compressed streams are fed through data ring buffers to each decompression format, as dspbuf does.  The
+ * output is checked and the throughput, in MB/s of decompressed output, is printed.  For packed16, the
+ * sample-at-a-time loop that the bulk kernels replaced is run on the same input as a reference.  For IMA-ADPCM, whole
+ * blocks of fixed pseudo-random codes are decoded.
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#define _POSIX_C_SOURCE 199309L         // clock_gettime()
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "ima_adpcm.h"
+#include "packed16.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_CHUNK_SAMPLES              (512)                               // packed16 samples written at a time
+#define TEST_CHUNK_COMPR_BYTES          (TEST_CHUNK_SAMPLES * PACKED16_COMPR_SAMPLE_BYTES)
+#define TEST_CHUNK_DECOMPR_BYTES        (TEST_CHUNK_SAMPLES * PACKED16_DECOMPR_SAMPLE_BYTES)
+#define TEST_COMPR_BUF_SIZE             (TEST_CHUNK_COMPR_BYTES * 2)
+#define TEST_DECOMPR_BUF_SIZE           (TEST_CHUNK_DECOMPR_BYTES * 2)
+#define TEST_BENCH_CHUNKS               (2048)                              // 6 MB of decompressed output a pass
+#define TEST_IMA_BLOCKS                 (3)                                 // Whole packed16 samples
+#define TEST_IMA_DECODED_BLOCK_BYTES    (IMA_ADPCM_SAMPLES_PER_BLOCK * sizeof(int16_t))
+#define TEST_PASSES                     (5)                                 // The fastest pass is reported
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+/**
+ * A way of decompressing a data buffer
+ */
+typedef uint32_t (*test_decompress_t)(void *context,
+                                      data_ringbuf_t *decompr_data_buf_ptr,
+                                      data_ringbuf_t *compr_data_buf_ptr,
+                                      uint32_t *bytes_decompressed);
+
+// Indices of the packed16 bytes of a sample within a compressed sample, for little-endian output
+static const uint32_t test_packed16_write_index[PACKED16_DECOMPR_SAMPLE_BYTES] = {3, 2, 1, 7, 6, 5};
+
+static uint8_t test_compr[TEST_CHUNK_COMPR_BYTES];
+static uint32_t test_compr_len;                                     // Bytes of test_compr fed in at a time
+static uint32_t test_chunk_decompr_len;                             // Bytes decompressed from them
+static uint8_t test_compr_mem[TEST_COMPR_BUF_SIZE];
+static uint8_t test_decompr_mem[TEST_DECOMPR_BUF_SIZE];
+static uint8_t test_out[TEST_CHUNK_DECOMPR_BYTES];
+static uint8_t test_ref_out[TEST_CHUNK_DECOMPR_BYTES];
+static data_ringbuf_t test_compr_buf;
+static data_ringbuf_t test_decompr_buf;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Free-running nanosecond count
+ *
+ */
+static uint64_t test_get_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * packed16 decompression a sample at a time through data_ringbuf_read()/data_ringbuf_write(), as it was before the
+ * bulk kernels, for little-endian output
+ *
+ */
+static uint32_t test_packed16_decompress_ref(void *context,
+                                             data_ringbuf_t *decompr_data_buf_ptr,
+                                             data_ringbuf_t *compr_data_buf_ptr,
+                                             uint32_t *bytes_decompressed)
+{
+    *bytes_decompressed = 0;
+    while ((data_ringbuf_data_length(compr_data_buf_ptr) >= PACKED16_COMPR_SAMPLE_BYTES)
+    &&     (data_ringbuf_free_space(decompr_data_buf_ptr) >= PACKED16_DECOMPR_SAMPLE_BYTES))
+    {
+        uint8_t samplebuf_compr[PACKED16_COMPR_SAMPLE_BYTES];
+        uint8_t samplebuf_decompr[PACKED16_DECOMPR_SAMPLE_BYTES];
+
+        if (data_ringbuf_read(compr_data_buf_ptr, &samplebuf_compr[0], PACKED16_COMPR_SAMPLE_BYTES)
+            != DATA_RINGBUF_STATUS_OK)
+        {
+            return DECOMPR_STATUS_FAIL;
+        }
+        for (uint32_t index = 0; index < PACKED16_DECOMPR_SAMPLE_BYTES; index++)
+        {
+            samplebuf_decompr[index] = samplebuf_compr[test_packed16_write_index[index]];
+        }
+        if (data_ringbuf_write(decompr_data_buf_ptr, &samplebuf_decompr[0], PACKED16_DECOMPR_SAMPLE_BYTES)
+            != DATA_RINGBUF_STATUS_OK)
+        {
+            return DECOMPR_STATUS_FAIL;
+        }
+        *bytes_decompressed += PACKED16_DECOMPR_SAMPLE_BYTES;
+    }
+
+    return DECOMPR_STATUS_OK;
+}
+
+/**
+ * Fill test_compr with a fixed pseudo-random packed16 stream, with the pad byte of every DSP word 0
+ *
+ */
+static void test_packed16_stream(void)
+{
+    uint32_t seed = 0x12345678;
+
+    for (uint32_t i = 0; i < TEST_CHUNK_COMPR_BYTES; i++)
+    {
+        seed = (seed * 1664525) + 1013904223;
+        test_compr[i] = ((i % 4) == 0) ? 0 : (uint8_t) (seed >> 24);
+    }
+    test_compr_len = TEST_CHUNK_COMPR_BYTES;
+    test_chunk_decompr_len = TEST_CHUNK_DECOMPR_BYTES;
+}
+
+/**
+ * Fill test_compr with TEST_IMA_BLOCKS IMA-ADPCM blocks of fixed pseudo-random codes, carried in packed16 format
+ *
+ */
+static void test_ima_adpcm_stream(void)
+{
+    uint8_t blocks[TEST_IMA_BLOCKS * IMA_ADPCM_BLOCK_SIZE];
+    void *packed16 = packed16_init(ENDIAN_LITTLE, NULL);
+    uint32_t seed = 0x87654321;
+
+    TEST_ASSERT_NOT_NULL(packed16);
+
+    for (uint32_t i = 0; i < sizeof(blocks); i++)
+    {
+        seed = (seed * 1664525) + 1013904223;
+        blocks[i] = (uint8_t) (seed >> 24);
+    }
+    for (uint32_t block = 0; block < TEST_IMA_BLOCKS; block++)
+    {
+        // First sample, a valid step index and the reserved byte
+        blocks[(block * IMA_ADPCM_BLOCK_SIZE) + 2] = (uint8_t) (20 + (block * 10));
+        blocks[(block * IMA_ADPCM_BLOCK_SIZE) + 3] = 0;
+    }
+
+    data_ringbuf_init(&test_compr_buf, test_compr, sizeof(test_compr));
+    TEST_ASSERT_EQUAL(sizeof(blocks), packed16_pack_ringbuf(packed16, &test_compr_buf, blocks, sizeof(blocks)));
+    packed16_deinit(packed16);
+
+    test_compr_len = data_ringbuf_data_length(&test_compr_buf);
+    test_chunk_decompr_len = TEST_IMA_BLOCKS * TEST_IMA_DECODED_BLOCK_BYTES;
+
+    // Keep the headers to check the decoded blocks against
+    memcpy(test_ref_out, blocks, sizeof(blocks));
+}
+
+/**
+ * Decompress one chunk of test_compr into out
+ *
+ */
+static void test_decompress_chunk(test_decompress_t decompress, void *context, uint8_t *out)
+{
+    uint32_t bytes;
+
+    data_ringbuf_init(&test_compr_buf, test_compr_mem, sizeof(test_compr_mem));
+    data_ringbuf_init(&test_decompr_buf, test_decompr_mem, sizeof(test_decompr_mem));
+
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_write(&test_compr_buf, test_compr, test_compr_len));
+    TEST_ASSERT_EQUAL(DECOMPR_STATUS_OK, decompress(context, &test_decompr_buf, &test_compr_buf, &bytes));
+    TEST_ASSERT_EQUAL(test_chunk_decompr_len, bytes);
+    TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK, data_ringbuf_read(&test_decompr_buf, out, bytes));
+}
+
+/**
+ * Feed test_compr through the data buffers a chunk at a time, discarding the output, and return the fastest pass
+ *
+ */
+static uint64_t test_bench(test_decompress_t decompress, void *context)
+{
+    uint64_t ns = UINT64_MAX;
+    uint32_t errors = 0;
+
+    // Make the buffers a sample short of whole chunks, so the chunks wrap at a different place each time
+    data_ringbuf_init(&test_compr_buf, test_compr_mem, sizeof(test_compr_mem) - PACKED16_COMPR_SAMPLE_BYTES);
+    data_ringbuf_init(&test_decompr_buf, test_decompr_mem, sizeof(test_decompr_mem) - PACKED16_DECOMPR_SAMPLE_BYTES);
+
+    for (uint32_t pass = 0; pass < TEST_PASSES; pass++)
+    {
+        uint64_t start_ns = test_get_ns();
+        uint64_t pass_ns;
+
+        for (uint32_t chunk = 0; chunk < TEST_BENCH_CHUNKS; chunk++)
+        {
+            uint32_t bytes;
+
+            errors += data_ringbuf_write(&test_compr_buf, test_compr, test_compr_len);
+            errors += decompress(context, &test_decompr_buf, &test_compr_buf, &bytes);
+            errors += (bytes != test_chunk_decompr_len);
+            bytes = data_ringbuf_data_length(&test_decompr_buf);
+            errors += data_ringbuf_commit_read_iov(&test_decompr_buf, bytes);
+        }
+        pass_ns = test_get_ns() - start_ns;
+        if (pass_ns < ns)
+        {
+            ns = pass_ns;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(0, errors);
+
+    return ns;
+}
+
+/**
+ * Print the throughput of a pass
+ *
+ */
+static void test_print_bench(const char *name, uint64_t ns)
+{
+    printf("codec bench %-26s %8.1f MB/s\n",
+           name,
+           (ns == 0) ? 0.0 : (((double) TEST_BENCH_CHUNKS * test_chunk_decompr_len * 1000.0) / (double) ns));
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(codec_bench);
+
+TEST_SETUP(codec_bench)
+{
+    memset(test_out, 0, sizeof(test_out));
+    memset(test_ref_out, 0, sizeof(test_ref_out));
+}
+
+TEST_TEAR_DOWN(codec_bench)
+{
+}
+
+TEST(codec_bench, packed16)
+{
+    void *packed16 = packed16_init(ENDIAN_LITTLE, NULL);
+
+    TEST_ASSERT_NOT_NULL(packed16);
+    test_packed16_stream();
+
+    // The bulk kernels must give the same output as the sample-at-a-time loop
+    test_decompress_chunk(test_packed16_decompress_ref, NULL, test_ref_out);
+    test_decompress_chunk(packed16_decompress, packed16, test_out);
+    TEST_ASSERT_EQUAL_MEMORY(test_ref_out, test_out, sizeof(test_out));
+
+    test_print_bench("packed16 sample at a time", test_bench(test_packed16_decompress_ref, NULL));
+    test_print_bench("packed16 bulk", test_bench(packed16_decompress, packed16));
+
+    packed16_deinit(packed16);
+}
+
+TEST(codec_bench, ima_adpcm)
+{
+    void *ima_adpcm = ima_adpcm_init(ENDIAN_LITTLE, NULL);
+
+    TEST_ASSERT_NOT_NULL(ima_adpcm);
+    test_ima_adpcm_stream();
+
+    // Every block decodes, starting with the first sample from its header
+    test_decompress_chunk(ima_adpcm_decompress, ima_adpcm, test_out);
+    for (uint32_t block = 0; block < TEST_IMA_BLOCKS; block++)
+    {
+        TEST_ASSERT_EQUAL_MEMORY(&test_ref_out[block * IMA_ADPCM_BLOCK_SIZE],
+                                 &test_out[block * TEST_IMA_DECODED_BLOCK_BYTES],
+                                 sizeof(int16_t));
+    }
+
+    test_print_bench("ima_adpcm block decode", test_bench(ima_adpcm_decompress, ima_adpcm));
+
+    ima_adpcm_deinit(ima_adpcm);
+}
+
+TEST_GROUP_RUNNER(codec_bench)
+{
+    RUN_TEST_CASE(codec_bench, packed16);
+    RUN_TEST_CASE(codec_bench, ima_adpcm);
+}
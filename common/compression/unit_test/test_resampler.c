@@ -0,0 +1,336 @@
+/**
+ * @file test_resampler.c
+ *
+ * @brief Unit tests and benchmark for the streaming sample rate converter
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "resampler.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_PI                         (3.14159265358979323846)
+#define TEST_IN_FRAMES                  (2048)
+#define TEST_OUT_FRAMES_MAX             (TEST_IN_FRAMES * 3 + 8)
+#define TEST_AMPLITUDE                  (16384.0)
+#define TEST_SETTLE_FRAMES              (64)    // Output frames skipped before fitting, covers the filter delay
+#define TEST_SINAD_MIN_DB               (50.0)
+#define TEST_BENCH_OUT_FRAMES           (4800000)
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+static resampler_t test_resampler;
+static int16_t test_in[TEST_IN_FRAMES * RESAMPLER_CHANNELS_MAX];
+static int16_t test_out[TEST_OUT_FRAMES_MAX * RESAMPLER_CHANNELS_MAX];
+static int16_t test_ref[TEST_OUT_FRAMES_MAX * RESAMPLER_CHANNELS_MAX];
+static uint8_t test_in_buf[(TEST_IN_FRAMES * RESAMPLER_CHANNELS_MAX * 2) + 4];
+static uint8_t test_out_buf[(TEST_OUT_FRAMES_MAX * RESAMPLER_CHANNELS_MAX * 2) + 4];
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Fill test_in with a sine on every channel, shifted by a quarter period on the second channel
+ *
+ */
+static void test_sine(uint32_t fs_hz, double freq_hz, uint8_t channels)
+{
+    for (uint32_t frame = 0; frame < TEST_IN_FRAMES; frame++)
+    {
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            double angle = (2.0 * TEST_PI * freq_hz * frame / fs_hz) + (channel * TEST_PI / 2.0);
+
+            test_in[(frame * channels) + channel] = (int16_t) lrint(TEST_AMPLITUDE * sin(angle));
+        }
+    }
+}
+
+/**
+ * Resample test_in into out, through data buffers of the given sizes fed and drained in chunks of chunk_bytes
+ *
+ * @return number of output frames
+ *
+ */
+static uint32_t test_run(const resampler_config_t *config,
+                         int16_t *out,
+                         uint32_t in_buf_size,
+                         uint32_t out_buf_size,
+                         uint32_t chunk_bytes)
+{
+    data_ringbuf_t in_data_buf;
+    data_ringbuf_t out_data_buf;
+    uint32_t frame_bytes = config->channels * 2;
+    uint32_t in_total = TEST_IN_FRAMES * frame_bytes;
+    uint32_t in_count = 0;
+    uint32_t out_count = 0;
+    uint32_t bytes_resampled;
+
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_OK, resampler_init(&test_resampler, config));
+    data_ringbuf_init(&in_data_buf, test_in_buf, in_buf_size);
+    data_ringbuf_init(&out_data_buf, test_out_buf, out_buf_size);
+
+    do
+    {
+        uint32_t len = in_total - in_count;
+
+        if (len > chunk_bytes)
+        {
+            len = chunk_bytes;
+        }
+        if (len > data_ringbuf_free_space(&in_data_buf))
+        {
+            len = data_ringbuf_free_space(&in_data_buf);
+        }
+        TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK,
+                          data_ringbuf_write(&in_data_buf, ((uint8_t *) test_in) + in_count, len));
+        in_count += len;
+
+        TEST_ASSERT_EQUAL(RESAMPLER_STATUS_OK,
+                          resampler_data(&test_resampler, &out_data_buf, &in_data_buf, &bytes_resampled));
+
+        len = data_ringbuf_data_length(&out_data_buf);
+        if (len > chunk_bytes)
+        {
+            len = chunk_bytes;
+        }
+        TEST_ASSERT_TRUE((out_count + len) <= (TEST_OUT_FRAMES_MAX * frame_bytes));
+        TEST_ASSERT_EQUAL(DATA_RINGBUF_STATUS_OK,
+                          data_ringbuf_read(&out_data_buf, ((uint8_t *) out) + out_count, len));
+        out_count += len;
+    } while ((in_count < in_total) || (bytes_resampled != 0) || (data_ringbuf_data_length(&out_data_buf) != 0));
+
+    TEST_ASSERT_EQUAL(0, out_count % frame_bytes);
+
+    return out_count / frame_bytes;
+}
+
+/**
+ * Signal to noise and distortion of one channel of the output, in dB
+ *
+ * Fits a sine of the expected frequency, with any phase and a DC offset, to the settled output by least squares and
+ * compares the fitted sine with everything else that is left.
+ *
+ */
+static double test_sinad_db(const int16_t *out, uint32_t frames, uint8_t channels, uint32_t fs_hz, double freq_hz)
+{
+    double m[3][3] = {{0}};
+    double v[3] = {0};
+    double basis[3];
+    double coeffs[3];
+    double det;
+    double signal = 0;
+    double noise = 0;
+
+    // Normal equations for out = a * sin + b * cos + c
+    for (uint32_t frame = TEST_SETTLE_FRAMES; frame < frames; frame++)
+    {
+        double angle = 2.0 * TEST_PI * freq_hz * frame / fs_hz;
+
+        basis[0] = sin(angle);
+        basis[1] = cos(angle);
+        basis[2] = 1.0;
+        for (uint32_t row = 0; row < 3; row++)
+        {
+            for (uint32_t col = 0; col < 3; col++)
+            {
+                m[row][col] += basis[row] * basis[col];
+            }
+            v[row] += basis[row] * out[frame * channels];
+        }
+    }
+
+    det = (m[0][0] * ((m[1][1] * m[2][2]) - (m[1][2] * m[2][1])))
+        - (m[0][1] * ((m[1][0] * m[2][2]) - (m[1][2] * m[2][0])))
+        + (m[0][2] * ((m[1][0] * m[2][1]) - (m[1][1] * m[2][0])));
+    for (uint32_t index = 0; index < 3; index++)
+    {
+        double mi[3][3];
+
+        // Cramer's rule
+        memcpy(mi, m, sizeof(mi));
+        for (uint32_t row = 0; row < 3; row++)
+        {
+            mi[row][index] = v[row];
+        }
+        coeffs[index] = ((mi[0][0] * ((mi[1][1] * mi[2][2]) - (mi[1][2] * mi[2][1])))
+                       - (mi[0][1] * ((mi[1][0] * mi[2][2]) - (mi[1][2] * mi[2][0])))
+                       + (mi[0][2] * ((mi[1][0] * mi[2][1]) - (mi[1][1] * mi[2][0])))) / det;
+    }
+
+    for (uint32_t frame = TEST_SETTLE_FRAMES; frame < frames; frame++)
+    {
+        double angle = 2.0 * TEST_PI * freq_hz * frame / fs_hz;
+        double fit = (coeffs[0] * sin(angle)) + (coeffs[1] * cos(angle));
+        double error = out[frame * channels] - fit - coeffs[2];
+
+        signal += fit * fit;
+        noise += error * error;
+    }
+
+    return 10.0 * log10(signal / noise);
+}
+
+/**
+ * Check the SINAD of a mono sine through the converter
+ *
+ */
+static void test_sinad_check(uint32_t in_fs_hz, uint32_t out_fs_hz, double freq_hz)
+{
+    resampler_config_t config = {.in_fs_hz = in_fs_hz, .out_fs_hz = out_fs_hz, .channels = 1};
+    uint32_t frames;
+    double sinad_db;
+
+    test_sine(in_fs_hz, freq_hz, 1);
+    frames = test_run(&config, test_out, sizeof(test_in_buf), sizeof(test_out_buf), sizeof(test_in_buf));
+    // Each input gives out_fs_hz / in_fs_hz outputs, with no drift
+    TEST_ASSERT_UINT32_WITHIN(4, ((uint64_t) TEST_IN_FRAMES * out_fs_hz) / in_fs_hz, frames);
+
+    sinad_db = test_sinad_db(test_out, frames, 1, out_fs_hz, freq_hz);
+    printf("resampler %lu->%lu Hz, %.0f Hz sine: SINAD %.1f dB\n",
+           (unsigned long) in_fs_hz, (unsigned long) out_fs_hz, freq_hz, sinad_db);
+    TEST_ASSERT_TRUE(sinad_db >= TEST_SINAD_MIN_DB);
+}
+
+/**
+ * Time the converter on a stream of TEST_BENCH_OUT_FRAMES output frames
+ *
+ */
+static void test_bench(uint32_t in_fs_hz, uint32_t out_fs_hz, uint8_t channels)
+{
+    resampler_config_t config = {.in_fs_hz = in_fs_hz, .out_fs_hz = out_fs_hz, .channels = channels};
+    data_ringbuf_t in_data_buf;
+    data_ringbuf_t out_data_buf;
+    uint32_t frame_bytes = channels * 2;
+    uint32_t out_frames = 0;
+    uint32_t bytes_resampled;
+    clock_t start;
+    double seconds;
+
+    test_sine(in_fs_hz, 1000.0, channels);
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_OK, resampler_init(&test_resampler, &config));
+    data_ringbuf_init(&in_data_buf, test_in_buf, 4096);
+    data_ringbuf_init(&out_data_buf, test_out_buf, 4096);
+
+    start = clock();
+    while (out_frames < TEST_BENCH_OUT_FRAMES)
+    {
+        uint32_t len = data_ringbuf_free_space(&in_data_buf);
+
+        len -= len % frame_bytes;
+        if (len > (TEST_IN_FRAMES * frame_bytes))
+        {
+            len = TEST_IN_FRAMES * frame_bytes;
+        }
+        data_ringbuf_write(&in_data_buf, (uint8_t *) test_in, len);
+        TEST_ASSERT_EQUAL(RESAMPLER_STATUS_OK,
+                          resampler_data(&test_resampler, &out_data_buf, &in_data_buf, &bytes_resampled));
+        data_ringbuf_bytes_read(&out_data_buf, bytes_resampled);
+        out_frames += bytes_resampled / frame_bytes;
+    }
+    seconds = ((double) (clock() - start)) / CLOCKS_PER_SEC;
+
+    printf("resampler %lu->%lu Hz, %u channel(s): %.1f M output samples/s, %.1f x real time\n",
+           (unsigned long) in_fs_hz, (unsigned long) out_fs_hz, (unsigned int) channels,
+           (out_frames * (double) channels) / (seconds * 1000000.0), out_frames / (seconds * out_fs_hz));
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(resampler);
+
+TEST_SETUP(resampler)
+{
+    memset(test_out, 0, sizeof(test_out));
+    memset(test_ref, 0, sizeof(test_ref));
+}
+
+TEST_TEAR_DOWN(resampler)
+{
+}
+
+TEST(resampler, init_rejects_unsupported_config)
+{
+    resampler_config_t config = {.in_fs_hz = 16000, .out_fs_hz = 48000, .channels = 0};
+
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_FAIL, resampler_init(&test_resampler, &config));
+    config.channels = RESAMPLER_CHANNELS_MAX + 1;
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_FAIL, resampler_init(&test_resampler, &config));
+    config.channels = 1;
+    config.out_fs_hz = 8000;
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_FAIL, resampler_init(&test_resampler, &config));
+    config.in_fs_hz = 0;
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_FAIL, resampler_init(&test_resampler, &config));
+    config.in_fs_hz = 16000;
+    config.out_fs_hz = 48000;
+    TEST_ASSERT_EQUAL(RESAMPLER_STATUS_OK, resampler_init(&test_resampler, &config));
+}
+
+TEST(resampler, sinad_16k_to_48k)
+{
+    test_sinad_check(16000, 48000, 1000.0);
+    test_sinad_check(16000, 48000, 3000.0);
+}
+
+TEST(resampler, sinad_44k1_to_48k)
+{
+    test_sinad_check(44100, 48000, 1000.0);
+    test_sinad_check(44100, 48000, 3000.0);
+}
+
+TEST(resampler, chunked_wrapping_matches_single_pass)
+{
+    resampler_config_t config = {.in_fs_hz = 44100, .out_fs_hz = 48000, .channels = 2};
+    uint32_t ref_frames;
+    uint32_t frames;
+
+    test_sine(44100, 1000.0, 2);
+    ref_frames = test_run(&config, test_ref, sizeof(test_in_buf), sizeof(test_out_buf), sizeof(test_in_buf));
+
+    // Buffer sizes that are not a multiple of the frame size, so that frames straddle the wrap
+    frames = test_run(&config, test_out, 62, 54, 6);
+    TEST_ASSERT_EQUAL(ref_frames, frames);
+    TEST_ASSERT_EQUAL_MEMORY(test_ref, test_out, frames * config.channels * 2);
+}
+
+TEST(resampler, bench_throughput)
+{
+    test_bench(16000, 48000, 1);
+    test_bench(16000, 48000, 2);
+    test_bench(44100, 48000, 2);
+}
+
+TEST_GROUP_RUNNER(resampler)
+{
+    RUN_TEST_CASE(resampler, init_rejects_unsupported_config);
+    RUN_TEST_CASE(resampler, sinad_16k_to_48k);
+    RUN_TEST_CASE(resampler, sinad_44k1_to_48k);
+    RUN_TEST_CASE(resampler, chunked_wrapping_matches_single_pass);
+    RUN_TEST_CASE(resampler, bench_throughput);
+}
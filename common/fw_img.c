@@ -23,6 +23,7 @@
  * INCLUDES
  **********************************************************************************************************************/
 #include <stddef.h>
+#include <string.h>
 #include "fw_img.h"
 
 /***********************************************************************************************************************
@@ -111,6 +112,10 @@ static uint32_t fw_img_process_data(fw_img_boot_state_t *state)
             ret = fw_img_copy_data(state, fw_info->alg_id_list, fw_info->header.alg_id_list_size * sizeof(fw_info->header.alg_id_list_size));
             break;
 
+        case FW_IMG_BOOT_STATE_READ_COEFF_SET_INDEX:
+            ret = fw_img_copy_data(state, (uint32_t *) fw_info->coeff_set_index, fw_info->header.coeff_sets * sizeof(fw_img_v3_coeff_set_t));
+            break;
+
         case FW_IMG_BOOT_STATE_READ_DATA_HEADER:
             if (fw_info->header.data_blocks > 0)
             {
@@ -187,6 +192,138 @@ static uint32_t fw_img_process_data(fw_img_boot_state_t *state)
     return ret;
 }
 
+/**
+ * Completion callback for reads issued by the fw_img reader
+ *
+ * @param [in] status           FW_IMG_STATUS_OK if the read succeeded
+ * @param [in] arg              Pointer to the fw_img reader
+ *
+ */
+static void fw_img_reader_cb(uint32_t status, void *arg)
+{
+    fw_img_reader_t *reader = (fw_img_reader_t *) arg;
+
+    reader->fill_status = status;
+    reader->fill_done = true;
+}
+
+/**
+ * Wait for the outstanding read of a fw_img reader to complete
+ *
+ * @param [in] reader           Pointer to the fw_img reader
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL         if the read failed
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+static uint32_t fw_img_reader_wait(fw_img_reader_t *reader)
+{
+    while (!reader->fill_done)
+    {
+        if (reader->wait != NULL)
+        {
+            reader->wait(reader->read_arg);
+        }
+    }
+
+    return (reader->fill_status == FW_IMG_STATUS_OK) ? FW_IMG_STATUS_OK : FW_IMG_STATUS_FAIL;
+}
+
+/**
+ * Issue a read of the next part of the fw_img into the half of the reader buffer not being processed
+ *
+ * @param [in] reader           Pointer to the fw_img reader
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL         if the source read could not be started
+ * - FW_IMG_STATUS_NODATA       if there is no more of the fw_img to read
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+static uint32_t fw_img_reader_fill(fw_img_reader_t *reader)
+{
+    uint32_t ret;
+
+    if (reader->offset >= reader->end)
+    {
+        reader->fill_length = 0;
+        return FW_IMG_STATUS_NODATA;
+    }
+
+    reader->fill_index ^= 1;
+    reader->fill_length = reader->end - reader->offset;
+    if (reader->fill_length > reader->half_size)
+    {
+        reader->fill_length = reader->half_size;
+    }
+    reader->fill_done = false;
+    reader->fill_status = FW_IMG_STATUS_OK;
+
+    ret = reader->read(reader->read_arg,
+                       reader->offset,
+                       reader->buffer + (reader->fill_index * reader->half_size),
+                       reader->fill_length,
+                       fw_img_reader_cb,
+                       reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        reader->fill_length = 0;
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    reader->offset += reader->fill_length;
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * Check the members of a fw_img reader initialised by the user, then read IMG_SIZE from its source
+ *
+ * @param [in] reader           Pointer to the fw_img reader
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL         if the reader is not valid, the source read fails or IMG_SIZE is too small
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+static uint32_t fw_img_reader_open(fw_img_reader_t *reader)
+{
+    uint32_t ret;
+
+    if (reader == NULL || reader->read == NULL || reader->buffer == NULL ||
+        (reader->buffer_size % 8) != 0 ||
+        (reader->buffer_size / 2) < (sizeof(fw_img_preheader_t) + sizeof(fw_img_v3_header_t)))
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    reader->half_size = reader->buffer_size / 2;
+    reader->offset = 0;
+    reader->fill_index = 1;
+    reader->fill_length = 0;
+
+    // Read just enough to get IMG_SIZE, so reads are never issued past the end of the fw_img
+    reader->fill_done = false;
+    ret = reader->read(reader->read_arg, 0, reader->buffer, FW_IMG_SIZE_BYTES, fw_img_reader_cb, reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+    if (fw_img_reader_wait(reader) != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    reader->img_size = FW_IMG_SIZE(reader->buffer);
+    if (reader->img_size < FW_IMG_SIZE_BYTES)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    return FW_IMG_STATUS_OK;
+}
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
@@ -216,6 +353,7 @@ uint32_t fw_img_read_header(fw_img_boot_state_t *state)
     else
     {
         state->count = 0;
+        memset(&fw_info->header, 0, sizeof(fw_info->header));
         switch (fw_info->preheader.img_format_rev)
         {
             case 1:
@@ -234,6 +372,14 @@ uint32_t fw_img_read_header(fw_img_boot_state_t *state)
                 }
                 state->count = 0;
                 break;
+            case 3:
+                ret = fw_img_copy_data(state, (uint32_t *)(&fw_info->header), sizeof(fw_img_v3_header_t));
+                if (ret != FW_IMG_STATUS_AGAIN)
+                {
+                    ret = FW_IMG_STATUS_FAIL;
+                }
+                state->count = 0;
+                break;
             default:
                 ret = FW_IMG_STATUS_FAIL;
                 break;
@@ -277,15 +423,38 @@ uint32_t fw_img_process(fw_img_boot_state_t *state)
  * Find if a symbol is in the symbol table and return its address if it is.
  *
  */
-uint32_t fw_img_find_symbol(fw_img_info_t *fw_info, uint32_t symbol_id)
+uint32_t fw_img_find_symbol(const fw_img_info_t *fw_info, uint32_t symbol_id)
 {
-    if (fw_info)
+    if (fw_info && fw_info->sym_table_sorted)
+    {
+        uint32_t low = 0;
+        uint32_t high = fw_info->header.sym_table_size;
+
+        while (low < high)
+        {
+            uint32_t mid = low + ((high - low) / 2);
+
+            if (fw_info->const_sym_table[mid].sym_id == symbol_id)
+            {
+                return fw_info->const_sym_table[mid].sym_addr;
+            }
+            else if (fw_info->const_sym_table[mid].sym_id < symbol_id)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+    }
+    else if (fw_info)
     {
         for (uint32_t i = 0; i < fw_info->header.sym_table_size; i++)
         {
-            if (fw_info->sym_table[i].sym_id == symbol_id)
+            if (fw_info->const_sym_table[i].sym_id == symbol_id)
             {
-                return fw_info->sym_table[i].sym_addr;
+                return fw_info->const_sym_table[i].sym_addr;
             }
         }
     }
@@ -296,16 +465,239 @@ uint32_t fw_img_find_symbol(fw_img_info_t *fw_info, uint32_t symbol_id)
 /**
  * Find if an algorithm is in the algorithm list.
  */
-bool fw_img_find_algid(fw_img_info_t *fw_info, uint32_t alg_id)
+bool fw_img_find_algid(const fw_img_info_t *fw_info, uint32_t alg_id)
 {
     if (fw_info)
     {
         for (uint32_t i = 0; i < fw_info->header.alg_id_list_size; i++)
         {
-            if (fw_info->alg_id_list[i] == alg_id)
+            if (fw_info->const_alg_id_list[i] == alg_id)
                 return true;
         }
     }
 
     return false;
 }
+
+/**
+ * Prepare to process a single coefficient set of a fw_img_v3
+ *
+ */
+uint32_t fw_img_coeff_set_start(fw_img_boot_state_t *state, uint32_t coeff_set)
+{
+    fw_img_info_t *fw_info;
+
+    if (state == NULL)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    fw_info = &state->fw_info;
+    if (fw_info->preheader.img_format_rev != 3 ||
+        fw_info->coeff_set_index == NULL ||
+        coeff_set >= fw_info->header.coeff_sets)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    // Each coefficient set is terminated by its own IMG_MAGIC_NUMBER_2 and checksum, so start the state machine at
+    // the data blocks and start a new checksum
+    fw_info->header.data_blocks = fw_info->coeff_set_index[coeff_set].data_blocks;
+    state->state = FW_IMG_BOOT_STATE_READ_DATA_HEADER;
+    state->count = 0;
+    state->c0 = 0;
+    state->c1 = 0;
+    state->fw_img_blocks_end = NULL;
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * Start streaming a fw_img from a reader
+ *
+ */
+uint32_t fw_img_reader_start(fw_img_reader_t *reader)
+{
+    uint32_t ret;
+
+    ret = fw_img_reader_open(reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+    reader->end = reader->img_size;
+
+    // Start the read of the first block
+    ret = fw_img_reader_fill(reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * Start streaming part of a fw_img from a reader
+ *
+ */
+uint32_t fw_img_reader_start_at(fw_img_reader_t *reader, uint32_t offset, uint32_t length)
+{
+    uint32_t ret;
+
+    ret = fw_img_reader_open(reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    if ((offset % sizeof(uint32_t)) != 0 || offset > reader->img_size || length > (reader->img_size - offset))
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+    reader->offset = offset;
+    reader->end = offset + length;
+
+    // Start the read of the first block of the part, rather than of the start of the fw_img
+    ret = fw_img_reader_fill(reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * Provide the next fw_img block from a reader to the fw_img boot state
+ *
+ */
+uint32_t fw_img_reader_next(fw_img_reader_t *reader, fw_img_boot_state_t *state)
+{
+    uint32_t ret;
+    uint8_t *block;
+    uint32_t block_size;
+
+    if (reader == NULL || state == NULL)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    if (reader->fill_length == 0)
+    {
+        return FW_IMG_STATUS_NODATA;
+    }
+
+    // Wait for the outstanding read to complete
+    if (fw_img_reader_wait(reader) != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    block = reader->buffer + (reader->fill_index * reader->half_size);
+    block_size = reader->fill_length;
+
+    // Read ahead into the other half whilst this block is processed
+    ret = fw_img_reader_fill(reader);
+    if (ret == FW_IMG_STATUS_FAIL)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    state->fw_img_blocks = block;
+    state->fw_img_blocks_size = block_size;
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * Move a reader to a different part of the fw_img
+ *
+ */
+uint32_t fw_img_reader_seek(fw_img_reader_t *reader, uint32_t offset, uint32_t length)
+{
+    uint32_t ret;
+
+    if (reader == NULL || reader->read == NULL ||
+        (offset % sizeof(uint32_t)) != 0 ||
+        offset > reader->img_size || length > (reader->img_size - offset))
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    // Wait for any read-ahead to complete before its half of the buffer can be reused
+    if (reader->fill_length != 0)
+    {
+        fw_img_reader_wait(reader);
+    }
+
+    reader->offset = offset;
+    reader->end = offset + length;
+
+    ret = fw_img_reader_fill(reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * fw_img_read_t implementation for a memory-mapped fw_img
+ *
+ */
+uint32_t fw_img_memory_read(void *arg,
+                            uint32_t offset,
+                            uint8_t *buffer,
+                            uint32_t length,
+                            bsp_callback_t cb,
+                            void *cb_arg)
+{
+    fw_img_memory_source_t *source = (fw_img_memory_source_t *) arg;
+
+    if (source == NULL || source->fw_img == NULL)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    memcpy(buffer, source->fw_img + offset, length);
+    cb(FW_IMG_STATUS_OK, cb_arg);
+
+    return FW_IMG_STATUS_OK;
+}
+
+#ifdef UNIT_TESTS
+/**
+ * fw_img_read_t implementation for a fw_img stored in a file on the host
+ *
+ */
+uint32_t fw_img_file_read(void *arg,
+                          uint32_t offset,
+                          uint8_t *buffer,
+                          uint32_t length,
+                          bsp_callback_t cb,
+                          void *cb_arg)
+{
+    fw_img_file_source_t *source = (fw_img_file_source_t *) arg;
+
+    if (source == NULL || source->file == NULL)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    if (fseek(source->file, offset, SEEK_SET) != 0)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    if (fread(buffer, 1, length, source->file) != length)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    cb(FW_IMG_STATUS_OK, cb_arg);
+
+    return FW_IMG_STATUS_OK;
+}
+#endif
@@ -32,6 +32,10 @@ extern "C" {
  **********************************************************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include "bsp_driver_if.h"
+#ifdef UNIT_TESTS
+#include <stdio.h>
+#endif
 
 /***********************************************************************************************************************
  * LITERALS, CONSTANTS, MACROS
@@ -61,11 +65,12 @@ extern "C" {
 #define FW_IMG_BOOT_STATE_INIT                         (0)
 #define FW_IMG_BOOT_STATE_READ_SYMBOLS                 (1)
 #define FW_IMG_BOOT_STATE_READ_ALGIDS                  (2)
-#define FW_IMG_BOOT_STATE_READ_DATA_HEADER             (3)
-#define FW_IMG_BOOT_STATE_WRITE_DATA                   (4)
-#define FW_IMG_BOOT_STATE_READ_MAGICNUM2               (5)
-#define FW_IMG_BOOT_STATE_READ_CHECKSUM                (6)
-#define FW_IMG_BOOT_STATE_DONE                         (7)
+#define FW_IMG_BOOT_STATE_READ_COEFF_SET_INDEX         (3)
+#define FW_IMG_BOOT_STATE_READ_DATA_HEADER             (4)
+#define FW_IMG_BOOT_STATE_WRITE_DATA                   (5)
+#define FW_IMG_BOOT_STATE_READ_MAGICNUM2               (6)
+#define FW_IMG_BOOT_STATE_READ_CHECKSUM                (7)
+#define FW_IMG_BOOT_STATE_DONE                         (8)
  /** @} */
 
 /**
@@ -87,6 +92,13 @@ extern "C" {
 
 #define FW_IMG_MODVAL                                   ((1 << 16) - 1)
 
+/**
+ * Number of bytes at the start of every fw_img needed to determine IMG_SIZE
+ *
+ * @see FW_IMG_SIZE
+ */
+#define FW_IMG_SIZE_BYTES                               (12)
+
 /***********************************************************************************************************************
  * ENUMS, STRUCTS, UNIONS, TYPEDEFS
  **********************************************************************************************************************/
@@ -147,17 +159,82 @@ typedef struct
     uint32_t fw_img_release;
 } fw_img_v2_header_t;
 
+/**
+ * Header for fw_img_v3
+ *
+ * A fw_img_v3 is a container of a single firmware and a number of coefficient sets (i.e. tunings).  The symbol table,
+ * algorithm ID list and firmware data blocks are shared, and are followed by IMG_MAGIC_NUMBER_2 and IMG_CHECKSUM as in
+ * fw_img_v2.  Each coefficient set is then appended with its own data blocks, IMG_MAGIC_NUMBER_2 and checksum, so that
+ * any one of them can be loaded on its own.  IMG_SIZE is the size of the whole container.
+ */
+typedef struct
+{
+    uint32_t img_size;
+    uint32_t sym_table_size;
+    uint32_t alg_id_list_size;
+    uint32_t fw_id;
+    uint32_t fw_version;
+    uint32_t data_blocks;
+    uint32_t max_block_size;
+    uint32_t fw_img_release;
+    uint32_t coeff_sets;
+} fw_img_v3_header_t;
+
+/**
+ * Coefficient set index entry for fw_img_v3
+ */
+typedef struct
+{
+    uint32_t offset;                            // Offset in bytes of the coefficient set from the start of the fw_img
+    uint32_t size;                              // Size in bytes of the coefficient set, including magic and checksum
+    uint32_t data_blocks;                       // Number of data blocks in the coefficient set
+} fw_img_v3_coeff_set_t;
+
 /**
  * Data structure to describe HALO firmware info
  */
 typedef struct
 {
     fw_img_preheader_t preheader;
-    fw_img_v2_header_t header;
-    fw_img_v1_sym_table_t *sym_table;
-    uint32_t *alg_id_list;
+    fw_img_v3_header_t header;
+    union
+    {
+        fw_img_v1_sym_table_t *sym_table;               // Buffer filled in by fw_img_process()
+        const fw_img_v1_sym_table_t *const_sym_table;   // Read-only view of the table, i.e. for a table in flash
+    };
+    union
+    {
+        uint32_t *alg_id_list;                          // Buffer filled in by fw_img_process()
+        const uint32_t *const_alg_id_list;              // Read-only view of the list, i.e. for a list in flash
+    };
+    fw_img_v3_coeff_set_t *coeff_set_index;     // Only used for fw_img_v3
+    bool sym_table_sorted;                      // Set if sym_table is in ascending order of sym_id
 } fw_img_info_t;
 
+/**
+ * Data block of a pre-linked fw_img
+ */
+typedef struct
+{
+    uint32_t block_size;
+    uint32_t block_addr;
+    const uint8_t *bytes;                       // Pointer into the pre-linked fw_img payload, word-aligned
+} fw_img_prelinked_block_t;
+
+/**
+ * Pre-linked fw_img, as exported by the firmware_converter 'fw_img_prelinked' command
+ *
+ * The header, symbol table, algorithm ID list and data block descriptors are all parsed at build time into const
+ * tables, so the device can be booted directly from them without fw_img_read_header()/fw_img_process() or any heap.
+ * fw_info.header.data_blocks is the number of entries in blocks.  The tables are only referenced through the
+ * const_sym_table and const_alg_id_list members of fw_info, so must be passed on as a const fw_img_info_t.
+ */
+typedef struct
+{
+    fw_img_info_t fw_info;
+    const fw_img_prelinked_block_t *blocks;
+} fw_img_prelinked_t;
+
 /**
  * Data structure to describe HALO firmware and coefficient download.
  */
@@ -183,6 +260,80 @@ typedef struct
     uint32_t c1;                                // Component 1, used for calculation of the fw_img's fletcher-32 checksum
 } fw_img_boot_state_t;
 
+/**
+ * Callback type for reading fw_img bytes from a streaming source
+ *
+ * The source may complete the read synchronously, calling \b cb before returning, or asynchronously (i.e. via DMA),
+ * calling \b cb once the bytes are in \b buffer.  \b cb must be called exactly once for every call that returns
+ * FW_IMG_STATUS_OK.
+ *
+ * @param [in] arg              Argument registered in fw_img_reader_t member read_arg
+ * @param [in] offset           Byte offset into the fw_img of the first byte to read
+ * @param [out] buffer          Pointer to buffer to read bytes into
+ * @param [in] length           Number of bytes to read
+ * @param [in] cb               Callback to call once the read has completed
+ * @param [in] cb_arg           Argument to pass to \b cb
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL         if the read could not be started
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+typedef uint32_t (*fw_img_read_t)(void *arg,
+                                  uint32_t offset,
+                                  uint8_t *buffer,
+                                  uint32_t length,
+                                  bsp_callback_t cb,
+                                  void *cb_arg);
+
+/**
+ * Data structure to describe a streaming fw_img source
+ *
+ * The buffer is split into two halves.  Whilst fw_img_process() is consuming one half, the next read from the source
+ * is issued into the other half, so sources that complete asynchronously overlap with control port writes.
+ */
+typedef struct
+{
+    fw_img_read_t read;                         // Initialised by user
+    void *read_arg;                             // Initialised by user
+    void (*wait)(void *read_arg);               // Initialised by user, optional - called repeatedly while waiting
+                                                // for a read to complete, i.e. to yield to other tasks
+    uint8_t *buffer;                            // Initialised by user
+    uint32_t buffer_size;                       // Initialised by user, must be a multiple of 8 bytes and each half
+                                                // must hold the whole fw_img header
+
+    uint32_t img_size;
+    uint32_t offset;
+    uint32_t end;
+    uint32_t half_size;
+    uint8_t fill_index;
+    uint32_t fill_length;
+    volatile bool fill_done;
+    volatile uint32_t fill_status;
+} fw_img_reader_t;
+
+/**
+ * Data structure to describe a fw_img that is memory-mapped
+ *
+ * @see fw_img_memory_read
+ */
+typedef struct
+{
+    const uint8_t *fw_img;
+} fw_img_memory_source_t;
+
+#ifdef UNIT_TESTS
+/**
+ * Data structure to describe a fw_img stored in a file on the host
+ *
+ * @see fw_img_file_read
+ */
+typedef struct
+{
+    FILE *file;
+} fw_img_file_source_t;
+#endif
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
@@ -226,7 +377,8 @@ extern uint32_t fw_img_process(fw_img_boot_state_t *state);
  * Find if a symbol is in the symbol table and return its address if it is.
  *
  * This will search through the symbol table pointed to in the 'fw_info' member of the driver state and return
- * the control port register address to use for access.  The 'symbol_id' parameter must be from the list of
+ * the control port register address to use for access.  If fw_info member sym_table_sorted is set, a binary search
+ * is used.  The 'symbol_id' parameter must be from the list of
  * <driver>_SYM_* defines in the <driver>_sym.h.
  *
  * @param [in] fw_info          Pointer to the data structure describing FW Info
@@ -237,7 +389,7 @@ extern uint32_t fw_img_process(fw_img_boot_state_t *state);
  * - 0 - symbol not found.
  *
  */
-uint32_t fw_img_find_symbol(fw_img_info_t *fw_info, uint32_t symbol_id);
+uint32_t fw_img_find_symbol(const fw_img_info_t *fw_info, uint32_t symbol_id);
 
 /**
  * Find if an algorithm is in the algorithm list.
@@ -252,7 +404,139 @@ uint32_t fw_img_find_symbol(fw_img_info_t *fw_info, uint32_t symbol_id);
  * - false - algorithm is not present in fw_img
  *
  */
-bool fw_img_find_algid(fw_img_info_t *fw_info, uint32_t alg_id);
+bool fw_img_find_algid(const fw_img_info_t *fw_info, uint32_t alg_id);
+
+/**
+ * Prepare to process a single coefficient set of a fw_img_v3
+ *
+ * The fw_img must have been processed previously with the same \b state (or with member fw_info restored from a
+ * previous boot), so that the header and coefficient set index are available and nothing needs to be re-parsed.
+ * After this call, fw_img bytes starting from fw_info.coeff_set_index[coeff_set].offset must be provided to
+ * fw_img_process() as usual.  fw_img_process() returns FW_IMG_STATUS_OK once the checksum of the coefficient set
+ * has been verified.
+ *
+ * @param [in] state            Pointer to the fw_img boot state
+ * @param [in] coeff_set        Index of the coefficient set to process
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL if:
+ *      - any NULL pointers
+ *      - fw_img is not fw_img_v3
+ *      - coeff_set is out of range
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+uint32_t fw_img_coeff_set_start(fw_img_boot_state_t *state, uint32_t coeff_set);
+
+/**
+ * Start streaming a fw_img from a reader
+ *
+ * Reads IMG_SIZE from the source and issues the first read.  Members read, read_arg, buffer and buffer_size of the
+ * reader must be initialised by the user before calling.
+ *
+ * @param [in] reader           Pointer to the fw_img reader
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL if:
+ *      - any NULL pointers
+ *      - buffer_size is not a non-zero multiple of 8
+ *      - the source read fails
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+uint32_t fw_img_reader_start(fw_img_reader_t *reader);
+
+/**
+ * Start streaming part of a fw_img from a reader
+ *
+ * As fw_img_reader_start(), but the first read is issued from \b offset and the reader will not read past
+ * \b offset + \b length.  Used to random-access a coefficient set of a fw_img_v3 after fw_img_coeff_set_start(),
+ * without first reading ahead from the start of the fw_img.
+ *
+ * @param [in] reader           Pointer to the fw_img reader
+ * @param [in] offset           Byte offset into the fw_img to read from
+ * @param [in] length           Number of bytes to read from \b offset
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL if:
+ *      - any NULL pointers
+ *      - buffer_size is not a non-zero multiple of 8
+ *      - offset and length are not within the fw_img, or offset is not word-aligned
+ *      - the source read fails
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+uint32_t fw_img_reader_start_at(fw_img_reader_t *reader, uint32_t offset, uint32_t length);
+
+/**
+ * Provide the next fw_img block from a reader to the fw_img boot state
+ *
+ * Waits for the outstanding read to complete, points fw_img_blocks/fw_img_blocks_size of \b state at it and then
+ * issues the read for the following block.  Should be called to start processing and whenever fw_img_process()
+ * returns FW_IMG_STATUS_NODATA.
+ *
+ * @param [in] reader           Pointer to the fw_img reader
+ * @param [in] state            Pointer to the fw_img boot state
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL         if the source read failed
+ * - FW_IMG_STATUS_NODATA       if the entire fw_img has already been provided
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+uint32_t fw_img_reader_next(fw_img_reader_t *reader, fw_img_boot_state_t *state);
+
+/**
+ * Move a reader to a different part of the fw_img
+ *
+ * Waits for any outstanding read to complete, then issues a read from \b offset.  The reader will not read past
+ * \b offset + \b length.  Used to random-access a coefficient set of a fw_img_v3 after fw_img_coeff_set_start().
+ *
+ * @param [in] reader           Pointer to the fw_img reader, previously started with fw_img_reader_start()
+ * @param [in] offset           Byte offset into the fw_img to read from
+ * @param [in] length           Number of bytes to read from \b offset
+ *
+ * @return
+ * - FW_IMG_STATUS_FAIL if:
+ *      - any NULL pointers
+ *      - offset and length are not within the fw_img, or offset is not word-aligned
+ *      - the source read fails
+ * - FW_IMG_STATUS_OK           otherwise
+ *
+ */
+uint32_t fw_img_reader_seek(fw_img_reader_t *reader, uint32_t offset, uint32_t length);
+
+/**
+ * fw_img_read_t implementation for a memory-mapped fw_img
+ *
+ * @param [in] arg              Pointer to fw_img_memory_source_t
+ *
+ * @see fw_img_read_t
+ *
+ */
+uint32_t fw_img_memory_read(void *arg,
+                            uint32_t offset,
+                            uint8_t *buffer,
+                            uint32_t length,
+                            bsp_callback_t cb,
+                            void *cb_arg);
+
+#ifdef UNIT_TESTS
+/**
+ * fw_img_read_t implementation for a fw_img stored in a file on the host
+ *
+ * @param [in] arg              Pointer to fw_img_file_source_t
+ *
+ * @see fw_img_read_t
+ *
+ */
+uint32_t fw_img_file_read(void *arg,
+                          uint32_t offset,
+                          uint8_t *buffer,
+                          uint32_t length,
+                          bsp_callback_t cb,
+                          void *cb_arg);
+#endif
 
 /**********************************************************************************************************************/
 #ifdef __cplusplus
@@ -0,0 +1,115 @@
+/**
+ * @file perf_stats.c
+ *
+ * @brief Performance statistics module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "perf_stats.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+static uint32_t (*perf_stats_get_ticks_fn)(void) = NULL;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Get the histogram bucket for a latency, i.e. the number of significant bits
+ *
+ */
+static inline uint32_t perf_stats_bucket(uint32_t ticks)
+{
+    uint32_t bucket = (ticks == 0) ? 0 : (32 - __builtin_clz(ticks));
+
+    return (bucket < PERF_STATS_BUCKETS) ? bucket : (PERF_STATS_BUCKETS - 1);
+}
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+void perf_stats_set_time_source(uint32_t (*get_ticks)(void))
+{
+    perf_stats_get_ticks_fn = get_ticks;
+}
+
+uint32_t perf_stats_get_ticks(void)
+{
+    return (perf_stats_get_ticks_fn != NULL) ? perf_stats_get_ticks_fn() : 0;
+}
+
+void perf_stats_record(perf_stats_t *stats, uint32_t start_ticks, uint32_t bytes)
+{
+    // Unsigned subtraction copes with the tick count wrapping
+    uint32_t ticks = perf_stats_get_ticks() - start_ticks;
+
+    stats->calls++;
+    stats->bytes += bytes;
+    stats->ticks += ticks;
+    if (ticks > stats->max_ticks)
+    {
+        stats->max_ticks = ticks;
+    }
+    stats->histogram[perf_stats_bucket(ticks)]++;
+}
+
+void perf_stats_reset(perf_stats_t *stats)
+{
+    memset(stats, 0, sizeof(perf_stats_t));
+}
+
+uint32_t perf_stats_get_percentile(perf_stats_t *stats, uint32_t percent)
+{
+    uint64_t target = (((uint64_t) stats->calls * percent) + 99) / 100;
+    uint64_t count = 0;
+
+    for (uint32_t bucket = 0; bucket < PERF_STATS_BUCKETS; bucket++)
+    {
+        count += stats->histogram[bucket];
+        if ((count >= target) && (count > 0))
+        {
+            uint32_t bound = (bucket == 0) ? 0 : (uint32_t) ((1ULL << bucket) - 1);
+
+            // Nothing took longer than the worst case seen, which also bounds the top bucket
+            return (bound < stats->max_ticks) ? bound : stats->max_ticks;
+        }
+    }
+
+    return 0;
+}
+
+uint32_t perf_stats_get_throughput(perf_stats_t *stats, uint32_t ticks_per_sec)
+{
+    if (stats->ticks == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t) ((stats->bytes * ticks_per_sec) / stats->ticks);
+}
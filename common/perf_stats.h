@@ -0,0 +1,150 @@
+/**
+ * @file perf_stats.h
+ *
+ * @brief Functions and prototypes exported by the performance statistics module
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2026 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+
+/***********************************************************************************************************************
+ * LITERALS, CONSTANTS, MACROS
+ **********************************************************************************************************************/
+
+/**
+ * Number of latency histogram buckets, bucket n counting calls that took from 2^(n-1) to 2^n - 1 ticks
+ */
+#define PERF_STATS_BUCKETS                             (32)
+
+/*
+ * If CONFIG_PERF_STATS is defined (i.e. CONFIG_PERF_STATS=1 in the makefile), each stage of the audio pipeline
+ * (dspbuf_read(), decompr_data(), compr_data(), fmtconv_data() and resampler_data()) records the bytes it produced
+ * and the time it took per call into a perf_stats_t.  Otherwise the macros below compile to nothing.
+ */
+#ifdef CONFIG_PERF_STATS
+#define PERF_STATS_START(start)                        uint32_t start = perf_stats_get_ticks()
+#define PERF_STATS_RECORD(stats, start, bytes)         perf_stats_record((stats), (start), (bytes))
+#define PERF_STATS_RESET(stats)                        perf_stats_reset(stats)
+#else
+#define PERF_STATS_START(start)
+#define PERF_STATS_RECORD(stats, start, bytes)
+#define PERF_STATS_RESET(stats)
+#endif
+
+/***********************************************************************************************************************
+ * ENUMS, STRUCTS, UNIONS, TYPEDEFS
+ **********************************************************************************************************************/
+
+/**
+ * Statistics of the calls to one stage
+ */
+typedef struct
+{
+    uint32_t calls;
+    uint64_t bytes;
+    uint64_t ticks;
+    uint32_t max_ticks;
+    uint32_t histogram[PERF_STATS_BUCKETS];
+} perf_stats_t;
+
+/***********************************************************************************************************************
+ * API FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Set the time source for all statistics
+ *
+ * Until a time source is set, only calls and bytes are recorded.
+ *
+ * @param [in]
+ * - get_ticks           Function returning a free-running tick count, i.e. a cycle counter
+ *
+ */
+void perf_stats_set_time_source(uint32_t (*get_ticks)(void));
+
+/**
+ * Get the current tick count of the time source
+ *
+ * @return                The tick count, or 0 if there is no time source
+ *
+ */
+uint32_t perf_stats_get_ticks(void);
+
+/**
+ * Record one call to a stage
+ *
+ * @param [in]
+ * - stats               Pointer to the statistics of the stage
+ * - start_ticks         Tick count at the start of the call
+ * - bytes               Number of bytes produced by the call
+ *
+ */
+void perf_stats_record(perf_stats_t *stats, uint32_t start_ticks, uint32_t bytes);
+
+/**
+ * Clear the statistics of a stage
+ *
+ * @param [in]
+ * - stats               Pointer to the statistics of the stage
+ *
+ */
+void perf_stats_reset(perf_stats_t *stats);
+
+/**
+ * Get a percentile of the per-call latency of a stage
+ *
+ * The result is the upper bound of the histogram bucket that the percentile falls in, so it is within a factor of
+ * two of the true value.
+ *
+ * @param [in]
+ * - stats               Pointer to the statistics of the stage
+ * - percent             Percentile, from 0 to 100
+ *
+ * @return                Latency in ticks
+ *
+ */
+uint32_t perf_stats_get_percentile(perf_stats_t *stats, uint32_t percent);
+
+/**
+ * Get the throughput of a stage while it was running
+ *
+ * @param [in]
+ * - stats               Pointer to the statistics of the stage
+ * - ticks_per_sec       Rate of the time source
+ *
+ * @return                Bytes per second, or 0 if no time has been recorded
+ *
+ */
+uint32_t perf_stats_get_throughput(perf_stats_t *stats, uint32_t ticks_per_sec);
+
+/**********************************************************************************************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_STATS_H
@@ -223,6 +223,7 @@
 #define BSP_TIM5_PREPRIO                            (0x4)
 #define BSP_I2C1_ERROR_PREPRIO                      (0x1)
 #define BSP_I2C1_EVENT_PREPRIO                      (0x2)
+#define BSP_SPI1_PREPRIO                            (0x3)
 
 typedef struct
 {
@@ -273,6 +274,10 @@ static bool bsp_timer_elapsed;
 
 static bsp_callback_t bsp_i2c_done_cb;
 static void *bsp_i2c_done_cb_arg;
+// State of an interrupt-driven SPI read, which owns SPI1 until it completes
+static volatile bool bsp_spi_async_busy = false;
+static bsp_callback_t bsp_spi_done_cb;
+static void *bsp_spi_done_cb_arg;
 static uint8_t bsp_i2c_current_transaction_type;
 static uint8_t *bsp_i2c_read_buffer_ptr;
 static uint32_t bsp_i2c_read_length;
@@ -1396,6 +1401,10 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef* hspi)
     GPIO_InitStruct.Alternate = 0;
     HAL_GPIO_Init(GPIOC, &GPIO_InitStruct);
 
+    // Interrupt for reads that complete asynchronously, i.e. bsp_eeprom_fw_img_read()
+    HAL_NVIC_SetPriority(SPI1_IRQn, BSP_SPI1_PREPRIO, 0);
+    HAL_NVIC_EnableIRQ(SPI1_IRQn);
+
   /* USER CODE BEGIN SPI1_MspInit 1 */
 
   /* USER CODE END SPI1_MspInit 1 */
@@ -1419,6 +1428,8 @@ void HAL_SPI_MspDeInit(SPI_HandleTypeDef* hspi)
     /* Peripheral clock disable */
     __HAL_RCC_SPI1_CLK_DISABLE();
 
+    HAL_NVIC_DisableIRQ(SPI1_IRQn);
+
     /**SPI1 GPIO Configuration
     PA15     ------> SPI1_NSS
     PB3     ------> SPI1_SCK
@@ -1660,6 +1671,39 @@ void HAL_I2C_AbortCpltCallback(I2C_HandleTypeDef *hi2c)
     return;
 }
 
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+    if ((hspi == &hspi1) && bsp_spi_async_busy)
+    {
+        // Only the EEPROM is read asynchronously
+        HAL_GPIO_WritePin(GPIOD, GPIO_PIN_2, GPIO_PIN_SET);
+        bsp_spi_async_busy = false;
+        if (bsp_spi_done_cb != NULL)
+        {
+            bsp_spi_done_cb(BSP_STATUS_OK, bsp_spi_done_cb_arg);
+        }
+    }
+
+    bsp_irq_count++;
+
+    return;
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+    if ((hspi == &hspi1) && bsp_spi_async_busy)
+    {
+        HAL_GPIO_WritePin(GPIOD, GPIO_PIN_2, GPIO_PIN_SET);
+        bsp_spi_async_busy = false;
+        if (bsp_spi_done_cb != NULL)
+        {
+            bsp_spi_done_cb(BSP_STATUS_FAIL, bsp_spi_done_cb_arg);
+        }
+    }
+
+    return;
+}
+
 void HAL_I2S_MspInit(I2S_HandleTypeDef *hi2s)
 {
     static DMA_HandleTypeDef hdma_i2sTx;
@@ -2998,6 +3042,12 @@ uint32_t bsp_set_timer(uint32_t duration_ms, bsp_callback_t cb, void *cb_arg)
     return BSP_STATUS_OK;
 }
 
+uint32_t bsp_get_time_ms(void)
+{
+    // SysTick is configured by HAL_Init() to tick every 1ms
+    return HAL_GetTick();
+}
+
 uint32_t bsp_set_gpio(uint32_t gpio_id, uint8_t gpio_state)
 {
     uint8_t buffer[2] = {0, 0};
@@ -3217,6 +3267,9 @@ uint32_t bsp_spi_read(uint32_t bsp_dev_id,
 #ifdef USE_CMSIS_OS
     xSemaphoreTake(mutex_spi, portMAX_DELAY);
 #endif
+    // Wait for any interrupt-driven read to finish with the bus
+    while (bsp_spi_async_busy);
+
     // Chip select low
     HAL_GPIO_WritePin(cs_gpio_per, cs_gpio_pin, GPIO_PIN_RESET);
 
@@ -3295,6 +3348,9 @@ uint32_t bsp_spi_write(uint32_t bsp_dev_id,
 #ifdef USE_CMSIS_OS
     xSemaphoreTake(mutex_spi, portMAX_DELAY);
 #endif
+    // Wait for any interrupt-driven read to finish with the bus
+    while (bsp_spi_async_busy);
+
     // Chip select low
     HAL_GPIO_WritePin(cs_gpio_per, cs_gpio_pin, GPIO_PIN_RESET);
 
@@ -3698,6 +3754,9 @@ uint32_t bsp_spi_throttle_speed(uint32_t speed_hz)
     uint32_t spi_baud_hz = HAL_RCC_GetPCLK2Freq();  // Currently using SPI1 which is on APB2
     uint32_t temp_spi_baud_prescaler;
 
+    // SPI1 cannot be reinitialised in the middle of an interrupt-driven read
+    while (bsp_spi_async_busy);
+
     // Save the current prescaler value
     spi_baud_prescaler = temp_spi_baud_prescaler = (hspi1.Init.BaudRatePrescaler >> SPI_CR1_BR_Pos);
     // Get the current SPI Baud in Hz
@@ -3739,6 +3798,8 @@ uint32_t bsp_spi_throttle_speed(uint32_t speed_hz)
 
 uint32_t bsp_spi_restore_speed(void)
 {
+    while (bsp_spi_async_busy);
+
     // If the SPI baud rate was changed, restore it
     if (spi_baud_prescaler != (hspi1.Init.BaudRatePrescaler >> SPI_CR1_BR_Pos))
     {
@@ -3847,6 +3908,76 @@ uint32_t bsp_eeprom_read(uint32_t addr,
     return ret;
 }
 
+/**
+ * Read part of a fw_img stored in the EEPROM, for use as a fw_img_read_t source
+ *
+ * 'arg' must point to a uint32_t containing the EEPROM address of the start of the fw_img.  If 'cb' is NULL the read
+ * is completed before returning.  Otherwise the data is received under interrupt and 'cb' is called from the SPI1
+ * IRQ once it is in 'data_buffer', so that the read overlaps with whatever the caller does next (i.e. writing the
+ * previous part of the fw_img to a device over I2C).  Other SPI transfers wait for the read to complete.
+ */
+uint32_t bsp_eeprom_fw_img_read(void *arg,
+                                uint32_t offset,
+                                uint8_t *data_buffer,
+                                uint32_t data_length,
+                                bsp_callback_t cb,
+                                void *cb_arg)
+{
+    HAL_StatusTypeDef ret;
+    uint32_t addr;
+    uint8_t buffer[4];
+
+    if (arg == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    addr = *((uint32_t *) arg) + offset;
+
+    if (cb == NULL)
+    {
+        return bsp_eeprom_read(addr, data_buffer, data_length);
+    }
+
+    buffer[0] = BSP_EEPROM_OPCODE_READ_DATA;
+    buffer[1] = GET_BYTE_FROM_WORD(addr, 2);
+    buffer[2] = GET_BYTE_FROM_WORD(addr, 1);
+    buffer[3] = GET_BYTE_FROM_WORD(addr, 0);
+
+    bsp_wait_for_eeprom();
+
+#ifdef USE_CMSIS_OS
+    xSemaphoreTake(mutex_spi, portMAX_DELAY);
+#endif
+    while (bsp_spi_async_busy);
+
+    HAL_GPIO_WritePin(GPIOD, GPIO_PIN_2, GPIO_PIN_RESET);
+
+    // The command is short, so only the data is received under interrupt
+    ret = HAL_SPI_Transmit(&hspi1, buffer, 4, HAL_MAX_DELAY);
+    if (ret == HAL_OK)
+    {
+        bsp_spi_done_cb = cb;
+        bsp_spi_done_cb_arg = cb_arg;
+        bsp_spi_async_busy = true;
+        ret = HAL_SPI_Receive_IT(&hspi1, data_buffer, data_length);
+        if (ret != HAL_OK)
+        {
+            bsp_spi_async_busy = false;
+        }
+    }
+    if (ret != HAL_OK)
+    {
+        HAL_GPIO_WritePin(GPIOD, GPIO_PIN_2, GPIO_PIN_SET);
+    }
+
+#ifdef USE_CMSIS_OS
+    xSemaphoreGive(mutex_spi);
+#endif
+
+    return (ret == HAL_OK) ? BSP_STATUS_OK : BSP_STATUS_FAIL;
+}
+
 uint32_t bsp_eeprom_program(uint32_t addr,
                             uint8_t *data_buffer,
                             uint32_t data_length)
@@ -54,6 +54,7 @@ extern I2S_HandleTypeDef i2s_drv_handle;
 extern I2S_HandleTypeDef i2s3_drv_handle;
 extern EXTI_HandleTypeDef exti_pb0_handle, exti_pb1_handle, exti_pb2_handle, exti_pb3_handle, exti_pb4_handle, exti_cdc_int_handle, exti_dsp_int_handle;
 extern UART_HandleTypeDef uart_drv_handle;
+extern SPI_HandleTypeDef hspi1;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -317,3 +318,8 @@ void USART2_IRQHandler(void)
 {
   HAL_UART_IRQHandler(&uart_drv_handle);
 }
+
+void SPI1_IRQHandler(void)
+{
+  HAL_SPI_IRQHandler(&hspi1);
+}
@@ -171,6 +171,7 @@ uint32_t bsp_audio_pause(bsp_i2s_port_t port);
 uint32_t bsp_audio_resume(bsp_i2s_port_t port);
 uint32_t bsp_audio_stop(bsp_i2s_port_t port);
 uint32_t bsp_set_timer(uint32_t duration_ms, bsp_callback_t cb, void *cb_arg);
+uint32_t bsp_get_time_ms(void);
 uint32_t bsp_set_gpio(uint32_t gpio_id, uint8_t gpio_state);
 bool     bsp_was_pb_pressed(uint8_t pb_id);
 void     bsp_sleep(void);
@@ -196,6 +197,12 @@ uint32_t bsp_eeprom_read_jedecid(uint8_t *buffer);
 uint32_t bsp_eeprom_read(uint32_t addr,
                          uint8_t *data_buffer,
                          uint32_t data_length);
+uint32_t bsp_eeprom_fw_img_read(void *arg,
+                                uint32_t offset,
+                                uint8_t *data_buffer,
+                                uint32_t data_length,
+                                bsp_callback_t cb,
+                                void *cb_arg);
 uint32_t bsp_eeprom_program(uint32_t addr,
                             uint8_t *data_buffer,
                             uint32_t data_length);
@@ -530,6 +530,45 @@ uint32_t regmap_write_block(regmap_cp_config_t *cp, uint32_t addr, uint8_t *byte
     return ret;
 }
 
+/**
+ * Starts writing from byte array to consecutive number of Control Port memory addresses
+ *
+ */
+uint32_t regmap_write_block_async(regmap_cp_config_t *cp,
+                                  uint32_t addr,
+                                  uint8_t *addr_bytes,
+                                  uint8_t *bytes,
+                                  uint32_t length,
+                                  bsp_callback_t cb,
+                                  void *cb_arg)
+{
+    uint32_t ret;
+
+    if (cp->bus_type != REGMAP_BUS_TYPE_I2C)
+    {
+        ret = regmap_write_block(cp, addr, bytes, length);
+        if (ret == REGMAP_STATUS_OK)
+        {
+            cb(BSP_STATUS_OK, cb_arg);
+        }
+
+        return ret;
+    }
+
+    addr_bytes[0] = GET_BYTE_FROM_WORD(addr, 3);
+    addr_bytes[1] = GET_BYTE_FROM_WORD(addr, 2);
+    addr_bytes[2] = GET_BYTE_FROM_WORD(addr, 1);
+    addr_bytes[3] = GET_BYTE_FROM_WORD(addr, 0);
+
+    ret = bsp_driver_if_g->i2c_db_write(cp->dev_id, addr_bytes, 4, bytes, length, cb, cb_arg);
+    if (ret)
+    {
+        return REGMAP_STATUS_FAIL;
+    }
+
+    return REGMAP_STATUS_OK;
+}
+
 /**
  * Writes a value in a list to corresponding address. Data can be encoded to perform specific operations.
  *
@@ -581,7 +620,7 @@ uint32_t regmap_write_array(regmap_cp_config_t *cp, uint32_t * array, uint32_t a
  * Reads a firmware control corresponding to the respective symbol_id.
  *
  */
-uint32_t regmap_read_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint32_t symbol_id, uint32_t *val)
+uint32_t regmap_read_fw_control(regmap_cp_config_t *cp, const fw_img_info_t *f, uint32_t symbol_id, uint32_t *val)
 {
     uint32_t temp_reg_addr, ret;
 
@@ -606,7 +645,7 @@ uint32_t regmap_read_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint32
  * Writes a firmware control corresponding to the respective symbol_id.
  *
  */
-uint32_t regmap_write_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint32_t symbol_id, uint32_t val)
+uint32_t regmap_write_fw_control(regmap_cp_config_t *cp, const fw_img_info_t *f, uint32_t symbol_id, uint32_t val)
 {
     uint32_t temp_reg_addr, ret;
 
@@ -632,7 +671,7 @@ uint32_t regmap_write_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint3
  *
  */
 uint32_t regmap_update_fw_control(regmap_cp_config_t *cp,
-                                  fw_img_info_t *f,
+                                  const fw_img_info_t *f,
                                   uint32_t symbol_id,
                                   uint32_t mask,
                                   uint32_t val)
@@ -654,7 +693,7 @@ uint32_t regmap_update_fw_control(regmap_cp_config_t *cp,
  *
  */
 uint32_t regmap_poll_fw_control(regmap_cp_config_t *cp,
-                                fw_img_info_t *f,
+                                const fw_img_info_t *f,
                                 uint32_t symbol_id,
                                 uint32_t val,
                                 uint8_t tries,
@@ -690,7 +729,7 @@ uint32_t regmap_poll_fw_control(regmap_cp_config_t *cp,
  *
  */
 uint32_t regmap_write_acked_fw_control(regmap_cp_config_t *cp,
-                                       fw_img_info_t *f,
+                                       const fw_img_info_t *f,
                                        uint32_t symbol_id,
                                        uint32_t val,
                                        uint32_t acked_val,
@@ -714,7 +753,7 @@ uint32_t regmap_write_acked_fw_control(regmap_cp_config_t *cp,
  *
  */
 uint32_t regmap_write_fw_vals(regmap_cp_config_t *cp,
-                               fw_img_info_t *f,
+                               const fw_img_info_t *f,
                                uint32_t symbol_id,
                                uint32_t *val,
                                uint32_t length)
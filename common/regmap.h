@@ -246,6 +246,37 @@ uint32_t regmap_read_block(regmap_cp_config_t *cp, uint32_t addr, uint8_t *bytes
  */
 uint32_t regmap_write_block(regmap_cp_config_t *cp, uint32_t addr, uint8_t *bytes, uint32_t length);
 
+/**
+ * Starts writing from byte array to consecutive number of Control Port memory addresses
+ *
+ * On I2C the transfer is handed to the BSP with \b cb, so this returns as soon as the transfer has started and \b cb
+ * is called, possibly from interrupt context, once it has finished.  Other buses have no asynchronous transfers in
+ * bsp_driver_if_t, so the transfer finishes before this returns and \b cb is then called directly.  \b cb is only
+ * called if this returns REGMAP_STATUS_OK.
+ *
+ * \b addr_bytes and \b bytes must not be changed until \b cb has been called.
+ *
+ * @param [in] cp               Pointer to the BSP control port configuration
+ * @param [in] addr             32-bit address to be written
+ * @param [in] addr_bytes       pointer to 4 bytes to hold the address until the transfer has finished
+ * @param [in] bytes            pointer to array of bytes to write via Control Port bus
+ * @param [in] length           number of bytes to write
+ * @param [in] cb               pointer to callback function, called with BSP_STATUS_OK or BSP_STATUS_FAIL
+ * @param [in] cb_arg           pointer to argument to use when calling callback
+ *
+ * @return
+ * - REGMAP_STATUS_FAIL         if the call to BSP failed
+ * - REGMAP_STATUS_OK           otherwise
+ *
+ */
+uint32_t regmap_write_block_async(regmap_cp_config_t *cp,
+                                  uint32_t addr,
+                                  uint8_t *addr_bytes,
+                                  uint8_t *bytes,
+                                  uint32_t length,
+                                  bsp_callback_t cb,
+                                  void *cb_arg);
+
 /**
  * Writes a value in a list to corresponding address. Data can be encoded to perform specific operations.
  *
@@ -273,7 +304,7 @@ uint32_t regmap_write_array(regmap_cp_config_t *cp, uint32_t *array, uint32_t ar
  * - REGMAP_STATUS_OK           otherwise
  *
  */
-uint32_t regmap_read_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint32_t symbol_id, uint32_t *val);
+uint32_t regmap_read_fw_control(regmap_cp_config_t *cp, const fw_img_info_t *f, uint32_t symbol_id, uint32_t *val);
 
 /**
  * Writes a firmware control corresponding to the respective symbol_id.
@@ -288,7 +319,7 @@ uint32_t regmap_read_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint32
  * - REGMAP_STATUS_OK           otherwise
  *
  */
-uint32_t regmap_write_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint32_t symbol_id, uint32_t val);
+uint32_t regmap_write_fw_control(regmap_cp_config_t *cp, const fw_img_info_t *f, uint32_t symbol_id, uint32_t val);
 
 /**
  * Updates bitfields in a firmware control corresponding to the respective symbol_id.
@@ -305,7 +336,7 @@ uint32_t regmap_write_fw_control(regmap_cp_config_t *cp, fw_img_info_t *f, uint3
  *
  */
 uint32_t regmap_update_fw_control(regmap_cp_config_t *cp,
-                                  fw_img_info_t *f,
+                                  const fw_img_info_t *f,
                                   uint32_t symbol_id,
                                   uint32_t mask,
                                   uint32_t val);
@@ -327,7 +358,7 @@ uint32_t regmap_update_fw_control(regmap_cp_config_t *cp,
  *
  */
 uint32_t regmap_poll_fw_control(regmap_cp_config_t *cp,
-                                fw_img_info_t *f,
+                                const fw_img_info_t *f,
                                 uint32_t symbol_id,
                                 uint32_t val,
                                 uint8_t tries,
@@ -350,7 +381,7 @@ uint32_t regmap_poll_fw_control(regmap_cp_config_t *cp,
  * - REGMAP_STATUS_OK           otherwise
  */
 uint32_t regmap_write_acked_fw_control(regmap_cp_config_t *cp,
-                                       fw_img_info_t *f,
+                                       const fw_img_info_t *f,
                                        uint32_t symbol_id,
                                        uint32_t val,
                                        uint32_t acked_val,
@@ -372,7 +403,7 @@ uint32_t regmap_write_acked_fw_control(regmap_cp_config_t *cp,
  *
  */
 uint32_t regmap_write_fw_vals(regmap_cp_config_t *cp,
-                              fw_img_info_t *f,
+                              const fw_img_info_t *f,
                               uint32_t symbol_id,
                               uint32_t *val,
                               uint32_t size);
@@ -22,6 +22,7 @@
 /***********************************************************************************************************************
  * INCLUDES
  **********************************************************************************************************************/
+#include <stddef.h>
 #include <scc.h>
 
 /***********************************************************************************************************************
@@ -30,6 +31,10 @@
 #define SCC_POLL_ACK_CTRL_MAX   (10)
 #define SCC_POLL_ACK_CTRL_MS    (10)
 
+// Most words read by one block read to snapshot the controls, including any other controls between them
+#define SCC_SNAPSHOT_MAX_WORDS  (16)
+#define SCC_BYTES_PER_REG       (4)
+
 /***********************************************************************************************************************
  * LOCAL VARIABLES
  **********************************************************************************************************************/
@@ -37,6 +42,122 @@
 /***********************************************************************************************************************
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
+static uint32_t scc_resolve_snapshot(scc_t *scc);
+static uint32_t scc_read_snapshot(scc_t *scc, uint32_t *values);
+static void scc_record_event(scc_t *scc, uint32_t old_status);
+
+/**
+ * Find the addresses of the controls read by scc_update_status(), and whether one block read can cover them
+ *
+ */
+static uint32_t scc_resolve_snapshot(scc_t *scc)
+{
+    const uint32_t symbols[SCC_N_SNAPSHOT_CONTROLS] =
+    {
+        scc->config.state_symbol,
+        scc->config.status_symbol,
+        scc->config.error_symbol,
+        scc->config.control_symbol
+    };
+    uint32_t min_address = UINT32_MAX;
+    uint32_t max_address = 0;
+
+    for (uint32_t i = 0; i < SCC_N_SNAPSHOT_CONTROLS; i++)
+    {
+        uint32_t address = fw_img_find_symbol(scc->config.fw_info, symbols[i]);
+
+        if (address == 0)
+        {
+            return SCC_STATUS_FAIL;
+        }
+        scc->snapshot_addresses[i] = address;
+        min_address = (address < min_address) ? address : min_address;
+        max_address = (address > max_address) ? address : max_address;
+    }
+
+    scc->snapshot_base = min_address;
+    scc->snapshot_words = ((max_address - min_address) / SCC_BYTES_PER_REG) + 1;
+    if (scc->snapshot_words > SCC_SNAPSHOT_MAX_WORDS)
+    {
+        scc->snapshot_words = 0;
+    }
+
+    return SCC_STATUS_OK;
+}
+
+/**
+ * Read the controls, in the order of scc_t member snapshot_addresses
+ *
+ */
+static uint32_t scc_read_snapshot(scc_t *scc, uint32_t *values)
+{
+    uint8_t bytes[SCC_SNAPSHOT_MAX_WORDS * SCC_BYTES_PER_REG];
+    uint32_t ret;
+
+    // Fall back to one read per control if they are too far apart
+    if (scc->snapshot_words == 0)
+    {
+        for (uint32_t i = 0; i < SCC_N_SNAPSHOT_CONTROLS; i++)
+        {
+            ret = regmap_read(scc->config.cp_config, scc->snapshot_addresses[i], &values[i]);
+            if (ret != REGMAP_STATUS_OK)
+            {
+                return SCC_STATUS_FAIL;
+            }
+        }
+
+        return SCC_STATUS_OK;
+    }
+
+    ret = regmap_read_block(scc->config.cp_config,
+                            scc->snapshot_base,
+                            bytes,
+                            scc->snapshot_words * SCC_BYTES_PER_REG);
+    if (ret != REGMAP_STATUS_OK)
+    {
+        return SCC_STATUS_FAIL;
+    }
+
+    for (uint32_t i = 0; i < SCC_N_SNAPSHOT_CONTROLS; i++)
+    {
+        uint8_t *word = &bytes[scc->snapshot_addresses[i] - scc->snapshot_base];
+
+        // Registers are big-endian on the bus
+        values[i] = (((uint32_t) word[0]) << 24) | (((uint32_t) word[1]) << 16)
+                  | (((uint32_t) word[2]) << 8) | ((uint32_t) word[3]);
+    }
+
+    return SCC_STATUS_OK;
+}
+
+/**
+ * Queue a trigger event if VTE1 has triggered since the last status update
+ *
+ */
+static void scc_record_event(scc_t *scc, uint32_t old_status)
+{
+    scc_event_t *event;
+    uint32_t index;
+
+    if (((scc->status & SCC_STATUS_VTE1_TRIGGERED) == 0) || ((old_status & SCC_STATUS_VTE1_TRIGGERED) != 0))
+    {
+        return;
+    }
+
+    // Keep the most recent triggers if they are not being taken
+    if (scc->event_count == SCC_EVENT_QUEUE_LEN)
+    {
+        scc->event_read_index = (scc->event_read_index + 1) % SCC_EVENT_QUEUE_LEN;
+        scc->event_count--;
+    }
+    index = (scc->event_read_index + scc->event_count) % SCC_EVENT_QUEUE_LEN;
+    event = &scc->events[index];
+
+    event->time_ms = (scc->config.get_time_ms != NULL) ? scc->config.get_time_ms() : 0;
+    event->write_index = (scc->config.dspbuf != NULL) ? dspbuf_get_write_index(scc->config.dspbuf) : 0;
+    event->status = scc->status;
+    scc->event_count++;
+}
 
 /***********************************************************************************************************************
  * API FUNCTIONS
@@ -55,6 +176,12 @@ uint32_t scc_init(scc_t *scc, scc_config_t *scc_config, uint32_t (*scc_init_fp)(
         return SCC_STATUS_FAIL;
     }
 
+    ret = scc_resolve_snapshot(scc);
+    if (ret != SCC_STATUS_OK)
+    {
+        return SCC_STATUS_FAIL;
+    }
+
     // Select the requested compressed stream encoding
     switch (scc_config->enc_format)
     {
@@ -66,6 +193,12 @@ uint32_t scc_init(scc_t *scc, scc_config_t *scc_config, uint32_t (*scc_init_fp)(
             scc_enc_format = SCC_COMPR_ENC_FORMAT_MSBC;
             break;
 
+#ifdef CONFIG_SCC_IMA_ADPCM
+        case COMPR_ENC_FORMAT_IMA_ADPCM:
+            scc_enc_format = SCC_COMPR_ENC_FORMAT_IMA_ADPCM;
+            break;
+#endif
+
         case COMPR_ENC_FORMAT_DEFAULT: // Do not change the buffer format (must be chosen for SCC lib v8.7.0 and older)
             scc_enc_format = SCC_COMPR_ENC_FORMAT_DEFAULT;
             break;
@@ -100,6 +233,9 @@ uint32_t scc_init(scc_t *scc, scc_config_t *scc_config, uint32_t (*scc_init_fp)(
     {
         return SCC_STATUS_FAIL;
     }
+    // Any trigger already reported is from before this init
+    scc->event_read_index = 0;
+    scc->event_count = 0;
 
     return SCC_STATUS_OK;
 }
@@ -124,6 +260,11 @@ uint32_t scc_get_error(scc_t *scc)
     return scc->error;
 }
 
+uint32_t scc_get_control(scc_t *scc)
+{
+    return scc->control;
+}
+
 uint32_t scc_host_command(scc_t *scc, scc_host_cmd_t command)
 {
     if (regmap_write_acked_fw_control(scc->config.cp_config,
@@ -144,33 +285,36 @@ uint32_t scc_host_command(scc_t *scc, scc_host_cmd_t command)
 
 uint32_t scc_update_status(scc_t *scc)
 {
+    uint32_t values[SCC_N_SNAPSHOT_CONTROLS];
+    uint32_t old_status = scc->status;
     uint32_t ret;
 
-    ret = regmap_read_fw_control(scc->config.cp_config,
-                                 scc->config.fw_info,
-                                 scc->config.state_symbol,
-                                 &scc->state);
-    if (ret != REGMAP_STATUS_OK)
-    {
-        return SCC_STATUS_FAIL;
-    }
-    ret = regmap_read_fw_control(scc->config.cp_config,
-                                 scc->config.fw_info,
-                                 scc->config.status_symbol,
-                                 &scc->status);
-    if (ret != REGMAP_STATUS_OK)
+    ret = scc_read_snapshot(scc, values);
+    if (ret != SCC_STATUS_OK)
     {
         return SCC_STATUS_FAIL;
     }
-    ret = regmap_read_fw_control(scc->config.cp_config,
-                                 scc->config.fw_info,
-                                 scc->config.error_symbol,
-                                 &scc->error);
-    if (ret != REGMAP_STATUS_OK)
+
+    scc->state = values[0];
+    scc->status = values[1];
+    scc->error = values[2];
+    scc->control = values[3];
+    scc_record_event(scc, old_status);
+
+    return SCC_STATUS_OK;
+}
+
+uint32_t scc_get_event(scc_t *scc, scc_event_t *event)
+{
+    if (scc->event_count == 0)
     {
         return SCC_STATUS_FAIL;
     }
 
+    *event = scc->events[scc->event_read_index];
+    scc->event_read_index = (scc->event_read_index + 1) % SCC_EVENT_QUEUE_LEN;
+    scc->event_count--;
+
     return SCC_STATUS_OK;
 }
 
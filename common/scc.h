@@ -32,6 +32,7 @@ extern "C" {
  **********************************************************************************************************************/
 #include <stdint.h>
 #include "decompr.h"
+#include "dspbuf.h"
 #include "regmap.h"
 #include "fw_img.h"
 
@@ -46,6 +47,8 @@ extern "C" {
  */
 #define SCC_COMPR_ENC_FORMAT_PACKED16       (0)
 #define SCC_COMPR_ENC_FORMAT_MSBC           (2)
+#define SCC_COMPR_ENC_FORMAT_IMA_ADPCM      (3)    // Needs SCC firmware with IMA ADPCM encoding, which the released
+                                                   // MSBC firmware does not have. Only used if CONFIG_SCC_IMA_ADPCM
 #define SCC_COMPR_ENC_FORMAT_DEFAULT        (0xFF) // Do not change the buffer format (must be chosen for SCC lib v8.7.0 and older)
 
 #define SCC_STATUS_CMD_ERROR                (1<<2)
@@ -57,6 +60,9 @@ extern "C" {
 
 #define SCC_NUM_HOST_CMD_RETRIES            (20)
 
+#define SCC_N_SNAPSHOT_CONTROLS             (4)    // State, status, error and control
+#define SCC_EVENT_QUEUE_LEN                 (4)
+
 
 /***********************************************************************************************************************
  * MACROS
@@ -107,8 +113,23 @@ typedef struct
     uint32_t manageackctrl_symbol;
     uint32_t enc_format_symbol;
     uint32_t host_buffer_raw_symbol;
+    uint32_t (*get_time_ms)(void);      // Optional, free-running millisecond count to timestamp trigger events
+    dspbuf_t *dspbuf;                   // Optional, host buffer whose write index is recorded with trigger events
 } scc_config_t;
 
+/**
+ * A VTE1 trigger, recorded by scc_update_status() when it first sees SCC_STATUS_VTE1_TRIGGERED set
+ *
+ * write_index is from the last dspbuf_update_status() of config.dspbuf, so that should be called just before
+ * scc_update_status().
+ */
+typedef struct
+{
+    uint32_t time_ms;                   // MCU time the trigger was seen, 0 if no get_time_ms
+    uint32_t write_index;               // Host buffer next_word_write_index at that time, 0 if no dspbuf
+    uint32_t status;                    // SCC status that reported the trigger
+} scc_event_t;
+
 typedef struct
 {
     scc_config_t config;
@@ -116,6 +137,16 @@ typedef struct
     uint32_t state;
     uint32_t status;
     uint32_t error;
+    uint32_t control;
+    // Addresses of state, status, error and control, resolved once by scc_init()
+    uint32_t snapshot_addresses[SCC_N_SNAPSHOT_CONTROLS];
+    // Span read by a single block read in scc_update_status(), 0 words if the controls are too far apart
+    uint32_t snapshot_base;
+    uint32_t snapshot_words;
+    // Trigger events not yet taken by scc_get_event(), the oldest is overwritten when full
+    scc_event_t events[SCC_EVENT_QUEUE_LEN];
+    uint8_t event_read_index;
+    uint8_t event_count;
 } scc_t;
 
 /***********************************************************************************************************************
@@ -131,9 +162,12 @@ uint32_t scc_get_host_buffer(scc_t *scc);
 uint32_t scc_get_state(scc_t *scc);
 uint32_t scc_get_status(scc_t *scc);
 uint32_t scc_get_error(scc_t *scc);
-uint32_t scc_update_status(scc_t *scc);
+uint32_t scc_get_control(scc_t *scc);
 uint32_t scc_host_command(scc_t *scc, scc_host_cmd_t command);
+// Read state, status, error and control together, in a single block read if possible, and record trigger events
 uint32_t scc_update_status(scc_t *scc);
+// Take the oldest trigger event, SCC_STATUS_FAIL if there are none
+uint32_t scc_get_event(scc_t *scc, scc_event_t *event);
 
 /**********************************************************************************************************************/
 #ifdef __cplusplus
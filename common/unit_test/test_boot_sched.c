@@ -0,0 +1,1096 @@
+/**
+ * @file test_boot_sched.c
+ *
+ * @brief Unit tests for the multi-device boot scheduler
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2021 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#define _POSIX_C_SOURCE 200112L         // pthreads, nanosleep(), clock_gettime(), sched_yield()
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "boot_sched.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_DEVICES                    (3)
+#define TEST_DEVICE_WORDS               (512)
+#define TEST_BROADCAST_DEV_ID           (0x10)
+#define TEST_IMG_MAX_WORDS              (256)
+#define TEST_IMG_BLOCKS                 (3)
+#define TEST_IMG_SYMBOLS                (2)
+#define TEST_MAX_BLOCK_SIZE             (128)
+#define TEST_BYTES_PER_MS               (64)            // Bus throughput of the mock control port
+#define TEST_RESET_WAIT_MS              (20)            // Time each mock device takes to come out of reset
+#define TEST_US_PER_BYTE                (50)            // Bus throughput of the threaded mock control port
+#define TEST_THREADED_PASSES            (3)             // Host timings vary, so the fastest pass is checked
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+/**
+ * Mock device on the mock control port
+ *
+ * Registers and memory are modelled as a sparse list of words.  Unless the test runs a thread per bus, transfers on
+ * the control port finish before returning, so each one advances the mock clock by the time it would take on the bus.
+ */
+typedef struct
+{
+    uint32_t addr[TEST_DEVICE_WORDS];
+    uint32_t val[TEST_DEVICE_WORDS];
+    uint32_t words;
+
+    bool ignores_broadcast;             // Device did not receive broadcast writes
+    uint32_t missed_addr;               // Word of a broadcast write the device did not receive, if not 0
+    bool fail_boot;
+    uint32_t reset_wait_ms;
+    uint32_t bus;                       // Bus the device is on, when the test runs a thread per bus
+
+    uint32_t reset_start_ms;
+    uint32_t reset_done_ms;
+    uint32_t first_write_ms;
+    uint32_t block_writes;
+    uint32_t boots;
+    const fw_img_info_t *booted_fw_info;
+} test_device_t;
+
+/**
+ * Mock control port bus, run by its own thread
+ *
+ * A transfer is handed to the thread, which takes as long as the transfer would take on the bus and then calls the
+ * BSP callback, as an interrupt would.  The request members are only written by the scheduler while the bus is idle.
+ */
+typedef struct
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool has_request;
+    bool quit;
+    uint32_t overlaps;                  // Transfers started, or the device accessed, while the bus was busy
+
+    uint32_t dev_id;
+    uint32_t addr;
+    uint8_t *bytes;
+    uint32_t length;
+    bsp_callback_t cb;
+    void *cb_arg;
+} test_bus_t;
+
+static test_device_t test_devices[TEST_DEVICES];
+static test_bus_t test_buses[TEST_DEVICES];
+static bool test_is_threaded;
+static uint32_t test_now_ms;
+static uint32_t test_timer_ms;
+
+static uint32_t test_fw_img_words[TEST_IMG_MAX_WORDS];
+static uint32_t test_tune_img_words[TEST_IMG_MAX_WORDS];
+static const uint8_t *test_fw_img = (uint8_t *) test_fw_img_words;
+static const uint8_t *test_tune_img = (uint8_t *) test_tune_img_words;
+
+static const uint32_t test_fw_block_sizes[TEST_IMG_BLOCKS] = {128, 48, 96};
+static const uint32_t test_fw_block_addrs[TEST_IMG_BLOCKS] = {0x2800000, 0x2800080, 0x3400000};
+static const uint32_t test_tune_block_sizes[TEST_IMG_BLOCKS] = {16, 128, 8};
+static const uint32_t test_tune_block_addrs[TEST_IMG_BLOCKS] = {0x2b80000, 0x2b80400, 0x2800080};
+
+static regmap_cp_config_t test_cps[TEST_DEVICES];
+static regmap_cp_config_t test_broadcast_cp;
+static fw_img_info_t test_fw_infos[TEST_DEVICES];
+static uint8_t test_block_data[TEST_DEVICES][TEST_MAX_BLOCK_SIZE] __attribute__((aligned(4)));
+static boot_sched_job_t test_jobs[TEST_DEVICES];
+
+static bsp_driver_if_t *test_saved_bsp_driver_if;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Write a word to a mock device
+ *
+ */
+static void test_device_write(test_device_t *device, uint32_t addr, uint32_t val)
+{
+    for (uint32_t i = 0; i < device->words; i++)
+    {
+        if (device->addr[i] == addr)
+        {
+            device->val[i] = val;
+            return;
+        }
+    }
+
+    TEST_ASSERT_LESS_THAN(TEST_DEVICE_WORDS, device->words);
+    device->addr[device->words] = addr;
+    device->val[device->words] = val;
+    device->words++;
+}
+
+/**
+ * Read a word from a mock device, unwritten words read as 0
+ *
+ */
+static uint32_t test_device_read(test_device_t *device, uint32_t addr)
+{
+    for (uint32_t i = 0; i < device->words; i++)
+    {
+        if (device->addr[i] == addr)
+        {
+            return device->val[i];
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Write a block of big-endian words to a mock device, as it arrives on the control port
+ *
+ */
+static void test_device_write_block(test_device_t *device,
+                                    uint32_t addr,
+                                    const uint8_t *bytes,
+                                    uint32_t length,
+                                    bool is_broadcast)
+{
+    for (uint32_t i = 0; i < length; i += 4)
+    {
+        uint32_t val = ((uint32_t) bytes[i] << 24) | ((uint32_t) bytes[i + 1] << 16) |
+                       ((uint32_t) bytes[i + 2] << 8) | bytes[i + 3];
+
+        if (is_broadcast && ((addr + i) == device->missed_addr))
+        {
+            continue;
+        }
+
+        test_device_write(device, addr + i, val);
+    }
+
+    if (device->block_writes == 0)
+    {
+        device->first_write_ms = test_now_ms;
+    }
+    device->block_writes++;
+}
+
+/**
+ * Sleep the calling thread
+ *
+ */
+static void test_sleep_us(uint32_t us)
+{
+    struct timespec duration = {us / 1000000, (us % 1000000) * 1000};
+
+    while (nanosleep(&duration, &duration) != 0)
+    {
+    }
+}
+
+/**
+ * Free-running microsecond count
+ *
+ */
+static uint64_t test_get_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t) now.tv_sec * 1000000ULL) + ((uint64_t) now.tv_nsec / 1000);
+}
+
+/**
+ * Record a device being accessed while a transfer is still on its bus
+ *
+ */
+static void test_bus_check_idle(uint32_t bus_index)
+{
+    test_bus_t *bus = &test_buses[bus_index];
+
+    pthread_mutex_lock(&bus->mutex);
+    if (bus->has_request)
+    {
+        bus->overlaps++;
+    }
+    pthread_mutex_unlock(&bus->mutex);
+}
+
+/**
+ * Mock bus thread, performing one transfer at a time
+ *
+ */
+static void *test_bus_thread(void *arg)
+{
+    test_bus_t *bus = (test_bus_t *) arg;
+
+    pthread_mutex_lock(&bus->mutex);
+    while (1)
+    {
+        bsp_callback_t cb;
+        void *cb_arg;
+
+        while ((!bus->has_request) && (!bus->quit))
+        {
+            pthread_cond_wait(&bus->cond, &bus->mutex);
+        }
+        if (bus->quit)
+        {
+            break;
+        }
+        pthread_mutex_unlock(&bus->mutex);
+
+        // The address and data take as long as they would on the bus
+        test_sleep_us((4 + bus->length) * TEST_US_PER_BYTE);
+        test_device_write_block(&test_devices[bus->dev_id], bus->addr, bus->bytes, bus->length, false);
+        cb = bus->cb;
+        cb_arg = bus->cb_arg;
+
+        pthread_mutex_lock(&bus->mutex);
+        bus->has_request = false;
+        pthread_mutex_unlock(&bus->mutex);
+        cb(BSP_STATUS_OK, cb_arg);
+        pthread_mutex_lock(&bus->mutex);
+    }
+    pthread_mutex_unlock(&bus->mutex);
+
+    return NULL;
+}
+
+/**
+ * Start a thread for each mock bus
+ *
+ */
+static void test_buses_start(void)
+{
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        test_bus_t *bus = &test_buses[i];
+
+        memset(bus, 0, sizeof(test_bus_t));
+        pthread_mutex_init(&bus->mutex, NULL);
+        pthread_cond_init(&bus->cond, NULL);
+        TEST_ASSERT_EQUAL(0, pthread_create(&bus->thread, NULL, test_bus_thread, bus));
+    }
+    test_is_threaded = true;
+}
+
+/**
+ * Stop the mock bus threads, returning the total number of overlapping accesses seen
+ *
+ */
+static uint32_t test_buses_stop(void)
+{
+    uint32_t overlaps = 0;
+
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        test_bus_t *bus = &test_buses[i];
+
+        pthread_mutex_lock(&bus->mutex);
+        bus->quit = true;
+        pthread_cond_signal(&bus->cond);
+        pthread_mutex_unlock(&bus->mutex);
+        pthread_join(bus->thread, NULL);
+        pthread_cond_destroy(&bus->cond);
+        pthread_mutex_destroy(&bus->mutex);
+        overlaps += bus->overlaps;
+    }
+    test_is_threaded = false;
+
+    return overlaps;
+}
+
+/**
+ * Hand a transfer to the thread of a mock bus
+ *
+ */
+static uint32_t test_bus_start_transfer(uint32_t bsp_dev_id,
+                                        uint32_t addr,
+                                        uint8_t *bytes,
+                                        uint32_t length,
+                                        bsp_callback_t cb,
+                                        void *cb_arg)
+{
+    test_bus_t *bus = &test_buses[test_devices[bsp_dev_id].bus];
+    uint32_t ret = BSP_STATUS_OK;
+
+    pthread_mutex_lock(&bus->mutex);
+    if (bus->has_request)
+    {
+        bus->overlaps++;
+        ret = BSP_STATUS_FAIL;
+    }
+    else
+    {
+        bus->dev_id = bsp_dev_id;
+        bus->addr = addr;
+        bus->bytes = bytes;
+        bus->length = length;
+        bus->cb = cb;
+        bus->cb_arg = cb_arg;
+        bus->has_request = true;
+        pthread_cond_signal(&bus->cond);
+    }
+    pthread_mutex_unlock(&bus->mutex);
+
+    return ret;
+}
+
+/**
+ * Mock bsp_driver_if_t set_timer - sleeping advances the mock clock, unless the test runs a thread per bus
+ *
+ */
+static uint32_t test_set_timer(uint32_t duration_ms, bsp_callback_t cb, void *cb_arg)
+{
+    if (test_is_threaded)
+    {
+        test_sleep_us(duration_ms * 1000);
+        return BSP_STATUS_OK;
+    }
+
+    test_now_ms += duration_ms;
+    test_timer_ms += duration_ms;
+
+    return BSP_STATUS_OK;
+}
+
+/**
+ * Mock bsp_driver_if_t i2c_read_repeated_start
+ *
+ */
+static uint32_t test_i2c_read_repeated_start(uint32_t bsp_dev_id,
+                                             uint8_t *write_buffer,
+                                             uint32_t write_length,
+                                             uint8_t *read_buffer,
+                                             uint32_t read_length,
+                                             bsp_callback_t cb,
+                                             void *cb_arg)
+{
+    uint32_t addr;
+
+    if ((bsp_dev_id >= TEST_DEVICES) || (write_length != 4))
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    addr = ((uint32_t) write_buffer[0] << 24) | ((uint32_t) write_buffer[1] << 16) |
+           ((uint32_t) write_buffer[2] << 8) | write_buffer[3];
+    for (uint32_t i = 0; i < read_length; i += 4)
+    {
+        uint32_t val = test_device_read(&test_devices[bsp_dev_id], addr + i);
+
+        read_buffer[i] = (uint8_t) (val >> 24);
+        read_buffer[i + 1] = (uint8_t) (val >> 16);
+        read_buffer[i + 2] = (uint8_t) (val >> 8);
+        read_buffer[i + 3] = (uint8_t) val;
+    }
+    test_now_ms += (read_length + write_length) / TEST_BYTES_PER_MS;
+
+    return BSP_STATUS_OK;
+}
+
+/**
+ * Mock bsp_driver_if_t i2c_db_write, as used by regmap_write_block() and regmap_write_block_async()
+ *
+ * Without a thread per bus, a transfer with a callback still finishes before returning, and then calls the callback.
+ */
+static uint32_t test_i2c_db_write(uint32_t bsp_dev_id,
+                                  uint8_t *write_buffer_0,
+                                  uint32_t write_length_0,
+                                  uint8_t *write_buffer_1,
+                                  uint32_t write_length_1,
+                                  bsp_callback_t cb,
+                                  void *cb_arg)
+{
+    uint32_t addr;
+
+    if ((write_length_0 != 4) || ((write_length_1 % 4) != 0))
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    addr = ((uint32_t) write_buffer_0[0] << 24) | ((uint32_t) write_buffer_0[1] << 16) |
+           ((uint32_t) write_buffer_0[2] << 8) | write_buffer_0[3];
+
+    if (test_is_threaded && (cb != NULL) && (bsp_dev_id < TEST_DEVICES))
+    {
+        return test_bus_start_transfer(bsp_dev_id, addr, write_buffer_1, write_length_1, cb, cb_arg);
+    }
+
+    // The transfer blocks for as long as it takes on the bus
+    test_now_ms += (write_length_0 + write_length_1 + TEST_BYTES_PER_MS - 1) / TEST_BYTES_PER_MS;
+
+    if (bsp_dev_id == TEST_BROADCAST_DEV_ID)
+    {
+        for (uint32_t i = 0; i < TEST_DEVICES; i++)
+        {
+            if (!test_devices[i].ignores_broadcast)
+            {
+                test_device_write_block(&test_devices[i], addr, write_buffer_1, write_length_1, true);
+            }
+        }
+    }
+    else if (bsp_dev_id < TEST_DEVICES)
+    {
+        test_device_write_block(&test_devices[bsp_dev_id], addr, write_buffer_1, write_length_1, false);
+    }
+    else
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    if (cb != NULL)
+    {
+        cb(BSP_STATUS_OK, cb_arg);
+    }
+
+    return BSP_STATUS_OK;
+}
+
+static bsp_driver_if_t test_bsp_driver_if =
+{
+    .set_timer = test_set_timer,
+    .i2c_read_repeated_start = test_i2c_read_repeated_start,
+    .i2c_db_write = test_i2c_db_write,
+};
+
+/**
+ * Mock free-running millisecond count
+ *
+ * The scheduler polls this while transfers are on the threaded buses, so give their threads the CPU.
+ */
+static uint32_t test_get_time_ms(void)
+{
+    if (test_is_threaded)
+    {
+        sched_yield();
+    }
+
+    return test_now_ms;
+}
+
+/**
+ * boot_sched_ops_t reset for a mock device - a reset pulse, then a wait for the device to come out of reset
+ *
+ */
+static uint32_t test_ops_reset(void *driver, uint32_t *step, uint32_t *wait_ms)
+{
+    test_device_t *device = (test_device_t *) driver;
+
+    switch (*step)
+    {
+        case 0:
+            device->reset_start_ms = test_now_ms;
+            device->words = 0;
+            *wait_ms = 1;
+            *step = 1;
+            break;
+
+        case 1:
+            *wait_ms = device->reset_wait_ms;
+            *step = 2;
+            break;
+
+        case 2:
+            // The device must not be accessed before it is out of reset
+            TEST_ASSERT_GREATER_OR_EQUAL(device->reset_start_ms + 1 + device->reset_wait_ms, test_now_ms);
+            device->reset_done_ms = test_now_ms;
+            *step = BOOT_SCHED_RESET_STEP_DONE;
+            break;
+
+        default:
+            return BOOT_SCHED_STATUS_FAIL;
+    }
+
+    return BOOT_SCHED_STATUS_OK;
+}
+
+/**
+ * boot_sched_ops_t boot for a mock device
+ *
+ */
+static uint32_t test_ops_boot(void *driver, fw_img_info_t *fw_info)
+{
+    test_device_t *device = (test_device_t *) driver;
+
+    device->boots++;
+    device->booted_fw_info = fw_info;
+
+    return device->fail_boot ? BOOT_SCHED_STATUS_FAIL : BOOT_SCHED_STATUS_OK;
+}
+
+static const boot_sched_ops_t test_ops =
+{
+    .reset = test_ops_reset,
+    .boot = test_ops_boot,
+};
+
+/**
+ * boot_sched_ops_t reset for a mock device on a threaded bus - reset is immediate, but must not overlap a transfer
+ *
+ */
+static uint32_t test_ops_reset_threaded(void *driver, uint32_t *step, uint32_t *wait_ms)
+{
+    test_device_t *device = (test_device_t *) driver;
+
+    test_bus_check_idle(device->bus);
+    device->words = 0;
+    *step = BOOT_SCHED_RESET_STEP_DONE;
+
+    return BOOT_SCHED_STATUS_OK;
+}
+
+/**
+ * boot_sched_ops_t boot for a mock device on a threaded bus - boot must not overlap a transfer
+ *
+ */
+static uint32_t test_ops_boot_threaded(void *driver, fw_img_info_t *fw_info)
+{
+    test_device_t *device = (test_device_t *) driver;
+
+    test_bus_check_idle(device->bus);
+
+    return test_ops_boot(driver, fw_info);
+}
+
+static const boot_sched_ops_t test_ops_threaded =
+{
+    .reset = test_ops_reset_threaded,
+    .boot = test_ops_boot_threaded,
+};
+
+/**
+ * Data byte at a given index of a given test block
+ *
+ */
+static uint8_t test_block_byte(uint32_t seed, uint32_t block, uint32_t index)
+{
+    return (uint8_t) (seed + (block * 0x35) + (index * 7) + 1);
+}
+
+/**
+ * Build a fw_img_v2 with a correct checksum
+ *
+ * As for fw_imgs made by the firmware converter, only firmware fw_imgs have a symbol table and algorithm ID list.
+ *
+ */
+static void test_build_img(uint32_t *words,
+                           uint32_t seed,
+                           bool is_firmware,
+                           const uint32_t *block_sizes,
+                           const uint32_t *block_addrs)
+{
+    uint32_t i = 0;
+    uint32_t c0 = 0;
+    uint32_t c1 = 0;
+    uint16_t *halves;
+
+    memset(words, 0, TEST_IMG_MAX_WORDS * sizeof(uint32_t));
+
+    words[i++] = FW_IMG_BOOT_FW_IMG_V1_MAGIC_1;
+    words[i++] = 2;
+    words[i++] = 0;                                     // img_size, filled in below
+    words[i++] = is_firmware ? TEST_IMG_SYMBOLS : 0;
+    words[i++] = is_firmware ? 1 : 0;                   // alg_id_list_size
+    words[i++] = 0x1234 + seed;                         // fw_id
+    words[i++] = 0x010203;                              // fw_version
+    words[i++] = TEST_IMG_BLOCKS;
+    words[i++] = TEST_MAX_BLOCK_SIZE;
+    words[i++] = 0x0b00;                                // fw_img_release
+
+    if (is_firmware)
+    {
+        for (uint32_t s = 0; s < TEST_IMG_SYMBOLS; s++)
+        {
+            words[i++] = 0x100 + s;
+            words[i++] = 0x2800100 + (s * 4);
+        }
+        words[i++] = 0xf0000;
+    }
+
+    for (uint32_t b = 0; b < TEST_IMG_BLOCKS; b++)
+    {
+        uint8_t *data;
+
+        words[i++] = block_sizes[b];
+        words[i++] = block_addrs[b];
+        data = (uint8_t *) &words[i];
+        for (uint32_t j = 0; j < block_sizes[b]; j++)
+        {
+            data[j] = test_block_byte(seed, b, j);
+        }
+        i += block_sizes[b] / sizeof(uint32_t);
+    }
+
+    words[i++] = FW_IMG_BOOT_FW_IMG_V1_MAGIC_2;
+    words[2] = (i + 1) * sizeof(uint32_t);
+
+    halves = (uint16_t *) words;
+    for (uint32_t h = 0; h < (i * 2); h++)
+    {
+        c0 = (c0 + halves[h]) % FW_IMG_MODVAL;
+        c1 = (c1 + c0) % FW_IMG_MODVAL;
+    }
+    words[i] = c0 + (c1 << 16);
+}
+
+/**
+ * Check that a mock device holds the blocks of a test fw_img
+ *
+ */
+static void test_check_img(test_device_t *device,
+                           uint32_t seed,
+                           const uint32_t *block_sizes,
+                           const uint32_t *block_addrs,
+                           uint32_t first_block,
+                           uint32_t num_blocks)
+{
+    for (uint32_t b = first_block; b < (first_block + num_blocks); b++)
+    {
+        for (uint32_t j = 0; j < block_sizes[b]; j += 4)
+        {
+            uint32_t expected = ((uint32_t) test_block_byte(seed, b, j) << 24) |
+                                ((uint32_t) test_block_byte(seed, b, j + 1) << 16) |
+                                ((uint32_t) test_block_byte(seed, b, j + 2) << 8) |
+                                test_block_byte(seed, b, j + 3);
+
+            TEST_ASSERT_EQUAL_HEX32(expected, test_device_read(device, block_addrs[b] + j));
+        }
+    }
+}
+
+/**
+ * Check that a mock device holds the test firmware, overlaid with the test tuning
+ *
+ */
+static void test_check_device(test_device_t *device)
+{
+    // The last tuning block overwrites the second firmware block, so only check the firmware blocks it doesn't touch
+    test_check_img(device, 0, test_fw_block_sizes, test_fw_block_addrs, 0, 1);
+    test_check_img(device, 0, test_fw_block_sizes, test_fw_block_addrs, 2, 1);
+    test_check_img(device, 0x40, test_tune_block_sizes, test_tune_block_addrs, 0, TEST_IMG_BLOCKS);
+    TEST_ASSERT_EQUAL_HEX32(((uint32_t) test_block_byte(0, 1, 8) << 24) |
+                            ((uint32_t) test_block_byte(0, 1, 9) << 16) |
+                            ((uint32_t) test_block_byte(0, 1, 10) << 8) |
+                            test_block_byte(0, 1, 11),
+                            test_device_read(device, test_fw_block_addrs[1] + 8));
+}
+
+/**
+ * Free the fw_info tables allocated by the scheduler
+ *
+ */
+static void test_free_fw_infos(void)
+{
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        if (test_jobs[i].arena == NULL)
+        {
+            free(test_fw_infos[i].sym_table);
+            free(test_fw_infos[i].alg_id_list);
+            free(test_fw_infos[i].coeff_set_index);
+        }
+        memset(&test_fw_infos[i], 0, sizeof(fw_img_info_t));
+    }
+}
+
+/**
+ * Boot a number of mock devices on threaded buses, returning the fastest time taken in us
+ *
+ */
+static uint64_t test_run_threaded(uint32_t num_jobs)
+{
+    uint64_t fastest_us = UINT64_MAX;
+
+    for (uint32_t pass = 0; pass < TEST_THREADED_PASSES; pass++)
+    {
+        uint64_t start_us;
+        uint64_t pass_us;
+
+        test_free_fw_infos();
+        for (uint32_t i = 0; i < num_jobs; i++)
+        {
+            test_devices[i].block_writes = 0;
+            test_devices[i].boots = 0;
+            test_jobs[i].ops = &test_ops_threaded;
+            test_jobs[i].bus_id = test_devices[i].bus;
+        }
+
+        start_us = test_get_us();
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, num_jobs, test_get_time_ms));
+        pass_us = test_get_us() - start_us;
+        if (pass_us < fastest_us)
+        {
+            fastest_us = pass_us;
+        }
+    }
+
+    return fastest_us;
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(boot_sched);
+
+TEST_SETUP(boot_sched)
+{
+    test_saved_bsp_driver_if = bsp_driver_if_g;
+    bsp_driver_if_g = &test_bsp_driver_if;
+    test_now_ms = 0;
+    test_timer_ms = 0;
+
+    test_build_img(test_fw_img_words, 0, true, test_fw_block_sizes, test_fw_block_addrs);
+    test_build_img(test_tune_img_words, 0x40, false, test_tune_block_sizes, test_tune_block_addrs);
+
+    memset(test_devices, 0, sizeof(test_devices));
+    memset(test_jobs, 0, sizeof(test_jobs));
+    memset(test_fw_infos, 0, sizeof(test_fw_infos));
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        test_devices[i].reset_wait_ms = TEST_RESET_WAIT_MS;
+
+        test_cps[i].dev_id = i;
+        test_cps[i].bus_type = REGMAP_BUS_TYPE_I2C;
+
+        test_jobs[i].driver = &test_devices[i];
+        test_jobs[i].ops = &test_ops;
+        test_jobs[i].cp = &test_cps[i];
+        test_jobs[i].fw_imgs[0] = test_fw_img;
+        test_jobs[i].fw_imgs[1] = test_tune_img;
+        test_jobs[i].fw_info = &test_fw_infos[i];
+        test_jobs[i].block_data = test_block_data[i];
+        test_jobs[i].block_data_size = TEST_MAX_BLOCK_SIZE;
+    }
+    test_broadcast_cp.dev_id = TEST_BROADCAST_DEV_ID;
+    test_broadcast_cp.bus_type = REGMAP_BUS_TYPE_I2C;
+}
+
+TEST_TEAR_DOWN(boot_sched)
+{
+    if (test_is_threaded)
+    {
+        test_buses_stop();
+    }
+    test_free_fw_infos();
+    bsp_driver_if_g = test_saved_bsp_driver_if;
+}
+
+TEST(boot_sched, run_invalid_jobs)
+{
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_run(NULL, 1, test_get_time_ms));
+
+    test_jobs[1].ops = NULL;
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_run(test_jobs, 2, test_get_time_ms));
+
+    test_jobs[1].ops = &test_ops;
+    test_jobs[1].block_data = NULL;
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_run(test_jobs, 2, test_get_time_ms));
+
+    // Nothing is touched unless every job is valid
+    TEST_ASSERT_EQUAL(0, test_devices[0].block_writes);
+    TEST_ASSERT_EQUAL(0, test_devices[0].reset_start_ms + test_devices[0].boots);
+}
+
+TEST(boot_sched, run_boots_every_device)
+{
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, TEST_DEVICES, test_get_time_ms));
+
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[i].state);
+        TEST_ASSERT_EQUAL(1, test_devices[i].boots);
+        TEST_ASSERT_EQUAL_PTR(&test_fw_infos[i], test_devices[i].booted_fw_info);
+        TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[i].block_writes);
+        test_check_device(&test_devices[i]);
+
+        // fw_info is that of the firmware rather than the tuning
+        TEST_ASSERT_EQUAL(0x1234, test_fw_infos[i].header.fw_id);
+        TEST_ASSERT_EQUAL_HEX32(0x2800104, fw_img_find_symbol(&test_fw_infos[i], 0x101));
+        TEST_ASSERT_TRUE(fw_img_find_algid(&test_fw_infos[i], 0xf0000));
+    }
+}
+
+TEST(boot_sched, run_overlaps_reset_waits)
+{
+    uint32_t sequential_ms = 0;
+    uint32_t download_ms = 0;
+
+    // Time taken to boot the devices one after another
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        test_now_ms = 0;
+        test_devices[i].reset_wait_ms = TEST_RESET_WAIT_MS * (i + 1);
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(&test_jobs[i], 1, test_get_time_ms));
+        sequential_ms += test_now_ms;
+        download_ms = test_now_ms - test_devices[i].reset_done_ms;
+    }
+    test_free_fw_infos();
+
+    test_now_ms = 0;
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, TEST_DEVICES, test_get_time_ms));
+
+    // The first device is downloaded to whilst the others are still waiting to come out of reset...
+    TEST_ASSERT_LESS_THAN(test_devices[1].reset_done_ms, test_devices[0].first_write_ms);
+    TEST_ASSERT_LESS_THAN(test_devices[2].reset_done_ms, test_devices[1].first_write_ms);
+    // ...so the whole boot takes little more than the slowest device, rather than the sum of all of them
+    TEST_ASSERT_LESS_THAN(sequential_ms, test_now_ms);
+    TEST_ASSERT_LESS_OR_EQUAL(test_devices[2].reset_done_ms + download_ms, test_now_ms);
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        test_check_device(&test_devices[i]);
+    }
+}
+
+TEST(boot_sched, run_shared_bus_serialises_downloads)
+{
+    uint32_t download_ms;
+
+    // With no reset waits there is nothing to overlap - every job is on the one bus, so downloads just take turns
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        test_devices[i].reset_wait_ms = 0;
+    }
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, TEST_DEVICES, test_get_time_ms));
+    download_ms = test_now_ms - test_timer_ms;
+
+    test_free_fw_infos();
+    test_now_ms = 0;
+    test_timer_ms = 0;
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, 1, test_get_time_ms));
+    TEST_ASSERT_EQUAL(download_ms, TEST_DEVICES * (test_now_ms - test_timer_ms));
+}
+
+TEST(boot_sched, run_separate_buses_download_concurrently)
+{
+    uint64_t one_us;
+    uint64_t shared_us;
+    uint64_t separate_us;
+    uint32_t device_transfer_us = 0;
+
+    for (uint32_t b = 0; b < TEST_IMG_BLOCKS; b++)
+    {
+        device_transfer_us += (8 + test_fw_block_sizes[b] + test_tune_block_sizes[b]) * TEST_US_PER_BYTE;
+    }
+
+    test_buses_start();
+
+    // One device on its own
+    one_us = test_run_threaded(1);
+
+    // Two devices on one bus take turns, so take at least twice as long
+    test_devices[1].bus = 0;
+    shared_us = test_run_threaded(2);
+
+    // Two devices on their own buses download at the same time, so take about as long as one
+    test_devices[1].bus = 1;
+    separate_us = test_run_threaded(2);
+
+    TEST_ASSERT_EQUAL(0, test_buses_stop());
+    printf("boot_sched threaded buses: 1 device %lu us, 2 devices on 1 bus %lu us, on 2 buses %lu us\n",
+           (unsigned long) one_us,
+           (unsigned long) shared_us,
+           (unsigned long) separate_us);
+
+    TEST_ASSERT_GREATER_OR_EQUAL(device_transfer_us, one_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(2 * device_transfer_us, shared_us);
+    TEST_ASSERT_LESS_THAN((one_us * 3) / 2, separate_us);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[i].state);
+        TEST_ASSERT_EQUAL(1, test_devices[i].boots);
+        TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[i].block_writes);
+        test_check_device(&test_devices[i]);
+    }
+}
+
+TEST(boot_sched, run_without_time_source)
+{
+    // Without a time source, waits are never shortened by time spent downloading to other devices
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, TEST_DEVICES, NULL));
+    TEST_ASSERT_GREATER_OR_EQUAL(1 + TEST_RESET_WAIT_MS, test_timer_ms);
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[i].state);
+        test_check_device(&test_devices[i]);
+    }
+}
+
+TEST(boot_sched, run_failed_job_does_not_stop_others)
+{
+    test_devices[1].fail_boot = true;
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_run(test_jobs, TEST_DEVICES, test_get_time_ms));
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[0].state);
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_ERROR, test_jobs[1].state);
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[2].state);
+}
+
+TEST(boot_sched, run_truncated_fw_img)
+{
+    // IMG_SIZE no longer covers the checksum of the tuning
+    test_tune_img_words[2] -= 8;
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_run(test_jobs, 1, test_get_time_ms));
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_ERROR, test_jobs[0].state);
+    TEST_ASSERT_EQUAL(0, test_devices[0].boots);
+}
+
+TEST(boot_sched, run_block_too_large)
+{
+    test_jobs[0].block_data_size = TEST_MAX_BLOCK_SIZE - 4;
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_run(test_jobs, 1, test_get_time_ms));
+    TEST_ASSERT_EQUAL(0, test_devices[0].block_writes);
+}
+
+TEST(boot_sched, run_with_arena)
+{
+    uint8_t arena_buf[TEST_DEVICES][128] __attribute__((aligned(8)));
+    arena_t arenas[TEST_DEVICES];
+
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        arena_init(&arenas[i], arena_buf[i], sizeof(arena_buf[i]));
+        test_jobs[i].arena = &arenas[i];
+    }
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_run(test_jobs, TEST_DEVICES, test_get_time_ms));
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        TEST_ASSERT_TRUE((uint8_t *) test_fw_infos[i].sym_table >= arena_buf[i]);
+        TEST_ASSERT_TRUE((uint8_t *) test_fw_infos[i].sym_table < (arena_buf[i] + sizeof(arena_buf[i])));
+        TEST_ASSERT_GREATER_THAN(0, arena_get_high_water(&arenas[i]));
+        TEST_ASSERT_EQUAL_HEX32(0x2800100, fw_img_find_symbol(&test_fw_infos[i], 0x100));
+    }
+}
+
+TEST(boot_sched, broadcast_invalid_jobs)
+{
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_broadcast(test_jobs, 0, &test_broadcast_cp));
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_broadcast(test_jobs, TEST_DEVICES, NULL));
+
+    test_jobs[2].fw_info = NULL;
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_broadcast(test_jobs, TEST_DEVICES, &test_broadcast_cp));
+    test_jobs[2].fw_info = &test_fw_infos[2];
+
+    TEST_ASSERT_EQUAL(0, test_devices[0].block_writes);
+}
+
+TEST(boot_sched, broadcast_verify_all_received)
+{
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_broadcast(test_jobs, TEST_DEVICES, &test_broadcast_cp));
+
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[i].state);
+        TEST_ASSERT_EQUAL(1, test_devices[i].boots);
+        // Every device received the one broadcast, so nothing was downloaded individually
+        TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[i].block_writes);
+        test_check_device(&test_devices[i]);
+        TEST_ASSERT_EQUAL_HEX32(0x2800104, fw_img_find_symbol(&test_fw_infos[i], 0x101));
+        TEST_ASSERT_TRUE(fw_img_find_algid(&test_fw_infos[i], 0xf0000));
+    }
+}
+
+TEST(boot_sched, broadcast_verify_fails_downloads_individually)
+{
+    // The second device is not listening to the broadcast address, so holds stale data
+    test_devices[1].ignores_broadcast = true;
+    test_device_write(&test_devices[1], test_fw_block_addrs[0], 0xdeadbeef);
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_broadcast(test_jobs, TEST_DEVICES, &test_broadcast_cp));
+
+    TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[0].block_writes);
+    TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[1].block_writes);
+    TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[2].block_writes);
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[i].state);
+        TEST_ASSERT_EQUAL(1, test_devices[i].boots);
+        test_check_device(&test_devices[i]);
+    }
+}
+
+TEST(boot_sched, broadcast_verify_detects_partial_download)
+{
+    // The third device received the firmware but then missed the end of the tuning, so only a word of it differs
+    test_devices[2].missed_addr = test_tune_block_addrs[1] + test_tune_block_sizes[1] - 4;
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_broadcast(test_jobs, TEST_DEVICES, &test_broadcast_cp));
+    TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[1].block_writes);
+    TEST_ASSERT_EQUAL(4 * TEST_IMG_BLOCKS, test_devices[2].block_writes);
+    test_check_device(&test_devices[2]);
+}
+
+TEST(boot_sched, broadcast_verify_detects_missed_middle_word)
+{
+    // The second device missed a single word in the middle of the first firmware block, so only that word differs
+    test_devices[1].missed_addr = test_fw_block_addrs[0] + (test_fw_block_sizes[0] / 2);
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_OK, boot_sched_broadcast(test_jobs, TEST_DEVICES, &test_broadcast_cp));
+
+    // Only the second device was downloaded to individually, after receiving the broadcast
+    TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[0].block_writes);
+    TEST_ASSERT_EQUAL(4 * TEST_IMG_BLOCKS, test_devices[1].block_writes);
+    TEST_ASSERT_EQUAL(2 * TEST_IMG_BLOCKS, test_devices[2].block_writes);
+    for (uint32_t i = 0; i < TEST_DEVICES; i++)
+    {
+        TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[i].state);
+        test_check_device(&test_devices[i]);
+        TEST_ASSERT_EQUAL_HEX32(0x2800104, fw_img_find_symbol(&test_fw_infos[i], 0x101));
+    }
+}
+
+TEST(boot_sched, broadcast_failed_boot_does_not_stop_others)
+{
+    test_devices[0].fail_boot = true;
+
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATUS_FAIL, boot_sched_broadcast(test_jobs, TEST_DEVICES, &test_broadcast_cp));
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_ERROR, test_jobs[0].state);
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[1].state);
+    TEST_ASSERT_EQUAL(BOOT_SCHED_STATE_DONE, test_jobs[2].state);
+    test_check_device(&test_devices[1]);
+}
+
+TEST_GROUP_RUNNER(boot_sched)
+{
+    RUN_TEST_CASE(boot_sched, run_invalid_jobs);
+    RUN_TEST_CASE(boot_sched, run_boots_every_device);
+    RUN_TEST_CASE(boot_sched, run_overlaps_reset_waits);
+    RUN_TEST_CASE(boot_sched, run_shared_bus_serialises_downloads);
+    RUN_TEST_CASE(boot_sched, run_separate_buses_download_concurrently);
+    RUN_TEST_CASE(boot_sched, run_without_time_source);
+    RUN_TEST_CASE(boot_sched, run_failed_job_does_not_stop_others);
+    RUN_TEST_CASE(boot_sched, run_truncated_fw_img);
+    RUN_TEST_CASE(boot_sched, run_block_too_large);
+    RUN_TEST_CASE(boot_sched, run_with_arena);
+    RUN_TEST_CASE(boot_sched, broadcast_invalid_jobs);
+    RUN_TEST_CASE(boot_sched, broadcast_verify_all_received);
+    RUN_TEST_CASE(boot_sched, broadcast_verify_fails_downloads_individually);
+    RUN_TEST_CASE(boot_sched, broadcast_verify_detects_partial_download);
+    RUN_TEST_CASE(boot_sched, broadcast_verify_detects_missed_middle_word);
+    RUN_TEST_CASE(boot_sched, broadcast_failed_boot_does_not_stop_others);
+}
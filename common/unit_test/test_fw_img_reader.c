@@ -0,0 +1,623 @@
+/**
+ * @file test_fw_img_reader.c
+ *
+ * @brief Unit tests for the fw_img streaming reader
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic 2021 All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <string.h>
+#include "unity.h"
+#include "unity_fixture.h"
+#include "fw_img.h"
+
+/***********************************************************************************************************************
+ * LOCAL LITERAL SUBSTITUTIONS
+ **********************************************************************************************************************/
+#define TEST_IMG_MAX_WORDS              (512)
+#define TEST_IMG_SYMBOLS                (3)
+#define TEST_IMG_ALGIDS                 (2)
+#define TEST_IMG_BLOCKS                 (4)
+#define TEST_IMG_MAX_BLOCK_SIZE         (256)
+#define TEST_READ_BUFFER_MAX            (1024)
+
+/***********************************************************************************************************************
+ * LOCAL VARIABLES
+ **********************************************************************************************************************/
+/**
+ * Asynchronous fw_img source
+ *
+ * Reads are only started when issued, and are completed later from the reader's wait hook - the same way a DMA or
+ * interrupt-driven source (i.e. bsp_eeprom_fw_img_read) completes them from an ISR.
+ */
+typedef struct
+{
+    const uint8_t *img;
+    uint32_t available;                 // Bytes of img that can be read, reads past this complete with a failure
+    bool fail_start;                    // Fail the next read when it is issued
+
+    bool pending;
+    uint32_t offset;
+    uint8_t *buffer;
+    uint32_t length;
+    bsp_callback_t cb;
+    void *cb_arg;
+
+    uint32_t reads;
+    uint32_t completions;
+    uint32_t waits;
+} test_async_source_t;
+
+static const uint32_t test_block_sizes[TEST_IMG_BLOCKS] = {20, 256, 4, 132};
+static const uint32_t test_block_addrs[TEST_IMG_BLOCKS] = {0x2800000, 0x2801000, 0x2b80000, 0x3400000};
+
+static uint32_t test_img_words[TEST_IMG_MAX_WORDS];
+static uint8_t *test_img = (uint8_t *) test_img_words;
+static uint32_t test_img_size;
+
+static test_async_source_t test_source;
+static uint8_t test_read_buffer[TEST_READ_BUFFER_MAX];
+
+static fw_img_v1_sym_table_t test_sym_table[TEST_IMG_SYMBOLS];
+static uint32_t test_alg_id_list[TEST_IMG_ALGIDS];
+static uint8_t test_block_data[TEST_IMG_MAX_BLOCK_SIZE];
+
+// Image as seen by the device, reconstructed from the data blocks passed out by fw_img_process()
+static uint8_t test_written[TEST_IMG_BLOCKS][TEST_IMG_MAX_BLOCK_SIZE];
+static uint32_t test_written_addr[TEST_IMG_BLOCKS];
+static uint32_t test_written_size[TEST_IMG_BLOCKS];
+static uint32_t test_written_count;
+
+// Number of next calls that returned with the read-ahead still in flight
+static uint32_t test_overlapped;
+
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+/**
+ * Data byte at a given index of a given test block
+ *
+ */
+static uint8_t test_block_byte(uint32_t block, uint32_t index)
+{
+    return (uint8_t) ((block * 0x35) + (index * 7) + 1);
+}
+
+/**
+ * Build a fw_img_v2 with the test symbols, algorithm IDs and data blocks, and a correct checksum
+ *
+ */
+static void test_build_img(void)
+{
+    uint32_t i = 0;
+    uint32_t c0 = 0;
+    uint32_t c1 = 0;
+    uint16_t *halves;
+
+    memset(test_img_words, 0, sizeof(test_img_words));
+
+    test_img_words[i++] = FW_IMG_BOOT_FW_IMG_V1_MAGIC_1;
+    test_img_words[i++] = 2;
+    test_img_words[i++] = 0;                            // img_size, filled in below
+    test_img_words[i++] = TEST_IMG_SYMBOLS;
+    test_img_words[i++] = TEST_IMG_ALGIDS;
+    test_img_words[i++] = 0x1234;                       // fw_id
+    test_img_words[i++] = 0x010203;                     // fw_version
+    test_img_words[i++] = TEST_IMG_BLOCKS;
+    test_img_words[i++] = TEST_IMG_MAX_BLOCK_SIZE;
+    test_img_words[i++] = 0x0b00;                       // fw_img_release
+
+    for (uint32_t s = 0; s < TEST_IMG_SYMBOLS; s++)
+    {
+        test_img_words[i++] = 0x100 + s;
+        test_img_words[i++] = 0x2800100 + (s * 4);
+    }
+
+    for (uint32_t a = 0; a < TEST_IMG_ALGIDS; a++)
+    {
+        test_img_words[i++] = 0xf0000 + a;
+    }
+
+    for (uint32_t b = 0; b < TEST_IMG_BLOCKS; b++)
+    {
+        uint8_t *data;
+
+        test_img_words[i++] = test_block_sizes[b];
+        test_img_words[i++] = test_block_addrs[b];
+        data = (uint8_t *) &test_img_words[i];
+        for (uint32_t j = 0; j < test_block_sizes[b]; j++)
+        {
+            data[j] = test_block_byte(b, j);
+        }
+        i += test_block_sizes[b] / sizeof(uint32_t);
+    }
+
+    test_img_words[i++] = FW_IMG_BOOT_FW_IMG_V1_MAGIC_2;
+    test_img_size = (i + 1) * sizeof(uint32_t);
+    test_img_words[2] = test_img_size;
+
+    // Fletcher checksum over every 16-bit half up to and including IMG_MAGIC_NUMBER_2
+    halves = (uint16_t *) test_img_words;
+    for (uint32_t h = 0; h < (i * 2); h++)
+    {
+        c0 = (c0 + halves[h]) % FW_IMG_MODVAL;
+        c1 = (c1 + c0) % FW_IMG_MODVAL;
+    }
+    test_img_words[i] = c0 + (c1 << 16);
+}
+
+/**
+ * fw_img_read_t implementation for the asynchronous test source
+ *
+ */
+static uint32_t test_async_read(void *arg,
+                                uint32_t offset,
+                                uint8_t *buffer,
+                                uint32_t length,
+                                bsp_callback_t cb,
+                                void *cb_arg)
+{
+    test_async_source_t *source = (test_async_source_t *) arg;
+
+    // The reader must never issue a read whilst one is outstanding
+    TEST_ASSERT_FALSE(source->pending);
+
+    if (source->fail_start)
+    {
+        return FW_IMG_STATUS_FAIL;
+    }
+
+    source->pending = true;
+    source->offset = offset;
+    source->buffer = buffer;
+    source->length = length;
+    source->cb = cb;
+    source->cb_arg = cb_arg;
+    source->reads++;
+
+    return FW_IMG_STATUS_OK;
+}
+
+/**
+ * Wait hook for the asynchronous test source - completes the outstanding read, as its ISR would
+ *
+ */
+static void test_async_wait(void *arg)
+{
+    test_async_source_t *source = (test_async_source_t *) arg;
+    uint32_t status = FW_IMG_STATUS_OK;
+
+    source->waits++;
+    if (!source->pending)
+    {
+        return;
+    }
+
+    if ((source->offset + source->length) > source->available)
+    {
+        status = FW_IMG_STATUS_FAIL;
+    }
+    else
+    {
+        memcpy(source->buffer, source->img + source->offset, source->length);
+    }
+
+    source->pending = false;
+    source->completions++;
+    source->cb(status, source->cb_arg);
+}
+
+/**
+ * Set up a reader on the asynchronous test source
+ *
+ */
+static void test_reader_init(fw_img_reader_t *reader, uint32_t buffer_size)
+{
+    memset(reader, 0, sizeof(fw_img_reader_t));
+    reader->read = test_async_read;
+    reader->read_arg = &test_source;
+    reader->wait = test_async_wait;
+    reader->buffer = test_read_buffer;
+    reader->buffer_size = buffer_size;
+}
+
+/**
+ * Stream the test fw_img through fw_img_process(), as bsp_dut_stream_fw_img() does
+ *
+ */
+static uint32_t test_stream_img(uint32_t buffer_size)
+{
+    uint32_t ret;
+    fw_img_reader_t reader;
+    fw_img_boot_state_t boot_state;
+
+    test_reader_init(&reader, buffer_size);
+    memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+
+    ret = fw_img_reader_start(&reader);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return ret;
+    }
+
+    ret = fw_img_reader_next(&reader, &boot_state);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return ret;
+    }
+    if (test_source.pending)
+    {
+        test_overlapped++;
+    }
+
+    boot_state.fw_info.sym_table = test_sym_table;
+    boot_state.fw_info.alg_id_list = test_alg_id_list;
+    ret = fw_img_read_header(&boot_state);
+    if (ret != FW_IMG_STATUS_OK)
+    {
+        return ret;
+    }
+    boot_state.block_data_size = boot_state.fw_info.header.max_block_size;
+    boot_state.block_data = test_block_data;
+
+    while (1)
+    {
+        ret = fw_img_process(&boot_state);
+        if (ret == FW_IMG_STATUS_DATA_READY)
+        {
+            TEST_ASSERT_LESS_THAN(TEST_IMG_BLOCKS, test_written_count);
+            test_written_addr[test_written_count] = boot_state.block.block_addr;
+            test_written_size[test_written_count] = boot_state.block.block_size;
+            memcpy(test_written[test_written_count], boot_state.block_data, boot_state.block.block_size);
+            test_written_count++;
+            continue;
+        }
+        if (ret != FW_IMG_STATUS_NODATA)
+        {
+            break;
+        }
+
+        ret = fw_img_reader_next(&reader, &boot_state);
+        if (ret != FW_IMG_STATUS_OK)
+        {
+            break;
+        }
+        // The following read must still be in flight, so that it overlaps with the processing of this block
+        if (test_source.pending)
+        {
+            test_overlapped++;
+        }
+    }
+
+    // Nothing may be left in flight once streaming has finished
+    TEST_ASSERT_FALSE(test_source.pending);
+
+    return ret;
+}
+
+/**
+ * Check that every data block of the test fw_img was passed out intact and in order
+ *
+ */
+static void test_check_written(void)
+{
+    TEST_ASSERT_EQUAL(TEST_IMG_BLOCKS, test_written_count);
+    for (uint32_t b = 0; b < TEST_IMG_BLOCKS; b++)
+    {
+        TEST_ASSERT_EQUAL_HEX32(test_block_addrs[b], test_written_addr[b]);
+        TEST_ASSERT_EQUAL(test_block_sizes[b], test_written_size[b]);
+        for (uint32_t j = 0; j < test_block_sizes[b]; j++)
+        {
+            TEST_ASSERT_EQUAL_HEX8(test_block_byte(b, j), test_written[b][j]);
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * TESTS
+ **********************************************************************************************************************/
+TEST_GROUP(fw_img_reader);
+
+TEST_SETUP(fw_img_reader)
+{
+    test_build_img();
+
+    memset(&test_source, 0, sizeof(test_source));
+    test_source.img = test_img;
+    test_source.available = test_img_size;
+
+    memset(test_written, 0, sizeof(test_written));
+    test_written_count = 0;
+    test_overlapped = 0;
+}
+
+TEST_TEAR_DOWN(fw_img_reader)
+{
+}
+
+TEST(fw_img_reader, start_rejects_bad_buffer)
+{
+    fw_img_reader_t reader;
+
+    // Each half must hold the preheader and largest header
+    test_reader_init(&reader, 80);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start(&reader));
+
+    // Buffer must be a multiple of 8 bytes
+    test_reader_init(&reader, 92);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start(&reader));
+
+    test_reader_init(&reader, 88);
+    reader.read = NULL;
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start(&reader));
+
+    TEST_ASSERT_EQUAL(0, test_source.reads);
+}
+
+TEST(fw_img_reader, blocks_cover_img)
+{
+    uint32_t buffer_sizes[] = {88, 96, 136, 200, TEST_READ_BUFFER_MAX};
+
+    for (uint32_t i = 0; i < (sizeof(buffer_sizes) / sizeof(uint32_t)); i++)
+    {
+        fw_img_reader_t reader;
+        fw_img_boot_state_t boot_state;
+        uint32_t expected_offset = 0;
+        uint32_t half_size = buffer_sizes[i] / 2;
+
+        memset(&test_source, 0, sizeof(test_source));
+        test_source.img = test_img;
+        test_source.available = test_img_size;
+
+        test_reader_init(&reader, buffer_sizes[i]);
+        memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+        TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_start(&reader));
+        TEST_ASSERT_EQUAL(test_img_size, reader.img_size);
+
+        // Every block is a full half of the buffer apart from the last, and consecutive blocks tile the fw_img
+        while (expected_offset < test_img_size)
+        {
+            uint32_t expected_size = test_img_size - expected_offset;
+
+            if (expected_size > half_size)
+            {
+                expected_size = half_size;
+            }
+
+            TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+            TEST_ASSERT_EQUAL(expected_size, boot_state.fw_img_blocks_size);
+            TEST_ASSERT_EQUAL_MEMORY(test_img + expected_offset, boot_state.fw_img_blocks, expected_size);
+            expected_offset += expected_size;
+
+            // The read of the following block is still outstanding, so the halves must not overlap
+            if (expected_offset < test_img_size)
+            {
+                TEST_ASSERT_TRUE(test_source.pending);
+                TEST_ASSERT_TRUE((test_source.buffer + test_source.length <= boot_state.fw_img_blocks) ||
+                                 (boot_state.fw_img_blocks + boot_state.fw_img_blocks_size <= test_source.buffer));
+            }
+        }
+
+        TEST_ASSERT_FALSE(test_source.pending);
+        TEST_ASSERT_EQUAL(FW_IMG_STATUS_NODATA, fw_img_reader_next(&reader, &boot_state));
+    }
+}
+
+TEST(fw_img_reader, process_img_all_buffer_sizes)
+{
+    uint32_t buffer_sizes[] = {88, 96, 104, 136, 200, 264, TEST_READ_BUFFER_MAX};
+
+    for (uint32_t i = 0; i < (sizeof(buffer_sizes) / sizeof(uint32_t)); i++)
+    {
+        memset(&test_source, 0, sizeof(test_source));
+        test_source.img = test_img;
+        test_source.available = test_img_size;
+        memset(test_written, 0, sizeof(test_written));
+        test_written_count = 0;
+        test_overlapped = 0;
+
+        TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, test_stream_img(buffer_sizes[i]));
+        test_check_written();
+
+        TEST_ASSERT_EQUAL(test_source.reads, test_source.completions);
+        // Once the whole fw_img fits in half of the buffer there is nothing to read ahead
+        if ((buffer_sizes[i] / 2) < test_img_size)
+        {
+            TEST_ASSERT_GREATER_THAN(0, test_overlapped);
+        }
+    }
+}
+
+TEST(fw_img_reader, process_img_sync_source)
+{
+    fw_img_memory_source_t source;
+    fw_img_reader_t reader;
+    fw_img_boot_state_t boot_state;
+    uint32_t ret;
+
+    source.fw_img = test_img;
+    memset(&reader, 0, sizeof(fw_img_reader_t));
+    reader.read = fw_img_memory_read;
+    reader.read_arg = &source;
+    reader.buffer = test_read_buffer;
+    reader.buffer_size = 96;
+    memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_start(&reader));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    boot_state.fw_info.sym_table = test_sym_table;
+    boot_state.fw_info.alg_id_list = test_alg_id_list;
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_read_header(&boot_state));
+    boot_state.block_data_size = boot_state.fw_info.header.max_block_size;
+    boot_state.block_data = test_block_data;
+
+    while ((ret = fw_img_process(&boot_state)) != FW_IMG_STATUS_OK)
+    {
+        if (ret == FW_IMG_STATUS_DATA_READY)
+        {
+            test_written_addr[test_written_count] = boot_state.block.block_addr;
+            test_written_size[test_written_count] = boot_state.block.block_size;
+            memcpy(test_written[test_written_count], boot_state.block_data, boot_state.block.block_size);
+            test_written_count++;
+            continue;
+        }
+        TEST_ASSERT_EQUAL(FW_IMG_STATUS_NODATA, ret);
+        TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    }
+
+    test_check_written();
+    TEST_ASSERT_EQUAL_HEX32(0x2800104, fw_img_find_symbol(&boot_state.fw_info, 0x101));
+    TEST_ASSERT_TRUE(fw_img_find_algid(&boot_state.fw_info, 0xf0001));
+}
+
+TEST(fw_img_reader, truncated_img_size)
+{
+    fw_img_reader_t reader;
+
+    // IMG_SIZE too small to even hold itself
+    test_img_words[2] = FW_IMG_SIZE_BYTES - 4;
+    test_reader_init(&reader, 96);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start(&reader));
+
+    // Source shorter than the IMG_SIZE bytes
+    test_source.available = FW_IMG_SIZE_BYTES - 1;
+    test_reader_init(&reader, 96);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start(&reader));
+    TEST_ASSERT_FALSE(test_source.pending);
+}
+
+TEST(fw_img_reader, truncated_source)
+{
+    uint32_t buffer_sizes[] = {88, 136, TEST_READ_BUFFER_MAX};
+
+    for (uint32_t i = 0; i < (sizeof(buffer_sizes) / sizeof(uint32_t)); i++)
+    {
+        memset(&test_source, 0, sizeof(test_source));
+        test_source.img = test_img;
+        test_written_count = 0;
+
+        // Source ends part way through the last data block
+        test_source.available = test_img_size - 20;
+        TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, test_stream_img(buffer_sizes[i]));
+        TEST_ASSERT_LESS_THAN(TEST_IMG_BLOCKS, test_written_count);
+        TEST_ASSERT_EQUAL(test_source.reads, test_source.completions);
+    }
+}
+
+TEST(fw_img_reader, truncated_img)
+{
+    // IMG_SIZE claims fewer bytes than the fw_img needs, so processing runs out of data before the checksum
+    test_img_words[2] = test_img_size - 8;
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_NODATA, test_stream_img(88));
+    TEST_ASSERT_FALSE(test_source.pending);
+}
+
+TEST(fw_img_reader, read_start_failure)
+{
+    fw_img_reader_t reader;
+    fw_img_boot_state_t boot_state;
+
+    test_reader_init(&reader, 88);
+    memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_start(&reader));
+
+    // The read-ahead issued by next fails to start
+    test_source.fail_start = true;
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_FALSE(test_source.pending);
+}
+
+TEST(fw_img_reader, corrupted_checksum)
+{
+    test_img_words[(test_img_size / sizeof(uint32_t)) - 1] ^= 1;
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, test_stream_img(136));
+    // All data blocks were passed out before the checksum was found to be wrong
+    TEST_ASSERT_EQUAL(TEST_IMG_BLOCKS, test_written_count);
+}
+
+TEST(fw_img_reader, seek_with_read_ahead_pending)
+{
+    fw_img_reader_t reader;
+    fw_img_boot_state_t boot_state;
+    uint32_t offset = 40;
+
+    test_reader_init(&reader, 88);
+    memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_start(&reader));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_TRUE(test_source.pending);
+
+    // Seeking must wait for the read-ahead before reusing its half of the buffer
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_seek(&reader, offset, 60));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_EQUAL(44, boot_state.fw_img_blocks_size);
+    TEST_ASSERT_EQUAL_MEMORY(test_img + offset, boot_state.fw_img_blocks, 44);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_EQUAL(16, boot_state.fw_img_blocks_size);
+    TEST_ASSERT_EQUAL_MEMORY(test_img + offset + 44, boot_state.fw_img_blocks, 16);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_NODATA, fw_img_reader_next(&reader, &boot_state));
+
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_seek(&reader, 2, 4));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_seek(&reader, 0, test_img_size + 4));
+}
+
+TEST(fw_img_reader, start_at_offset)
+{
+    fw_img_reader_t reader;
+    fw_img_boot_state_t boot_state;
+    uint32_t offset = 40;
+
+    test_reader_init(&reader, 88);
+    memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_start_at(&reader, offset, 60));
+
+    // Only IMG_SIZE and the requested part are read, with no read-ahead from the start of the fw_img
+    TEST_ASSERT_TRUE(test_source.pending);
+    TEST_ASSERT_EQUAL(offset, test_source.offset);
+    TEST_ASSERT_EQUAL(2, test_source.reads);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_EQUAL(44, boot_state.fw_img_blocks_size);
+    TEST_ASSERT_EQUAL_MEMORY(test_img + offset, boot_state.fw_img_blocks, 44);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_OK, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_EQUAL(16, boot_state.fw_img_blocks_size);
+    TEST_ASSERT_EQUAL_MEMORY(test_img + offset + 44, boot_state.fw_img_blocks, 16);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_NODATA, fw_img_reader_next(&reader, &boot_state));
+    TEST_ASSERT_EQUAL(3, test_source.reads);
+
+    test_reader_init(&reader, 88);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start_at(&reader, 2, 4));
+    test_reader_init(&reader, 88);
+    TEST_ASSERT_EQUAL(FW_IMG_STATUS_FAIL, fw_img_reader_start_at(&reader, 0, test_img_size + 4));
+    TEST_ASSERT_FALSE(test_source.pending);
+}
+
+TEST_GROUP_RUNNER(fw_img_reader)
+{
+    RUN_TEST_CASE(fw_img_reader, start_rejects_bad_buffer);
+    RUN_TEST_CASE(fw_img_reader, blocks_cover_img);
+    RUN_TEST_CASE(fw_img_reader, process_img_all_buffer_sizes);
+    RUN_TEST_CASE(fw_img_reader, process_img_sync_source);
+    RUN_TEST_CASE(fw_img_reader, truncated_img_size);
+    RUN_TEST_CASE(fw_img_reader, truncated_source);
+    RUN_TEST_CASE(fw_img_reader, truncated_img);
+    RUN_TEST_CASE(fw_img_reader, read_start_failure);
+    RUN_TEST_CASE(fw_img_reader, corrupted_checksum);
+    RUN_TEST_CASE(fw_img_reader, seek_with_read_ahead_pending);
+    RUN_TEST_CASE(fw_img_reader, start_at_offset);
+}
@@ -33,20 +33,34 @@
 #include "cs35l41_tune_48_fw_img.h"
 #include "cs35l41_tune_44p1_fw_img.h"
 #include "cs35l41_cal_fw_img.h"
+#ifdef CONFIG_FW_IMG_PRELINKED
+#include "cs35l41_fw_img_prelinked.h"
+#include "cs35l41_tune_fw_img_prelinked.h"
+#include "cs35l41_cal_fw_img_prelinked.h"
+#endif
 #include "test_tone_tables.h"
 #include "cs35l41_fs_switch_syscfg.h"
 #include "bridge.h"
+#include "boot_sched.h"
 
 /***********************************************************************************************************************
  * LOCAL LITERAL SUBSTITUTIONS
  **********************************************************************************************************************/
+/**
+ * Coefficient sets of the Fs tunings in a fw_img_v3 cs35l41_fw_img, in the order of the wmdr files passed to
+ * firmware_converter (see HALO_TUNE_48_WMDR and HALO_TUNE_44P1_WMDR in the makefile)
+ */
+#define BSP_DUT_COEFF_SET_TUNE_48       (0)
+#define BSP_DUT_COEFF_SET_TUNE_44P1     (1)
 
 /***********************************************************************************************************************
  * LOCAL VARIABLES
  **********************************************************************************************************************/
 static cs35l41_t cs35l41_driver;
 static fw_img_info_t fw_img_info;
+static uint8_t fw_img_read_buffer[2 * 1024] __attribute__((aligned(4)));
 static uint32_t bsp_dut_dig_gain = CS35L42_AMP_VOL_PCM_0DB;
+static uint8_t fw_img_block_data[CS35L41_CONTROL_PORT_MAX_PAYLOAD_BYTES] __attribute__((aligned(4)));
 
 static cs35l41_bsp_config_t bsp_config =
 {
@@ -94,30 +108,114 @@ static bridge_device_t device_list[] =
 /***********************************************************************************************************************
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
-uint32_t bsp_dut_write_fw_img(const uint8_t *fw_img, fw_img_info_t *fw_img_info)
+static uint32_t bsp_dut_sched_reset(void *driver, uint32_t *step, uint32_t *wait_ms)
+{
+    return cs35l41_reset_step((cs35l41_t *) driver, step, wait_ms);
+}
+
+static uint32_t bsp_dut_sched_boot(void *driver, fw_img_info_t *fw_info)
+{
+    return cs35l41_boot((cs35l41_t *) driver, fw_info);
+}
+
+static const boot_sched_ops_t bsp_dut_sched_ops =
+{
+    .reset = bsp_dut_sched_reset,
+    .boot = bsp_dut_sched_boot,
+};
+
+static uint32_t bsp_dut_process_fw_img(fw_img_reader_t *reader, fw_img_boot_state_t *boot_state)
 {
     uint32_t ret;
-    fw_img_boot_state_t boot_state;
-    const uint8_t *fw_img_end;
-    uint32_t write_size;
+
+    while (1)
+    {
+        // Start processing the rest of the fw_img
+        ret = fw_img_process(boot_state);
+        if (ret == FW_IMG_STATUS_DATA_READY)
+        {
+            // Data is ready to be sent to the device, so pass it to the driver
+            ret = regmap_write_block(&(cs35l41_driver.config.bsp_config.cp_config),
+                                       boot_state->block.block_addr,
+                                       boot_state->block_data,
+                                       boot_state->block.block_size);
+            if (ret == CS35L41_STATUS_FAIL)
+            {
+                ret = BSP_STATUS_FAIL;
+                break;
+            }
+            // There is still more data in this fw_img block, so don't provide new data
+            continue;
+        }
+        if (ret == FW_IMG_STATUS_FAIL)
+        {
+            ret = BSP_STATUS_FAIL;
+            break;
+        }
+        if (ret == FW_IMG_STATUS_OK)
+        {
+            // The fw_img checksum has been processed, so all blocks have been written
+            break;
+        }
+
+        // This fw_img block has been processed, so fetch the next block from the reader.  The reader will already
+        // have started reading it whilst the previous block was being written.
+        ret = fw_img_reader_next(reader, boot_state);
+        if (ret != FW_IMG_STATUS_OK)
+        {
+            ret = BSP_STATUS_FAIL;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+uint32_t bsp_dut_write_fw_img(const uint8_t *fw_img, fw_img_info_t *fw_img_info)
+{
+    fw_img_memory_source_t source;
 
     if (fw_img == NULL)
     {
         return BSP_STATUS_FAIL;
     }
 
-    // Ensure your fw_img_boot_state_t struct is initialised to zero.
+    // In this example the fw_img is memory-mapped, but any fw_img_read_t source (i.e. bsp_eeprom_fw_img_read) can be
+    // passed to bsp_dut_stream_fw_img()
+    source.fw_img = fw_img;
+
+    return bsp_dut_stream_fw_img(fw_img_memory_read, &source, fw_img_info);
+}
+
+uint32_t bsp_dut_stream_fw_img(fw_img_read_t read, void *read_arg, fw_img_info_t *fw_img_info)
+{
+    uint32_t ret;
+    fw_img_boot_state_t boot_state;
+    fw_img_reader_t reader;
+
+    // Ensure your fw_img_boot_state_t and fw_img_reader_t structs are initialised to zero.
     memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+    memset(&reader, 0, sizeof(fw_img_reader_t));
 
-    // Get pointer to end of this fw_img
-    fw_img_end = fw_img + FW_IMG_SIZE(fw_img);
+    // Emulate a system where only 1k fw_img blocks can be processed at a time - the reader buffer holds the block
+    // being processed plus the block being read ahead
+    reader.read = read;
+    reader.read_arg = read_arg;
+    reader.buffer = fw_img_read_buffer;
+    reader.buffer_size = sizeof(fw_img_read_buffer);
 
-    // Emulate a system where only 1k fw_img blocks can be processed at a time
-    write_size = 1024;
+    ret = fw_img_reader_start(&reader);
+    if (ret)
+    {
+        return BSP_STATUS_FAIL;
+    }
 
-    // Update the fw_img pointer and size in cs35l41_boot_state_t to start transferring data blocks
-    boot_state.fw_img_blocks = (uint8_t *) fw_img;
-    boot_state.fw_img_blocks_size = write_size;
+    // Get the first block of the fw_img into cs35l41_boot_state_t
+    ret = fw_img_reader_next(&reader, &boot_state);
+    if (ret)
+    {
+        return BSP_STATUS_FAIL;
+    }
 
     // Get pointers to buffers for Symbol and Algorithm list
     if (fw_img_info != NULL)
@@ -151,54 +249,74 @@ uint32_t bsp_dut_write_fw_img(const uint8_t *fw_img, fw_img_info_t *fw_img_info)
         return BSP_STATUS_FAIL;
     }
 
-    while (fw_img < fw_img_end)
+    ret = bsp_dut_process_fw_img(&reader, &boot_state);
+
+    if ((fw_img_info != NULL) && (ret != BSP_STATUS_FAIL))
     {
-        // Start processing the rest of the fw_img
-        ret = fw_img_process(&boot_state);
-        if (ret == FW_IMG_STATUS_DATA_READY)
-        {
-            // Data is ready to be sent to the device, so pass it to the driver
-            ret = regmap_write_block(&(cs35l41_driver.config.bsp_config.cp_config),
-                                       boot_state.block.block_addr,
-                                       boot_state.block_data,
-                                       boot_state.block.block_size);
-            if (ret == CS35L41_STATUS_FAIL)
-            {
-                ret = BSP_STATUS_FAIL;
-                break;
-            }
-            // There is still more data in this fw_img block, so don't provide new data
-            continue;
-        }
-        if (ret == FW_IMG_STATUS_FAIL)
-        {
-            ret = BSP_STATUS_FAIL;
-            break;
-        }
+        *fw_img_info = boot_state.fw_info;
+    }
 
-        // This fw_img block has been processed, so fetch the next block.
-        // In this example, we just increment the pointer.
-        fw_img += write_size;
+    if (boot_state.block_data)
+        free(boot_state.block_data);
 
-        if (ret == FW_IMG_STATUS_NODATA)
-        {
-            if (fw_img_end - fw_img < write_size)
-            {
-                write_size = fw_img_end - fw_img;
-            }
+    return ret;
+}
 
-            boot_state.fw_img_blocks = (uint8_t *) fw_img;
-            boot_state.fw_img_blocks_size = write_size;
-        }
+uint32_t bsp_dut_write_fw_img_coeff_set(const uint8_t *fw_img, uint32_t coeff_set)
+{
+    uint32_t ret;
+    fw_img_memory_source_t source;
+    fw_img_boot_state_t boot_state;
+    fw_img_reader_t reader;
+    fw_img_v3_coeff_set_t *set;
+
+    if (fw_img == NULL)
+    {
+        return BSP_STATUS_FAIL;
     }
 
-    if ((fw_img_info != NULL) && (ret != BSP_STATUS_FAIL))
+    memset(&boot_state, 0, sizeof(fw_img_boot_state_t));
+    memset(&reader, 0, sizeof(fw_img_reader_t));
+
+    // Reuse the header and coefficient set index read in when the fw_img_v3 was booted, so only the blocks of the
+    // requested coefficient set are read and written
+    boot_state.fw_info = fw_img_info;
+    ret = fw_img_coeff_set_start(&boot_state, coeff_set);
+    if (ret)
     {
-        *fw_img_info = boot_state.fw_info;
+        return BSP_STATUS_FAIL;
     }
+    set = &(fw_img_info.coeff_set_index[coeff_set]);
 
-    if (boot_state.block_data)
-        free(boot_state.block_data);
+    source.fw_img = fw_img;
+    reader.read = fw_img_memory_read;
+    reader.read_arg = &source;
+    reader.buffer = fw_img_read_buffer;
+    reader.buffer_size = sizeof(fw_img_read_buffer);
+
+    // Read only the coefficient set, rather than reading ahead from the start of the fw_img
+    ret = fw_img_reader_start_at(&reader, set->offset, set->size);
+    if (ret)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    ret = fw_img_reader_next(&reader, &boot_state);
+    if (ret)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    boot_state.block_data_size = fw_img_info.header.max_block_size;
+    boot_state.block_data = (uint8_t *) malloc(boot_state.block_data_size);
+    if (boot_state.block_data == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    ret = bsp_dut_process_fw_img(&reader, &boot_state);
+
+    free(boot_state.block_data);
 
     return ret;
 }
@@ -281,6 +399,13 @@ uint32_t bsp_dut_reset(void)
 
 uint32_t bsp_dut_boot(bool cal_boot)
 {
+#ifdef CONFIG_FW_IMG_PRELINKED
+    cs35l41_driver.is_cal_boot = cal_boot;
+
+    // The fw_imgs were parsed into const tables at build time, so boot straight from them
+    return bsp_dut_boot_prelinked(&cs35l41_fw_img_prelinked,
+                                  cal_boot ? &cs35l41_cal_fw_img_prelinked : &cs35l41_tune_fw_img_prelinked);
+#else
     uint32_t ret;
     const uint8_t *fw_img;
     const uint8_t *tune_img;
@@ -311,6 +436,8 @@ uint32_t bsp_dut_boot(bool cal_boot)
         free(fw_img_info.sym_table);
     if (fw_img_info.alg_id_list)
         free(fw_img_info.alg_id_list);
+    if (fw_img_info.coeff_set_index)
+        free(fw_img_info.coeff_set_index);
 
     // Ensure your fw_img_boot_state_t struct is initialised to zero.
     memset(&fw_img_info, 0, sizeof(fw_img_info_t));
@@ -347,15 +474,149 @@ uint32_t bsp_dut_boot(bool cal_boot)
         return BSP_STATUS_FAIL;
     }
 
+    // For a fw_img_v3, malloc enough memory to hold the coefficient set index so that coefficient sets can be loaded
+    // later with bsp_dut_write_fw_img_coeff_set()
+    if (fw_img_info.header.coeff_sets > 0)
+    {
+        fw_img_info.coeff_set_index = (fw_img_v3_coeff_set_t *) malloc(fw_img_info.header.coeff_sets *
+                                                                       sizeof(fw_img_v3_coeff_set_t));
+        if (fw_img_info.coeff_set_index == NULL)
+        {
+            return BSP_STATUS_FAIL;
+        }
+    }
+
     bsp_dut_write_fw_img(fw_img, &fw_img_info);
     bsp_dut_write_fw_img(tune_img, NULL);
 
     // fw_img processing is complete, so inform the driver and pass it the fw_info block
     ret = cs35l41_boot(&cs35l41_driver, &fw_img_info);
 
+    return ret;
+#endif
+}
+
+uint32_t bsp_dut_write_fw_img_prelinked(const fw_img_prelinked_t *fw_img)
+{
+    uint32_t ret;
+
+    if (fw_img == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    // The blocks were parsed from the fw_img at build time, so just write them
+    for (uint32_t i = 0; i < fw_img->fw_info.header.data_blocks; i++)
+    {
+        ret = regmap_write_block(&(cs35l41_driver.config.bsp_config.cp_config),
+                                 fw_img->blocks[i].block_addr,
+                                 (uint8_t *) fw_img->blocks[i].bytes,
+                                 fw_img->blocks[i].block_size);
+        if (ret)
+        {
+            return BSP_STATUS_FAIL;
+        }
+    }
+
+    return BSP_STATUS_OK;
+}
+
+uint32_t bsp_dut_boot_prelinked(const fw_img_prelinked_t *fw_img, const fw_img_prelinked_t *tune_img)
+{
+    uint32_t ret;
+
+    if (fw_img == NULL)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    // Inform the driver that any current firmware is no longer available by passing a NULL
+    // fw_info pointer to cs35l41_boot
+    ret = cs35l41_boot(&cs35l41_driver, NULL);
+    if (ret != CS35L41_STATUS_OK)
+    {
+        return ret;
+    }
+
+    ret = bsp_dut_write_fw_img_prelinked(fw_img);
+    if (ret)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    if (tune_img != NULL)
+    {
+        ret = bsp_dut_write_fw_img_prelinked(tune_img);
+        if (ret)
+        {
+            return BSP_STATUS_FAIL;
+        }
+    }
+
+    // The symbol table and algorithm list are const tables, so can be passed to the driver directly
+    ret = cs35l41_boot(&cs35l41_driver, &(fw_img->fw_info));
+
     return ret;
 }
 
+uint32_t bsp_dut_boot_scheduled(bool cal_boot)
+{
+#ifdef CONFIG_FW_IMG_PRELINKED
+    uint32_t ret;
+
+    // The prelinked fw_imgs need no parsing, so there is nothing for the scheduler to overlap with the reset
+    ret = bsp_dut_reset();
+    if (ret != BSP_STATUS_OK)
+    {
+        return ret;
+    }
+
+    return bsp_dut_boot(cal_boot);
+#else
+    uint32_t ret;
+    boot_sched_job_t job;
+
+    cs35l41_driver.is_cal_boot = cal_boot;
+
+    // Inform the driver that any current firmware is no longer available by passing a NULL
+    // fw_info pointer to cs35l41_boot
+    ret = cs35l41_boot(&cs35l41_driver, NULL);
+    if (ret != CS35L41_STATUS_OK)
+    {
+        return ret;
+    }
+
+    // Free anything malloc'ed in previous boots
+    if (fw_img_info.sym_table)
+        free(fw_img_info.sym_table);
+    if (fw_img_info.alg_id_list)
+        free(fw_img_info.alg_id_list);
+    if (fw_img_info.coeff_set_index)
+        free(fw_img_info.coeff_set_index);
+    memset(&fw_img_info, 0, sizeof(fw_img_info_t));
+
+    // This board has a single CS35L41, but one job per device can be passed to boot_sched_run() so that each device's
+    // reset and OTP waits overlap with the downloads to the others
+    memset(&job, 0, sizeof(boot_sched_job_t));
+    job.driver = &cs35l41_driver;
+    job.ops = &bsp_dut_sched_ops;
+    job.cp = &(cs35l41_driver.config.bsp_config.cp_config);
+    job.fw_imgs[0] = cs35l41_fw_img;
+    job.fw_imgs[1] = cal_boot ? cs35l41_cal_fw_img : cs35l41_tune_fw_img;
+    job.fw_info = &fw_img_info;
+    job.block_data = fw_img_block_data;
+    job.block_data_size = sizeof(fw_img_block_data);
+
+    ret = boot_sched_run(&job, 1, bsp_get_time_ms);
+    if (ret != BOOT_SCHED_STATUS_OK)
+    {
+        return BSP_STATUS_FAIL;
+    }
+
+    return BSP_STATUS_OK;
+#endif
+}
+
 uint32_t bsp_dut_calibrate(void)
 {
     if (CS35L41_STATUS_OK == cs35l41_calibrate(&cs35l41_driver, 23))
@@ -513,6 +774,7 @@ uint32_t bsp_dut_change_fs(uint32_t fs_hz)
 {
     uint32_t ret;
     const uint8_t *tune_img;
+    uint32_t coeff_set;
     const uint32_t *cfg;
     uint16_t cfg_length;
 
@@ -520,12 +782,14 @@ uint32_t bsp_dut_change_fs(uint32_t fs_hz)
     if (fs_hz == 48000)
     {
         tune_img = cs35l41_tune_48_fw_img;
+        coeff_set = BSP_DUT_COEFF_SET_TUNE_48;
         cfg = cs35l41_fs_48kHz_syscfg;
         cfg_length = CS35L41_FS_48KHZ_SYSCFG_REGS_TOTAL;
     }
     else if (fs_hz == 44100)
     {
         tune_img = cs35l41_tune_44p1_fw_img;
+        coeff_set = BSP_DUT_COEFF_SET_TUNE_44P1;
         cfg = cs35l41_fs_44p1kHz_syscfg;
         cfg_length = CS35L41_FS_44P1KHZ_SYSCFG_REGS_TOTAL;
     }
@@ -546,8 +810,21 @@ uint32_t bsp_dut_change_fs(uint32_t fs_hz)
         return BSP_STATUS_FAIL;
     }
 
-    // Load new Fs tuning
-    bsp_dut_write_fw_img(tune_img, NULL);
+    // Load new Fs tuning.  If cs35l41_fw_img is a fw_img_v3 holding the Fs tunings as coefficient sets, only the
+    // blocks of the requested set are streamed, reusing the fw_img_info read in at boot.  Otherwise fall back to the
+    // separate fw_img of the tuning.
+    if (coeff_set < fw_img_info.header.coeff_sets)
+    {
+        ret = bsp_dut_write_fw_img_coeff_set(cs35l41_fw_img, coeff_set);
+    }
+    else
+    {
+        ret = bsp_dut_write_fw_img(tune_img, NULL);
+    }
+    if (ret)
+    {
+        return BSP_STATUS_FAIL;
+    }
 
     ret = cs35l41_finish_tuning_switch(&cs35l41_driver);
     if (ret)
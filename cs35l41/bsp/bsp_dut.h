@@ -32,6 +32,7 @@ extern "C" {
  **********************************************************************************************************************/
 #include "bsp_driver_if.h"
 #include <stdbool.h>
+#include "fw_img.h"
 
 /***********************************************************************************************************************
  * LITERALS & CONSTANTS
@@ -58,6 +59,11 @@ extern "C" {
 uint32_t bsp_dut_initialize(void);
 uint32_t bsp_dut_reset(void);
 uint32_t bsp_dut_boot(bool cal_boot);
+uint32_t bsp_dut_stream_fw_img(fw_img_read_t read, void *read_arg, fw_img_info_t *fw_img_info);
+uint32_t bsp_dut_write_fw_img_coeff_set(const uint8_t *fw_img, uint32_t coeff_set);
+uint32_t bsp_dut_write_fw_img_prelinked(const fw_img_prelinked_t *fw_img);
+uint32_t bsp_dut_boot_prelinked(const fw_img_prelinked_t *fw_img, const fw_img_prelinked_t *tune_img);
+uint32_t bsp_dut_boot_scheduled(bool cal_boot);
 uint32_t bsp_dut_calibrate(void);
 uint32_t bsp_dut_power_up(void);
 uint32_t bsp_dut_power_down(void);
@@ -1879,46 +1879,66 @@ uint32_t cs35l41_process(cs35l41_t *driver)
 }
 
 /**
- * Reset the CS35L41 and prepare for HALO FW booting
+ * Perform the next step of resetting the CS35L41
  *
  */
-uint32_t cs35l41_reset(cs35l41_t *driver)
+uint32_t cs35l41_reset_step(cs35l41_t *driver, uint32_t *step, uint32_t *wait_ms)
 {
     uint32_t ret;
-    uint8_t i;
     uint32_t temp_reg_val;
     regmap_cp_config_t *cp = REGMAP_GET_CP(driver);
 
-    // Drive RESET low for at least T_RLPW (1ms)
-    bsp_driver_if_g->set_gpio(driver->config.bsp_config.reset_gpio_id, BSP_GPIO_LOW);
-    bsp_driver_if_g->set_timer(CS35L41_T_RLPW_MS, NULL, NULL);
-    // Drive RESET high and wait for at least T_IRS (1ms)
-    bsp_driver_if_g->set_gpio(driver->config.bsp_config.reset_gpio_id, BSP_GPIO_HIGH);
-    bsp_driver_if_g->set_timer(CS35L41_T_IRS_MS, NULL, NULL);
-
-    // Start polling OTP_BOOT_DONE bit every 10ms
-    for (i = 0; i < CS35L41_POLL_OTP_BOOT_DONE_MAX; i++)
+    if ((step == NULL) || (wait_ms == NULL))
     {
-        ret = regmap_read(cp, CS35L41_OTP_CTRL_OTP_CTRL8_REG, &temp_reg_val);
-        if (ret)
-        {
-            return ret;
-        }
+        return CS35L41_STATUS_FAIL;
+    }
 
-        // If OTP_BOOT_DONE is set
-        if (temp_reg_val & OTP_CTRL_OTP_CTRL8_OTP_BOOT_DONE_STS_BITMASK)
-        {
-            break;
-        }
+    *wait_ms = 0;
 
-        bsp_driver_if_g->set_timer(CS35L41_POLL_OTP_BOOT_DONE_MS, NULL, NULL);
+    if (*step == CS35L41_RESET_STEP_ASSERT)
+    {
+        // Drive RESET low for at least T_RLPW (1ms)
+        bsp_driver_if_g->set_gpio(driver->config.bsp_config.reset_gpio_id, BSP_GPIO_LOW);
+        *wait_ms = CS35L41_T_RLPW_MS;
+        *step = CS35L41_RESET_STEP_DEASSERT;
+        return CS35L41_STATUS_OK;
     }
 
-    if (i >= CS35L41_POLL_OTP_BOOT_DONE_MAX)
+    if (*step == CS35L41_RESET_STEP_DEASSERT)
+    {
+        // Drive RESET high and wait for at least T_IRS (1ms)
+        bsp_driver_if_g->set_gpio(driver->config.bsp_config.reset_gpio_id, BSP_GPIO_HIGH);
+        *wait_ms = CS35L41_T_IRS_MS;
+        *step = CS35L41_RESET_STEP_POLL_OTP_BOOT_DONE;
+        return CS35L41_STATUS_OK;
+    }
+
+    if ((*step < CS35L41_RESET_STEP_POLL_OTP_BOOT_DONE) ||
+        (*step >= (CS35L41_RESET_STEP_POLL_OTP_BOOT_DONE + CS35L41_POLL_OTP_BOOT_DONE_MAX)))
     {
         return CS35L41_STATUS_FAIL;
     }
 
+    // Poll OTP_BOOT_DONE bit every 10ms, each poll being a separate step
+    ret = regmap_read(cp, CS35L41_OTP_CTRL_OTP_CTRL8_REG, &temp_reg_val);
+    if (ret)
+    {
+        return ret;
+    }
+
+    // If OTP_BOOT_DONE is not set
+    if (!(temp_reg_val & OTP_CTRL_OTP_CTRL8_OTP_BOOT_DONE_STS_BITMASK))
+    {
+        (*step)++;
+        if (*step >= (CS35L41_RESET_STEP_POLL_OTP_BOOT_DONE + CS35L41_POLL_OTP_BOOT_DONE_MAX))
+        {
+            return CS35L41_STATUS_FAIL;
+        }
+
+        *wait_ms = CS35L41_POLL_OTP_BOOT_DONE_MS;
+        return CS35L41_STATUS_OK;
+    }
+
     // Read DEVID
     ret = regmap_read(cp, CS35L41_SW_RESET_DEVID_REG, &(driver->devid));
     if (ret)
@@ -1996,6 +2016,35 @@ uint32_t cs35l41_reset(cs35l41_t *driver)
         driver->state = CS35L41_STATE_STANDBY;
     }
 
+    *step = CS35L41_RESET_STEP_DONE;
+
+    return CS35L41_STATUS_OK;
+}
+
+/**
+ * Reset the CS35L41 and prepare for HALO FW booting
+ *
+ */
+uint32_t cs35l41_reset(cs35l41_t *driver)
+{
+    uint32_t ret;
+    uint32_t step = CS35L41_RESET_STEP_ASSERT;
+    uint32_t wait_ms;
+
+    do
+    {
+        ret = cs35l41_reset_step(driver, &step, &wait_ms);
+        if (ret)
+        {
+            return ret;
+        }
+
+        if (wait_ms > 0)
+        {
+            bsp_driver_if_g->set_timer(wait_ms, NULL, NULL);
+        }
+    } while (step != CS35L41_RESET_STEP_DONE);
+
     return CS35L41_STATUS_OK;
 }
 
@@ -2003,7 +2052,7 @@ uint32_t cs35l41_reset(cs35l41_t *driver)
  * Finish booting the CS35L41
  *
  */
-uint32_t cs35l41_boot(cs35l41_t *driver, fw_img_info_t *fw_info)
+uint32_t cs35l41_boot(cs35l41_t *driver, const fw_img_info_t *fw_info)
 {
     uint32_t ret = CS35L41_STATUS_OK;
     regmap_cp_config_t *cp = REGMAP_GET_CP(driver);
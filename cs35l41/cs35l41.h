@@ -84,6 +84,22 @@ extern "C" {
 #define CS35L41_MODE_HANDLING_EVENTS                    (1)
 /** @} */
 
+/**
+ * @defgroup CS35L41_RESET_STEP_
+ * @brief Steps of resetting the CS35L41 with cs35l41_reset_step()
+ *
+ * Steps from CS35L41_RESET_STEP_POLL_OTP_BOOT_DONE onwards are each a poll of OTP_BOOT_DONE.
+ *
+ * @see cs35l41_reset_step
+ *
+ * @{
+ */
+#define CS35L41_RESET_STEP_ASSERT                       (0)
+#define CS35L41_RESET_STEP_DEASSERT                     (1)
+#define CS35L41_RESET_STEP_POLL_OTP_BOOT_DONE           (2)
+#define CS35L41_RESET_STEP_DONE                         (0xFFFFFFFF)
+/** @} */
+
 #define CS35L41_POLL_OTP_BOOT_DONE_MS                   (10)        ///< Delay in ms between polling OTP_BOOT_DONE
 #define CS35L41_POLL_OTP_BOOT_DONE_MAX                  (10)        ///< Maximum number of times to poll OTP_BOOT_DONE
 #define CS35L41_OTP_SIZE_BYTES                          (32 * 4)    ///< Total size of CS35L41 OTP in bytes
@@ -263,7 +279,7 @@ typedef struct
     // Extra state material used by reset and boot
     uint32_t devid;                     ///< CS35L41 DEVID of current device
     uint32_t revid;                     ///< CS35L41 REVID of current device
-    fw_img_info_t *fw_info;             ///< Current HALO FW/Coefficient boot configuration
+    const fw_img_info_t *fw_info;       ///< Current HALO FW/Coefficient boot configuration
     bool is_cal_boot;                   ///< Flag to indicate current HALO FW boot is for Calibration
 
     uint32_t event_flags;               ///< Flags set by Event Handler that are passed to noticiation callback
@@ -351,6 +367,31 @@ uint32_t cs35l41_process(cs35l41_t *driver);
  */
 uint32_t cs35l41_reset(cs35l41_t *driver);
 
+/**
+ * Perform the next step of resetting the CS35L41
+ *
+ * Performs the same reset as cs35l41_reset(), but returns instead of waiting between steps, so that the caller can
+ * make use of the time (i.e. booting other devices).  Should be called first with \b step set to
+ * CS35L41_RESET_STEP_ASSERT, then again no sooner than \b wait_ms later, until \b step is CS35L41_RESET_STEP_DONE.
+ *
+ * @param [in] driver           Pointer to the driver state
+ * @param [in,out] step         Pointer to the current step, updated to the next step
+ * @param [out] wait_ms         Minimum time to wait in ms before performing the next step
+ *
+ * @return
+ * - CS35L41_STATUS_FAIL if:
+ *      - any control port activity fails
+ *      - OTP_BOOT_DONE polling times out
+ *      - the part is not supported
+ *      - no OTP unpacking map exists for the part
+ *      - step is invalid
+ * - otherwise, returns CS35L41_STATUS_OK
+ *
+ * @see cs35l41_reset
+ *
+ */
+uint32_t cs35l41_reset_step(cs35l41_t *driver, uint32_t *step, uint32_t *wait_ms);
+
 /**
  * Finish booting the CS35L41
  *
@@ -371,7 +412,7 @@ uint32_t cs35l41_reset(cs35l41_t *driver);
  * - CS35L41_STATUS_OK          otherwise
  *
  */
-uint32_t cs35l41_boot(cs35l41_t *driver, fw_img_info_t *fw_info);
+uint32_t cs35l41_boot(cs35l41_t *driver, const fw_img_info_t *fw_info);
 
 /**
  * Change the power state
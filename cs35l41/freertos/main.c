@@ -130,8 +130,7 @@ static void AmpControlThread(void *argument)
                     bsp_audio_stop(BSP_I2S_PORT_PRIMARY);
                     bsp_audio_set_fs(BSP_AUDIO_FS_48000_HZ);
                     bsp_audio_play_record(BSP_I2S_PORT_PRIMARY, BSP_PLAY_SILENCE);
-                    bsp_dut_reset();
-                    bsp_dut_boot(true);
+                    bsp_dut_boot_scheduled(true);
                     bsp_dut_power_up();
                     bsp_dut_calibrate();
                     bsp_dut_power_down();
@@ -145,8 +144,7 @@ static void AmpControlThread(void *argument)
                     bsp_audio_stop(BSP_I2S_PORT_PRIMARY);
                     bsp_audio_set_fs(BSP_AUDIO_FS_48000_HZ);
                     bsp_audio_play_record(BSP_I2S_PORT_PRIMARY, BSP_PLAY_STEREO_1KHZ_20DBFS);
-                    bsp_dut_reset();
-                    bsp_dut_boot(false);
+                    bsp_dut_boot_scheduled(false);
                     uint8_t dut_id;
                     bsp_dut_get_id(&dut_id);
                     if (dut_id == BSP_DUT_ID_LEFT)
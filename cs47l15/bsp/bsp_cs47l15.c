@@ -26,11 +26,11 @@
 #include <stdlib.h>
 #include "platform_bsp.h"
 #include "cs47l15.h"
-#include "cs47l15_ext.h"
 #include "cs47l15_syscfg_regs.h"
 #include "cs47l15_fw_img.h"
 #include "mp3_test_01_441.h"
 #include "mp3_test_01_48.h"
+#include "dspbuf.h"
 
 /***********************************************************************************************************************
  * LOCAL LITERAL SUBSTITUTIONS
@@ -49,12 +49,30 @@ static cs47l15_t cs47l15_driver;
 static fw_img_boot_state_t boot_state;
 
 static void * lin_buf_ptr;
+static data_ringbuf_t mp3_data_buf;
 static uint8_t * mp3_data;
 static uint32_t mp3_data_len;
 static uint32_t bytes_written_total;
 static bool start_decoding_flag = false;
 
-dsp_buffer_t buffer;
+static dspbuf_config_t dspbuf_config =
+{
+    .cp = REGMAP_GET_CP(&cs47l15_driver),
+    .bufs_config =
+    {
+        {.base_id = buf1_base, .size_id = buf1_size, .mem_base = CS47L15_DSP1_XMEM_0},
+    },
+    .n_bufs = 1,
+    .rb_struct_mem_start_address = CS47L15_DSP1_XMEM_0,
+    .compr_buf_ptr = NULL,
+    .compr_buf_size = 0,
+    .buf_symbol = 0,
+    .bytes_per_reg = 4,
+    .addr_per_reg = CS47L15_DSP_OFFSET_MUL_VALUE,
+    .struct_layout = dspbuf_adsp2_struct_layout,
+};
+
+static dspbuf_t dspbuf_dec;
 
 static cs47l15_bsp_config_t bsp_config =
 {
@@ -74,6 +92,52 @@ static cs47l15_bsp_config_t bsp_config =
 bool bsp_write_process_done = false;
 bool dsp_decoder_interrupt_flag = false;
 
+/***********************************************************************************************************************
+ * LOCAL FUNCTIONS
+ **********************************************************************************************************************/
+
+/**
+ * Pad the next MP3 data into 24bit DSP words in mp3_data_buf, no more than space_avail bytes of words
+ *
+ * Each word is a 0 byte followed by 3 bytes of data, and the last word of the stream is filled out with 0s.
+ *
+ */
+static void bsp_dut_pad_mp3_data(uint32_t space_avail)
+{
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+    uint32_t padded_len = 0;
+
+    // mp3_data_buf only ever holds whole words, so each part of its free space does too
+    data_ringbuf_get_write_iov(&mp3_data_buf, iov);
+    for (uint32_t i = 0; i < DATA_RINGBUF_IOV_MAX; i++)
+    {
+        for (uint32_t offset = 0; (offset + 4) <= iov[i].len; offset += 4)
+        {
+            uint8_t *word = iov[i].ptr + offset;
+
+            if (((padded_len + 4) > space_avail) || (bytes_written_total >= mp3_data_len))
+            {
+                data_ringbuf_commit_write_iov(&mp3_data_buf, padded_len);
+                return;
+            }
+
+            word[0] = 0x00;
+            for (uint32_t j = 1; j < 4; j++)
+            {
+                word[j] = 0x00;
+                if (bytes_written_total < mp3_data_len)
+                {
+                    word[j] = *mp3_data++;
+                    bytes_written_total++;
+                }
+            }
+            padded_len += 4;
+        }
+    }
+
+    data_ringbuf_commit_write_iov(&mp3_data_buf, padded_len);
+}
+
 /***********************************************************************************************************************
  * API FUNCTIONS
  **********************************************************************************************************************/
@@ -278,8 +342,7 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
 {
     uint32_t ret = BSP_STATUS_FAIL;
     uint32_t play_stop_address;
-    uint32_t buf_symbol;
-    uint32_t space_avail;
+    uint32_t data_len;
     uint32_t scratch;
     uint32_t count = 0;
 
@@ -369,10 +432,17 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             cs47l15_write_reg(&cs47l15_driver, CS47L15_DAC_DIGITAL_VOLUME_1L, 0x290);
             cs47l15_write_reg(&cs47l15_driver, CS47L15_DAC_DIGITAL_VOLUME_1R, 0x290);
 
-            // Init data and dsp buffer
+            // Init data buffer, which holds the MP3 data padded to DSP words until it is written
             lin_buf_ptr =  (uint8_t *)malloc(BSP_DUT_BUFFER_SIZE);
-            buf_symbol = cs47l15_find_symbol(&cs47l15_driver, 0, CS47L15_SYM_MP3_DEC_RING_BUFF_ADDRESS);
-            ret = cs47l15_dsp_buf_init(&cs47l15_driver, &buffer, lin_buf_ptr, BSP_DUT_BUFFER_SIZE, buf_symbol, 1);
+            data_ringbuf_init(&mp3_data_buf, lin_buf_ptr, BSP_DUT_BUFFER_SIZE);
+
+            // Init dsp buffer
+            dspbuf_config.buf_symbol = cs47l15_find_symbol(&cs47l15_driver, 0, CS47L15_SYM_MP3_DEC_RING_BUFF_ADDRESS);
+            ret = dspbuf_init(&dspbuf_dec, &dspbuf_config);
+            if (ret)
+            {
+                return BSP_STATUS_FAIL;
+            }
             mp3_data = (uint8_t*)&mp3_test_01_mp3_441[0];
             mp3_data_len = mp3_test_01_mp3_441_len;
             bytes_written_total = 0;
@@ -442,10 +512,13 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             cs47l15_write_reg(&cs47l15_driver, CS47L15_DAC_DIGITAL_VOLUME_1L, 0x290);
             cs47l15_write_reg(&cs47l15_driver, CS47L15_DAC_DIGITAL_VOLUME_1R, 0x290);
 
-            // Init data and dsp buffer
+            // Init data buffer, which holds the MP3 data padded to DSP words until it is written
             lin_buf_ptr =  (uint8_t *)malloc(BSP_DUT_BUFFER_SIZE);
-            buf_symbol = cs47l15_find_symbol(&cs47l15_driver, 0, CS47L15_SYM_MP3_DEC_RING_BUFF_ADDRESS);
-            ret = cs47l15_dsp_buf_init(&cs47l15_driver, &buffer, lin_buf_ptr, BSP_DUT_BUFFER_SIZE, buf_symbol, 1);
+            data_ringbuf_init(&mp3_data_buf, lin_buf_ptr, BSP_DUT_BUFFER_SIZE);
+
+            // Init dsp buffer
+            dspbuf_config.buf_symbol = cs47l15_find_symbol(&cs47l15_driver, 0, CS47L15_SYM_MP3_DEC_RING_BUFF_ADDRESS);
+            ret = dspbuf_init(&dspbuf_dec, &dspbuf_config);
             if (ret)
             {
                 return BSP_STATUS_FAIL;
@@ -473,32 +546,37 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             // Write data to be played to buffer
             if (dsp_decoder_interrupt_flag)
             {
-                ret = cs47l15_dsp_buf_avail(&cs47l15_driver, &buffer, &space_avail);
+                dsp_decoder_interrupt_flag = false;
+
+                ret = dspbuf_update_status(&dspbuf_dec);
                 if (ret)
                 {
                     return BSP_STATUS_FAIL;
                 }
-                if (space_avail)
+
+                bsp_dut_pad_mp3_data(dspbuf_get_space_avail(&dspbuf_dec));
+                data_len = data_ringbuf_data_length(&mp3_data_buf);
+                if (data_len)
                 {
-                    if (bytes_written_total + space_avail > mp3_data_len)
+                    // The padded words are written with one block per wrap and a single update of the decoder's
+                    // write index
+                    ret = dspbuf_write(&dspbuf_dec, &mp3_data_buf, data_len, &data_len);
+                    if (ret)
                     {
-                        space_avail = mp3_data_len - bytes_written_total;
+                        bsp_write_process_done = true;
+                        return BSP_STATUS_FAIL;
                     }
-                    ret = cs47l15_dsp_buf_write(&cs47l15_driver, &buffer, mp3_data, space_avail);
-                    if (ret) // error
+
+                    ret = dspbuf_reenable_irq(&dspbuf_dec);
+                    if (ret)
                     {
-                        dsp_decoder_interrupt_flag = false;
-                        bsp_write_process_done = true;
                         return BSP_STATUS_FAIL;
                     }
-                    mp3_data += space_avail;
-                    bytes_written_total += space_avail;
                 }
-                dsp_decoder_interrupt_flag = false;
             }
             if (bytes_written_total >= mp3_data_len)
             {
-                cs47l15_dsp_buf_eof(&cs47l15_driver, &buffer);
+                dspbuf_write_eof(&dspbuf_dec);
                 bsp_write_process_done = true;
             }
             break;
@@ -130,6 +130,17 @@ extern "C" {
 #define CS47L15_NUM_DSP                                 (1)
 #define CS47L15_NUM_FLL                                 (2)
 
+/**
+ * @defgroup CS47L15_DSP_
+ * @brief Values for communicating with the DSP core
+ *
+ * @{
+ */
+#define CS47L15_DSP_OFFSET_MUL_VALUE                    (2)
+#define CS47L15_DSP_DEC_ALGORITHM_STOPPED               (0x10000)
+#define CS47L15_DSP_SCRATCH_1_MASK                      (0xFFFF0000)
+/** @} */
+
 /**
  * @brief FLL Ids. Identifies the two FLLs.
  * Used in the FLL enable and disable functions
@@ -26,12 +26,12 @@
 #include <stdlib.h>
 #include "platform_bsp.h"
 #include "cs47l35.h"
-#include "cs47l35_ext.h"
 #include "cs47l35_syscfg_regs.h"
 #include "cs47l35_dsp2_fw_img.h"
 #include "cs47l35_dsp3_fw_img.h"
 #include "opus_test_01_16.h"
 #include "bridge.h"
+#include "dspbuf.h"
 
 /***********************************************************************************************************************
  * LOCAL LITERAL SUBSTITUTIONS
@@ -49,9 +49,8 @@ static cs47l35_t cs47l35_driver;
 static fw_img_boot_state_t boot_state_dsp2;
 static fw_img_boot_state_t boot_state_dsp3;
 
-static void * lin_buf_ptr_dec;
-static void * lin_buf_ptr_enc;
 static uint8_t * opus_data;
+static data_ringbuf_t opus_data_buf;
 static uint32_t data_avail;
 static uint32_t opus_data_len;
 static uint32_t bytes_written_total;
@@ -61,8 +60,25 @@ static bool start_encoding_flag = false;
 
 static uint32_t vad_symbol;
 
-dsp_buffer_t buffer_dec;
-dsp_buffer_t buffer_enc;
+static dspbuf_config_t dspbuf_config =
+{
+    .cp = REGMAP_GET_CP(&cs47l35_driver),
+    .bufs_config =
+    {
+        {.base_id = buf1_base, .size_id = buf1_size, .mem_base = CS47L35_DSP2_XMEM_0},
+    },
+    .n_bufs = 1,
+    .rb_struct_mem_start_address = CS47L35_DSP2_XMEM_0,
+    .compr_buf_ptr = NULL,
+    .compr_buf_size = 0,
+    .buf_symbol = 0,
+    .bytes_per_reg = 4,
+    .addr_per_reg = CS47L35_DSP_OFFSET_MUL_VALUE,
+    .struct_layout = dspbuf_adsp2_struct_layout,
+};
+
+static dspbuf_t dspbuf_dec;
+static dspbuf_t dspbuf_enc;
 
 static cs47l35_bsp_config_t bsp_config =
 {
@@ -314,7 +330,7 @@ void bsp_disable_mic()
 uint32_t bsp_dut_use_case(uint32_t use_case)
 {
     uint32_t ret = BSP_STATUS_FAIL;
-    uint32_t buf_symbol, space_avail, scratch, vad, addr, i;
+    uint32_t buf_symbol, scratch, vad, addr, i, data_len;
 
     switch(use_case) {
         case BSP_USE_CASE_TG_HP_EN:
@@ -473,10 +489,16 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             buf_symbol = cs47l35_find_symbol(&cs47l35_driver, 3, CS47L35_DSP3_SYM_SOUNDCLEAR_RT_WRITEREGID);
             cs47l35_write_reg(&cs47l35_driver, buf_symbol, 0x5);
 
-            // Init data and dsp buffer
-            lin_buf_ptr_dec =  (uint8_t *)malloc(BSP_DUT_BUFFER_SIZE);
-            buf_symbol = cs47l35_find_symbol(&cs47l35_driver, 2, CS47L35_DSP2_SYM_SILK_DECODER_RING_BUFF_ADDRESS);
-            ret = cs47l35_dsp_buf_init(&cs47l35_driver, &buffer_dec, lin_buf_ptr_dec, BSP_DUT_BUFFER_SIZE, buf_symbol, 2);
+            // Init data buffer, which holds the recorded data as padded DSP words until it is played
+            opus_data = (uint8_t *)malloc(BSP_DUT_BUFFER_SIZE);
+            data_ringbuf_init(&opus_data_buf, opus_data, BSP_DUT_BUFFER_SIZE);
+            opus_data_len = 0x8000;
+
+            // Init dsp buffers
+            dspbuf_config.buf_symbol = cs47l35_find_symbol(&cs47l35_driver,
+                                                           2,
+                                                           CS47L35_DSP2_SYM_SILK_DECODER_RING_BUFF_ADDRESS);
+            ret = dspbuf_init(&dspbuf_dec, &dspbuf_config);
             if (ret)
             {
                 break;
@@ -485,17 +507,14 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             bsp_write_process_done = false;
             start_decoding_flag = true;
 
-            // Init data and dsp buffer
-            lin_buf_ptr_enc =  (uint8_t *)malloc(BSP_DUT_BUFFER_SIZE);
-            buf_symbol = cs47l35_find_symbol(&cs47l35_driver, 2, CS47L35_DSP2_SYM_SILK_ENCODER_RING_BUFF_ADDRESS);
-            ret = cs47l35_dsp_buf_init(&cs47l35_driver, &buffer_enc, lin_buf_ptr_enc, BSP_DUT_BUFFER_SIZE, buf_symbol, 2);
+            dspbuf_config.buf_symbol = cs47l35_find_symbol(&cs47l35_driver,
+                                                           2,
+                                                           CS47L35_DSP2_SYM_SILK_ENCODER_RING_BUFF_ADDRESS);
+            ret = dspbuf_init(&dspbuf_enc, &dspbuf_config);
             if (ret)
             {
                 break;
             }
-
-            opus_data = (uint8_t *)malloc(BSP_DUT_RECORDING_SIZE);
-            opus_data_len = 0x8000;
             bytes_read_total = 0;
 
             bsp_read_process_done = false;
@@ -523,13 +542,25 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
                     cs47l35_write_reg(&cs47l35_driver, addr, 80);
                 }
 
-                ret = cs47l35_dsp_buf_data_avail(&cs47l35_driver, &buffer_enc, &data_avail);
+                ret = dspbuf_update_status(&dspbuf_enc);
+                if (ret)
+                {
+                    break;
+                }
+
+                // opus_data_buf only ever holds whole words, so its free space is too
+                data_len = dspbuf_get_data_avail(&dspbuf_enc);
+                if (data_len > data_ringbuf_free_space(&opus_data_buf))
+                {
+                    data_len = data_ringbuf_free_space(&opus_data_buf);
+                }
+                ret = dspbuf_read(&dspbuf_enc, &opus_data_buf, data_len, &data_avail);
                 if (ret)
                 {
                     break;
                 }
 
-                ret = cs47l35_dsp_buf_read(&cs47l35_driver, &buffer_enc, opus_data, data_avail);
+                ret = dspbuf_reenable_irq(&dspbuf_enc);
                 if (ret)
                 {
                     break;
@@ -537,13 +568,13 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
 
                 for (i = 0; i < 10; i++)
                 {
-                    ret = cs47l35_dsp_buf_space_avail(&cs47l35_driver, &buffer_dec, &space_avail);
+                    ret = dspbuf_update_status(&dspbuf_dec);
                     if (ret)
                     {
                         continue;
                     }
 
-                    if (space_avail >= data_avail)
+                    if (dspbuf_get_space_avail(&dspbuf_dec) >= data_ringbuf_data_length(&opus_data_buf))
                     {
                         break;
                     }
@@ -557,7 +588,18 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
 
                 if (data_avail)
                 {
-                    ret = cs47l35_dsp_buf_write(&cs47l35_driver, &buffer_dec, opus_data, data_avail);
+                    // The words are written as they were read, with one block per wrap and a single update of the
+                    // decoder's write index
+                    ret = dspbuf_write(&dspbuf_dec,
+                                       &opus_data_buf,
+                                       data_ringbuf_data_length(&opus_data_buf),
+                                       &data_len);
+                    if (ret)
+                    {
+                        break;
+                    }
+
+                    ret = dspbuf_reenable_irq(&dspbuf_dec);
                     if (ret)
                     {
                         break;
@@ -566,16 +608,17 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
 
                 if (!bsp_read_process_done)
                 {
-                    bytes_read_total += data_avail;
+                    // opus_data_len is in bytes of 24bit words, without their padding
+                    bytes_read_total += (data_avail / 4) * 3;
                     if (bytes_read_total >= opus_data_len)
                     {
-                        cs47l35_dsp_buf_eof(&cs47l35_driver, &buffer_enc);
+                        dspbuf_write_eof(&dspbuf_enc);
                         bsp_read_process_done = true;
                     }
                 }
                 else
                 {
-                    cs47l35_dsp_buf_eof(&cs47l35_driver, &buffer_dec);
+                    dspbuf_write_eof(&dspbuf_dec);
                     bsp_write_process_done = true;
                 }
             }
@@ -607,8 +650,6 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
 
             start_encoding_flag = false;
             start_decoding_flag = false;
-            free(lin_buf_ptr_dec);
-            free(lin_buf_ptr_enc);
             free(opus_data);
 
             cs47l35_write_reg(&cs47l35_driver, CS47L35_DAC_DIGITAL_VOLUME_1R, 0x360);
@@ -131,6 +131,17 @@ extern "C" {
 #define CS47L35_NUM_DSP                                 (3)
 #define CS47L35_NUM_FLL                                 (1)
 
+/**
+ * @defgroup CS47L35_DSP_
+ * @brief Values for communicating with the DSP cores
+ *
+ * @{
+ */
+#define CS47L35_DSP_OFFSET_MUL_VALUE                    (2)
+#define CS47L35_DSP_ENC_ALGORITHM_STOPPED               (0xFF000000)
+#define CS47L35_DSP_DEC_ALGORITHM_STOPPED               (0x00FF0000)
+/** @} */
+
 /**
  * @brief FLL Ids. Identifies the two FLLs.
  * Used in the FLL enable and disable functions
@@ -27,7 +27,9 @@
 #include <stdlib.h>
 #include "platform_bsp.h"
 #include "debug.h"
+#include "arena.h"
 #include "decompr.h"
+#include "fmtconv.h"
 #include "cs47l63.h"
 #include "cs47l63_ext.h"
 #include "cs47l63_sym.h"
@@ -35,7 +37,11 @@
 #include "cs47l63_fw_img.h"
 #include "bridge.h"
 #include "dspbuf.h"
+#include "data_ringbuf_tee.h"
 #include "scc.h"
+#ifdef CONFIG_PERF_STATS
+#include "stm32f4xx_hal.h"
+#endif
 
 /***********************************************************************************************************************
  * LOCAL LITERAL SUBSTITUTIONS
@@ -64,11 +70,15 @@ static fw_img_boot_state_t boot_state;
 
 static uint8_t *decompressed_data;
 static uint32_t decompressed_data_len;
-static uint8_t *i2s_data;
-static uint32_t i2s_data_len;
-static data_ringbuf_t i2s_data_buf;
+static uint8_t *bsp_arena_mem;
+static arena_t bsp_arena;
+static fmtconv_t i2s_conv;
 static uint32_t bytes_read_total;
 static volatile bool bsp_decompressed_data_playing;
+static data_ringbuf_tee_t i2s_data_tee;
+static uint32_t i2s_reader;
+static uint32_t level_meter_reader;
+static uint32_t level_meter_peak;
 
 static cs47l63_bsp_config_t bsp_config =
 {
@@ -112,6 +122,16 @@ static bridge_device_t device_list[] =
 };
 #endif
 
+static const fmtconv_config_t i2s_conv_config =
+{
+    .in_channels = 1,
+    .out_channels = 2,
+    .out_sample_bytes = 2,
+    .in_endian = ENDIAN_LITTLE,
+    .out_endian = ENDIAN_LITTLE,
+    .gain = FMTCONV_GAIN_UNITY
+};
+
 static scc_config_t scc_config =
 {
     .dsp_core = 1,
@@ -125,6 +145,8 @@ static scc_config_t scc_config =
     .manageackctrl_symbol = CS47L63_SYM_SCC_SCCMANAGEACKCTRL,
     .enc_format_symbol = CS47L63_SYM_SCC_BUFFER_FORMAT,
     .host_buffer_raw_symbol = CS47L63_SYM_SCC_HOST_BUFFER_RAW,
+    .get_time_ms = bsp_get_time_ms,
+    .dspbuf = NULL,
 };
 
 static scc_t scc;
@@ -144,9 +166,14 @@ static dspbuf_config_t dspbuf_config =
     .buf_symbol = 0,
     .enc_format = COMPR_ENC_FORMAT_PACKED16,
     .bytes_per_reg = CS47L63_DSP_UNPACKED24_BYTES_PER_REG,
+    .get_time_ms = bsp_get_time_ms,
+    .hwm_latency_min_ms = 20,
+    .hwm_latency_max_ms = 250,
 };
 
 static dspbuf_t dspbuf;
+static dspbuf_t *dspbuf_streams[] = {&dspbuf};
+static dspbuf_group_t dspbuf_group;
 
 /***********************************************************************************************************************
  * GLOBAL VARIABLES
@@ -158,59 +185,100 @@ volatile bool bsp_process_i2s = false;
  * LOCAL FUNCTIONS
  **********************************************************************************************************************/
 
+#ifdef CONFIG_PERF_STATS
+// Read the Cortex-M4 DWT cycle counter - the time source of the pipeline statistics
+static uint32_t bsp_dut_get_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+// Start the DWT cycle counter and use it to time the stages of the pipeline
+static void bsp_dut_perf_stats_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    perf_stats_set_time_source(bsp_dut_get_cycles);
+}
+
+// Print the statistics of one stage of the pipeline - latencies are in core clock cycles
+static void bsp_dut_print_perf_stats(const char *name, perf_stats_t *stats)
+{
+    debug_printf("%s: %lu calls, %lu bytes, %lu B/s, p50 %lu p99 %lu max %lu cycles\n\r",
+                 name,
+                 stats->calls,
+                 (uint32_t) stats->bytes,
+                 perf_stats_get_throughput(stats, SystemCoreClock),
+                 perf_stats_get_percentile(stats, 50),
+                 perf_stats_get_percentile(stats, 99),
+                 stats->max_ticks);
+}
+#endif
+
 // Write audio data to I2S - silence or decompressed audio (if started streaming)
 static void bsp_dut_update_i2s_data(void)
 {
-    // Remove the read data
-    data_ringbuf_bytes_read(&i2s_data_buf, BSP_DUT_I2S_HALF_SIZE);
+    data_ringbuf_iov_t iov[DATA_RINGBUF_IOV_MAX];
+
+    // The I2S DMA has played half of the buffer, which is free once the level meter has been dropped if need be
+    data_ringbuf_tee_bytes_read(&i2s_data_tee, i2s_reader, BSP_DUT_I2S_HALF_SIZE);
+    data_ringbuf_tee_get_write_iov(&i2s_data_tee, iov);
 
     // If not yet playing then fake adding more silence
     if (!bsp_decompressed_data_playing)
     {
-        uint8_t *next_write_ptr;
-        uint32_t next_write_length;
-
-        // Get the next write block
-        data_ringbuf_next_write_block(&i2s_data_buf, &next_write_ptr, &next_write_length);
-        // Fill with silence
-        memset(next_write_ptr, 0, next_write_length);
-        data_ringbuf_bytes_written(&i2s_data_buf, next_write_length);
+        for (uint32_t i = 0; i < DATA_RINGBUF_IOV_MAX; i++)
+        {
+            if (iov[i].len > 0)
+            {
+                memset(iov[i].ptr, 0, iov[i].len);
+            }
+        }
+        data_ringbuf_tee_commit_write_iov(&i2s_data_tee, iov[0].len + iov[1].len);
     }
     else
     {
         // Playing so add more decompressed data to i2s data buffer
         // CS47L63 only provides a mono stream whereas the I2S is expecting stereo, so duplicate the stream as it
-        // is copied in
-        uint32_t data_to_write = data_ringbuf_free_space(&i2s_data_buf);
-        uint32_t decompr_data_avail = data_ringbuf_data_length(&dspbuf.decompr_data_buf);
+        // is converted straight into the I2S buffer, where the level meter also reads it
+        uint32_t bytes_converted;
 
+        fmtconv_data_iov(&i2s_conv, iov, &dspbuf.decompr_data_buf, &bytes_converted);
+        data_ringbuf_tee_commit_write_iov(&i2s_data_tee, bytes_converted);
+    }
+}
 
-        // Whilst there is space for data and data to be read, copy it mono->stereo
-        while ((data_to_write > 0) && (decompr_data_avail > 0))
+// Find the peak level of the audio played since the last update
+static void bsp_dut_update_level_meter(void)
+{
+    uint8_t *read_ptr;
+    uint32_t read_len;
+
+    data_ringbuf_tee_next_read_block(&i2s_data_tee, level_meter_reader, &read_ptr, &read_len);
+    while (read_len >= sizeof(int16_t))
+    {
+        uint32_t peak = level_meter_peak;
+
+        read_len &= ~(sizeof(int16_t) - 1);
+        for (uint32_t i = 0; i < read_len; i += sizeof(int16_t))
         {
-            uint8_t *next_read_ptr;
-            uint32_t next_read_len = 0;
-            uint8_t stereo_buf[256];
-            uint32_t stereo_bytes_written = 0;
-            data_ringbuf_next_read_block(&dspbuf.decompr_data_buf, &next_read_ptr, &next_read_len);
-            while ((next_read_len > 0) && (data_to_write > 0) && ((stereo_bytes_written + 3) < sizeof(stereo_buf)))
+            int32_t sample = (int16_t) (read_ptr[i] | (read_ptr[i + 1] << 8));
+            uint32_t level = (sample < 0) ? -sample : sample;
+
+            if (level > peak)
             {
-                stereo_buf[stereo_bytes_written] = *next_read_ptr;
-                stereo_buf[stereo_bytes_written + 2] = *next_read_ptr;
-                next_read_ptr++;
-                next_read_len--;
-                decompr_data_avail--;
-                stereo_buf[stereo_bytes_written + 1] = *next_read_ptr;
-                stereo_buf[stereo_bytes_written + 3] = *next_read_ptr;
-                next_read_ptr++;
-                next_read_len--;
-                decompr_data_avail--;
-                stereo_bytes_written += 4;
-                data_to_write -= 4;
+                peak = level;
             }
-            data_ringbuf_write(&i2s_data_buf, stereo_buf, stereo_bytes_written);
-            data_ringbuf_bytes_read(&dspbuf.decompr_data_buf, stereo_bytes_written / 2);
         }
+
+        // If the meter fell behind, the samples may have been overwritten as they were measured, so discard them
+        if (data_ringbuf_tee_bytes_read(&i2s_data_tee, level_meter_reader, read_len) == DATA_RINGBUF_TEE_STATUS_OK)
+        {
+            level_meter_peak = peak;
+        }
+
+        data_ringbuf_tee_next_read_block(&i2s_data_tee, level_meter_reader, &read_ptr, &read_len);
     }
 }
 
@@ -299,6 +367,10 @@ uint32_t bsp_dut_initialize(void)
     // Set audio frequency to 16000
     bsp_audio_set_fs(BSP_AUDIO_FS_16000_HZ);
 
+#ifdef CONFIG_PERF_STATS
+    bsp_dut_perf_stats_init();
+#endif
+
     return ret;
 }
 
@@ -479,41 +551,52 @@ static uint32_t bsp_dut_scc_record(compr_enc_format_t enc_format, uint32_t dsp_c
     bsp_process_i2s = false;
     bsp_decompressed_data_playing = false;
 
-    // Play silence to ensure there is a clock
-    if (i2s_data == NULL)
+    // All buffers and contexts of the pipeline come from one arena, which is only malloc'ed once so that repeatedly
+    // starting and stopping cannot fragment the heap
+    if (bsp_arena_mem == NULL)
     {
-        i2s_data_len = BSP_DUT_I2S_SIZE;
-        i2s_data = (uint8_t *)malloc(i2s_data_len);
-        if (i2s_data == NULL)
+        bsp_arena_mem = (uint8_t *)malloc(BSP_DUT_ARENA_SIZE);
+        if (bsp_arena_mem == NULL)
         {
-            debug_printf("Failed to allocate I2S buffer\n\r");
-            i2s_data_len = 0;
+            debug_printf("Failed to allocate arena\n\r");
             return BSP_STATUS_FAIL;
         }
+        arena_init(&bsp_arena, bsp_arena_mem, BSP_DUT_ARENA_SIZE);
     }
-    memset(i2s_data, 0, i2s_data_len);
-    data_ringbuf_init(&i2s_data_buf, i2s_data, i2s_data_len);
+    arena_reset(&bsp_arena);
+
+    // Play silence to ensure there is a clock
+    // The I2S DMA reads the buffer without ever missing data, and the level meter reads the same audio from the same
+    // buffer but is dropped rather than ever holding up playback
+    ret = data_ringbuf_tee_init(&i2s_data_tee,
+                                (uint8_t *)arena_alloc(&bsp_arena, BSP_DUT_I2S_SIZE),
+                                BSP_DUT_I2S_SIZE);
+    if ((ret != DATA_RINGBUF_TEE_STATUS_OK) || (i2s_data_tee.buf_ptr == NULL))
+    {
+        debug_printf("Failed to allocate I2S buffer\n\r");
+        return BSP_STATUS_FAIL;
+    }
+    data_ringbuf_tee_add_reader(&i2s_data_tee, DATA_RINGBUF_TEE_POLICY_BLOCK, &i2s_reader);
     // Fake the buffer being full so the DMA callbacks can keep track of which part to fill with data
-    data_ringbuf_bytes_written(&i2s_data_buf, i2s_data_len);
+    memset(i2s_data_tee.buf_ptr, 0, BSP_DUT_I2S_SIZE);
+    data_ringbuf_tee_bytes_written(&i2s_data_tee, BSP_DUT_I2S_SIZE);
+    data_ringbuf_tee_add_reader(&i2s_data_tee, DATA_RINGBUF_TEE_POLICY_DROP, &level_meter_reader);
+    level_meter_peak = 0;
 
+    decompressed_data_len = BSP_DUT_RECORDING_SIZE;
+    decompressed_data = (uint8_t *)arena_alloc(&bsp_arena, decompressed_data_len);
     if (decompressed_data == NULL)
     {
-        decompressed_data_len = BSP_DUT_RECORDING_SIZE;
-        decompressed_data = (uint8_t *)malloc(decompressed_data_len);
-        if (decompressed_data == NULL)
-        {
-            decompressed_data_len = 0;
-            free(i2s_data);
-            i2s_data = NULL;
-            i2s_data_len = 0;
-            debug_printf("Failed to allocate decompressed data buffer\n\r");
-            return BSP_STATUS_FAIL;
-        }
+        decompressed_data_len = 0;
+        debug_printf("Failed to allocate decompressed data buffer\n\r");
+        return BSP_STATUS_FAIL;
     }
     data_ringbuf_init(&dspbuf.decompr_data_buf, decompressed_data, decompressed_data_len);
+    fmtconv_init(&i2s_conv, &i2s_conv_config);
+
     ret =  bsp_audio_play_stream(BSP_I2S_PORT_PRIMARY,
-                                 i2s_data,
-                                 i2s_data_len,
+                                 i2s_data_tee.buf_ptr,
+                                 i2s_data_tee.buf_size,
                                  cs47l63_i2s_callback,
                                  NULL,
                                  cs47l63_i2s_callback,
@@ -579,6 +662,7 @@ static uint32_t bsp_dut_scc_record(compr_enc_format_t enc_format, uint32_t dsp_c
     scc_config.enc_format = enc_format;
     scc_config.fw_info = cs47l63_driver.dsp_info[scc_config.dsp_core -1].fw_info; //TODO: Should be a getter
     scc_config.cp_config = cp;
+    scc_config.dspbuf = &dspbuf;
     scc_init(&scc, &scc_config, &bsp_scc_init);
 
     // Set up audio input channels
@@ -598,12 +682,16 @@ static uint32_t bsp_dut_scc_record(compr_enc_format_t enc_format, uint32_t dsp_c
         return CS47L63_STATUS_FAIL;
     }
 
-    // Init data and dsp buffer
-    dspbuf_config.compr_buf_ptr = malloc(BSP_DUT_BUFFER_SIZE);
-    dspbuf_config.compr_buf_size = BSP_DUT_BUFFER_SIZE;
+    // Init data and dsp buffer, serviced as a group of one stream
+    dspbuf_config.arena = &bsp_arena;
     dspbuf_config.buf_symbol = scc_get_host_buffer(&scc);
     dspbuf_config.enc_format = enc_format;
-    ret = dspbuf_init(&dspbuf, &dspbuf_config);
+    ret = dspbuf_group_init(&dspbuf_group,
+                            dspbuf_streams,
+                            &dspbuf_config,
+                            1,
+                            arena_alloc(&bsp_arena, BSP_DUT_BUFFER_SIZE),
+                            BSP_DUT_BUFFER_SIZE);
     if (ret != DSPBUF_STATUS_OK)
     {
         debug_printf("Failed to init dsp buf %lu\n\r", ret);
@@ -616,14 +704,15 @@ static uint32_t bsp_dut_scc_record(compr_enc_format_t enc_format, uint32_t dsp_c
         debug_printf("Failed to send host command\n\r");
         return BSP_STATUS_FAIL;
     }
-    ret = scc_update_status(&scc);
-    if (ret != SCC_STATUS_OK)
+    // The dsp buffer first, so any trigger event scc records has the current host buffer write index
+    ret = dspbuf_update_status(&dspbuf);
+    if (ret != DSPBUF_STATUS_OK)
     {
         debug_printf("Failed to update status\n\r");
         return BSP_STATUS_FAIL;
     }
-    ret = dspbuf_update_status(&dspbuf);
-    if (ret != DSPBUF_STATUS_OK)
+    ret = scc_update_status(&scc);
+    if (ret != SCC_STATUS_OK)
     {
         debug_printf("Failed to update status\n\r");
         return BSP_STATUS_FAIL;
@@ -632,49 +721,35 @@ static uint32_t bsp_dut_scc_record(compr_enc_format_t enc_format, uint32_t dsp_c
     return ret;
 }
 
-uint32_t bsp_dut_process_compressed_data(void)
+// Read and decompress the data signalled by the DSP IRQ, or just decompress data already read
+static uint32_t bsp_dut_process_compressed_data(bool service_dspbuf)
 {
     uint32_t ret;
-    bool can_read_more_data;
-    bool can_decrypt_more_data;
+    uint32_t data_read = 0;
+    uint32_t bytes_decompressed;
 
-    do
+    if (service_dspbuf)
     {
-        uint32_t compress_space_avail;
-        uint32_t decompress_space_avail;
-        uint32_t data_read = 0;
-        uint32_t bytes_decompressed;
-
-        compress_space_avail = data_ringbuf_free_space(&dspbuf.compr_data_buf);
-
-        // Check if we can read more data
-        if ((compress_space_avail > 0) && (dspbuf_get_data_avail(&dspbuf) > 0))
+        // The IRQ is only re-enabled once everything has been read, so keep servicing until nothing is pending
+        ret = dspbuf_group_service(&dspbuf_group, &data_read);
+        if (ret == DSPBUF_STATUS_FAIL)
         {
-            uint32_t data_len = (compress_space_avail > dspbuf_get_data_avail(&dspbuf)) ?
-                            dspbuf_get_data_avail(&dspbuf) : compress_space_avail;
-            ret = dspbuf_read(&dspbuf, &dspbuf.compr_data_buf, data_len, &data_read);
-            if (ret != DSPBUF_STATUS_OK)
-            {
-                debug_printf("Failed to read %lu bytes\n\r", data_len);
-                return BSP_STATUS_FAIL;
-            }
+            debug_printf("Failed to service dsp buf\n\r");
+            return BSP_STATUS_FAIL;
         }
+        bsp_process_irq = (ret == DSPBUF_STATUS_AGAIN);
+        bytes_read_total += data_read;
+    }
+    else
+    {
+        // Data left over when the decompressed data buffer filled up
         ret = decompr_data(&dspbuf.decompr, &dspbuf.decompr_data_buf, &dspbuf.compr_data_buf, &bytes_decompressed);
-        if (ret != CS47L63_STATUS_OK)
+        if (ret != DECOMPR_STATUS_OK)
         {
             debug_printf("Failed to decompress\n\r");
             return BSP_STATUS_FAIL;
         }
-
-        // See how much more data can be dealt with
-        compress_space_avail = data_ringbuf_free_space(&dspbuf.compr_data_buf);
-        decompress_space_avail = data_ringbuf_free_space(&dspbuf.decompr_data_buf);
-        bytes_read_total += data_read;
-        can_read_more_data = (dspbuf_get_data_avail(&dspbuf) > 0) && (compress_space_avail > 4);
-        can_decrypt_more_data = (decompress_space_avail > 8)
-                             && (data_ringbuf_data_length(&dspbuf.compr_data_buf) > 0)
-                             && (bytes_decompressed > 0);
-    } while (can_read_more_data && can_decrypt_more_data);
+    }
 
     if (!bsp_decompressed_data_playing
      && (data_ringbuf_data_length(&dspbuf.decompr_data_buf) >= (BSP_DUT_I2S_SIZE * 2)))
@@ -682,19 +757,6 @@ uint32_t bsp_dut_process_compressed_data(void)
         bsp_decompressed_data_playing = true;
     }
 
-    // If all data from the original interrupt has been processed, and it has not yet been acknowledged, then
-    // acknowledge the interrupt
-    if ((dspbuf_get_data_avail(&dspbuf) == 0) && bsp_process_irq)
-    {
-         // If the data has been dealt with, ack the interrupt
-         ret = dspbuf_reenable_irq(&dspbuf);
-         if (ret != DSPBUF_STATUS_OK)
-         {
-             return BSP_STATUS_FAIL;
-         }
-         bsp_process_irq = false;
-     }
-
     return BSP_STATUS_OK;
 }
 
@@ -705,6 +767,10 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
     uint32_t scc_state;
     uint32_t scc_status;
     uint32_t scc_error;
+    scc_event_t scc_event;
+    uint32_t overrun_count;
+    uint32_t overrun_bytes;
+    bool service_dspbuf = false;
     regmap_cp_config_t *cp = REGMAP_GET_CP(&cs47l63_driver);
 
     switch (use_case) {
@@ -716,25 +782,38 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             bsp_dut_scc_record(COMPR_ENC_FORMAT_MSBC, 1);
             debug_printf("MSBC format\n\r");
             break;
+#ifdef CONFIG_SCC_IMA_ADPCM
+        case BSP_USE_CASE_SCC_RECORD_IMA_ADPCM:
+            bsp_dut_scc_record(COMPR_ENC_FORMAT_IMA_ADPCM, 1);
+            debug_printf("IMA_ADPCM format\n\r");
+            break;
+#endif
         case BSP_USE_CASE_SCC_MANUAL_TRIGGER:
-            ret = scc_update_status(&scc);
-            if (ret != SCC_STATUS_OK)
-            {
-                debug_printf("MANUAL_TRIGGER: failed to update scc status\n\r");
-                return BSP_STATUS_FAIL;
-            }
+            // The dsp buffer is updated before scc each time, so trigger events get the current write index
             ret = dspbuf_update_status(&dspbuf);
             if (ret != DSPBUF_STATUS_OK)
             {
                 debug_printf("MANUAL_TRIGGER: failed to update dsp_buf status\n\r");
                 return BSP_STATUS_FAIL;
             }
+            ret = scc_update_status(&scc);
+            if (ret != SCC_STATUS_OK)
+            {
+                debug_printf("MANUAL_TRIGGER: failed to update scc status\n\r");
+                return BSP_STATUS_FAIL;
+            }
             ret = scc_host_command(&scc, SCC_HOST_CMD_START_VTE_STREAM1);
             if (ret != SCC_STATUS_OK)
             {
                 debug_printf("MANUAL_TRIGGER: failed to issue START_VTE_STREAM1 command\n\r");
                 return BSP_STATUS_FAIL;
             }
+            ret = dspbuf_update_status(&dspbuf);
+            if (ret != DSPBUF_STATUS_OK)
+            {
+                debug_printf("MANUAL_TRIGGER: failed to update dsp_buf status\n\r");
+                return BSP_STATUS_FAIL;
+            }
             ret = scc_update_status(&scc);
             if (ret != SCC_STATUS_OK)
             {
@@ -758,6 +837,13 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             && ((scc_status & SCC_STATUS_VTE1_MOST_RECENT_TRIGGER) == SCC_STATUS_VTE1_MOST_RECENT_TRIGGER))
             {
                 debug_printf("SCC VTE1 has TRIGGERED!\n\r");
+                // The trigger was seen by the IRQ, which noted where the host buffer had got to at the time
+                while (scc_get_event(&scc, &scc_event) == SCC_STATUS_OK)
+                {
+                    debug_printf("Trigger at %lu ms, host buffer write index %lu\n\r",
+                                 scc_event.time_ms,
+                                 scc_event.write_index);
+                }
 
                 // Acknowledge the trigger
                 ret = scc_host_command(&scc, SCC_HOST_CMD_ACK_VTE1_TRIG);
@@ -766,18 +852,18 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
                     debug_printf("TRIGGERED: failed to issue ACK_VTE1_TRIG command\n\r");
                     return BSP_STATUS_FAIL;
                 }
-                ret = scc_update_status(&scc);
-                if (ret != SCC_STATUS_OK)
-                {
-                    debug_printf("TRIGGERED: failed to update scc status\n\r");
-                    return BSP_STATUS_FAIL;
-                }
                 ret = dspbuf_update_status(&dspbuf);
                 if (ret != DSPBUF_STATUS_OK)
                 {
                     debug_printf("TRIGGERED: failed to update dsp_buf status\n\r");
                     return BSP_STATUS_FAIL;
                 }
+                ret = scc_update_status(&scc);
+                if (ret != SCC_STATUS_OK)
+                {
+                    debug_printf("TRIGGERED: failed to update scc status\n\r");
+                    return BSP_STATUS_FAIL;
+                }
             }
             else
             {
@@ -786,31 +872,24 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             }
             // Deliberate drop through to read any data and ack the interrupt
         case BSP_USE_CASE_SCC_PROCESS_IRQ:
-            if (dspbuf_get_data_avail(&dspbuf) == 0)
-            {
-                ret = dspbuf_data_avail(&dspbuf);
-                if (ret != DSPBUF_STATUS_OK)
-                {
-                    debug_printf("Failed to get data_avail\n\r");
-                    return BSP_STATUS_FAIL;
-                }
-            }
+            // The dsp_buf status is read, and an overflow skipped, when it is serviced
+            service_dspbuf = true;
             // Deliberate drop-through
         case BSP_USE_CASE_SCC_PROCESS_I2S:
-            dsp_buf_error = dspbuf_get_error(&dspbuf);
             scc_error = scc_get_error(&scc);
-            if ((dsp_buf_error != 0) || (scc_error != 0))
+            if (scc_error != 0)
             {
-                debug_printf("PROCESS_I2S: dsp_buf or scc error\n\r");
+                debug_printf("PROCESS_I2S: scc error\n\r");
                 return BSP_STATUS_FAIL;
             }
 
-            ret = bsp_dut_process_compressed_data();
+            ret = bsp_dut_process_compressed_data(service_dspbuf);
             if (ret != BSP_STATUS_OK)
             {
                 debug_printf("SCC PROCESS: Failed to process data\n\r");
                 return BSP_STATUS_FAIL;
             }
+            bsp_dut_update_level_meter();
             break;
         case BSP_USE_CASE_SCC_STOP_RECORDING:
             // SCC
@@ -824,13 +903,13 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             {
                 return BSP_STATUS_FAIL;
             }
-            ret = scc_update_status(&scc);
-            if (ret != SCC_STATUS_OK)
+            ret = dspbuf_update_status(&dspbuf);
+            if (ret != DSPBUF_STATUS_OK)
             {
                 return BSP_STATUS_FAIL;
             }
-            ret = dspbuf_update_status(&dspbuf);
-            if (ret != DSPBUF_STATUS_OK)
+            ret = scc_update_status(&scc);
+            if (ret != SCC_STATUS_OK)
             {
                 return BSP_STATUS_FAIL;
             }
@@ -842,19 +921,29 @@ uint32_t bsp_dut_use_case(uint32_t use_case)
             // Allow some time for the last interrupt to fire
             cs47l63_wait(200);
 
+#ifdef CONFIG_PERF_STATS
+            bsp_dut_print_perf_stats("dspbuf_read", &dspbuf.stats.read_perf);
+            bsp_dut_print_perf_stats("decompr_data", &dspbuf.decompr.perf);
+            bsp_dut_print_perf_stats("fmtconv_data", &i2s_conv.perf);
+#endif
             decompr_deinit(&dspbuf.decompr);
 
-            // Buffers free
-            free(dspbuf_config.compr_buf_ptr);
-            dspbuf_config.compr_buf_ptr = NULL;
-            free(decompressed_data);
+            data_ringbuf_tee_get_overruns(&i2s_data_tee, level_meter_reader, &overrun_count, &overrun_bytes);
+            debug_printf("Level meter peak %lu, %lu overruns, %lu bytes lost\n\r",
+                         level_meter_peak,
+                         overrun_count,
+                         overrun_bytes);
+
+            // Buffers free, all at once
+            dspbuf.config.compr_buf_ptr = NULL;
             decompressed_data = NULL;
             decompressed_data_len = 0;
             data_ringbuf_init(&dspbuf.decompr_data_buf, decompressed_data, decompressed_data_len);
-            free(i2s_data);
-            i2s_data = NULL;
-            i2s_data_len = 0;
-            data_ringbuf_init(&i2s_data_buf, i2s_data, i2s_data_len);
+            i2s_data_tee.buf_ptr = NULL;
+            debug_printf("Arena high water %lu of %lu bytes\n\r",
+                         arena_get_high_water(&bsp_arena),
+                         (uint32_t) BSP_DUT_ARENA_SIZE);
+            arena_reset(&bsp_arena);
 
             // Reset flags
             bsp_process_irq = false;
@@ -929,7 +1018,6 @@ void cs47l63_notification_callback(uint32_t event_flags, void* arg)
     if (event_flags & CS47L63_EVENT_FLAG_DSP1_IRQ0)
     {
         // Update the statuses of the dsp buffer and scc
-        dspbuf_data_avail(&dspbuf);
         dspbuf_update_status(&dspbuf);
         scc_update_status(&scc);
         bsp_process_irq = true;
@@ -37,10 +37,14 @@ extern "C" {
  **********************************************************************************************************************/
 #define BSP_DUT_I2C_ADDRESS_8BIT                            (0x80)
 
+// The I2S buffer is also read by the level meter through a data_ringbuf_tee, so must be a power of two
 #define BSP_DUT_I2S_HALF_SIZE                               (4096)
 #define BSP_DUT_I2S_SIZE                                    (BSP_DUT_I2S_HALF_SIZE * 2)
 #define BSP_DUT_BUFFER_SIZE                                 (BSP_DUT_I2S_SIZE * 2)
 #define BSP_DUT_RECORDING_SIZE                              (BSP_DUT_I2S_SIZE * 3)
+// I2S, decompressed and compressed data buffers, plus the decompression contexts
+#define BSP_DUT_ARENA_SIZE                                  (BSP_DUT_I2S_SIZE + BSP_DUT_RECORDING_SIZE + \
+                                                             BSP_DUT_BUFFER_SIZE + 2048)
 
 /***********************************************************************************************************************
  * MACROS
@@ -54,6 +58,10 @@ extern "C" {
 #define BSP_USE_CASE_SCC_PROCESS_IRQ                            (0x6)
 #define BSP_USE_CASE_SCC_PROCESS_I2S                            (0x7)
 #define BSP_USE_CASE_SCC_STOP_RECORDING                         (0x8)
+#ifdef CONFIG_SCC_IMA_ADPCM
+// Needs SCC firmware with IMA ADPCM encoding, see CONFIG_SCC_IMA_ADPCM in the makefile
+#define BSP_USE_CASE_SCC_RECORD_IMA_ADPCM                       (0x9)
+#endif
 
 /***********************************************************************************************************************
  * ENUMS, STRUCTS, UNIONS, TYPEDEFS
@@ -66,7 +66,7 @@ supported_part_numbers = ['cs35l41',
                           'cs47l24_dsp2',
                           'cs47l24_dsp3']
 
-supported_commands = ['print', 'export', 'wisce', 'fw_img_v1', 'fw_img_v2', 'json']
+supported_commands = ['print', 'export', 'wisce', 'fw_img_v1', 'fw_img_v2', 'fw_img_v3', 'fw_img_prelinked', 'json']
 
 supported_mem_maps = {
     'halo_type_0': {
@@ -378,7 +378,7 @@ def validate_args(args):
                 return False
 
     # Check that all symbol id header files exist
-    if ((args.command == 'fw_img_v1' or args.command == 'fw_img_v2') and (args.symbol_id_input is not None)):
+    if ((args.command in ['fw_img_v1', 'fw_img_v2', 'fw_img_v3', 'fw_img_prelinked']) and (args.symbol_id_input is not None)):
         if (not os.path.exists(args.symbol_id_input)):
             print("Invalid Symbol Header path: " + args.symbol_id_input)
             return False
@@ -418,7 +418,7 @@ def print_args(args):
     else:
         print("No suffix")
 
-    if (args.command == 'fw_img_v1' or args.command == 'fw_img_v2'):
+    if (args.command in ['fw_img_v1', 'fw_img_v2', 'fw_img_v3', 'fw_img_prelinked']):
         if (args.symbol_id_input is not None):
             print("Input Symbol ID Header: " + args.symbol_id_input)
         else:
@@ -592,6 +592,12 @@ def main(argv):
         f.add_firmware_exporter('fw_img_v2')
         if args.no_sym_table:
             f.add_firmware_exporter('c_array')
+    elif (args.command == 'fw_img_v3'):
+        f.add_firmware_exporter('fw_img_v3')
+        if args.no_sym_table:
+            f.add_firmware_exporter('c_array')
+    elif (args.command == 'fw_img_prelinked'):
+        f.add_firmware_exporter('fw_img_prelinked')
     elif (args.command == 'wisce'):
         f.add_firmware_exporter('wisce')
     elif (args.command == 'json'):
@@ -28,12 +28,13 @@ from firmware_exporter import firmware_exporter
 from c_h_file_templates import source_file_exporter
 from wisce_file_templates import wisce_script_file
 from fw_img_v1_templates import fw_img_v1_file
+from fw_img_prelinked_templates import fw_img_prelinked_file
 from json_exporter import json_exporter
 
 #==========================================================================
 # CONSTANTS/GLOBALS
 #==========================================================================
-exporter_types = ['c_array', 'fw_img_v1', 'fw_img_v2', 'wisce', 'json']
+exporter_types = ['c_array', 'fw_img_v1', 'fw_img_v2', 'fw_img_v3', 'fw_img_prelinked', 'wisce', 'json']
 
 #==========================================================================
 # CLASSES
@@ -59,6 +60,12 @@ class firmware_exporter_factory(firmware_exporter):
         elif (type == 'fw_img_v2'):
             e = fw_img_v1_file(self.attributes, 0x2)
             self.exporters.append(e)
+        elif (type == 'fw_img_v3'):
+            e = fw_img_v1_file(self.attributes, 0x3)
+            self.exporters.append(e)
+        elif (type == 'fw_img_prelinked'):
+            e = fw_img_prelinked_file(self.attributes)
+            self.exporters.append(e)
         elif (type == 'wisce'):
             e = wisce_script_file(self.attributes)
             self.exporters.append(e)
@@ -0,0 +1,316 @@
+#==========================================================================
+# (c) 2026 Cirrus Logic, Inc.
+#--------------------------------------------------------------------------
+# Project : Templates for pre-linked fw_img C Source and Header files
+# File    : fw_img_prelinked_templates.py
+#--------------------------------------------------------------------------
+# Licensed under the Apache License, Version 2.0 (the License); you may
+# not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an AS IS BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#--------------------------------------------------------------------------
+#
+# Environment Requirements: None
+#
+#==========================================================================
+
+#==========================================================================
+# IMPORTS
+#==========================================================================
+import os
+from fw_img_v1_templates import fw_img_v1_file, IMG_MAGIC_NUMBER_1
+import time
+
+#==========================================================================
+# CONSTANTS/GLOBALS
+#==========================================================================
+header_file_template_str = """/**
+ * @file {part_number_lc}_fw_img_prelinked.h
+ *
+ * @brief {part_number_uc} Pre-linked FW IMG Header File
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic """ + time.strftime("%Y") + """ All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef {part_number_uc}_FW_IMG_PRELINKED_H
+#define {part_number_uc}_FW_IMG_PRELINKED_H
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include <stdint.h>
+#include "fw_img.h"
+
+/***********************************************************************************************************************
+ * FW_IMG
+ **********************************************************************************************************************/
+
+extern const fw_img_prelinked_t {part_number_lc}_fw_img_prelinked;
+
+/**********************************************************************************************************************/
+
+#endif // {part_number_uc}_FW_IMG_PRELINKED_H
+
+"""
+
+source_file_template_str = """/**
+ * @file {part_number_lc}_fw_img_prelinked.c
+ *
+ * @brief {part_number_uc} Pre-linked FW IMG Source File
+ *
+ * @copyright
+ * Copyright (c) Cirrus Logic """ + time.strftime("%Y") + """ All Rights Reserved, http://www.cirrus.com/
+ *
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+{metadata_text} *
+ */
+
+/***********************************************************************************************************************
+ * INCLUDES
+ **********************************************************************************************************************/
+#include "{part_number_lc}_fw_img_prelinked.h"
+
+/***********************************************************************************************************************
+ * FW_IMG
+ **********************************************************************************************************************/
+
+/**
+ * @defgroup {part_number_uc}_FW_IMG_PRELINKED
+ * @brief Pre-linked firmware image
+ *
+ * @{
+ */
+
+// Symbol Linking Table, sorted by SYM_ID
+static const fw_img_v1_sym_table_t {part_number_lc}_fw_img_sym_table[] = {
+{sym_table}
+};
+
+// Algorithm ID List
+static const uint32_t {part_number_lc}_fw_img_alg_id_list[] = {
+{alg_list}
+};
+
+// Payload Data
+static const uint8_t {part_number_lc}_fw_img_payload[] __attribute__((aligned(4))) = {
+{payload}
+};
+
+// Data Blocks
+static const fw_img_prelinked_block_t {part_number_lc}_fw_img_blocks[] = {
+{blocks}
+};
+
+const fw_img_prelinked_t {part_number_lc}_fw_img_prelinked = {
+    .fw_info = {
+        .preheader = {
+            .img_magic_number_1 = {magic_number_1},
+            .img_format_rev = {img_format_rev},
+        },
+        .header = {
+            .img_size = {img_size},
+            .sym_table_size = {sym_table_size},
+            .alg_id_list_size = {alg_list_size},
+            .fw_id = {fw_id},
+            .fw_version = {fw_ver},
+            .data_blocks = {data_block_count},
+            .max_block_size = {max_block_size},
+            .fw_img_release = {bin_ver},
+        },
+        .const_sym_table = {part_number_lc}_fw_img_sym_table,
+        .const_alg_id_list = {part_number_lc}_fw_img_alg_id_list,
+        .sym_table_sorted = true,
+    },
+    .blocks = {part_number_lc}_fw_img_blocks,
+};
+
+/** @} */
+
+/**********************************************************************************************************************/
+
+"""
+
+source_file_template_sym_entry_str = """    { .sym_id = {sym_id}, .sym_addr = {sym_addr} }, // {sym_name}"""
+
+source_file_template_alg_entry_str = """    {alg_id}, // {alg_name}"""
+
+source_file_template_block_entry_str = """    { .block_size = {block_size}, .block_addr = {block_addr}, .bytes = {part_number_lc}_fw_img_payload + {block_offset} }, // {block_name}"""
+
+#==========================================================================
+# CLASSES
+#==========================================================================
+class fw_img_prelinked_file(fw_img_v1_file):
+    def __init__(self, attributes):
+        # Same contents and header values as fw_img_v2, but already parsed into C tables
+        fw_img_v1_file.__init__(self, attributes, 0x2)
+
+        return
+
+    def get_block_list(self):
+        # Blocks are in the same order as they would be in a fw_img
+        block_list = []
+        for i in range(0, len(self.fw_data_block_list)):
+            block_list.append(('FW_BLOCK_' + str(i), self.fw_data_block_list[i][1], self.fw_data_block_list[i][2]))
+        for i in range(0, len(self.coeff_data_block_list)):
+            for j in range(0, len(self.coeff_data_block_list[i])):
+                block_list.append(('COEFF_BLOCK_' + str(i) + '_' + str(j),
+                                   self.coeff_data_block_list[i][j][1],
+                                   self.coeff_data_block_list[i][j][2]))
+        for i in range(0, len(self.bin_data_block_list)):
+            for j in range(0, len(self.bin_data_block_list[i])):
+                block_list.append(('BIN_BLOCK_' + str(i) + '_' + str(j),
+                                   self.bin_data_block_list[i][j][1],
+                                   self.bin_data_block_list[i][j][2]))
+
+        return block_list
+
+    def create_source_file_text(self):
+        output_str = source_file_template_str
+
+        # Get list of symbols, sorted by ID so that fw_img_find_symbol() can use a binary search
+        sym_list = []
+        if not self.terms['no_sym_table']:
+            if (self.algorithms):
+                for alg_name, alg_id in self.algorithms.items():
+                    for control in self.algorithm_controls[alg_name]:
+                        sym_id = self.find_symbol_id(control[0])
+                        if sym_id:
+                            sym_list.append((sym_id, control[1], control[0].upper()))
+        sym_list.sort(key=lambda s: s[0])
+
+        temp_str = ''
+        for sym in sym_list:
+            temp_sym_str = source_file_template_sym_entry_str.replace('{sym_id}', hex(sym[0]))
+            temp_sym_str = temp_sym_str.replace('{sym_addr}', hex(sym[1]))
+            temp_sym_str = temp_sym_str.replace('{sym_name}', sym[2])
+            temp_str += temp_sym_str + '\n'
+        # Empty initializer lists are not allowed, so keep a dummy entry if no symbols
+        if (len(sym_list) == 0):
+            temp_str = '    { 0 },\n'
+        output_str = output_str.replace('{sym_table}\n', temp_str)
+
+        temp_str = ''
+        for alg_name, alg_id in self.algorithms.items():
+            temp_alg_str = source_file_template_alg_entry_str.replace('{alg_id}', hex(alg_id))
+            temp_alg_str = temp_alg_str.replace('{alg_name}', alg_name)
+            temp_str += temp_alg_str + '\n'
+        if (len(self.algorithms) == 0):
+            temp_str = '    0,\n'
+        output_str = output_str.replace('{alg_list}\n', temp_str)
+
+        # Add payload and block descriptors pointing into it
+        block_list = self.get_block_list()
+        payload_str = ''
+        blocks_str = ''
+        offset = 0
+        for block in block_list:
+            payload_str += '// ' + block[0] + '\n' + self.get_bytes_string(block[2]) + '\n'
+            temp_block_str = source_file_template_block_entry_str.replace('{block_size}', hex(len(block[2])))
+            temp_block_str = temp_block_str.replace('{block_addr}', hex(block[1]))
+            temp_block_str = temp_block_str.replace('{block_offset}', hex(offset))
+            temp_block_str = temp_block_str.replace('{block_name}', block[0])
+            blocks_str += temp_block_str + '\n'
+            offset += len(block[2])
+        if (len(block_list) == 0):
+            payload_str = '0x00,\n'
+            blocks_str = '    { 0 },\n'
+        output_str = output_str.replace('{payload}\n', payload_str)
+        output_str = output_str.replace('{blocks}\n', blocks_str)
+
+        # Equivalent fw_img_v2 size, for information
+        img_size = (12 + (len(sym_list) * 2) + len(self.algorithms)) * 4
+        for block in block_list:
+            img_size += 8 + len(block[2])
+
+        output_str = output_str.replace('{magic_number_1}', hex(IMG_MAGIC_NUMBER_1))
+        output_str = output_str.replace('{img_format_rev}', hex(self.terms['version']))
+        output_str = output_str.replace('{img_size}', hex(img_size))
+        output_str = output_str.replace('{sym_table_size}', str(len(sym_list)))
+        output_str = output_str.replace('{alg_list_size}', str(len(self.algorithms)))
+        output_str = output_str.replace('{fw_id}', hex(self.terms['fw_id']))
+        output_str = output_str.replace('{fw_ver}', hex(self.terms['fw_rev']))
+        output_str = output_str.replace('{data_block_count}', str(len(block_list)))
+        output_str = output_str.replace('{max_block_size}', str(self.terms['max_block_size']))
+        output_str = output_str.replace('{bin_ver}', hex(self.terms['bin_ver']))
+
+        output_str = output_str.replace('{part_number_lc}', self.terms['part_number_lc'])
+        output_str = output_str.replace('{part_number_uc}', self.terms['part_number_uc'])
+        output_str = output_str.replace('{metadata_text}', self.terms['metadata_text'])
+
+        return output_str
+
+    def create_header_file_text(self):
+        output_str = header_file_template_str
+
+        output_str = output_str.replace('{part_number_lc}', self.terms['part_number_lc'])
+        output_str = output_str.replace('{part_number_uc}', self.terms['part_number_uc'])
+
+        return output_str
+
+    def to_file(self):
+        results_str = 'Exported to files:\n'
+
+        temp_filename = self.attributes['part_number_str'] + self.attributes['suffix'] + "_fw_img_prelinked"
+        if self.attributes['output_directory']:
+            if not os.path.exists(self.attributes['output_directory']):
+                os.makedirs(self.attributes['output_directory'])
+            temp_filename = os.path.join(self.attributes['output_directory'], temp_filename)
+
+        # Open or generate the symbol id header
+        if (self.sym_id_input is not None):
+            tmp = open(self.sym_id_input, 'r')
+            self.sym_header = tmp.read()
+            tmp.close()
+        elif not self.terms['no_sym_table']:
+            self.sym_header = self.generate_symbol_header(None)
+
+        f = open(temp_filename + ".h", 'w')
+        f.write(self.create_header_file_text())
+        f.close()
+        results_str = results_str + temp_filename + '.h\n'
+
+        f = open(temp_filename + ".c", 'w')
+        f.write(self.create_source_file_text())
+        f.close()
+        results_str = results_str + temp_filename + '.c\n'
+
+        return results_str
+
+#==========================================================================
+# HELPER FUNCTIONS
+#==========================================================================
+
+#==========================================================================
+# MAIN PROGRAM
+#==========================================================================
@@ -129,10 +129,12 @@ const uint8_t {part_number_lc}_fw_img[] __attribute__((aligned(4))) = {
 {data_block_count} // DATA_BLOCKS
 {max_block_size}
 {bin_ver}
+{coeff_set_count}
 // Symbol Linking Table
 {sym_table}
 // Algorithm ID List
 {alg_list}
+{coeff_set_index}
 // Firmware Data
 {fw_data_blocks}
 {coeff_data}
@@ -141,6 +143,7 @@ const uint8_t {part_number_lc}_fw_img[] __attribute__((aligned(4))) = {
 // Footer
 {magic_number_2} // IMG_MAGIC_NUMBER_2
 {img_checksum} // IMG_CHECKSUM
+{coeff_sets}
 };
 
 /** @} */
@@ -166,6 +169,20 @@ source_file_template_coeff_block_str = """{coeff_block_size} // COEFF_BLOCK_SIZE
 {coeff_block_addr} // COEFF_BLOCK_ADDR_{coeff_index}_{block_index}
 {block_bytes}"""
 
+source_file_template_coeff_set_index_str = """// Coefficient Set Index
+{coeff_set_index_entries}"""
+
+source_file_template_coeff_set_index_entry_str = """{coeff_set_offset} // COEFF_SET_OFFSET_{coeff_index}
+{coeff_set_size} // COEFF_SET_SIZE_{coeff_index}
+{coeff_set_data_blocks} // COEFF_SET_DATA_BLOCKS_{coeff_index}
+"""
+
+source_file_template_coeff_set_str = """
+// COEFF_SET_{coeff_index}
+{coeff_block_arrays}{coeff_set_magic_number_2} // COEFF_SET_MAGIC_NUMBER_2_{coeff_index}
+{coeff_set_checksum} // COEFF_SET_CHECKSUM_{coeff_index}
+"""
+
 symbol_id_header_file_template_str = """
 /**
  * @file {part_number_lc}_sym.h
@@ -448,12 +465,74 @@ class fw_img_v1_file(firmware_exporter):
         self.c0 = (self.c0 + (bytes[2] + (bytes[3] << 8))) % modval
         self.c1 = (self.c1 + self.c0) % modval
 
-    def calc_checksum(self):
-        for i in range(0, len(self.image_word_list)):
+    def calc_checksum(self, start_index=0):
+        for i in range(start_index, len(self.image_word_list)):
             self.fletch32(self.image_word_list[i])
 
         return self.c0 + (self.c1 << 16)
 
+    def get_coeff_set_sizes(self):
+        # Each coefficient set is its data blocks followed by IMG_MAGIC_NUMBER_2 and a checksum
+        sizes = []
+        for coeff_data_block_list in self.coeff_data_block_list:
+            size = 8
+            for block in coeff_data_block_list:
+                size += 8 + block[0]
+            sizes.append(size)
+
+        return sizes
+
+    def get_coeff_set_index_str(self, control_count):
+        # fw_img_v3 only - the index precedes the blocks it points at, so calculate where each set will start
+        offset = (11 + (control_count * 2) + len(self.algorithms) + (len(self.coeff_data_block_list) * 3)) * 4
+        for block in self.fw_data_block_list:
+            offset += 8 + block[0]
+        for bin_data_block_list in self.bin_data_block_list:
+            for block in bin_data_block_list:
+                offset += 8 + block[0]
+        # IMG_MAGIC_NUMBER_2 and IMG_CHECKSUM
+        offset += 8
+
+        temp_str = ''
+        coeff_set_sizes = self.get_coeff_set_sizes()
+        for i in range(0, len(self.coeff_data_block_list)):
+            temp_temp_str = source_file_template_coeff_set_index_entry_str.replace('{coeff_index}', str(i))
+            temp_temp_str = temp_temp_str.replace('{coeff_set_offset}', self.add_word_to_img(offset))
+            temp_temp_str = temp_temp_str.replace('{coeff_set_size}', self.add_word_to_img(coeff_set_sizes[i]))
+            temp_temp_str = temp_temp_str.replace('{coeff_set_data_blocks}',
+                                                  self.add_word_to_img(len(self.coeff_data_block_list[i])))
+            temp_str += temp_temp_str
+            offset += coeff_set_sizes[i]
+
+        self.terms['coeff_sets_size'] = sum(coeff_set_sizes)
+
+        return source_file_template_coeff_set_index_str.replace('{coeff_set_index_entries}', temp_str)
+
+    def get_coeff_sets_str(self):
+        # fw_img_v3 only - each set is checksummed on its own so that it can be loaded without the rest of the fw_img
+        temp_str = ''
+        for i in range(0, len(self.coeff_data_block_list)):
+            start_index = len(self.image_word_list)
+            temp_temp_str = ''
+            for j in range(0, len(self.coeff_data_block_list[i])):
+                address = self.coeff_data_block_list[i][j][1]
+                data_bytes = self.coeff_data_block_list[i][j][2]
+                temp_temp_str += source_file_template_coeff_block_str.replace('{block_index}', str(j)) + '\n'
+                temp_temp_str = temp_temp_str.replace('{coeff_index}', str(i))
+                temp_temp_str = temp_temp_str.replace('{coeff_block_size}', self.add_word_to_img(len(data_bytes)))
+                temp_temp_str = temp_temp_str.replace('{coeff_block_addr}', self.add_word_to_img(address))
+                temp_temp_str = temp_temp_str.replace('{block_bytes}', self.add_bytes_to_img(data_bytes))
+
+            set_str = source_file_template_coeff_set_str.replace('{coeff_index}', str(i))
+            set_str = set_str.replace('{coeff_block_arrays}', temp_temp_str)
+            set_str = set_str.replace('{coeff_set_magic_number_2}', self.add_word_to_img(IMG_MAGIC_NUMBER_2))
+            self.c0 = 0x0
+            self.c1 = 0x0
+            set_str = set_str.replace('{coeff_set_checksum}', self.add_word_to_img(self.calc_checksum(start_index)))
+            temp_str += set_str
+
+        return temp_str
+
     def to_byte_array(self):
         # Convert to byte array
         byte_list = []
@@ -491,9 +570,11 @@ class fw_img_v1_file(firmware_exporter):
         output_str = output_str.replace('{fw_ver}', self.add_word_to_img(self.terms['fw_rev']))
 
         # Calculate 'DATA_BLOCKS' - number of total data blocks
+        # For fw_img_v3, coefficient set data blocks are counted in the Coefficient Set Index instead
         data_block_count = len(self.fw_data_block_list)
-        for i in range(0, len(self.coeff_data_block_list)):
-            data_block_count += len(self.coeff_data_block_list[i])
+        if self.terms['version'] != 3:
+            for i in range(0, len(self.coeff_data_block_list)):
+                data_block_count += len(self.coeff_data_block_list[i])
         for i in range(0, len(self.bin_data_block_list)):
             data_block_count += len(self.bin_data_block_list[i])
         output_str = output_str.replace('{data_block_count}', self.add_word_to_img(data_block_count))
@@ -506,6 +587,12 @@ class fw_img_v1_file(firmware_exporter):
             output_str = output_str.replace('{max_block_size}', self.add_word_to_img(self.terms['max_block_size']) + " // MAX_BLOCK_SIZE")
             output_str = output_str.replace('{bin_ver}', self.add_word_to_img(self.terms['bin_ver']) + " // FW_IMG_VERSION")
 
+        # Set COEFF_SETS
+        if self.terms['version'] == 3:
+            output_str = output_str.replace('{coeff_set_count}', self.add_word_to_img(len(self.coeff_data_block_list)) + " // COEFF_SETS")
+        else:
+            output_str = output_str.replace('{coeff_set_count}\n', "")
+
         # Add Symbol Linking Table
         if not self.terms['no_sym_table']:
             temp_ctl_str = ''
@@ -530,6 +617,12 @@ class fw_img_v1_file(firmware_exporter):
 
         output_str = output_str.replace('{alg_list}\n', temp_alg_str)
 
+        # Add Coefficient Set Index
+        if self.terms['version'] == 3:
+            output_str = output_str.replace('{coeff_set_index}', self.get_coeff_set_index_str(control_count))
+        else:
+            output_str = output_str.replace('{coeff_set_index}\n', "")
+
         # Add Firmware Data
         fw_block_str = ''
         for i in range(0, len(self.fw_data_block_list)):
@@ -545,8 +638,8 @@ class fw_img_v1_file(firmware_exporter):
 
         output_str = output_str.replace('{fw_data_blocks}', fw_block_str)
 
-        # Add COEFF_DATA_BLOCKS_
-        if (self.includes_coeff):
+        # Add COEFF_DATA_BLOCKS_ - for fw_img_v3 these are added as coefficient sets after the footer
+        if (self.includes_coeff and self.terms['version'] != 3):
             temp_str = ''
 
             for i in range(0, len(self.coeff_data_block_list)):
@@ -592,7 +685,10 @@ class fw_img_v1_file(firmware_exporter):
 
         # Update IMG_SIZE
         # need to add 8 to include the checksum and the img_size field itself.
+        # For fw_img_v3, IMG_SIZE also includes the coefficient sets following the footer.
         self.terms['img_size'] += 8
+        if self.terms['version'] == 3:
+            self.terms['img_size'] += self.terms['coeff_sets_size']
         output_str = output_str.replace('{img_size}', self.get_word_string(self.terms['img_size']))
         self.image_word_list.insert(2, self.terms['img_size'])
 
@@ -602,6 +698,12 @@ class fw_img_v1_file(firmware_exporter):
         else:
             output_str = output_str.replace('{img_checksum}', self.add_word_to_img(self.calc_checksum()))
 
+        # Add coefficient sets
+        if self.terms['version'] == 3:
+            output_str = output_str.replace('{coeff_sets}\n', self.get_coeff_sets_str())
+        else:
+            output_str = output_str.replace('{coeff_sets}\n', "")
+
         output_str = output_str.replace('{part_number_lc}', self.terms['part_number_lc'])
         output_str = output_str.replace('{part_number_uc}', self.terms['part_number_uc'])
         output_str = output_str.replace('{metadata_text}', self.terms['metadata_text'])